@@ -0,0 +1,222 @@
+//Library Includes
+#include <stdio.h>
+#include <string.h>
+
+//Local Includes
+#include <Engine\mappedfile.h>
+
+//This Include
+#include "cookcache.h"
+
+//Static Variables
+static const unsigned long long s_kullPrime1 = 0x9E3779B185EBCA87ULL;
+static const unsigned long long s_kullPrime2 = 0xC2B2AE3D27D4EB4FULL;
+static const unsigned long long s_kullPrime3 = 0x165667B19E3779F9ULL;
+static const unsigned long long s_kullPrime4 = 0x85EBCA77C2B2AE63ULL;
+static const unsigned long long s_kullPrime5 = 0x27D4EB2F165667C5ULL;
+
+//Helpers
+static inline unsigned long long RotateLeft(unsigned long long _ullValue, int _iBits)
+{
+	return((_ullValue << _iBits) | (_ullValue >> (64 - _iBits)));
+}
+
+static inline unsigned long long Read64(const unsigned char* _pData)
+{
+	unsigned long long ullValue;
+	memcpy(&ullValue, _pData, sizeof(ullValue));
+	return(ullValue);
+}
+
+static inline unsigned int Read32(const unsigned char* _pData)
+{
+	unsigned int uiValue;
+	memcpy(&uiValue, _pData, sizeof(uiValue));
+	return(uiValue);
+}
+
+static inline unsigned long long Round(unsigned long long _ullAccumulator, unsigned long long _ullInput)
+{
+	_ullAccumulator += _ullInput * s_kullPrime2;
+	_ullAccumulator = RotateLeft(_ullAccumulator, 31);
+	return(_ullAccumulator * s_kullPrime1);
+}
+
+static inline unsigned long long MergeRound(unsigned long long _ullAccumulator, unsigned long long _ullValue)
+{
+	_ullAccumulator ^= Round(0, _ullValue);
+	return(_ullAccumulator * s_kullPrime1 + s_kullPrime4);
+}
+
+//Implementation
+CCookCache::CCookCache()
+{
+	//Constructor
+}
+
+CCookCache::~CCookCache()
+{
+	//Destructor
+}
+
+bool
+CCookCache::Load(const char* _kpcFilename)
+{
+	m_mapEntries.clear();
+
+	FILE* pFile = nullptr;
+	if(fopen_s(&pFile, _kpcFilename, "r") != 0 || !pFile) return(false);
+
+	char pcLine[1024];
+	while(fgets(pcLine, sizeof(pcLine), pFile))
+	{
+		TEntry tEntry;
+		int iPathStart = 0;
+		if(sscanf_s(pcLine, "%llx %llx %llu %llu %n", &tEntry.ullContentHash, &tEntry.ullCookKey, &tEntry.ullSize, &tEntry.ullWriteTime, &iPathStart) < 4 || !iPathStart) continue;
+
+		//Path is the rest of the line, spaces included
+		std::string strPath = pcLine + iPathStart;
+		while(!strPath.empty() && (strPath.back() == '\n' || strPath.back() == '\r')) strPath.pop_back();
+		if(!strPath.empty()) m_mapEntries[strPath] = tEntry;
+	}
+
+	fclose(pFile);
+	return(true);
+}
+
+bool
+CCookCache::Save(const char* _kpcFilename) const
+{
+	//Written to the side and swapped in so an interrupted save can't lose the old cache
+	std::string strTemp = std::string(_kpcFilename) + ".tmp";
+
+	FILE* pFile = nullptr;
+	if(fopen_s(&pFile, strTemp.c_str(), "w") != 0 || !pFile) return(false);
+
+	bool bWritten = true;
+	m_mutexEntries.lock();
+	for(auto& rPair : m_mapEntries)
+	{
+		const TEntry& rtEntry = rPair.second;
+		bWritten = bWritten && fprintf(pFile, "%016llx %016llx %llu %llu %s\n", rtEntry.ullContentHash, rtEntry.ullCookKey, rtEntry.ullSize, rtEntry.ullWriteTime, rPair.first.c_str()) > 0;
+	}
+	m_mutexEntries.unlock();
+
+	bWritten = (fclose(pFile) == 0) && bWritten;
+	bWritten = bWritten && MoveFileExA(strTemp.c_str(), _kpcFilename, MOVEFILE_REPLACE_EXISTING);
+	if(!bWritten) remove(strTemp.c_str());
+
+	return(bWritten);
+}
+
+bool
+CCookCache::Find(const std::string& _rstrPath, TEntry& _rtEntry) const
+{
+	std::lock_guard<std::mutex> lockEntries(m_mutexEntries);
+
+	auto it = m_mapEntries.find(_rstrPath);
+	if(it == m_mapEntries.end()) return(false);
+
+	_rtEntry = it->second;
+	return(true);
+}
+
+void
+CCookCache::Store(const std::string& _rstrPath, const TEntry& _rtEntry)
+{
+	std::lock_guard<std::mutex> lockEntries(m_mutexEntries);
+	m_mapEntries[_rstrPath] = _rtEntry;
+}
+
+unsigned long long
+CCookCache::HashBytes(const void* _pData, size_t _uiSize, unsigned long long _ullSeed)
+{
+	const unsigned char* pData = static_cast<const unsigned char*>(_pData);
+	const unsigned char* pEnd = pData + _uiSize;
+	unsigned long long ullHash = 0;
+
+	//Four independent lanes over 32 byte stripes
+	if(_uiSize >= 32)
+	{
+		unsigned long long ullLane1 = _ullSeed + s_kullPrime1 + s_kullPrime2;
+		unsigned long long ullLane2 = _ullSeed + s_kullPrime2;
+		unsigned long long ullLane3 = _ullSeed;
+		unsigned long long ullLane4 = _ullSeed - s_kullPrime1;
+
+		const unsigned char* pLimit = pEnd - 32;
+		do
+		{
+			ullLane1 = Round(ullLane1, Read64(pData));
+			ullLane2 = Round(ullLane2, Read64(pData + 8));
+			ullLane3 = Round(ullLane3, Read64(pData + 16));
+			ullLane4 = Round(ullLane4, Read64(pData + 24));
+			pData += 32;
+		}
+		while(pData <= pLimit);
+
+		ullHash = RotateLeft(ullLane1, 1) + RotateLeft(ullLane2, 7) + RotateLeft(ullLane3, 12) + RotateLeft(ullLane4, 18);
+		ullHash = MergeRound(ullHash, ullLane1);
+		ullHash = MergeRound(ullHash, ullLane2);
+		ullHash = MergeRound(ullHash, ullLane3);
+		ullHash = MergeRound(ullHash, ullLane4);
+	}
+	else
+	{
+		ullHash = _ullSeed + s_kullPrime5;
+	}
+
+	ullHash += _uiSize;
+
+	//Tail
+	for(; pData + 8 <= pEnd; pData += 8)
+	{
+		ullHash ^= Round(0, Read64(pData));
+		ullHash = RotateLeft(ullHash, 27) * s_kullPrime1 + s_kullPrime4;
+	}
+
+	if(pData + 4 <= pEnd)
+	{
+		ullHash ^= (unsigned long long)Read32(pData) * s_kullPrime1;
+		ullHash = RotateLeft(ullHash, 23) * s_kullPrime2 + s_kullPrime3;
+		pData += 4;
+	}
+
+	for(; pData < pEnd; ++pData)
+	{
+		ullHash ^= (*pData) * s_kullPrime5;
+		ullHash = RotateLeft(ullHash, 11) * s_kullPrime1;
+	}
+
+	//Avalanche
+	ullHash ^= ullHash >> 33;
+	ullHash *= s_kullPrime2;
+	ullHash ^= ullHash >> 29;
+	ullHash *= s_kullPrime3;
+	ullHash ^= ullHash >> 32;
+
+	return(ullHash);
+}
+
+bool
+CCookCache::HashFile(const char* _kpcFilename, unsigned long long& _rullHash)
+{
+	CMappedFile mappedFile;
+	if(mappedFile.Open(_kpcFilename))
+	{
+		_rullHash = HashBytes(mappedFile.GetData(), mappedFile.GetSize());
+		return(true);
+	}
+
+	//Mapping fails on empty files, which still have a hash
+	WIN32_FILE_ATTRIBUTE_DATA tAttributes;
+	if(!GetFileAttributesExA(_kpcFilename, GetFileExInfoStandard, &tAttributes) || tAttributes.nFileSizeLow || tAttributes.nFileSizeHigh) return(false);
+
+	_rullHash = HashBytes(nullptr, 0);
+	return(true);
+}
+
+unsigned long long
+CCookCache::Combine(unsigned long long _ullHash, unsigned long long _ullValue)
+{
+	return(HashBytes(&_ullValue, sizeof(_ullValue), _ullHash));
+}
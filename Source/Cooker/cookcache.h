@@ -0,0 +1,58 @@
+#pragma once
+#ifndef __COOK_CACHE_H__
+#define __COOK_CACHE_H__
+
+//Library Includes
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+//Remembers what every cooked output was built from, so unchanged sources are skipped without reading them
+//Each source is keyed by a hash of its bytes, the cook key mixes in the settings it was cooked with
+//Size and write time are kept alongside, if neither has changed the stored content hash is trusted
+//
+//Stored as text next to the resources, one source per line:
+//	<content hash> <cook key> <size> <write time> <relative path>
+
+//Prototypes
+class CCookCache
+{
+	//Types
+public:
+	struct TEntry
+	{
+		unsigned long long ullContentHash;
+		unsigned long long ullCookKey;
+		unsigned long long ullSize;
+		unsigned long long ullWriteTime;
+	};
+
+	//Member Functions
+public:
+	CCookCache();
+	~CCookCache();
+
+	//A missing or unreadable file starts an empty cache
+	bool Load(const char* _kpcFilename);
+	bool Save(const char* _kpcFilename) const;
+
+	//Safe from any thread
+	bool Find(const std::string& _rstrPath, TEntry& _rtEntry) const;
+	void Store(const std::string& _rstrPath, const TEntry& _rtEntry);
+
+	//xxHash64 over a buffer, fast enough that hashing is bound by the disk
+	static unsigned long long HashBytes(const void* _pData, size_t _uiSize, unsigned long long _ullSeed = 0);
+
+	//Hashes the whole file through a mapping, false if it can't be opened. Empty files hash to the empty buffer
+	static bool HashFile(const char* _kpcFilename, unsigned long long& _rullHash);
+
+	static unsigned long long Combine(unsigned long long _ullHash, unsigned long long _ullValue);
+
+	//Member Variables
+private:
+	mutable std::mutex m_mutexEntries;
+	std::unordered_map<std::string, TEntry> m_mapEntries;
+
+};
+
+#endif //__COOK_CACHE_H__
@@ -0,0 +1,287 @@
+//Library Includes
+#include <windows.h>
+#include <objbase.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+//Local Includes
+#include <Engine\model.h>
+#include <Engine\texture.h>
+#include <Engine\mappedfile.h>
+#include <Engine\cookedmodel.h>
+#include <Engine\meshweld.h>
+#include <Engine\cookedtexture.h>
+
+//This Include
+#include "cooker.h"
+#include "pakwriter.h"
+
+//Static Variables
+static const unsigned int s_kuiCookerVersion = 1; //Bump to throw away every cached cook
+static const char* s_kpcCacheFile = "cookcache.txt";
+
+static const char* s_kpcModelExtensions[] = { ".fbx", ".obj", ".dae", ".3ds", ".blend", ".gltf", ".glb" };
+static const char* s_kpcTextureExtensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff", ".gif" };
+
+//Helpers
+static bool HasExtension(const std::string& _rstrName, const char* const* _ppcExtensions, size_t _uiCount)
+{
+	size_t uiDot = _rstrName.find_last_of('.');
+	if(uiDot == std::string::npos) return(false);
+
+	for(size_t i = 0; i < _uiCount; ++i)
+	{
+		if(_stricmp(_rstrName.c_str() + uiDot, _ppcExtensions[i]) == 0) return(true);
+	}
+
+	return(false);
+}
+
+static const char* GetCookedExtension(ESourceType _eType)
+{
+	return(_eType == SOURCE_MODEL ? COOKED_MODEL_EXTENSION : COOKED_TEXTURE_EXTENSION);
+}
+
+//Implementation
+CCooker::CCooker()
+	: m_uiRemaining(0)
+	, m_uiCooked(0)
+	, m_uiUpToDate(0)
+	, m_uiFailed(0)
+	, m_ullBytesHashed(0)
+{
+	//Constructor
+}
+
+CCooker::~CCooker()
+{
+	//Destructor
+}
+
+bool
+CCooker::Cook(const char* _kpcRoot, const TCookSettings& _rtSettings)
+{
+	auto tStart = std::chrono::steady_clock::now();
+
+	m_strRoot = _kpcRoot;
+	while(!m_strRoot.empty() && (m_strRoot.back() == '\\' || m_strRoot.back() == '/')) m_strRoot.pop_back();
+	m_tSettings = _rtSettings;
+
+	//Forced cooks start from nothing, otherwise last run's hashes decide what can be skipped
+	std::string strCacheFile = m_strRoot + "\\" + s_kpcCacheFile;
+	if(!m_tSettings.bForce) m_previousCache.Load(strCacheFile.c_str());
+
+	//Engine side settings, cooked textures are written in full and never streamed here
+	CTexture::SetHighQualityCook(m_tSettings.bHighQuality);
+	CTexture::SetMipFilter(m_tSettings.eMipFilter);
+	CTexture::SetStreamed(false);
+
+	m_vecSources.clear();
+	FindSources("");
+
+	//Biggest first, small files fill in the gaps at the end
+	std::sort(m_vecSources.begin(), m_vecSources.end(), [](const TSource& _rtLeft, const TSource& _rtRight) { return(_rtLeft.ullSize > _rtRight.ullSize); });
+
+	m_uiRemaining = (unsigned int)m_vecSources.size();
+	m_uiCooked = 0;
+	m_uiUpToDate = 0;
+	m_uiFailed = 0;
+	m_ullBytesHashed = 0;
+
+	//WIC needs COM on every thread that decodes
+	unsigned int uiThreads = m_tSettings.uiThreads ? m_tSettings.uiThreads : max(1u, std::thread::hardware_concurrency());
+	CJobSystem jobSystem;
+	bool bAsync = jobSystem.Initialize(uiThreads, []() { CoInitialize(nullptr); }, []() { CoUninitialize(); });
+
+	for(const TSource& rtSource : m_vecSources)
+	{
+		if(!bAsync || !jobSystem.Submit([this, &rtSource]() { CookSource(rtSource); })) CookSource(rtSource);
+	}
+
+	std::unique_lock<std::mutex> lockDone(m_mutexDone);
+	m_cvDone.wait(lockDone, [this]() { return(m_uiRemaining == 0); });
+	lockDone.unlock();
+
+	jobSystem.Shutdown();
+
+	//Only what was seen this run is kept, deleted sources drop out of the cache
+	bool bSaved = m_cache.Save(strCacheFile.c_str());
+	if(!bSaved) printf("Failed to write cook cache: %s\n", strCacheFile.c_str());
+
+	bool bPacked = m_tSettings.strPakFile.empty() || WritePak();
+
+	double dElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	printf("Cooked %u, up to date %u, failed %u of %zu sources in %.2fs. Hashed %.1fMB over %u threads\n",
+		(unsigned int)m_uiCooked, (unsigned int)m_uiUpToDate, (unsigned int)m_uiFailed, m_vecSources.size(), dElapsedMs / 1000.0,
+		m_ullBytesHashed / (1024.0 * 1024.0), bAsync ? uiThreads : 1);
+
+	return(m_uiFailed == 0 && bSaved && bPacked);
+}
+
+void
+CCooker::FindSources(const std::string& _rstrDirectory)
+{
+	WIN32_FIND_DATAA tFindData;
+	std::string strSearch = m_strRoot + "\\" + (_rstrDirectory.empty() ? "" : _rstrDirectory + "\\") + "*";
+
+	HANDLE hFind = FindFirstFileA(strSearch.c_str(), &tFindData);
+	if(hFind == INVALID_HANDLE_VALUE) return;
+
+	do
+	{
+		std::string strName = tFindData.cFileName;
+		if(strName == "." || strName == "..") continue;
+
+		std::string strPath = _rstrDirectory.empty() ? strName : _rstrDirectory + "\\" + strName;
+		if(tFindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+		{
+			FindSources(strPath);
+			continue;
+		}
+
+		TSource tSource;
+		if(HasExtension(strName, s_kpcModelExtensions, _countof(s_kpcModelExtensions))) tSource.eType = SOURCE_MODEL;
+		else if(HasExtension(strName, s_kpcTextureExtensions, _countof(s_kpcTextureExtensions))) tSource.eType = SOURCE_TEXTURE;
+		else continue;
+
+		//Same packing as CMappedFile::GetWriteTime, which is what cooked headers are stamped with
+		tSource.strPath = strPath;
+		tSource.ullSize = ((unsigned long long)tFindData.nFileSizeHigh << 32) | tFindData.nFileSizeLow;
+		tSource.ullWriteTime = ((unsigned long long)tFindData.ftLastWriteTime.dwHighDateTime << 32) | tFindData.ftLastWriteTime.dwLowDateTime;
+		m_vecSources.push_back(tSource);
+	}
+	while(FindNextFileA(hFind, &tFindData));
+
+	FindClose(hFind);
+}
+
+void
+CCooker::CookSource(const TSource& _rtSource)
+{
+	std::string strSource = m_strRoot + "\\" + _rtSource.strPath;
+	std::string strCooked = strSource + GetCookedExtension(_rtSource.eType);
+
+	CCookCache::TEntry tEntry;
+	tEntry.ullSize = _rtSource.ullSize;
+	tEntry.ullWriteTime = _rtSource.ullWriteTime;
+
+	//Size and write time unchanged since last run, trust the stored hash rather than reading the file again
+	CCookCache::TEntry tPrevious;
+	bool bCached = m_previousCache.Find(_rtSource.strPath, tPrevious);
+	bool bHashed = true;
+	if(bCached && tPrevious.ullSize == tEntry.ullSize && tPrevious.ullWriteTime == tEntry.ullWriteTime)
+	{
+		tEntry.ullContentHash = tPrevious.ullContentHash;
+	}
+	else
+	{
+		bHashed = CCookCache::HashFile(strSource.c_str(), tEntry.ullContentHash);
+		m_ullBytesHashed += tEntry.ullSize;
+	}
+
+	tEntry.ullCookKey = CCookCache::Combine(tEntry.ullContentHash, GetSettingsHash(_rtSource.eType));
+
+	//Same bytes and settings as the existing cook. A touched source only needs the cook's header to agree with it
+	bool bUpToDate = bHashed && bCached && !m_tSettings.bForce && tPrevious.ullCookKey == tEntry.ullCookKey
+		&& CMappedFile::GetWriteTime(strCooked.c_str()) && RestampCook(strCooked, _rtSource.eType, _rtSource.ullWriteTime);
+
+	bool bSuccessful = bUpToDate;
+	if(bUpToDate)
+	{
+		++m_uiUpToDate;
+	}
+	else if(bHashed)
+	{
+		bSuccessful = (_rtSource.eType == SOURCE_MODEL) ? CModel::Cook(strSource.c_str(), strCooked.c_str()) : CTexture::Cook(strSource.c_str(), strCooked.c_str());
+		if(bSuccessful) ++m_uiCooked;
+	}
+
+	if(bSuccessful)
+	{
+		m_cache.Store(_rtSource.strPath, tEntry);
+	}
+	else
+	{
+		++m_uiFailed;
+		printf("Failed to cook: %s\n", strSource.c_str());
+	}
+
+	//Last one out wakes the main thread
+	if(--m_uiRemaining == 0)
+	{
+		std::lock_guard<std::mutex> lockDone(m_mutexDone);
+		m_cvDone.notify_all();
+	}
+}
+
+bool
+CCooker::WritePak() const
+{
+	CPakWriter pakWriter;
+	for(const TSource& rtSource : m_vecSources)
+	{
+		//Failed cooks are left out, the engine falls back to the loose source for them
+		std::string strCooked = m_strRoot + "\\" + rtSource.strPath + GetCookedExtension(rtSource.eType);
+		if(CMappedFile::GetWriteTime(strCooked.c_str())) pakWriter.AddFile(strCooked.c_str(), strCooked.c_str());
+	}
+
+	return(pakWriter.Write(m_tSettings.strPakFile.c_str()));
+}
+
+unsigned long long
+CCooker::GetSettingsHash(ESourceType _eType) const
+{
+	unsigned long long ullHash = CCookCache::Combine(s_kuiCookerVersion, _eType);
+
+	if(_eType == SOURCE_MODEL)
+	{
+		//Import flags and the runtime layouts the blobs are stored in
+		ullHash = CCookCache::Combine(ullHash, CModel::GetImportFlags());
+		ullHash = CCookCache::Combine(ullHash, COOKED_MODEL_VERSION);
+		ullHash = CCookCache::Combine(ullHash, sizeof(TVertexTexNorm));
+		ullHash = CCookCache::Combine(ullHash, sizeof(TVertexPacked));
+		ullHash = CCookCache::Combine(ullHash, sizeof(DWORD));
+		ullHash = CCookCache::Combine(ullHash, sizeof(TModelMeshInstance));
+		ullHash = CCookCache::Combine(ullHash, sizeof(TMeshCluster));
+
+		//Weld tolerances change the vertices written
+		TMeshWeldTolerance tWeld;
+		ullHash = CCookCache::Combine(ullHash, HashMeshBytes(&tWeld, sizeof(tWeld)));
+	}
+	else
+	{
+		ullHash = CCookCache::Combine(ullHash, COOKED_TEXTURE_VERSION);
+		ullHash = CCookCache::Combine(ullHash, m_tSettings.bHighQuality);
+		ullHash = CCookCache::Combine(ullHash, m_tSettings.eMipFilter);
+	}
+
+	return(ullHash);
+}
+
+bool
+CCooker::RestampCook(const std::string& _rstrCooked, ESourceType _eType, unsigned long long _ullSourceWriteTime)
+{
+	unsigned int uiMagic = (_eType == SOURCE_MODEL) ? COOKED_MODEL_MAGIC : COOKED_TEXTURE_MAGIC;
+	long lOffset = (long)((_eType == SOURCE_MODEL) ? offsetof(TCookedModelHeader, ullSourceWriteTime) : offsetof(TCookedTextureHeader, ullSourceWriteTime));
+
+	FILE* pFile = nullptr;
+	if(fopen_s(&pFile, _rstrCooked.c_str(), "r+b") != 0 || !pFile) return(false);
+
+	//Both headers start with their magic, anything else isn't one of ours
+	unsigned int uiFileMagic = 0;
+	unsigned long long ullStamp = 0;
+	bool bValid = fread(&uiFileMagic, sizeof(uiFileMagic), 1, pFile) == 1 && uiFileMagic == uiMagic
+		&& fseek(pFile, lOffset, SEEK_SET) == 0 && fread(&ullStamp, sizeof(ullStamp), 1, pFile) == 1;
+
+	//Only written when it differs, so an untouched tree leaves every cook alone
+	if(bValid && ullStamp != _ullSourceWriteTime)
+	{
+		bValid = fseek(pFile, lOffset, SEEK_SET) == 0 && fwrite(&_ullSourceWriteTime, sizeof(_ullSourceWriteTime), 1, pFile) == 1;
+	}
+
+	fclose(pFile);
+	return(bValid);
+}
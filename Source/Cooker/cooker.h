@@ -0,0 +1,100 @@
+#pragma once
+#ifndef __COOKER_H__
+#define __COOKER_H__
+
+//Library Includes
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+//Local Includes
+#include <Engine\jobsystem.h>
+#include <Engine\mipgen.h>
+#include "cookcache.h"
+
+//Walks a resource tree and cooks every model and texture next to its source, the same files the engine writes on first load
+//Sources are cooked in parallel, largest first so one big scene doesn't end up last on a single core
+//Optionally the cooks are then packed into a single archive, run from the game's working directory so the names line up
+
+//Types
+enum ESourceType
+{
+	SOURCE_MODEL,
+	SOURCE_TEXTURE,
+};
+
+struct TCookSettings
+{
+	bool bForce;				//Cook everything, ignoring the cache
+	bool bHighQuality;			//BC7 for colour textures
+	EMipFilter eMipFilter;
+	unsigned int uiThreads;		//0 uses every core
+	std::string strPakFile;		//Packs every cook into this archive afterwards, empty to leave them loose
+
+	TCookSettings()
+		: bForce(false)
+		, bHighQuality(false)
+		, eMipFilter(MIP_FILTER_KAISER)
+		, uiThreads(0)
+	{
+	}
+};
+
+//Prototypes
+class CCooker
+{
+	//Types
+private:
+	struct TSource
+	{
+		std::string strPath; //Relative to the root, the cache key
+		ESourceType eType;
+		unsigned long long ullSize;
+		unsigned long long ullWriteTime;
+	};
+
+	//Member Functions
+public:
+	CCooker();
+	~CCooker();
+
+	//Returns false if anything failed to cook
+	bool Cook(const char* _kpcRoot, const TCookSettings& _rtSettings);
+
+private:
+	CCooker(const CCooker& _rhs) = delete;
+
+	void FindSources(const std::string& _rstrDirectory);
+	void CookSource(const TSource& _rtSource);
+
+	//Cooks are named as the engine asks for them, the root as given plus the relative path
+	bool WritePak() const;
+
+	//Hash of everything besides the source bytes that changes the output
+	unsigned long long GetSettingsHash(ESourceType _eType) const;
+
+	//Brings the write time in a cooked header in line with the source, the engine checks it before trusting a cook
+	static bool RestampCook(const std::string& _rstrCooked, ESourceType _eType, unsigned long long _ullSourceWriteTime);
+
+	//Member Variables
+private:
+	std::string m_strRoot;
+	TCookSettings m_tSettings;
+	CCookCache m_previousCache; //As loaded, read only while cooking
+	CCookCache m_cache; //Built up from this run
+	std::vector<TSource> m_vecSources;
+
+	//Progress, written by the workers
+	std::atomic<unsigned int> m_uiRemaining;
+	std::atomic<unsigned int> m_uiCooked;
+	std::atomic<unsigned int> m_uiUpToDate;
+	std::atomic<unsigned int> m_uiFailed;
+	std::atomic<unsigned long long> m_ullBytesHashed;
+	std::mutex m_mutexDone;
+	std::condition_variable m_cvDone;
+
+};
+
+#endif //__COOKER_H__
@@ -0,0 +1,60 @@
+//Library Includes
+#include <Engine\engine.h>
+#include <Engine\common.h>
+#include <Engine\headlessrenderer.h>
+#include <Engine\assetmanager.hpp>
+#include <Engine\logmanager.h>
+#include <objbase.h>
+#include <stdio.h>
+
+//Local Includes
+#include "cooker.h"
+
+int
+main(int _iArgCount, char* _ppcArgs[])
+{
+	if(_iArgCount < 2)
+	{
+		printf("Usage: Cooker <resource folder> [-force] [-hq] [-threads <count>] [-filter box|kaiser|lanczos] [-pak <file>]\n");
+		printf("  -force    cook everything, ignoring the cache\n");
+		printf("  -hq       BC7 for colour textures, slower to encode\n");
+		printf("  -threads  worker count, every core by default\n");
+		printf("  -filter   mip filter, kaiser by default\n");
+		printf("  -pak      pack every cook into an archive, run from the game's working directory\n");
+		return(1);
+	}
+
+	TCookSettings tSettings;
+	for(int i = 2; i < _iArgCount; ++i)
+	{
+		if(_stricmp(_ppcArgs[i], "-force") == 0) tSettings.bForce = true;
+		else if(_stricmp(_ppcArgs[i], "-hq") == 0) tSettings.bHighQuality = true;
+		else if(_stricmp(_ppcArgs[i], "-threads") == 0 && i + 1 < _iArgCount) tSettings.uiThreads = (unsigned int)atoi(_ppcArgs[++i]);
+		else if(_stricmp(_ppcArgs[i], "-pak") == 0 && i + 1 < _iArgCount) tSettings.strPakFile = _ppcArgs[++i];
+		else if(_stricmp(_ppcArgs[i], "-filter") == 0 && i + 1 < _iArgCount)
+		{
+			++i;
+			if(_stricmp(_ppcArgs[i], "box") == 0) tSettings.eMipFilter = MIP_FILTER_BOX;
+			else if(_stricmp(_ppcArgs[i], "lanczos") == 0) tSettings.eMipFilter = MIP_FILTER_LANCZOS;
+			else tSettings.eMipFilter = MIP_FILTER_KAISER;
+		}
+		else printf("Ignoring unknown option: %s\n", _ppcArgs[i]);
+	}
+
+	CoInitialize(nullptr);
+	CLogManager::GetInstance().Initialize(false);
+
+	//No device is needed, the cook paths only create stand-in resources on the way through
+	CHeadlessRenderer* pRenderer = new CHeadlessRenderer();
+	bool bReady = pRenderer->Initialize(NULL, 0, 0, true) && CAssetManager::GetInstance().Initialize(pRenderer);
+
+	CCooker cooker;
+	bool bCooked = bReady && cooker.Cook(_ppcArgs[1], tSettings);
+
+	CAssetManager::DestroyInstance();
+	SafeDelete(pRenderer);
+	CLogManager::DestroyInstance();
+	CoUninitialize();
+
+	return(bCooked ? 0 : 1);
+}
@@ -0,0 +1,140 @@
+//Library Includes
+#include <windows.h>
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+
+//Local Includes
+#include <Engine\mappedfile.h>
+#include <Engine\pakfile.h>
+#include <Engine\lzcompress.h>
+
+//This Include
+#include "pakwriter.h"
+
+//Implementation
+CPakWriter::CPakWriter()
+{
+	//Constructor
+}
+
+CPakWriter::~CPakWriter()
+{
+	//Destructor
+}
+
+void
+CPakWriter::AddFile(const char* _kpcName, const char* _kpcPath)
+{
+	if(!_kpcName || !_kpcPath) return;
+
+	//Stored folded, the reader folds what it is asked for and compares bytes
+	std::string strName = _kpcName;
+	for(char& c : strName) c = CPakFile::FoldNameChar(c);
+
+	m_mapFiles[strName] = _kpcPath;
+}
+
+bool
+CPakWriter::Write(const char* _kpcFilename)
+{
+	auto tStart = std::chrono::steady_clock::now();
+
+	std::string strTemp = std::string(_kpcFilename) + ".tmp";
+	FILE* pFile = nullptr;
+	if(fopen_s(&pFile, strTemp.c_str(), "wb") != 0 || !pFile)
+	{
+		printf("Failed to create pak: %s\n", strTemp.c_str());
+		return(false);
+	}
+
+	//Filled in once everything else is written
+	TPakHeader tHeader;
+	ZeroMemory(&tHeader, sizeof(TPakHeader));
+	bool bSuccessful = fwrite(&tHeader, sizeof(TPakHeader), 1, pFile) == 1;
+
+	std::vector<TPakEntry> vecEntries;
+	std::vector<TPakChunk> vecChunks;
+	std::string strNames;
+	std::vector<uint8_t> vecCompressed(LZCompressBound(PAK_CHUNK_SIZE));
+	unsigned long long ullOffset = sizeof(TPakHeader);
+	unsigned long long ullRawBytes = 0;
+	unsigned int uiSkipped = 0;
+
+	for(auto it = m_mapFiles.begin(); it != m_mapFiles.end() && bSuccessful; ++it)
+	{
+		CMappedFile mappedFile;
+		if(!mappedFile.Open(it->second.c_str()))
+		{
+			printf("Skipping unreadable file: %s\n", it->second.c_str());
+			++uiSkipped;
+			continue;
+		}
+
+		TPakEntry tEntry;
+		tEntry.ullNameHash = CPakFile::HashName(it->first.c_str());
+		tEntry.ullSize = mappedFile.GetSize();
+		tEntry.uiNameOffset = (unsigned int)strNames.size();
+		tEntry.uiNameLength = (unsigned int)it->first.size();
+		tEntry.uiFirstChunk = (unsigned int)vecChunks.size();
+		tEntry.uiChunkCount = 0;
+
+		for(size_t uiRead = 0; uiRead < mappedFile.GetSize() && bSuccessful; uiRead += PAK_CHUNK_SIZE)
+		{
+			const uint8_t* pChunk = mappedFile.GetData() + uiRead;
+			size_t uiChunkSize = min((size_t)PAK_CHUNK_SIZE, mappedFile.GetSize() - uiRead);
+
+			size_t uiCompressed = LZCompress(pChunk, uiChunkSize, vecCompressed.data(), vecCompressed.size());
+			bool bCompressed = uiCompressed && uiCompressed < uiChunkSize - uiChunkSize / 8;
+
+			TPakChunk tChunk;
+			tChunk.ullOffset = ullOffset;
+			tChunk.uiStoredSize = (unsigned int)(bCompressed ? uiCompressed : uiChunkSize);
+			tChunk.uiFlags = bCompressed ? PAK_CHUNK_COMPRESSED : 0;
+			bSuccessful = fwrite(bCompressed ? vecCompressed.data() : pChunk, 1, tChunk.uiStoredSize, pFile) == tChunk.uiStoredSize;
+
+			vecChunks.push_back(tChunk);
+			ullOffset += tChunk.uiStoredSize;
+			++tEntry.uiChunkCount;
+		}
+
+		ullRawBytes += tEntry.ullSize;
+		strNames += it->first;
+		vecEntries.push_back(tEntry);
+	}
+
+	//Sorted for the reader's binary search, chunks are found through the entries so their order doesn't matter
+	std::sort(vecEntries.begin(), vecEntries.end(), [](const TPakEntry& _rtLeft, const TPakEntry& _rtRight) { return(_rtLeft.ullNameHash < _rtRight.ullNameHash); });
+
+	tHeader.uiMagic = PAK_MAGIC;
+	tHeader.uiVersion = PAK_VERSION;
+	tHeader.uiEntryCount = (unsigned int)vecEntries.size();
+	tHeader.uiChunkCount = (unsigned int)vecChunks.size();
+	tHeader.uiChunkSize = PAK_CHUNK_SIZE;
+	tHeader.uiNamesSize = (unsigned int)strNames.size();
+	tHeader.ullTOCOffset = ullOffset;
+	tHeader.ullFileSize = ullOffset + vecEntries.size() * sizeof(TPakEntry) + vecChunks.size() * sizeof(TPakChunk) + strNames.size();
+
+	if(bSuccessful && !vecEntries.empty()) bSuccessful = fwrite(vecEntries.data(), sizeof(TPakEntry), vecEntries.size(), pFile) == vecEntries.size();
+	if(bSuccessful && !vecChunks.empty()) bSuccessful = fwrite(vecChunks.data(), sizeof(TPakChunk), vecChunks.size(), pFile) == vecChunks.size();
+	if(bSuccessful && !strNames.empty()) bSuccessful = fwrite(strNames.data(), 1, strNames.size(), pFile) == strNames.size();
+	if(bSuccessful) bSuccessful = fseek(pFile, 0, SEEK_SET) == 0 && fwrite(&tHeader, sizeof(TPakHeader), 1, pFile) == 1;
+
+	bSuccessful = (fclose(pFile) == 0) && bSuccessful;
+
+	//Only replaces the old pak once the new one is whole
+	if(bSuccessful) bSuccessful = MoveFileExA(strTemp.c_str(), _kpcFilename, MOVEFILE_REPLACE_EXISTING) != FALSE;
+	if(!bSuccessful)
+	{
+		remove(strTemp.c_str());
+		printf("Failed to write pak: %s\n", _kpcFilename);
+		return(false);
+	}
+
+	double dElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	printf("Packed %zu files (%u skipped) into %s in %.2fs, %.1fMB to %.1fMB\n", vecEntries.size(), uiSkipped, _kpcFilename,
+		dElapsedMs / 1000.0, ullRawBytes / (1024.0 * 1024.0), tHeader.ullFileSize / (1024.0 * 1024.0));
+
+	return(uiSkipped == 0);
+}
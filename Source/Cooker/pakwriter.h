@@ -0,0 +1,36 @@
+#pragma once
+#ifndef __PAK_WRITER_H__
+#define __PAK_WRITER_H__
+
+//Library Includes
+#include <string>
+#include <map>
+
+//Packs files into a pak archive for CPakFile, see pakformat.h
+//Every chunk is compressed and kept only if that saves at least an eighth of it, files that don't compress stay readable in place
+//Data goes out in name order so files from the same folder sit together on disk
+
+//Prototypes
+class CPakWriter
+{
+	//Member Functions
+public:
+	CPakWriter();
+	~CPakWriter();
+
+	//_kpcName is what the engine will ask for, _kpcPath is where to read it from now. Adding a name again replaces it
+	void AddFile(const char* _kpcName, const char* _kpcPath);
+
+	//Written next to _kpcFilename and moved over it once complete. Files that can't be read are skipped and reported
+	bool Write(const char* _kpcFilename);
+
+private:
+	CPakWriter(const CPakWriter& _rhs) = delete;
+
+	//Member Variables
+private:
+	std::map<std::string, std::string> m_mapFiles; //Folded name to path
+
+};
+
+#endif //__PAK_WRITER_H__
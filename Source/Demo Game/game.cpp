@@ -29,6 +29,11 @@ CGame::CGame()
 	, m_pRiggedEntityTest(nullptr)
 {
 	//Constructor
+	for(unsigned int i = 0; i < 2; ++i)
+	{
+		m_puiPassDraws[i] = 0;
+		m_puiPassBinds[i] = 0;
+	}
 }
 
 CGame::~CGame()
@@ -40,13 +45,14 @@ CGame::~CGame()
 	for(auto pInstancer : m_vecpInstancers) SafeDelete(pInstancer);
 	m_vecpInstancers.clear();
 
-	//Destroy the asset manager, unloading all assets loaded in
-	CAssetManager::DestroyInstance();
-
+	//Shaders hold references to the default textures, drop them before the assets go
 	SafeDelete(m_pDefaultShader);
 	SafeDelete(m_pDebugShader);
 	SafeDelete(m_pCamera);
 
+	//Destroy the asset manager, unloading all assets loaded in
+	CAssetManager::DestroyInstance();
+
 	//Released by CEngine
 	m_pRenderer = nullptr;
 }
@@ -61,6 +67,14 @@ CGame::Initialize()
 	CAssetManager& rAssetManager = CAssetManager::GetInstance();
 	rAssetManager.Initialize(m_pRenderer, 5);
 
+	//Built by the cooker with -pak, without it everything loads loose
+	rAssetManager.MountPak("Resources.pak");
+
+#ifdef _DEBUG
+	//Edited textures and models are picked up without a restart
+	rAssetManager.EnableHotReload("Resources");
+#endif //_DEBUG
+
 	m_pCamera = new CFreeCamera;
 	m_pCamera->Initialize(m_pRenderer);
 	m_pCamera->SetNearFarPlane(1.0f, 1000.0f);
@@ -88,8 +102,9 @@ CGame::Initialize()
 	m_pDefaultShader->GetSun()->SetDefinition(tSunProperties);
 
 	//Queue up models for loading
-	auto pTestRiggedModel = rAssetManager.LoadAsset<CModel>("Resources\\POLYGON_City_Pack\\Characters\\SK_Character_BusinessMan_Shirt.fbx");
-	auto pTestScene = rAssetManager.LoadAsset<CModel>("Resources\\POLYGON_City_Pack\\POLYGON_City_Demo_Scene.fbx");
+	//The scene goes first, the rigged model can trail behind the textures
+	auto pTestRiggedModel = rAssetManager.LoadAsset<CModel>("Resources\\POLYGON_City_Pack\\Characters\\SK_Character_BusinessMan_Shirt.fbx", ASSET_PRIORITY_LOW);
+	auto pTestScene = rAssetManager.LoadAsset<CModel>("Resources\\POLYGON_City_Pack\\POLYGON_City_Demo_Scene.fbx", ASSET_PRIORITY_HIGH);
 
 	//Queue up textures for loading
 	TMaterial tMaterial01;
@@ -120,95 +135,126 @@ CGame::Initialize()
 	tMaterial04.bTransparent	= false;
 
 	//Default textures
-	CTexture* pBlackTex = rAssetManager.LoadAsset<CTexture>("Resources\\black.png");
-	CTexture* pWhiteTex = rAssetManager.LoadAsset<CTexture>("Resources\\white.png");
-	CTexture* pErrorTex = rAssetManager.LoadAsset<CTexture>("Resources\\uv.png");
+	auto pBlackTex = rAssetManager.LoadAsset<CTexture>("Resources\\black.png");
+	auto pWhiteTex = rAssetManager.LoadAsset<CTexture>("Resources\\white.png");
+	auto pErrorTex = rAssetManager.LoadAsset<CTexture>("Resources\\uv.png");
 	m_pDefaultShader->SetDefaultTextures(pErrorTex, pBlackTex, pWhiteTex);
 
-	//Apply textures to models
-	//TODO: put thread checks in pModel to simplify checking this
-	while(!AssetLoaded(pTestScene)) Sleep(1); //Sleep/yield to prevent excessive CPU ticks
-
-	//TODO: this function is not ideal
-	/*	0 all
-		1 glass(em / trans)
-		2 billboard
-		3 skyline
-		4 water
-	*/
-	pTestScene->SetMaterial(0, tMaterial01);
-	pTestScene->SetMaterial(1, tMaterial01);
-	pTestScene->SetMaterial(2, tMaterial02);
-	pTestScene->SetMaterial(3, tMaterial03);
-	pTestScene->SetMaterial(4, tMaterial04);
-
-	auto n = pTestRiggedModel->GetMaterialCount();
-	pTestRiggedModel->SetMaterial(0, tMaterial01);
-
-	//Load up instances into individual meshes for easier testing
-	/*for(unsigned int i = 0; i < pTestScene->GetInstanceCount(); ++i)
-	{
-		CStaticMesh* pMesh = new CStaticMesh;
-		ERRORCHECK(pMesh->Initialize(pTestScene, i));
-		m_vecpEntities.push_back(pMesh);
-	}*/
-
-	//Instance generation
-	//m_vecpInstancers
-	unsigned int uiMeshCount = pTestScene->GetMeshCount();
-	unsigned int uiInstanceCount = pTestScene->GetInstanceCount();
-	int* piMeshInstances = new int[uiMeshCount];
-	ZeroMemory(piMeshInstances, sizeof(int)* uiMeshCount);
-
-	//Figure out how many of each mesh to instance
-	for(unsigned int i = 0; i < uiInstanceCount; ++i)
+	//Apply textures to models once they have loaded, run from CEngine::GameLoop so nothing here blocks
+	//The instancers are built from the scene, the materials are copied in so their textures stay referenced until then
+	pTestScene.Then([this, tMaterial01, tMaterial02, tMaterial03, tMaterial04](CModel* _pScene, bool _bLoaded)
 	{
-		//Count up on instances per mesh
-		piMeshInstances[pTestScene->GetInstance(i).uiMeshID] += 1;
-	}
+		if(!_bLoaded) return;
+
+		//TODO: this function is not ideal
+		/*	0 all
+			1 glass(em / trans)
+			2 billboard
+			3 skyline
+			4 water
+		*/
+		_pScene->SetMaterial(0, tMaterial01);
+		_pScene->SetMaterial(1, tMaterial01);
+		_pScene->SetMaterial(2, tMaterial02);
+		_pScene->SetMaterial(3, tMaterial03);
+		_pScene->SetMaterial(4, tMaterial04);
+
+		//Load up instances into individual meshes for easier testing
+		/*for(unsigned int i = 0; i < _pScene->GetInstanceCount(); ++i)
+		{
+			CStaticMesh* pMesh = new CStaticMesh;
+			ERRORCHECK(pMesh->Initialize(_pScene, i));
+			m_vecpEntities.push_back(pMesh);
+		}*/
+
+		//Instance generation
+		//m_vecpInstancers
+		unsigned int uiMeshCount = _pScene->GetMeshCount();
+		unsigned int uiInstanceCount = _pScene->GetInstanceCount();
+		int* piMeshInstances = new int[uiMeshCount];
+		ZeroMemory(piMeshInstances, sizeof(int)* uiMeshCount);
+
+		//Figure out how many of each mesh to instance
+		for(unsigned int i = 0; i < uiInstanceCount; ++i)
+		{
+			//Count up on instances per mesh
+			piMeshInstances[_pScene->GetInstance(i).uiMeshID] += 1;
+		}
 
-	//Create instancers
-	for(unsigned int i = 0; i < uiMeshCount; ++i)
-	{
-		CStaticMeshInstancer* pInstancer = new CStaticMeshInstancer;
-		m_vecpInstancers.push_back(pInstancer);
+		//Create instancers
+		for(unsigned int i = 0; i < uiMeshCount; ++i)
+		{
+			CStaticMeshInstancer* pInstancer = new CStaticMeshInstancer;
+			m_vecpInstancers.push_back(pInstancer);
 
-		//Init with number of fixed instances of the mesh in the model
-		pInstancer->Initialize(m_pRenderer, piMeshInstances[i]);
-		pInstancer->ReadyBatch();
-	}
+			//Init with number of fixed instances of the mesh in the model
+			pInstancer->Initialize(m_pRenderer, piMeshInstances[i]);
+			pInstancer->ReadyBatch();
+		}
 
-	//Create the meshes for the instancer
-	for(unsigned int i = 0; i < uiInstanceCount; ++i)
-	{
-		//Get the relevant instancer for the instance mesh
-		CStaticMeshInstancer* pInstancer = m_vecpInstancers[pTestScene->GetInstance(i).uiMeshID];
+		//Create the meshes for the instancer
+		for(unsigned int i = 0; i < uiInstanceCount; ++i)
+		{
+			//Get the relevant instancer for the instance mesh
+			CStaticMeshInstancer* pInstancer = m_vecpInstancers[_pScene->GetInstance(i).uiMeshID];
 
-		//Create new mesh and add it to the entity list
-		CStaticMesh* pMesh = new CStaticMesh;
-		m_vecpEntities.push_back(pMesh);
+			//Create new mesh and add it to the entity list
+			CStaticMesh* pMesh = new CStaticMesh;
+			m_vecpEntities.push_back(pMesh);
 
-		//TODO: don't batch meshes where there are less than a certain number as instances need more than 1? instances for the mesh?
+			//TODO: don't batch meshes where there are less than a certain number as instances need more than 1? instances for the mesh?
 
-		//Init the mesh with the instance data
-		pMesh->Initialize(pTestScene, i, pInstancer);
+			//Init the mesh with the instance data
+			pMesh->Initialize(_pScene, i, pInstancer);
 
-		//Add the mesh to the instancer
-		pInstancer->AddToBatch(pMesh);
-	}
+			//Add the mesh to the instancer
+			pInstancer->AddToBatch(pMesh);
+		}
 
-	//Close instance buffers
-	for(auto pInstancer : m_vecpInstancers) pInstancer->FinishBatch();
-	SafeDeleteArray(piMeshInstances);
+		//Close instance buffers
+		for(auto pInstancer : m_vecpInstancers) pInstancer->FinishBatch();
+		SafeDeleteArray(piMeshInstances);
+	});
+
+	//The rigged model trails behind, it shows up whenever it is ready
+	pTestRiggedModel.Then([this, tMaterial01](CModel* _pRiggedModel, bool _bLoaded)
+	{
+		if(!_bLoaded) return;
 
-	auto pHuman = new CStaticMesh;
-	pHuman->Initialize(pTestRiggedModel);
-	m_pRiggedEntityTest = pHuman;
+		_pRiggedModel->SetMaterial(0, tMaterial01);
 
-	//TODO: this will process here, but when we make an actual world we will need to consider better isolation for rendering
-	//		especially with the instancers etc.
-	//		This is fine for processing, but rendering gets a bit finnicky with wasted loops/performance
-	m_vecpEntities.push_back(m_pRiggedEntityTest); //add it to the list for processing
+		auto pHuman = new CStaticMesh;
+		pHuman->Initialize(_pRiggedModel);
+		m_pRiggedEntityTest = pHuman;
+
+		//TODO: this will process here, but when we make an actual world we will need to consider better isolation for rendering
+		//		especially with the instancers etc.
+		//		This is fine for processing, but rendering gets a bit finnicky with wasted loops/performance
+		m_vecpEntities.push_back(m_pRiggedEntityTest); //add it to the list for processing
+	});
+
+	//Buffer memory saved by 16 bit indices and packed vertices across the demo scene, once every model has settled
+	rAssetManager.WhenAll({ pTestScene, pTestRiggedModel }, [pTestScene, pTestRiggedModel](bool _bLoaded)
+	{
+		size_t uiIndexSaved = 0, uiVertexSaved = 0;
+		for(CModel* pModel : { pTestScene.Get(), pTestRiggedModel.Get() })
+		{
+			if(!AssetLoaded(pModel)) continue;
+			uiIndexSaved += pModel->GetIndexBytesSaved();
+			uiVertexSaved += pModel->GetVertexBytesSaved();
+		}
+
+		char pcStats[256];
+		sprintf_s(pcStats, "Demo scene: %.1fKB of index buffer saved by 16 bit indices, %.1fKB of vertex buffer by packed vertices\n", uiIndexSaved / 1024.0, uiVertexSaved / 1024.0);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Game");
+
+		//Welding and meshes repeated within a model are logged per model on import, this is what models loaded so far share with each other
+		unsigned int uiMeshesShared = 0;
+		size_t uiSharedBytes = 0;
+		CModel::GetSharedMeshStats(uiMeshesShared, uiSharedBytes);
+		sprintf_s(pcStats, "Demo scene: %u meshes shared between models rather than created again, %.1fKB of buffers saved\n", uiMeshesShared, uiSharedBytes / 1024.0);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Game");
+	});
 
 	return false;
 }
@@ -236,6 +282,63 @@ CGame::Process(float _fDeltaTick)
 		rInput.SetKeyboardInput(VK_F2, false);
 	}
 
+	//Dump which texture mips are resident against what the scene is asking for
+	if(rInput.IsPressed(VK_F3))
+	{
+		CAssetManager::GetInstance().GetTextureStreamer().WriteResidencyReport();
+		rInput.SetKeyboardInput(VK_F3, false);
+	}
+
+	//Write out every asset load so far, open in chrome://tracing to see where the scene load time went
+	if(rInput.IsPressed(VK_F4))
+	{
+		CAssetManager::GetInstance().GetLoadTelemetry().WriteSummary();
+		CAssetManager::GetInstance().GetLoadTelemetry().ExportChromeTrace("loadtrace.json");
+		rInput.SetKeyboardInput(VK_F4, false);
+	}
+
+	//Per type memory split by heap, with peaks and the largest assets
+	if(rInput.IsPressed(VK_F5))
+	{
+		CAssetManager::GetInstance().WriteMemoryReport();
+		rInput.SetKeyboardInput(VK_F5, false);
+	}
+
+	//Triangles the instance batches submitted last frame against drawing every instance at full detail
+	if(rInput.IsPressed(VK_F6))
+	{
+		unsigned long long ullLodTriangles = 0;
+		unsigned long long ullFullTriangles = 0;
+		for(auto pInstancer : m_vecpInstancers)
+		{
+			ullLodTriangles += pInstancer->GetTriangleCount();
+			ullFullTriangles += pInstancer->GetTriangleCount(true);
+		}
+
+		char pcStats[256];
+		sprintf_s(pcStats, "LOD triangles: %llu drawn of %llu at full detail per pass (%.1f%%)\n", ullLodTriangles, ullFullTriangles,
+			ullFullTriangles ? 100.0 * ullLodTriangles / ullFullTriangles : 100.0);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Game");
+		rInput.SetKeyboardInput(VK_F6, false);
+	}
+
+	//Clusters culled per view last frame, by frustum and by facing away
+	if(rInput.IsPressed(VK_F7))
+	{
+		m_pRenderer->GetClusterCuller().WriteReport();
+		rInput.SetKeyboardInput(VK_F7, false);
+	}
+
+	//Draw calls and binds of each pass last frame, run with -nobatch to see them without static batching
+	if(rInput.IsPressed(VK_F8))
+	{
+		char pcStats[256];
+		sprintf_s(pcStats, "Shadow pass: %u draw calls, %u binds. Main pass: %u draw calls, %u binds. %u instance batches\n",
+			m_puiPassDraws[0], m_puiPassBinds[0], m_puiPassDraws[1], m_puiPassBinds[1], (unsigned int)m_vecpInstancers.size());
+		CLogManager::GetInstance().WriteDebug(pcStats, "Game");
+		rInput.SetKeyboardInput(VK_F8, false);
+	}
+
 	//Sun demo rotation
 	static float sfTime = 0.0f;
 	sfTime += _fDeltaTick * 10.0f;
@@ -258,6 +361,8 @@ CGame::Draw()
 	//Default Render
 	for(int iPass = 0; iPass < 2; ++iPass)
 	{
+		TRendererStats tPassStart = m_pRenderer->GetCurrentFrameStats();
+
 		//First pass apply shader
 		if(!iPass) m_pDefaultShader->ApplyShader();
 		else m_pDefaultShader->SetPass(iPass);
@@ -265,8 +370,12 @@ CGame::Draw()
 		//Draw static instance batches
 		for(auto pInstancer : m_vecpInstancers) pInstancer->DrawBatch();
 
-		//draw our single human
-		m_pRiggedEntityTest->Draw();
+		//draw our single human, once it has loaded
+		if(m_pRiggedEntityTest) m_pRiggedEntityTest->Draw();
+
+		const TRendererStats& rtPassEnd = m_pRenderer->GetCurrentFrameStats();
+		m_puiPassDraws[iPass] = rtPassEnd.uiDrawCalls - tPassStart.uiDrawCalls;
+		m_puiPassBinds[iPass] = rtPassEnd.uiStateChanges - tPassStart.uiStateChanges;
 	}
 
 	//Debug
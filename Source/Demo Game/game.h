@@ -42,6 +42,10 @@ protected:
 
 	bool m_bDebugBB;
 
+	//Draw calls and state changes of the shadow and main pass last frame
+	unsigned int m_puiPassDraws[2];
+	unsigned int m_puiPassBinds[2];
+
 };
 
 #endif //__GAME_H__
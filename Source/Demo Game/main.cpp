@@ -1,5 +1,9 @@
 //Library Includes
 #include <Engine\engine.h>
+#include <Engine\model.h>
+#include <Engine\texture.h>
+#include <Engine\mipgen.h>
+#include <Engine\vertexpack.h>
 
 //Local Includes
 #include "game.h"
@@ -11,7 +15,7 @@ WinMain(_In_ HINSTANCE _hInstance, _In_opt_ HINSTANCE _hPrevInstance, _In_ LPSTR
 	TWindowData tWindowData;
 	tWindowData.hInstance = _hInstance;
 	tWindowData.wstrTitle = L"Demo Game - DX11";
-	tWindowData.eRendererVersion = RENDERER_DX11;
+	tWindowData.eRendererVersion = (_lpCmdLine && strstr(_lpCmdLine, "-headless")) ? RENDERER_HEADLESS : RENDERER_DX11;
 	tWindowData.iWidth = 1280; //TODO: Set this via a device enumerator
 	tWindowData.iHeight = 960;
 	tWindowData.bFullscreen = false;
@@ -20,6 +24,26 @@ WinMain(_In_ HINSTANCE _hInstance, _In_opt_ HINSTANCE _hPrevInstance, _In_ LPSTR
 	CEngine& rEngine = CEngine::GetInstance();
 	rEngine.Initialize(tWindowData);
 
+	//-nocook forces every model through Assimp and every texture through WIC, for comparing load times against the cooked files
+	bool bUseCooked = !(_lpCmdLine && strstr(_lpCmdLine, "-nocook"));
+	CModel::SetUseCooked(bUseCooked);
+	CTexture::SetUseCooked(bUseCooked);
+
+	//-nobatch keeps every mesh placed once in its own buffers, for comparing draw calls and binds against the static batches
+	if (_lpCmdLine && strstr(_lpCmdLine, "-nobatch")) CModel::SetUseStaticBatching(false);
+
+	//-noshare gives every model its own mesh objects even where another model has the same geometry
+	if (_lpCmdLine && strstr(_lpCmdLine, "-noshare")) CModel::SetShareMeshes(false);
+
+	//-nostream uploads every cooked texture in full on load rather than streaming mips in from the tail
+	if (_lpCmdLine && strstr(_lpCmdLine, "-nostream")) CTexture::SetStreamed(false);
+
+	//-mipbench logs mip generation throughput per filter before the game starts
+	if (_lpCmdLine && strstr(_lpCmdLine, "-mipbench")) BenchmarkMipGeneration();
+
+	//-packtest round trips vertex packing through its edge cases and logs the worst errors against the tolerance
+	if (_lpCmdLine && strstr(_lpCmdLine, "-packtest")) TestVertexPacking();
+
 	//Create the game
 	CGame& rGame = CGame::GetInstance();
 	rGame.Initialize();
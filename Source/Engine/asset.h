@@ -5,6 +5,8 @@
 //Library Includes
 #include <atomic>
 #include <string>
+#include <memory>
+#include <list>
 
 //Macros
 #define AssetLoaded(x) (x && x->GetAssetState() == EAssetState::Loaded)
@@ -22,6 +24,37 @@ enum EAssetType
 	EAssetType_ERROR = -1
 };
 
+inline const char* GetAssetTypeName(EAssetType _eType)
+{
+	switch(_eType)
+	{
+	case ASSET_TEXTURE: return("texture");
+	case ASSET_MODEL: return("model");
+	default: return("unknown");
+	}
+}
+
+//Where an asset's memory lives
+enum EMemoryHeap
+{
+	MEMORY_HEAP_CPU_RETAINED,	//Kept in system memory while loaded: readable mesh copies, instance tables, decompressed stream sources
+	MEMORY_HEAP_CPU_STAGING,	//Copied into the upload queue and waiting for the GPU, gone once uploaded
+	MEMORY_HEAP_GPU,			//Video memory, estimated from formats, dimensions and mip counts
+
+	EMemoryHeap_MAX
+};
+
+struct TAssetMemory
+{
+	size_t puiBytes[EMemoryHeap_MAX];
+
+	TAssetMemory() { Clear(); }
+
+	void Clear() { for(unsigned int i = 0; i < EMemoryHeap_MAX; ++i) puiBytes[i] = 0; }
+	void Add(const TAssetMemory& _rtOther) { for(unsigned int i = 0; i < EMemoryHeap_MAX; ++i) puiBytes[i] += _rtOther.puiBytes[i]; }
+	size_t GetTotal() const { return(puiBytes[MEMORY_HEAP_CPU_RETAINED] + puiBytes[MEMORY_HEAP_CPU_STAGING] + puiBytes[MEMORY_HEAP_GPU]); }
+};
+
 enum class EAssetState
 {
 	Error,
@@ -31,6 +64,40 @@ enum class EAssetState
 	Loaded
 };
 
+//Higher loads first, any int is valid
+enum EAssetPriority
+{
+	ASSET_PRIORITY_LOW = -100,
+	ASSET_PRIORITY_NORMAL = 0,
+	ASSET_PRIORITY_HIGH = 100,
+	ASSET_PRIORITY_WAITING = 1000 //Something is blocked on the asset
+};
+
+//Stable reference into the asset registry, the generation catches reuse of a freed slot
+struct TAssetHandle
+{
+	unsigned int uiSlot;
+	unsigned int uiGeneration;
+
+	TAssetHandle() : uiSlot(0xFFFFFFFF), uiGeneration(0) {}
+	bool IsValid() const { return(uiSlot != 0xFFFFFFFF); }
+};
+
+//Shared flag, copies all see the same state. Queued assets holding a cancelled token are skipped
+class CCancelToken
+{
+	//Member Functions
+public:
+	CCancelToken() : m_pbCancelled(std::make_shared<std::atomic_bool>(false)) {}
+
+	void Cancel() { *m_pbCancelled = true; }
+	bool IsCancelled() const { return(*m_pbCancelled); }
+
+	//Member Variables
+private:
+	std::shared_ptr<std::atomic_bool> m_pbCancelled;
+};
+
 //Prototype
 class CAssetManager;
 class IAsset
@@ -40,10 +107,35 @@ public:
 	virtual EAssetState GetAssetState() { return(tm_eAssetState); };
 	virtual const char* GetName() { return(m_strAssetName.c_str()); };
 
+	//Reference counting, prefer holding a CAssetRef over calling these directly
+	//An asset nothing references is kept but may be evicted once the asset manager is over budget
+	void AddRef();
+	void RemoveRef();
+	int GetRefCount() const { return(tm_iRefCount); }
+
+	//Memory held while loaded, counted against the asset manager budget
+	virtual size_t GetCPUBytes() const { return(0); }
+	virtual size_t GetGPUBytes() const { return(0); }
+
+	//Breakdown by heap for the memory report, staging is transient and not charged to the budget
+	virtual void GetMemoryUsage(TAssetMemory& _rtMemory) const
+	{
+		_rtMemory.Clear();
+		_rtMemory.puiBytes[MEMORY_HEAP_CPU_RETAINED] = GetCPUBytes();
+		_rtMemory.puiBytes[MEMORY_HEAP_GPU] = GetGPUBytes();
+	}
+
 protected:
 	IAsset()
 		: tm_eAssetState(EAssetState::Unloaded)
 		, m_strAssetName("")
+		, tm_iLoadPriority(ASSET_PRIORITY_NORMAL)
+		, tm_uiQueueOrder(0)
+		, m_dQueuedMs(0.0)
+		, tm_iRefCount(0)
+		, m_bInLRU(false)
+		, m_uiChargedCPUBytes(0)
+		, m_uiChargedGPUBytes(0)
 	{
 		//Constructor
 	}
@@ -53,6 +145,11 @@ protected:
 
 	virtual void Release() = 0;
 	virtual bool Load(const char* _kpcFilename) = 0;
+
+	//Hot reload, a fresh asset is loaded to the side on a worker and traded in on the main thread between frames
+	//Assets that can't be reloaded return nullptr. SwapReloaded returns false to be tried again next frame
+	virtual IAsset* CreateReloadTarget() const { return(nullptr); }
+	virtual bool SwapReloaded(IAsset* _pReloaded) { return(false); }
 	//virtual bool Load(void* _pData, size_t _size) = 0;
 	//Create()
 
@@ -61,6 +158,21 @@ protected:
 	std::atomic<EAssetState> tm_eAssetState;
 	std::string m_strAssetName;
 
+	//Load queue ordering, only touched under the asset manager queue lock
+	int tm_iLoadPriority;
+	unsigned int tm_uiQueueOrder;
+	CCancelToken m_tCancelToken;
+	double m_dQueuedMs; //Load telemetry clock, when it last joined the queue
+
+	TAssetHandle m_tHandle; //Set by the asset manager on registration
+
+	//Eviction, the LRU fields and charged sizes are only touched under the asset manager LRU lock
+	std::atomic<int> tm_iRefCount;
+	bool m_bInLRU;
+	std::list<IAsset*>::iterator m_itLRU;
+	size_t m_uiChargedCPUBytes; //What was added to the budget when the asset loaded
+	size_t m_uiChargedGPUBytes;
+
 	friend CAssetManager;
 
 };
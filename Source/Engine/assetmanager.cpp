@@ -1,9 +1,10 @@
 //Library Includes
-#include <chrono> //for thread sleep
 #include <objbase.h> //coinit for threading
+#include <algorithm>
 
 //Local Includes
 #include "logmanager.h"
+#include "renderer.h"
 
 //This Include
 #include "assetmanager.hpp"
@@ -11,11 +12,32 @@
 //Static Variables
 CAssetManager* CAssetManager::sm_pThis = nullptr;
 
+//Helpers
+static inline double ToMB(size_t _uiBytes)
+{
+	return(_uiBytes / (1024.0 * 1024.0));
+}
+
 //Implementation
 CAssetManager::CAssetManager()
 	: m_pRenderer(nullptr)
 	, m_bAsyncLoad(false)
-	, m_bRunWorkers(false)
+	, m_iQueuedAssets(0)
+	, m_setQueuedAssets(&CAssetManager::QueueOrder)
+	, m_uiQueueCounter(0)
+	, m_dFirstAssetMs(0.0)
+	, m_uiBatchLoaded(0)
+	, m_uiCPUBytes(0)
+	, m_uiGPUBytes(0)
+	, m_uiCPUBudget(0)
+	, m_uiGPUBudget(0)
+	, m_bShuttingDown(false)
+	, m_bHotReload(false)
+#ifdef _DEBUG
+	, m_bLooseOverride(true)
+#else
+	, m_bLooseOverride(false)
+#endif //_DEBUG
 {
 	//Constructor
 }
@@ -23,28 +45,63 @@ CAssetManager::CAssetManager()
 CAssetManager::~CAssetManager()
 {
 	//Destructor
+	m_bShuttingDown = true;
 
 	//Close threads to ensure they don't mess up data if something is broken
-	m_bRunWorkers = false;
-	for (unsigned int i = 0; i < m_vecWorkerThreads.size(); ++i) m_vecWorkerThreads[i].join();
+	//Workers finish the asset they are on, anything still queued is released below
+	m_textureStreamer.Shutdown();
+	m_jobSystem.Shutdown();
+	m_setQueuedAssets.clear();
+	m_listLRU.clear();
 
-	//Release all assets
-	for (unsigned int uiAssetType = 0; uiAssetType < EAssetType_MAX; ++uiAssetType)
+	//Reloads that never ran or were never swapped, dropping them lets go of their assets
+	m_fileWatcher.Shutdown();
+	for (TReload* ptReload : m_listReloads) FreeReload(ptReload);
+	m_listReloads.clear();
+
+	//Continuations that never ran, dropping them lets go of their assets. Futures still waiting on them are left broken
+	for (auto& rPair : m_mapWaitingCompletions) rPair.second.pAsset->RemoveRef();
+	for (TCompletion& rtCompletion : m_vecReadyCompletions) if (rtCompletion.pAsset) rtCompletion.pAsset->RemoveRef();
+	m_mapWaitingCompletions.clear();
+	m_vecReadyCompletions.clear();
+
+	//Release all assets first, this drops the references assets hold on each other (model materials on textures)
+	std::vector<IAsset*> vecAssets;
+	m_registry.ForEach([&vecAssets](IAsset* _pAsset)
 	{
-		//Release assets in each list
-		for (unsigned int uiAssetID = 0; uiAssetID < m_vecStoredAssets[uiAssetType].size(); ++uiAssetID)
-		{
-			IAsset*& pAsset = m_vecStoredAssets[uiAssetType][uiAssetID];
+		_pAsset->Release();
+		vecAssets.push_back(_pAsset);
+	});
 
-			pAsset->Release();
-			delete pAsset;
-			pAsset = nullptr;
+	//Then free anything no longer referenced, deleting an asset can free up others so go until nothing changes
+	bool bFreed = true;
+	while (bFreed)
+	{
+		bFreed = false;
+		for (unsigned int i = 0; i < vecAssets.size(); ++i)
+		{
+			if (!vecAssets[i] || vecAssets[i]->GetRefCount() > 0) continue;
+			delete vecAssets[i];
+			vecAssets[i] = nullptr;
+			bFreed = true;
 		}
+	}
 
-		//Clear asset list
-		m_vecStoredAssets[uiAssetType].clear();
+	//Still referenced from outside, freeing would leave the holder pointing at nothing
+	for (IAsset* pAsset : vecAssets)
+	{
+		if (!pAsset) continue;
+		std::string debug = "Asset still referenced at shutdown, leaked: \"" + pAsset->m_strAssetName + "\"\n";
+		CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
 	}
 
+	//Clear asset list
+	m_registry.Clear();
+
+	//Last, anything loaded from a pak may have been reading straight out of its mapping
+	for (CPakFile* pPak : m_vecpPaks) delete pPak;
+	m_vecpPaks.clear();
+
 	//A good hint that we're not loaded is if this is null
 	m_pRenderer = nullptr;
 }
@@ -74,29 +131,285 @@ CAssetManager::Initialize(CRenderer* _pRenderer, int _iMaxConcurrentLoading)
 	m_pRenderer = _pRenderer;
 	m_bAsyncLoad = (_iMaxConcurrentLoading > 0);
 
-	//Queue up worker thread for loading assets if m_bAsyncLoad == true
+	//Start the worker pool for loading assets if m_bAsyncLoad == true
+	//WIC requires COM on every thread that decodes textures
 	if (m_bAsyncLoad)
 	{
-		m_bRunWorkers = true;
+		m_bAsyncLoad = m_jobSystem.Initialize(_iMaxConcurrentLoading, []() { CoInitialize(nullptr); }, []() { CoUninitialize(); });
+	}
+
+	m_textureStreamer.Initialize();
+
+	return(m_pRenderer != nullptr);
+}
 
-		//Create requested number of threads
-		for (int i = 0; i < _iMaxConcurrentLoading; ++i)
+void
+CAssetManager::SetMemoryBudget(size_t _uiCPUBytes, size_t _uiGPUBytes)
+{
+	m_mutexLRU.lock();
+	m_uiCPUBudget = _uiCPUBytes;
+	m_uiGPUBudget = _uiGPUBytes;
+	m_mutexLRU.unlock();
+}
+
+size_t
+CAssetManager::GetCPUBytes() const
+{
+	return(m_uiCPUBytes);
+}
+
+size_t
+CAssetManager::GetGPUBytes() const
+{
+	return(m_uiGPUBytes);
+}
+
+void
+CAssetManager::Process()
+{
+	//First, so mips swapped in this frame are counted before anything is evicted
+	m_textureStreamer.Process();
+	ProcessHotReload();
+
+	//Peaks are raised here, before anything is evicted
+	TMemoryReport tMemoryReport;
+	SampleMemory(tMemoryReport, false);
+
+	std::lock_guard<std::recursive_mutex> lockLRU(m_mutexLRU);
+	if (!IsOverBudget()) return;
+
+	unsigned int uiEvicted = 0;
+	size_t uiCPUBefore = m_uiCPUBytes;
+	size_t uiGPUBefore = m_uiGPUBytes;
+
+	//Oldest first. Anything still being loaded is skipped, it gets another chance next frame
+	auto it = m_listLRU.begin();
+	while (it != m_listLRU.end() && IsOverBudget())
+	{
+		IAsset* pAsset = *it;
+		EAssetState eState = pAsset->GetAssetState();
+
+		if (pAsset->GetRefCount() > 0 || (eState != EAssetState::Loaded && eState != EAssetState::Error))
 		{
-			m_vecWorkerThreads.push_back(std::thread(CAssetManager::WorkerThread));
+			++it;
+			continue;
 		}
+
+		it = m_listLRU.erase(it);
+		pAsset->m_bInLRU = false;
+
+		//The lock is held through the release so a new reference can't see it half evicted
+		//Anything this drops its references to joins the back of the list
+		pAsset->Release();
+		DischargeAsset(pAsset);
+		pAsset->tm_eAssetState = EAssetState::Unloaded;
+		++uiEvicted;
 	}
 
-	return(m_pRenderer != nullptr);
+	if (uiEvicted)
+	{
+		char pcStats[256];
+		sprintf_s(pcStats, "Evicted %u assets, freed %zu CPU bytes, %zu GPU bytes\n",
+			uiEvicted, uiCPUBefore - m_uiCPUBytes, uiGPUBefore - m_uiGPUBytes);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Asset Manager");
+	}
+}
+
+bool
+CAssetManager::MountPak(const char* _kpcFilename)
+{
+	CPakFile* pPak = new CPakFile();
+	if (!pPak->Open(_kpcFilename))
+	{
+		std::string debug = std::string("Failed to mount pak: ") + (_kpcFilename ? _kpcFilename : "") + "\n";
+		CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
+		delete pPak;
+		return(false);
+	}
+
+	char pcStats[512];
+	sprintf_s(pcStats, "Mounted pak with %u files: %s\n", pPak->GetEntryCount(), _kpcFilename);
+	CLogManager::GetInstance().WriteDebug(pcStats, "Asset Manager");
+
+	std::unique_lock<std::shared_timed_mutex> lockPaks(m_mutexPaks);
+	m_vecpPaks.push_back(pPak);
+
+	return(true);
+}
+
+void
+CAssetManager::SetLooseOverride(bool _bLooseOverride)
+{
+	m_bLooseOverride = _bLooseOverride;
+}
+
+bool
+CAssetManager::OpenFile(const char* _kpcFilename, CMappedFile& _rFile)
+{
+	bool bLooseOverride = m_bLooseOverride;
+	if (bLooseOverride && _rFile.Open(_kpcFilename)) return(true);
+
+	//Shared, the lookups are lock free inside each pak and decompression runs in parallel across the workers
+	{
+		std::shared_lock<std::shared_timed_mutex> lockPaks(m_mutexPaks);
+		for (auto it = m_vecpPaks.rbegin(); it != m_vecpPaks.rend(); ++it)
+		{
+			if ((*it)->OpenFile(_kpcFilename, _rFile)) return(true);
+		}
+	}
+
+	return(!bLooseOverride && _rFile.Open(_kpcFilename));
+}
+
+void
+CAssetManager::GetMemoryReport(TMemoryReport& _rtReport, bool _bPerAsset)
+{
+	SampleMemory(_rtReport, _bPerAsset);
+}
+
+void
+CAssetManager::WriteMemoryReport(unsigned int _uiLargestShown)
+{
+	TMemoryReport tReport;
+	GetMemoryReport(tReport, true);
+	CLogManager& rLog = CLogManager::GetInstance();
+
+	char pcLine[512];
+	const TAssetMemory& rtTotal = tReport.tCurrentTotal;
+	const TAssetMemory& rtPeak = tReport.tPeakTotal;
+	sprintf_s(pcLine, "%.2fMB retained, %.2fMB staging, %.2fMB GPU. Peak %.2fMB retained, %.2fMB staging, %.2fMB GPU\n",
+		ToMB(rtTotal.puiBytes[MEMORY_HEAP_CPU_RETAINED]), ToMB(rtTotal.puiBytes[MEMORY_HEAP_CPU_STAGING]), ToMB(rtTotal.puiBytes[MEMORY_HEAP_GPU]),
+		ToMB(rtPeak.puiBytes[MEMORY_HEAP_CPU_RETAINED]), ToMB(rtPeak.puiBytes[MEMORY_HEAP_CPU_STAGING]), ToMB(rtPeak.puiBytes[MEMORY_HEAP_GPU]));
+	rLog.WriteDebug(pcLine, "Asset Memory");
+
+	for (unsigned int i = 0; i < EAssetType_MAX; ++i)
+	{
+		const TAssetMemory& rtCurrent = tReport.ptCurrent[i];
+		sprintf_s(pcLine, "  %s: %u loaded, %.2fMB retained, %.2fMB staging, %.2fMB GPU\n", GetAssetTypeName((EAssetType)i), tReport.puiLoaded[i],
+			ToMB(rtCurrent.puiBytes[MEMORY_HEAP_CPU_RETAINED]), ToMB(rtCurrent.puiBytes[MEMORY_HEAP_CPU_STAGING]), ToMB(rtCurrent.puiBytes[MEMORY_HEAP_GPU]));
+		rLog.WriteDebug(pcLine, "Asset Memory");
+	}
+
+	sprintf_s(pcLine, "  upload queue: %.2fMB pending, %.2fMB staging ring\n", ToMB(tReport.uiUploadPendingBytes), ToMB(tReport.uiUploadStagingBytes));
+	rLog.WriteDebug(pcLine, "Asset Memory");
+
+	//What eviction works from, unreferenced assets stay charged until they are evicted
+	sprintf_s(pcLine, "  charged %.2fMB CPU, %.2fMB GPU against budgets of %.2fMB, %.2fMB (0 is unlimited)\n",
+		ToMB(m_uiCPUBytes), ToMB(m_uiGPUBytes), ToMB(m_uiCPUBudget), ToMB(m_uiGPUBudget));
+	rLog.WriteDebug(pcLine, "Asset Memory");
+
+	for (unsigned int i = 0; i < tReport.vecAssets.size() && i < _uiLargestShown; ++i)
+	{
+		const TAssetMemoryRecord& rtRecord = tReport.vecAssets[i];
+		const TAssetMemory& rtMemory = rtRecord.tMemory;
+		sprintf_s(pcLine, "  %.2fMB (%.2f retained, %.2f staging, %.2f GPU) %d refs, %s: %s\n", ToMB(rtMemory.GetTotal()),
+			ToMB(rtMemory.puiBytes[MEMORY_HEAP_CPU_RETAINED]), ToMB(rtMemory.puiBytes[MEMORY_HEAP_CPU_STAGING]), ToMB(rtMemory.puiBytes[MEMORY_HEAP_GPU]),
+			rtRecord.iRefCount, GetAssetTypeName(rtRecord.eType), rtRecord.strName.c_str());
+		rLog.WriteDebug(pcLine, "Asset Memory");
+	}
 }
 
 int
 CAssetManager::GetQueueLength()
 {
-	int iQueueLen = 0;
-	m_queueMutex.lock();
-	iQueueLen = (int)m_queueAssets.size();
-	m_queueMutex.unlock();
-	return(iQueueLen);
+	return(m_iQueuedAssets);
+}
+
+bool
+CAssetManager::SetAssetPriority(IAsset* _pAsset, int _iPriority, bool _bRaiseOnly)
+{
+	bool bQueued = false;
+
+	//Compared under the lock, another thread may be changing it
+	m_mutexQueue.lock();
+	bQueued = _pAsset && _pAsset->GetAssetState() == EAssetState::Queued;
+	if (bQueued && (!_bRaiseOnly || _iPriority > _pAsset->tm_iLoadPriority)) RequeueAsset(_pAsset, _iPriority);
+	m_mutexQueue.unlock();
+
+	return(bQueued);
+}
+
+bool
+CAssetManager::WaitForAsset(IAsset* _pAsset)
+{
+	if (!_pAsset) return(false);
+
+	//Calling this from a loader job on an asset queued behind it will deadlock if every worker does the same
+	std::unique_lock<std::mutex> lockQueue(m_mutexQueue);
+
+	//Jump the queue, never lowers an asset that is already higher
+	if (_pAsset->GetAssetState() == EAssetState::Queued && _pAsset->tm_iLoadPriority < ASSET_PRIORITY_WAITING)
+	{
+		RequeueAsset(_pAsset, ASSET_PRIORITY_WAITING);
+	}
+
+	m_cvAssetDone.wait(lockQueue, [_pAsset]() { return(IsSettled(_pAsset)); });
+
+	return(_pAsset->GetAssetState() == EAssetState::Loaded);
+}
+
+void
+CAssetManager::Then(IAsset* _pAsset, std::function<void(bool)> _fpContinuation)
+{
+	AddCompletion(_pAsset, _fpContinuation, false);
+}
+
+void
+CAssetManager::WhenAll(const std::vector<IAsset*>& _rvecAssets, std::function<void(bool)> _fpContinuation)
+{
+	//Every part runs from the dispatch, so the count is only ever touched on the main thread
+	struct TWhenAll
+	{
+		size_t uiRemaining;
+		bool bAllLoaded;
+		std::function<void(bool)> fpDone;
+	};
+
+	if (_rvecAssets.empty())
+	{
+		AddCompletion(nullptr, [_fpContinuation](bool) { _fpContinuation(true); }, false);
+		return;
+	}
+
+	auto ptWhenAll = std::make_shared<TWhenAll>();
+	ptWhenAll->uiRemaining = _rvecAssets.size();
+	ptWhenAll->bAllLoaded = true;
+	ptWhenAll->fpDone = _fpContinuation;
+
+	for (IAsset* pAsset : _rvecAssets)
+	{
+		AddCompletion(pAsset, [ptWhenAll](bool _bLoaded)
+		{
+			ptWhenAll->bAllLoaded = ptWhenAll->bAllLoaded && _bLoaded;
+			if (--ptWhenAll->uiRemaining == 0) ptWhenAll->fpDone(ptWhenAll->bAllLoaded);
+		}, false);
+	}
+}
+
+std::shared_future<bool>
+CAssetManager::GetFuture(IAsset* _pAsset)
+{
+	auto ptPromise = std::make_shared<std::promise<bool>>();
+	std::shared_future<bool> future = ptPromise->get_future().share();
+	AddCompletion(_pAsset, [ptPromise](bool _bLoaded) { ptPromise->set_value(_bLoaded); }, true);
+
+	return(future);
+}
+
+void
+CAssetManager::DispatchCompletions()
+{
+	//Taken as a batch, anything a continuation adds waits for the next dispatch
+	std::vector<TCompletion> vecReady;
+	m_mutexCompletions.lock();
+	vecReady.swap(m_vecReadyCompletions);
+	m_mutexCompletions.unlock();
+
+	for (TCompletion& rtCompletion : vecReady)
+	{
+		rtCompletion.fpDone(rtCompletion.pAsset && rtCompletion.pAsset->GetAssetState() == EAssetState::Loaded);
+		if (rtCompletion.pAsset) rtCompletion.pAsset->RemoveRef();
+	}
 }
 
 CRenderer*
@@ -105,66 +418,574 @@ CAssetManager::GetRenderer() const
 	return(m_pRenderer);
 }
 
+CTextureStreamer&
+CAssetManager::GetTextureStreamer()
+{
+	return(m_textureStreamer);
+}
+
+CLoadTelemetry&
+CAssetManager::GetLoadTelemetry()
+{
+	return(m_loadTelemetry);
+}
+
+bool
+CAssetManager::EnableHotReload(const char* _kpcDirectory, unsigned int _uiDebounceMs)
+{
+	if (m_bHotReload || !m_fileWatcher.Initialize(_kpcDirectory, _uiDebounceMs)) return(false);
+
+	//Everything already registered, new assets are added as they register
+	m_registry.ForEach([this](IAsset* _pAsset) { m_fileWatcher.AddFile(_pAsset->m_strAssetName.c_str()); });
+	m_bHotReload = true;
+
+	return(true);
+}
+
 void
-CAssetManager::WorkerThread()
+CAssetManager::DisableHotReload()
+{
+	m_bHotReload = false;
+	m_fileWatcher.Shutdown();
+}
+
+TAssetHandle
+CAssetManager::RegisterAsset(EAssetType _eType, const char* _kpcName, IAsset* _pAsset)
+{
+	if (m_bHotReload) m_fileWatcher.AddFile(_kpcName);
+	return(m_registry.Insert(_eType, _kpcName, _pAsset));
+}
+
+bool
+CAssetManager::RemoveStoredAsset(IAsset* _pAsset)
 {
-	//TODO: Ability to sleep or end thread when loading isn't required
-	// Maybe start a thread each time load is called if there are free thread slots
-	// Once thread finishes loading and nothing is queued after 5 seconds, terminate thread
-	// This will prevent the need for thread tracking outside of a semaphore for active count against max slots
-	std::string debug = "";
+	bool bWasQueued = false;
 
-	//Dummy
-	CoInitialize(nullptr);
+	//Someone still holds it, freeing it would leave them with a dangling pointer
+	if (_pAsset->GetRefCount() > 0)
+	{
+		std::string debug = "Can't unload referenced asset: \"" + _pAsset->m_strAssetName + "\"\n";
+		CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
+		return(false);
+	}
 
-	//While the asset manager technically exists and workers should be running
-	//TODO: Consider making sm_pThis atomic
-	while (sm_pThis != nullptr && sm_pThis->m_bRunWorkers)
+	//Pull it out of the queue, or let the worker that already has it finish before we free it
+	std::unique_lock<std::mutex> lockQueue(m_mutexQueue);
+	if (_pAsset->GetAssetState() == EAssetState::Queued)
 	{
-		//Try acquire next asset to load, avoid blocking in case of shutdown
-		if (sm_pThis->m_queueMutex.try_lock())
+		m_setQueuedAssets.erase(_pAsset);
+		_pAsset->tm_eAssetState = EAssetState::Unloaded;
+		bWasQueued = true;
+	}
+
+	m_cvAssetDone.wait(lockQueue, [_pAsset]() { return(_pAsset->GetAssetState() != EAssetState::Loading); });
+	lockQueue.unlock();
+
+	//Unloading an asset another thread is waiting on is not supported, the waiter would read freed memory
+	if (bWasQueued)
+	{
+		m_cvAssetDone.notify_all();
+		FinishQueuedAsset(false);
+	}
+
+	//Drop the name first so nothing can find it while it is being freed
+	m_registry.Remove(_pAsset->m_tHandle);
+	if (m_bHotReload) m_fileWatcher.RemoveFile(_pAsset->m_strAssetName.c_str());
+
+	m_mutexLRU.lock();
+	if (_pAsset->m_bInLRU) m_listLRU.erase(_pAsset->m_itLRU);
+	_pAsset->m_bInLRU = false;
+	DischargeAsset(_pAsset);
+	m_mutexLRU.unlock();
+
+	_pAsset->Release();
+	delete _pAsset;
+
+	return(true);
+}
+
+bool
+CAssetManager::RunLoad(IAsset* _pAsset, EAssetType _eType, bool _bQueued)
+{
+	TLoadRecord tRecord;
+	tRecord.strName = _pAsset->m_strAssetName;
+	tRecord.eType = _eType;
+	tRecord.iWorker = m_jobSystem.GetCurrentWorker();
+	tRecord.dStartMs = CLoadTelemetry::GetTimeMs();
+	tRecord.dQueuedMs = _bQueued ? _pAsset->m_dQueuedMs : tRecord.dStartMs;
+
+	//Loaders add their stages to the open record, a load nested inside this one gets its own and hands ours back
+	TLoadRecord* ptOuterRecord = CLoadTelemetry::SetCurrentRecord(&tRecord);
+
+	//TODO: This assumes asset name will not change, which can be bad
+	tRecord.bLoaded = _pAsset->Load(_pAsset->m_strAssetName.c_str());
+
+	CLoadTelemetry::SetCurrentRecord(ptOuterRecord);
+	tRecord.dEndMs = CLoadTelemetry::GetTimeMs();
+	if (tRecord.bLoaded) tRecord.uiBytesOut = _pAsset->GetCPUBytes() + _pAsset->GetGPUBytes();
+	m_loadTelemetry.AddRecord(tRecord);
+
+	return(tRecord.bLoaded);
+}
+
+bool
+CAssetManager::LoadStoredAsset(IAsset* _pAsset)
+{
+	bool bSuccessful = RunLoad(_pAsset, m_registry.GetType(_pAsset->m_tHandle), false);
+	_pAsset->tm_eAssetState = bSuccessful ? EAssetState::Loaded : EAssetState::Error;
+	if (bSuccessful) ChargeAsset(_pAsset);
+	SettleAsset(_pAsset);
+
+	return(bSuccessful);
+}
+
+void
+CAssetManager::OnAssetReferenced(IAsset* _pAsset)
+{
+	if (m_bShuttingDown) return;
+
+	//Referenced again, no longer a candidate for eviction
+	m_mutexLRU.lock();
+	if (_pAsset->m_bInLRU) m_listLRU.erase(_pAsset->m_itLRU);
+	_pAsset->m_bInLRU = false;
+	bool bEvicted = (_pAsset->GetAssetState() == EAssetState::Unloaded);
+	m_mutexLRU.unlock();
+
+	//Evicted or cancelled, bring it back
+	if (bEvicted)
+	{
+		if (m_bAsyncLoad) QueueAsset(_pAsset, ASSET_PRIORITY_NORMAL, CCancelToken());
+		else LoadStoredAsset(_pAsset);
+	}
+}
+
+void
+CAssetManager::OnAssetUnreferenced(IAsset* _pAsset)
+{
+	if (m_bShuttingDown) return;
+
+	//Checked again under the lock, another thread may have referenced it since
+	m_mutexLRU.lock();
+	if (!_pAsset->m_bInLRU && _pAsset->GetRefCount() == 0)
+	{
+		_pAsset->m_itLRU = m_listLRU.insert(m_listLRU.end(), _pAsset);
+		_pAsset->m_bInLRU = true;
+	}
+	m_mutexLRU.unlock();
+}
+
+void
+CAssetManager::ChargeAsset(IAsset* _pAsset)
+{
+	m_mutexLRU.lock();
+	DischargeAsset(_pAsset); //Reloads replace the old size
+
+	_pAsset->m_uiChargedCPUBytes = _pAsset->GetCPUBytes();
+	_pAsset->m_uiChargedGPUBytes = _pAsset->GetGPUBytes();
+	m_uiCPUBytes += _pAsset->m_uiChargedCPUBytes;
+	m_uiGPUBytes += _pAsset->m_uiChargedGPUBytes;
+	m_mutexLRU.unlock();
+}
+
+void
+CAssetManager::DischargeAsset(IAsset* _pAsset)
+{
+	m_uiCPUBytes -= _pAsset->m_uiChargedCPUBytes;
+	m_uiGPUBytes -= _pAsset->m_uiChargedGPUBytes;
+	_pAsset->m_uiChargedCPUBytes = 0;
+	_pAsset->m_uiChargedGPUBytes = 0;
+}
+
+bool
+CAssetManager::IsOverBudget() const
+{
+	return((m_uiCPUBudget && m_uiCPUBytes > m_uiCPUBudget) || (m_uiGPUBudget && m_uiGPUBytes > m_uiGPUBudget));
+}
+
+void
+CAssetManager::SampleMemory(TMemoryReport& _rtReport, bool _bPerAsset)
+{
+	for (unsigned int i = 0; i < EAssetType_MAX; ++i)
+	{
+		_rtReport.puiLoaded[i] = 0;
+		_rtReport.ptCurrent[i].Clear();
+	}
+	_rtReport.tCurrentTotal.Clear();
+	_rtReport.vecAssets.clear();
+
+	//Collected first so the registry lock isn't held while asking each asset, only the main thread frees them
+	std::vector<IAsset*> vecAssets;
+	m_registry.ForEach([&vecAssets](IAsset* _pAsset) { vecAssets.push_back(_pAsset); });
+
+	//Loaded only, anything loading is still being written by its worker
+	for (IAsset* pAsset : vecAssets)
+	{
+		EAssetType eType = m_registry.GetType(pAsset->m_tHandle);
+		if (pAsset->GetAssetState() != EAssetState::Loaded || eType < 0 || eType >= EAssetType_MAX) continue;
+
+		TAssetMemory tMemory;
+		pAsset->GetMemoryUsage(tMemory);
+		++_rtReport.puiLoaded[eType];
+		_rtReport.ptCurrent[eType].Add(tMemory);
+		_rtReport.tCurrentTotal.Add(tMemory);
+
+		if (_bPerAsset)
+		{
+			TAssetMemoryRecord tRecord;
+			tRecord.strName = pAsset->m_strAssetName;
+			tRecord.eType = eType;
+			tRecord.iRefCount = pAsset->GetRefCount();
+			tRecord.tMemory = tMemory;
+			_rtReport.vecAssets.push_back(tRecord);
+		}
+	}
+
+	//Each heap peaks on its own
+	for (unsigned int i = 0; i < EMemoryHeap_MAX; ++i)
+	{
+		for (unsigned int j = 0; j < EAssetType_MAX; ++j)
+		{
+			m_ptMemoryPeak[j].puiBytes[i] = max(m_ptMemoryPeak[j].puiBytes[i], _rtReport.ptCurrent[j].puiBytes[i]);
+		}
+		m_tMemoryPeakTotal.puiBytes[i] = max(m_tMemoryPeakTotal.puiBytes[i], _rtReport.tCurrentTotal.puiBytes[i]);
+	}
+
+	for (unsigned int i = 0; i < EAssetType_MAX; ++i) _rtReport.ptPeak[i] = m_ptMemoryPeak[i];
+	_rtReport.tPeakTotal = m_tMemoryPeakTotal;
+
+	//No renderer when running headless or from the cooker, nothing is uploaded then
+	_rtReport.uiUploadPendingBytes = 0;
+	_rtReport.uiUploadStagingBytes = 0;
+	if (m_pRenderer)
+	{
+		CUploadQueue& rUploadQueue = m_pRenderer->GetUploadQueue();
+		_rtReport.uiUploadPendingBytes = rUploadQueue.GetPendingBytes();
+		_rtReport.uiUploadStagingBytes = rUploadQueue.GetStagingBytes();
+	}
+
+	std::sort(_rtReport.vecAssets.begin(), _rtReport.vecAssets.end(), [](const TAssetMemoryRecord& _rtLeft, const TAssetMemoryRecord& _rtRight) { return(_rtLeft.tMemory.GetTotal() > _rtRight.tMemory.GetTotal()); });
+}
+
+void
+CAssetManager::QueueAsset(IAsset* _pAsset, int _iPriority, const CCancelToken& _tCancelToken)
+{
+	//Start a new batch if nothing is in flight
+	if (m_iQueuedAssets++ == 0)
+	{
+		m_mutexBatchStats.lock();
+		m_tBatchStart = std::chrono::steady_clock::now();
+		m_dFirstAssetMs = 0.0;
+		m_uiBatchLoaded = 0;
+		m_mutexBatchStats.unlock();
+	}
+
+	m_mutexQueue.lock();
+	_pAsset->tm_iLoadPriority = _iPriority;
+	_pAsset->tm_uiQueueOrder = m_uiQueueCounter++; //Ties load in call order
+	_pAsset->m_tCancelToken = _tCancelToken;
+	_pAsset->m_dQueuedMs = CLoadTelemetry::GetTimeMs();
+	_pAsset->tm_eAssetState = EAssetState::Queued; //Mark asset as queued up
+	m_setQueuedAssets.insert(_pAsset);
+	m_mutexQueue.unlock();
+
+	//The job does not own the asset, it loads whatever is most important when a worker picks it up
+	m_jobSystem.Submit([this]() { LoadNextQueuedAsset(); });
+}
+
+void
+CAssetManager::RequeueAsset(IAsset* _pAsset, int _iPriority)
+{
+	//Keys can't change while the asset is in the set
+	m_setQueuedAssets.erase(_pAsset);
+	_pAsset->tm_iLoadPriority = _iPriority;
+	m_setQueuedAssets.insert(_pAsset);
+}
+
+void
+CAssetManager::LoadNextQueuedAsset()
+{
+	IAsset* pAsset = nullptr;
+	std::vector<IAsset*> vecCancelled;
+
+	//Take the front of the queue, skipping anything cancelled. Loading is set under the lock so unload can't race us
+	m_mutexQueue.lock();
+	while (!pAsset && !m_setQueuedAssets.empty())
+	{
+		IAsset* pNext = *m_setQueuedAssets.begin();
+		m_setQueuedAssets.erase(m_setQueuedAssets.begin());
+
+		if (pNext->m_tCancelToken.IsCancelled())
+		{
+			pNext->tm_eAssetState = EAssetState::Unloaded;
+			vecCancelled.push_back(pNext);
+		}
+		else
 		{
-			//If the queue is not empty, grab the next asset
-			if (!sm_pThis->m_queueAssets.empty())
-			{
-				IAsset* pAsset = sm_pThis->m_queueAssets.front();
-				sm_pThis->m_queueAssets.pop();
-
-				//Unlock to allow other workers to continue
-				sm_pThis->m_queueMutex.unlock();
-
-				if (pAsset)
-				{
-					debug = "Loading asset: " + pAsset->m_strAssetName + "\n";
-					CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
-
-					//TODO: This assumes asset name will not change, which can be bad
-					pAsset->tm_eAssetState = EAssetState::Loading;
-					bool bSuccessful = pAsset->Load(pAsset->m_strAssetName.c_str());
-
-					//Update asset state
-					pAsset->tm_eAssetState = bSuccessful ? EAssetState::Loaded : EAssetState::Error;
-
-					std::string debug = bSuccessful ? "Asset Loaded: \"" : "Failed to load asset: \"";
-					debug += pAsset->m_strAssetName + "\"\n";
-					CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
-
-					//The return doesn't really matter here as Load() should call
-					//		to update AssetState if it loaded correctly or failed
-
-					//No point doing this as it will clear the ERROR flag
-					//if (!bSuccess) pAsset->Release();
-				}
-			}
-			else
-			{
-				//Unlock to allow other workers to continue
-				sm_pThis->m_queueMutex.unlock();
-			}
+			pNext->tm_eAssetState = EAssetState::Loading;
+			pAsset = pNext;
 		}
+	}
+	m_mutexQueue.unlock();
 
-		//Rest cpu and yield for others
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-		std::this_thread::yield();
+	if (!vecCancelled.empty())
+	{
+		m_cvAssetDone.notify_all();
+		for (IAsset* pCancelled : vecCancelled)
+		{
+			SettleAsset(pCancelled);
+			FinishQueuedAsset(false);
+		}
 	}
+
+	//Unloaded or cancelled before this job ran
+	if (!pAsset) return;
+
+	std::string debug = "Loading asset: " + pAsset->m_strAssetName + "\n";
+	CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
+
+	double dStartMs = CLoadTelemetry::GetTimeMs();
+	bool bSuccessful = RunLoad(pAsset, m_registry.GetType(pAsset->m_tHandle), true);
+
+	//Full breakdown is in the telemetry record
+	char pcStats[512];
+	sprintf_s(pcStats, "%s in %.2fms after %.2fms queued, worker %d: \"%s\"\n", bSuccessful ? "Asset Loaded" : "Failed to load asset",
+		CLoadTelemetry::GetTimeMs() - dStartMs, dStartMs - pAsset->m_dQueuedMs, m_jobSystem.GetCurrentWorker(), pAsset->m_strAssetName.c_str());
+	CLogManager::GetInstance().WriteDebug(pcStats, "Asset Manager");
+
+	if (bSuccessful) ChargeAsset(pAsset);
+
+	//Update asset state, under the lock so waiters can't miss it
+	m_mutexQueue.lock();
+	pAsset->tm_eAssetState = bSuccessful ? EAssetState::Loaded : EAssetState::Error;
+	m_mutexQueue.unlock();
+	m_cvAssetDone.notify_all();
+	SettleAsset(pAsset);
+
+	//No point releasing on failure as it will clear the ERROR flag
+	//if (!bSuccess) pAsset->Release();
+
+	FinishQueuedAsset(bSuccessful);
+}
+
+void
+CAssetManager::FinishQueuedAsset(bool _bLoaded)
+{
+	//Batch stats, time to first asset and throughput for the whole batch
+	m_mutexBatchStats.lock();
+	double dElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_tBatchStart).count();
+	if (_bLoaded && m_uiBatchLoaded++ == 0) m_dFirstAssetMs = dElapsedMs;
+
+	if (--m_iQueuedAssets == 0)
+	{
+		char pcStats[256];
+		sprintf_s(pcStats, "Queue drained: %u assets in %.2fms, first asset after %.2fms, %.1f assets/s\n",
+			m_uiBatchLoaded, dElapsedMs, m_dFirstAssetMs, dElapsedMs > 0.0 ? m_uiBatchLoaded * 1000.0 / dElapsedMs : 0.0);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Asset Manager");
+
+		//Where the time went, across every load so far
+		m_loadTelemetry.WriteSummary();
+	}
+	m_mutexBatchStats.unlock();
+}
+
+void
+CAssetManager::AddCompletion(IAsset* _pAsset, std::function<void(bool)> _fpDone, bool _bImmediate)
+{
+	TCompletion tCompletion;
+	tCompletion.pAsset = _pAsset;
+	tCompletion.fpDone = _fpDone;
+	tCompletion.bImmediate = _bImmediate;
+	if (_pAsset) _pAsset->AddRef();
+
+	//Checked under the lock, an asset settling after this sees the completion in the waiting list
+	std::unique_lock<std::mutex> lockCompletions(m_mutexCompletions);
+	if (_pAsset && !IsSettled(_pAsset))
+	{
+		m_mapWaitingCompletions.emplace(_pAsset, tCompletion);
+		return;
+	}
+
+	if (!_bImmediate)
+	{
+		m_vecReadyCompletions.push_back(tCompletion);
+		return;
+	}
+
+	lockCompletions.unlock();
+	tCompletion.fpDone(_pAsset && _pAsset->GetAssetState() == EAssetState::Loaded);
+	if (_pAsset) _pAsset->RemoveRef();
+}
+
+void
+CAssetManager::SettleAsset(IAsset* _pAsset)
+{
+	std::vector<TCompletion> vecImmediate;
+
+	m_mutexCompletions.lock();
+	auto tRange = m_mapWaitingCompletions.equal_range(_pAsset);
+	for (auto it = tRange.first; it != tRange.second; ++it)
+	{
+		if (it->second.bImmediate) vecImmediate.push_back(it->second);
+		else m_vecReadyCompletions.push_back(it->second);
+	}
+	m_mapWaitingCompletions.erase(tRange.first, tRange.second);
+	m_mutexCompletions.unlock();
+
+	//Outside the lock, whatever they wake may add completions of its own
+	bool bLoaded = _pAsset->GetAssetState() == EAssetState::Loaded;
+	for (TCompletion& rtCompletion : vecImmediate)
+	{
+		rtCompletion.fpDone(bLoaded);
+		rtCompletion.pAsset->RemoveRef();
+	}
+}
+
+bool
+CAssetManager::IsSettled(const IAsset* _pAsset)
+{
+	EAssetState eState = _pAsset->tm_eAssetState;
+	return(eState != EAssetState::Queued && eState != EAssetState::Loading);
+}
+
+bool
+CAssetManager::QueueOrder(const IAsset* _pLeft, const IAsset* _pRight)
+{
+	//Highest priority first, then oldest
+	if (_pLeft->tm_iLoadPriority != _pRight->tm_iLoadPriority) return(_pLeft->tm_iLoadPriority > _pRight->tm_iLoadPriority);
+	return(_pLeft->tm_uiQueueOrder < _pRight->tm_uiQueueOrder);
+}
+
+void
+CAssetManager::ProcessHotReload()
+{
+	std::vector<TReload*> vecSwapped;
+
+	//Swap in whatever has finished loading, assets hold off until their new resources are on the GPU
+	m_mutexReloads.lock();
+	auto it = m_listReloads.begin();
+	while (it != m_listReloads.end())
+	{
+		TReload* ptReload = *it;
+		if (!ptReload->bDone || (ptReload->bLoaded && !ptReload->pAsset->SwapReloaded(ptReload->pReloaded)))
+		{
+			++it;
+			continue;
+		}
+
+		vecSwapped.push_back(ptReload);
+		it = m_listReloads.erase(it);
+	}
+	m_mutexReloads.unlock();
+
+	for (TReload* ptReload : vecSwapped)
+	{
+		//Load is the worker time, the rest is the queue and waiting on the upload
+		char pcStats[512];
+		double dTotalMs = CLoadTelemetry::GetTimeMs() - ptReload->dStartMs;
+		sprintf_s(pcStats, "%s in %.2fms (load %.2fms, swapped after %.2fms): \"%s\"\n", ptReload->bLoaded ? "Hot reloaded" : "Hot reload failed, keeping the old asset",
+			dTotalMs, ptReload->dLoadMs, dTotalMs - ptReload->dLoadMs, ptReload->pAsset->m_strAssetName.c_str());
+		CLogManager::GetInstance().WriteDebug(pcStats, "Asset Manager");
+
+		//Sizes change with the contents
+		if (ptReload->bLoaded) ChargeAsset(ptReload->pAsset);
+		if (ptReload->bChangedAgain) StartReload(ptReload->pAsset, ptReload->eType);
+
+		FreeReload(ptReload);
+	}
+
+	if (!m_bHotReload) return;
+
+	std::vector<std::string> vecChanged;
+	m_fileWatcher.GetChangedFiles(vecChanged);
+
+	for (const std::string& rstrFile : vecChanged)
+	{
+		EAssetType eType = ASSET_TEXTURE;
+		IAsset* pAsset = m_registry.Find(eType, rstrFile.c_str());
+		if (!pAsset)
+		{
+			eType = ASSET_MODEL;
+			pAsset = m_registry.Find(eType, rstrFile.c_str());
+		}
+
+		//Only loaded assets have anything to swap, the rest read the new file when they next load
+		if (pAsset && pAsset->GetAssetState() == EAssetState::Loaded) StartReload(pAsset, eType);
+	}
+}
+
+void
+CAssetManager::StartReload(IAsset* _pAsset, EAssetType _eType)
+{
+	std::unique_lock<std::mutex> lockReloads(m_mutexReloads);
+
+	//Already on its way, one more pass once that one is swapped picks up the latest file
+	for (TReload* ptReload : m_listReloads)
+	{
+		if (ptReload->pAsset != _pAsset) continue;
+
+		ptReload->bChangedAgain = true;
+		return;
+	}
+
+	IAsset* pReloaded = _pAsset->CreateReloadTarget();
+	if (!pReloaded) return;
+
+	pReloaded->m_strAssetName = _pAsset->m_strAssetName;
+	pReloaded->m_dQueuedMs = CLoadTelemetry::GetTimeMs();
+
+	TReload* ptReload = new TReload();
+	ptReload->pAsset = _pAsset;
+	ptReload->pReloaded = pReloaded;
+	ptReload->eType = _eType;
+	ptReload->bDone = false;
+	ptReload->bLoaded = false;
+	ptReload->bChangedAgain = false;
+	ptReload->dStartMs = pReloaded->m_dQueuedMs;
+	ptReload->dLoadMs = 0.0;
+	m_listReloads.push_back(ptReload);
+	lockReloads.unlock();
+
+	_pAsset->AddRef();
+
+	std::string debug = "Hot reloading: " + _pAsset->m_strAssetName + "\n";
+	CLogManager::GetInstance().WriteDebug(debug.c_str(), "Asset Manager");
+
+	//Never through the load queue, the asset stays Loaded and keeps drawing the old contents meanwhile
+	if (!m_bAsyncLoad || !m_jobSystem.Submit([this, ptReload]() { RunReload(ptReload); })) RunReload(ptReload);
+}
+
+void
+CAssetManager::RunReload(TReload* _ptReload)
+{
+	//Recorded like any other load. A streamed texture keeps its old cook mapped, so its new cook
+	//can't be written until the old one is let go and the reload uploads from memory instead
+	double dStartMs = CLoadTelemetry::GetTimeMs();
+	_ptReload->bLoaded = RunLoad(_ptReload->pReloaded, _ptReload->eType, m_bAsyncLoad);
+	_ptReload->dLoadMs = CLoadTelemetry::GetTimeMs() - dStartMs;
+	_ptReload->bDone = true;
+}
+
+void
+CAssetManager::FreeReload(TReload* _ptReload)
+{
+	//After a swap this holds the old resources
+	_ptReload->pReloaded->Release();
+	delete _ptReload->pReloaded;
+
+	_ptReload->pAsset->RemoveRef();
+	delete _ptReload;
+}
+
+void
+IAsset::AddRef()
+{
+	//First reference pulls it off the eviction list
+	if (tm_iRefCount++ == 0 && CAssetManager::sm_pThis) CAssetManager::sm_pThis->OnAssetReferenced(this);
+}
+
+void
+IAsset::RemoveRef()
+{
+	//Last reference makes it a candidate for eviction, it is not freed
+	if (--tm_iRefCount == 0 && CAssetManager::sm_pThis) CAssetManager::sm_pThis->OnAssetUnreferenced(this);
 }
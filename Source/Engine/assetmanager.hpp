@@ -4,17 +4,76 @@
 
 //Library Includes
 #include <vector>
-#include <queue>
-#include <thread>
+#include <set>
+#include <list>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <chrono>
+#include <map>
+#include <functional>
+#include <future>
 
 //Local Includes
 #include "asset.h"
+#include "assetref.hpp"
+#include "assetregistry.h"
+#include "jobsystem.h"
+#include "texturestreamer.h"
+#include "loadtelemetry.h"
+#include "filewatcher.h"
+#include "pakfile.h"
+
+//Types
+struct TAssetMemoryRecord
+{
+	std::string strName;
+	EAssetType eType;
+	int iRefCount;
+	TAssetMemory tMemory;
+};
+
+struct TMemoryReport
+{
+	//Loaded assets only. Peaks are per heap and sampled once a frame, so they needn't have been reached at the same time
+	unsigned int puiLoaded[EAssetType_MAX];
+	TAssetMemory ptCurrent[EAssetType_MAX];
+	TAssetMemory ptPeak[EAssetType_MAX];
+	TAssetMemory tCurrentTotal;
+	TAssetMemory tPeakTotal;
+
+	//Upload queue, shared by everything that uploads and not only assets
+	size_t uiUploadPendingBytes;
+	size_t uiUploadStagingBytes;
+
+	std::vector<TAssetMemoryRecord> vecAssets; //Largest first, only filled when asked for
+};
 
 //Protoype
 class CRenderer;
 class CAssetManager
 {
+	//Types
+private:
+	struct TReload
+	{
+		IAsset* pAsset; //Referenced until the swap so it can't be evicted or unloaded meanwhile
+		IAsset* pReloaded; //Loaded to the side, freed with the old resources after the swap
+		EAssetType eType;
+		std::atomic_bool bDone;
+		bool bLoaded;
+		bool bChangedAgain; //Changed while reloading, goes again after the swap
+		double dStartMs;
+		double dLoadMs;
+	};
+
+	struct TCompletion
+	{
+		IAsset* pAsset; //Referenced until run so it can't be evicted or unloaded meanwhile
+		std::function<void(bool)> fpDone; //Passed whether the asset loaded
+		bool bImmediate; //Runs on whichever thread finished the asset instead of waiting for DispatchCompletions
+	};
+
 	//Member Functions
 public:
 	static CAssetManager& GetInstance();
@@ -23,8 +82,15 @@ public:
 	bool Initialize(CRenderer* _pRenderer, int _iMaxConcurrentLoading = 0);
 
 	//Templated functions for support of any asset
+	//_iPriority and _tCancelToken only apply to async loading, see EAssetPriority
+	//Loading an evicted asset loads it again, hold on to the returned reference to keep it resident
 	template<typename TAssetType>
-	TAssetType* LoadAsset(const char* _kpcFilename);
+	CAssetRef<TAssetType> LoadAsset(const char* _kpcFilename);
+
+	template<typename TAssetType>
+	CAssetRef<TAssetType> LoadAsset(const char* _kpcFilename, int _iPriority, CCancelToken _tCancelToken = CCancelToken());
+
+	//Unloading fails while the asset is still referenced
 
 	template<typename TAssetType>
 	bool UnloadAsset(const char* _kpcName);
@@ -35,6 +101,55 @@ public:
 	template<typename TAssetType>
 	TAssetType* FindAsset(const char* _kpcName);
 
+	//Reorders a queued asset, returns false if the asset is not waiting in the queue. _bRaiseOnly leaves a higher priority as it is
+	bool SetAssetPriority(IAsset* _pAsset, int _iPriority, bool _bRaiseOnly = false);
+
+	//Bumps the asset to the front of the queue and blocks until it has loaded, failed or been cancelled
+	bool WaitForAsset(IAsset* _pAsset);
+
+	//Continuations, run on the main thread from DispatchCompletions once the asset has loaded, failed or been cancelled
+	//Runs on the next dispatch if it already has. Continuations added by one run on the dispatch after
+	void Then(IAsset* _pAsset, std::function<void(bool)> _fpContinuation);
+
+	//Runs once every asset has settled, passed whether all of them loaded. nullptr entries count as failed
+	void WhenAll(const std::vector<IAsset*>& _rvecAssets, std::function<void(bool)> _fpContinuation);
+
+	//Resolved with whether the asset loaded on the thread that finished it, so it is safe to wait on from the main thread
+	std::shared_future<bool> GetFuture(IAsset* _pAsset);
+
+	//Main thread, once per frame from CEngine::GameLoop before the game logic
+	void DispatchCompletions();
+
+	//Unreferenced assets are evicted least recently used first while either total is over budget, 0 is unlimited
+	void SetMemoryBudget(size_t _uiCPUBytes, size_t _uiGPUBytes);
+	size_t GetCPUBytes() const;
+	size_t GetGPUBytes() const;
+
+	//Main thread. Per type and per heap memory, current and peak. _bPerAsset adds a record for every loaded asset
+	void GetMemoryReport(TMemoryReport& _rtReport, bool _bPerAsset = false);
+	void WriteMemoryReport(unsigned int _uiLargestShown = 10); //Totals and the largest assets to the debug log
+
+	//Main thread, once per frame. Streams texture mips then evicts until back under budget
+	void Process();
+
+	CTextureStreamer& GetTextureStreamer();
+
+	//Timeline of every load since startup, see CLoadTelemetry
+	CLoadTelemetry& GetLoadTelemetry();
+
+	//Reloads textures and models whose source under _kpcDirectory changes on disk, swapped in place so references stay valid
+	bool EnableHotReload(const char* _kpcDirectory, unsigned int _uiDebounceMs = 250);
+	void DisableHotReload(); //Reloads already started still finish
+
+	//Archives are searched newest mount first and stay mapped until shutdown, mount before loading anything from them
+	bool MountPak(const char* _kpcFilename);
+
+	//Loose files win over pak entries while on, on by default in debug builds so edited files are picked up
+	void SetLooseOverride(bool _bLooseOverride);
+
+	//Loaders open their files through here, any thread. Loose if overriding, then the paks, then loose anything not packed
+	bool OpenFile(const char* _kpcFilename, CMappedFile& _rFile);
+
 	int GetQueueLength();
 	CRenderer* GetRenderer() const;
 
@@ -43,7 +158,43 @@ private:
 	CAssetManager(const CAssetManager& _rhs) = default;
 	~CAssetManager();
 
-	static void WorkerThread();
+	TAssetHandle RegisterAsset(EAssetType _eType, const char* _kpcName, IAsset* _pAsset); //Main thread
+	bool RemoveStoredAsset(IAsset* _pAsset);
+
+	//Every load goes through here, IAsset::Load wrapped in a telemetry record
+	bool RunLoad(IAsset* _pAsset, EAssetType _eType, bool _bQueued);
+
+	//Synchronous load of a registered asset, charges the budget on success
+	bool LoadStoredAsset(IAsset* _pAsset);
+
+	//Budget and LRU bookkeeping, called from IAsset::AddRef/RemoveRef on the first and last reference
+	void OnAssetReferenced(IAsset* _pAsset);
+	void OnAssetUnreferenced(IAsset* _pAsset);
+	void ChargeAsset(IAsset* _pAsset);
+	void DischargeAsset(IAsset* _pAsset); //LRU lock must be held
+	bool IsOverBudget() const;
+	void SampleMemory(TMemoryReport& _rtReport, bool _bPerAsset); //Main thread, also raises the peaks
+
+	void QueueAsset(IAsset* _pAsset, int _iPriority, const CCancelToken& _tCancelToken);
+	void RequeueAsset(IAsset* _pAsset, int _iPriority); //Queue lock must be held
+	void LoadNextQueuedAsset();
+	void FinishQueuedAsset(bool _bLoaded);
+
+	//Completions, settling hands an asset's waiting completions to the dispatch or runs the immediate ones
+	void AddCompletion(IAsset* _pAsset, std::function<void(bool)> _fpDone, bool _bImmediate);
+	void SettleAsset(IAsset* _pAsset); //After the state has left Queued/Loading
+	static bool IsSettled(const IAsset* _pAsset);
+
+	static bool QueueOrder(const IAsset* _pLeft, const IAsset* _pRight);
+
+	//Hot reload, changes are picked up and finished reloads swapped from Process
+	void ProcessHotReload();
+	void StartReload(IAsset* _pAsset, EAssetType _eType);
+	void RunReload(TReload* _ptReload);
+	void FreeReload(TReload* _ptReload);
+
+	friend IAsset;
+	friend CTextureStreamer;
 
 	//Member Variables
 protected:
@@ -51,18 +202,66 @@ protected:
 	CRenderer* m_pRenderer;
 	bool m_bAsyncLoad;
 
-	std::vector<IAsset*> m_vecStoredAssets[EAssetType_MAX];
-
-	std::vector<std::thread> m_vecWorkerThreads;
-	std::queue<IAsset*> m_queueAssets;
-	std::atomic_bool m_bRunWorkers;
-	std::mutex m_queueMutex;
+	CAssetRegistry m_registry; //Every stored asset by type and path
+
+	//Async loading, one job per queued asset. Each job loads whatever is at the front of the queue when it runs
+	CJobSystem m_jobSystem;
+	std::atomic<int> m_iQueuedAssets; //Queued or loading
+	std::mutex m_mutexQueue;
+	std::condition_variable m_cvAssetDone; //Signalled when an asset leaves the Queued/Loading states
+	std::set<IAsset*, bool(*)(const IAsset*, const IAsset*)> m_setQueuedAssets;
+	unsigned int m_uiQueueCounter;
+
+	//Batch stats, a batch starts when the queue is empty and ends when it drains again
+	std::mutex m_mutexBatchStats;
+	std::chrono::steady_clock::time_point m_tBatchStart;
+	double m_dFirstAssetMs;
+	unsigned int m_uiBatchLoaded;
+
+	//Eviction, front of the list is the asset that has gone unreferenced the longest
+	//Recursive as releasing a model drops its texture references from inside an eviction
+	std::recursive_mutex m_mutexLRU;
+	std::list<IAsset*> m_listLRU;
+	std::atomic<size_t> m_uiCPUBytes;
+	std::atomic<size_t> m_uiGPUBytes;
+	size_t m_uiCPUBudget;
+	size_t m_uiGPUBudget;
+	std::atomic_bool m_bShuttingDown;
+
+	//Memory report peaks, per type and heap
+	TAssetMemory m_ptMemoryPeak[EAssetType_MAX];
+	TAssetMemory m_tMemoryPeakTotal;
+
+	CTextureStreamer m_textureStreamer;
+	CLoadTelemetry m_loadTelemetry;
+
+	//Hot reload, every registered file is watched while enabled
+	bool m_bHotReload;
+	CFileWatcher m_fileWatcher;
+	std::mutex m_mutexReloads;
+	std::list<TReload*> m_listReloads;
+
+	//Completions waiting on their asset, in the order they were added, and those ready for the next dispatch
+	std::mutex m_mutexCompletions;
+	std::multimap<IAsset*, TCompletion> m_mapWaitingCompletions;
+	std::vector<TCompletion> m_vecReadyCompletions;
+
+	//Mounted archives, read by the loaders
+	mutable std::shared_timed_mutex m_mutexPaks;
+	std::vector<CPakFile*> m_vecpPaks;
+	std::atomic_bool m_bLooseOverride;
 
 };
 
 //Template Implementation
 template<typename TAssetType>
-TAssetType* CAssetManager::LoadAsset(const char* _kpcFilename)
+CAssetRef<TAssetType> CAssetManager::LoadAsset(const char* _kpcFilename)
+{
+	return(LoadAsset<TAssetType>(_kpcFilename, ASSET_PRIORITY_NORMAL));
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType> CAssetManager::LoadAsset(const char* _kpcFilename, int _iPriority, CCancelToken _tCancelToken)
 {
 	TAssetType* pAsset = nullptr;
 	EAssetType eType = TAssetType::GetAssetType(); //Assumes type has a static function for returning, fails if not correct
@@ -81,11 +280,12 @@ TAssetType* CAssetManager::LoadAsset(const char* _kpcFilename)
 		if (!m_bAsyncLoad)
 		{
 			//Attempt to load in the asset
-			if (pAsset->Load(_kpcFilename))
+			if (RunLoad(pAsset, eType, false))
 			{
 				//Asset loaded
-				m_vecStoredAssets[eType].push_back(pAsset);
+				pAsset->m_tHandle = RegisterAsset(eType, _kpcFilename, pAsset);
 				pAsset->tm_eAssetState = EAssetState::Loaded;
+				ChargeAsset(pAsset);
 			}
 			else
 			{
@@ -100,80 +300,69 @@ TAssetType* CAssetManager::LoadAsset(const char* _kpcFilename)
 		else
 		{
 			//Load Async
-			//Lock the queue for adding an asset to it
-			m_queueMutex.lock();
-
-			pAsset->tm_eAssetState = EAssetState::Queued; //Mark asset as queued up
-			pAsset->m_strAssetName = _kpcFilename; //File to load async
-			m_queueAssets.push(pAsset); //Store to the queue for the workers
-			m_vecStoredAssets[eType].push_back(pAsset); //Store to the main asset list
-
-			m_queueMutex.unlock();
+			pAsset->m_tHandle = RegisterAsset(eType, _kpcFilename, pAsset); //Store to the main asset list
+			QueueAsset(pAsset, _iPriority, _tCancelToken); //Hand to the job system
 		}
 	}
+	else if (pAsset->GetAssetState() == EAssetState::Unloaded)
+	{
+		//Previously cancelled or evicted, queue it again under the new token
+		if (m_bAsyncLoad) QueueAsset(pAsset, _iPriority, _tCancelToken);
+		else LoadStoredAsset(pAsset);
+	}
+	else if (m_bAsyncLoad && pAsset->GetAssetState() == EAssetState::Queued)
+	{
+		//Requested again while waiting, a cancelled request is revived under the new token
+		m_mutexQueue.lock();
+		if (pAsset->GetAssetState() == EAssetState::Queued && pAsset->m_tCancelToken.IsCancelled()) pAsset->m_tCancelToken = _tCancelToken;
+		m_mutexQueue.unlock();
+
+		//Only ever raise the priority
+		SetAssetPriority(pAsset, _iPriority, true);
+	}
 
-	return(pAsset);
+	//Queued before the reference is taken so referencing doesn't requeue it at the default priority
+	return(CAssetRef<TAssetType>(pAsset));
 }
 
 template<typename TAssetType>
 bool CAssetManager::UnloadAsset(const char* _kpcName)
 {
-	bool bSuccess = false;
-	EAssetType eType = TAssetType::GetAssetType(); //Assumes type has a static function for returning, fails if not correct
-
-	//Search for the ID
-	for (unsigned int i = 0; i < m_vecStoredAssets[eType].size(); ++i)
-	{
-		TAssetType* pAsset = (TAssetType*)m_vecStoredAssets[eType][i];
-
-		if (pAsset && !strcmp(pAsset->GetName(), _kpcName))
-		{
-			//Matched names, that must be us
-			pAsset->Release();
-			delete pAsset;
-			pAsset = nullptr;
-
-			//TODO: Consider changing to std::list to speed up unloading specific assets should this become a perf issue
-			m_vecStoredAssets[eType].erase(m_vecStoredAssets[eType].begin() + i);
-			bSuccess = true;
-			break;
-		}
-	}
-
-	return(bSuccess);
+	IAsset* pAsset = FindAsset<TAssetType>(_kpcName);
+	return(pAsset && RemoveStoredAsset(pAsset));
 }
 
 template<typename TAssetType>
 bool CAssetManager::UnloadAsset(TAssetType* _pAsset)
 {
-	bool bSuccess = false;
-
-	//Fail on nullptr before calling Unload()
-	bSuccess = _pAsset && UnloadAsset<TAssetType>(_pAsset);
-
-	return(bSuccess);
+	//Fail on nullptr or an asset we don't own, the handle resolves straight to the slot
+	bool bOwned = _pAsset && m_registry.Get(_pAsset->m_tHandle) == _pAsset;
+	return(bOwned && RemoveStoredAsset(_pAsset));
 }
 
 template<typename TAssetType>
 TAssetType* CAssetManager::FindAsset(const char* _kpcName)
 {
-	TAssetType* pAsset = nullptr;
 	EAssetType eType = TAssetType::GetAssetType(); //Assumes type has a static function for returning, fails if not correct
 
-	//Search for already existing
-	for (unsigned int i = 0; i < m_vecStoredAssets[eType].size(); ++i)
-	{
-		TAssetType* pTargetAsset = (TAssetType*)m_vecStoredAssets[eType][i];
+	//Registry is keyed by type so the cast is safe
+	return(static_cast<TAssetType*>(m_registry.Find(eType, _kpcName)));
+}
 
-		if (pTargetAsset && !strcmp(pTargetAsset->GetName(), _kpcName))
-		{
-			//Matched names, assume asset exists
-			pAsset = pTargetAsset;
-			break;
-		}
-	}
+//Declared in assetref.hpp, defined here as they go through the manager
+template<typename TAssetType>
+const CAssetRef<TAssetType>& CAssetRef<TAssetType>::Then(std::function<void(TAssetType*, bool)> _fpContinuation) const
+{
+	TAssetType* pAsset = m_pAsset;
+	CAssetManager::GetInstance().Then(pAsset, [pAsset, _fpContinuation](bool _bLoaded) { _fpContinuation(pAsset, _bLoaded); });
 
-	return(pAsset);
+	return(*this);
+}
+
+template<typename TAssetType>
+std::shared_future<bool> CAssetRef<TAssetType>::GetFuture() const
+{
+	return(CAssetManager::GetInstance().GetFuture(m_pAsset));
 }
 
 #endif //__ASSET_MANAGER_H__
@@ -0,0 +1,142 @@
+#pragma once
+#ifndef __ASSET_REF_H__
+#define __ASSET_REF_H__
+
+//Library Includes
+#include <functional>
+#include <future>
+
+//Local Includes
+#include "asset.h"
+
+//Prototypes
+//Counted reference to an asset, the asset can't be evicted while any reference to it is alive
+//Referencing an evicted asset reloads it, so check AssetLoaded() before use as with a raw pointer
+template<typename TAssetType>
+class CAssetRef
+{
+	//Member Functions
+public:
+	CAssetRef();
+	CAssetRef(TAssetType* _pAsset);
+	CAssetRef(const CAssetRef& _rhs);
+	CAssetRef(CAssetRef&& _rhs);
+	~CAssetRef();
+
+	CAssetRef& operator=(const CAssetRef& _rhs);
+	CAssetRef& operator=(CAssetRef&& _rhs);
+	CAssetRef& operator=(TAssetType* _pAsset);
+
+	//Drops the reference, the asset stays in the manager
+	void Reset();
+
+	TAssetType* Get() const;
+	TAssetType* operator->() const;
+	operator TAssetType*() const;
+
+	//Completion, see CAssetManager::Then and GetFuture. Defined in assetmanager.hpp
+	//Then returns this reference so continuations can be chained, they run in the order they were added
+	const CAssetRef& Then(std::function<void(TAssetType* _pAsset, bool _bLoaded)> _fpContinuation) const;
+	std::shared_future<bool> GetFuture() const;
+
+	//Member Variables
+private:
+	TAssetType* m_pAsset;
+
+};
+
+//Template Implementation
+template<typename TAssetType>
+CAssetRef<TAssetType>::CAssetRef()
+	: m_pAsset(nullptr)
+{
+	//Constructor
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>::CAssetRef(TAssetType* _pAsset)
+	: m_pAsset(_pAsset)
+{
+	//Constructor
+	if(m_pAsset) m_pAsset->AddRef();
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>::CAssetRef(const CAssetRef& _rhs)
+	: m_pAsset(_rhs.m_pAsset)
+{
+	//Copy Constructor
+	if(m_pAsset) m_pAsset->AddRef();
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>::CAssetRef(CAssetRef&& _rhs)
+	: m_pAsset(_rhs.m_pAsset)
+{
+	//Move Constructor, the reference changes hands without touching the count
+	_rhs.m_pAsset = nullptr;
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>::~CAssetRef()
+{
+	//Destructor
+	Reset();
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>& CAssetRef<TAssetType>::operator=(const CAssetRef& _rhs)
+{
+	return(*this = _rhs.m_pAsset);
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>& CAssetRef<TAssetType>::operator=(CAssetRef&& _rhs)
+{
+	if(this != &_rhs)
+	{
+		Reset();
+		m_pAsset = _rhs.m_pAsset;
+		_rhs.m_pAsset = nullptr;
+	}
+
+	return(*this);
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>& CAssetRef<TAssetType>::operator=(TAssetType* _pAsset)
+{
+	//Add before remove so reassigning the same asset never drops it to zero
+	if(_pAsset) _pAsset->AddRef();
+	Reset();
+	m_pAsset = _pAsset;
+
+	return(*this);
+}
+
+template<typename TAssetType>
+void CAssetRef<TAssetType>::Reset()
+{
+	if(m_pAsset) m_pAsset->RemoveRef();
+	m_pAsset = nullptr;
+}
+
+template<typename TAssetType>
+TAssetType* CAssetRef<TAssetType>::Get() const
+{
+	return(m_pAsset);
+}
+
+template<typename TAssetType>
+TAssetType* CAssetRef<TAssetType>::operator->() const
+{
+	return(m_pAsset);
+}
+
+template<typename TAssetType>
+CAssetRef<TAssetType>::operator TAssetType*() const
+{
+	return(m_pAsset);
+}
+
+#endif //__ASSET_REF_H__
@@ -0,0 +1,277 @@
+//Library Includes
+#include <mutex>
+
+//Local Includes
+#include "common.h"
+
+//This Include
+#include "assetregistry.h"
+
+//Helpers
+//Path characters are compared case insensitive with either slash direction, same as the filesystem
+static inline char FoldPathChar(char _c)
+{
+	if(_c >= 'A' && _c <= 'Z') return(_c - 'A' + 'a');
+	if(_c == '/') return('\\');
+	return(_c);
+}
+
+static bool PathEquals(const std::string& _rStored, const char* _kpcName)
+{
+	size_t uiLength = _rStored.size();
+	for(size_t i = 0; i < uiLength; ++i)
+	{
+		if(_kpcName[i] == '\0' || FoldPathChar(_rStored[i]) != FoldPathChar(_kpcName[i])) return(false);
+	}
+
+	return(_kpcName[uiLength] == '\0');
+}
+
+//Implementation
+CAssetRegistry::CAssetRegistry()
+	: m_uiUsedBuckets(0)
+	, m_uiSlotCount(0)
+{
+	//Constructor
+	for(unsigned int i = 0; i < EAssetType_MAX; ++i) m_uiCount[i] = 0;
+}
+
+CAssetRegistry::~CAssetRegistry()
+{
+	//Destructor
+	Clear();
+}
+
+unsigned long long
+CAssetRegistry::HashName(const char* _kpcName, EAssetType _eType)
+{
+	//64bit FNV-1a
+	unsigned long long ullHash = 14695981039346656037ULL;
+	for(const char* pc = _kpcName; *pc; ++pc)
+	{
+		ullHash ^= (unsigned char)FoldPathChar(*pc);
+		ullHash *= 1099511628211ULL;
+	}
+
+	//Fold in the type so a texture and a model can share a path
+	ullHash ^= (unsigned long long)_eType;
+	ullHash *= 1099511628211ULL;
+
+	return(ullHash);
+}
+
+TAssetHandle
+CAssetRegistry::Insert(EAssetType _eType, const char* _kpcName, IAsset* _pAsset)
+{
+	TAssetHandle tHandle;
+	if(!_pAsset || !_kpcName || _eType < 0 || _eType >= EAssetType_MAX) return(tHandle);
+
+	std::unique_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	//Names are unique per type
+	unsigned long long ullKey = HashName(_kpcName, _eType);
+	if(FindBucket(ullKey, _eType, _kpcName) != sm_kuiEmpty) return(tHandle);
+
+	//Keep the load factor under 3/4, counting tombstones as they lengthen probes just the same
+	if((m_uiUsedBuckets + 1) * 4 > (unsigned int)m_vecBuckets.size() * 3) Grow();
+
+	//Reuse a freed slot before allocating a new one
+	unsigned int uiSlot = 0;
+	if(!m_vecFreeSlots.empty())
+	{
+		uiSlot = m_vecFreeSlots.back();
+		m_vecFreeSlots.pop_back();
+	}
+	else
+	{
+		if(m_uiSlotCount % sm_kuiChunkSize == 0) m_vecChunks.push_back(new TSlot[sm_kuiChunkSize]());
+		uiSlot = m_uiSlotCount++;
+	}
+
+	TSlot& rSlot = GetSlot(uiSlot);
+	rSlot.ullKey = ullKey;
+	rSlot.strName = _kpcName;
+	rSlot.pAsset = _pAsset;
+	rSlot.eType = _eType;
+
+	//First empty or tombstoned bucket, the lookup above already proved there is no match further along
+	unsigned int uiMask = (unsigned int)m_vecBuckets.size() - 1;
+	unsigned int uiBucket = (unsigned int)ullKey & uiMask;
+	while(m_vecBuckets[uiBucket].uiSlot != sm_kuiEmpty && m_vecBuckets[uiBucket].uiSlot != sm_kuiTombstone) uiBucket = (uiBucket + 1) & uiMask;
+
+	if(m_vecBuckets[uiBucket].uiSlot == sm_kuiEmpty) ++m_uiUsedBuckets;
+	m_vecBuckets[uiBucket].ullKey = ullKey;
+	m_vecBuckets[uiBucket].uiSlot = uiSlot;
+
+	++m_uiCount[_eType];
+
+	tHandle.uiSlot = uiSlot;
+	tHandle.uiGeneration = rSlot.uiGeneration;
+	return(tHandle);
+}
+
+bool
+CAssetRegistry::Remove(TAssetHandle _tHandle)
+{
+	std::unique_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	//Stale or invalid handle
+	if(_tHandle.uiSlot >= m_uiSlotCount) return(false);
+	TSlot& rSlot = GetSlot(_tHandle.uiSlot);
+	if(!rSlot.pAsset || rSlot.uiGeneration != _tHandle.uiGeneration) return(false);
+
+	//Tombstone the bucket pointing at this slot
+	unsigned int uiMask = (unsigned int)m_vecBuckets.size() - 1;
+	unsigned int uiBucket = (unsigned int)rSlot.ullKey & uiMask;
+	while(m_vecBuckets[uiBucket].uiSlot != _tHandle.uiSlot) uiBucket = (uiBucket + 1) & uiMask;
+	m_vecBuckets[uiBucket].uiSlot = sm_kuiTombstone;
+
+	--m_uiCount[rSlot.eType];
+
+	//Bump the generation so old handles stop resolving
+	rSlot.pAsset = nullptr;
+	rSlot.strName.clear();
+	++rSlot.uiGeneration;
+	m_vecFreeSlots.push_back(_tHandle.uiSlot);
+
+	return(true);
+}
+
+IAsset*
+CAssetRegistry::Find(EAssetType _eType, const char* _kpcName) const
+{
+	if(!_kpcName) return(nullptr);
+
+	std::shared_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	unsigned int uiBucket = FindBucket(HashName(_kpcName, _eType), _eType, _kpcName);
+	return(uiBucket != sm_kuiEmpty ? GetSlot(m_vecBuckets[uiBucket].uiSlot).pAsset : nullptr);
+}
+
+IAsset*
+CAssetRegistry::Get(TAssetHandle _tHandle) const
+{
+	IAsset* pAsset = nullptr;
+
+	std::shared_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	if(_tHandle.uiSlot < m_uiSlotCount)
+	{
+		const TSlot& rSlot = GetSlot(_tHandle.uiSlot);
+		if(rSlot.uiGeneration == _tHandle.uiGeneration) pAsset = rSlot.pAsset;
+	}
+
+	return(pAsset);
+}
+
+EAssetType
+CAssetRegistry::GetType(TAssetHandle _tHandle) const
+{
+	EAssetType eType = EAssetType_ERROR;
+
+	std::shared_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	if(_tHandle.uiSlot < m_uiSlotCount)
+	{
+		const TSlot& rSlot = GetSlot(_tHandle.uiSlot);
+		if(rSlot.uiGeneration == _tHandle.uiGeneration) eType = rSlot.eType;
+	}
+
+	return(eType);
+}
+
+unsigned int
+CAssetRegistry::GetCount(EAssetType _eType) const
+{
+	std::shared_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+	return((_eType >= 0 && _eType < EAssetType_MAX) ? m_uiCount[_eType] : 0);
+}
+
+void
+CAssetRegistry::ForEach(std::function<void(IAsset*)> _fpVisit) const
+{
+	std::shared_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	for(unsigned int i = 0; i < m_uiSlotCount; ++i)
+	{
+		IAsset* pAsset = GetSlot(i).pAsset;
+		if(pAsset) _fpVisit(pAsset);
+	}
+}
+
+void
+CAssetRegistry::Clear()
+{
+	std::unique_lock<std::shared_timed_mutex> lockRegistry(m_mutexRegistry);
+
+	for(unsigned int i = 0; i < m_vecChunks.size(); ++i) SafeDeleteArray(m_vecChunks[i]);
+	m_vecChunks.clear();
+	m_vecFreeSlots.clear();
+	m_vecBuckets.clear();
+	m_uiUsedBuckets = 0;
+	m_uiSlotCount = 0;
+
+	for(unsigned int i = 0; i < EAssetType_MAX; ++i) m_uiCount[i] = 0;
+}
+
+CAssetRegistry::TSlot&
+CAssetRegistry::GetSlot(unsigned int _uiSlot) const
+{
+	return(m_vecChunks[_uiSlot / sm_kuiChunkSize][_uiSlot % sm_kuiChunkSize]);
+}
+
+unsigned int
+CAssetRegistry::FindBucket(unsigned long long _ullKey, EAssetType _eType, const char* _kpcName) const
+{
+	if(m_vecBuckets.empty()) return(sm_kuiEmpty);
+
+	unsigned int uiMask = (unsigned int)m_vecBuckets.size() - 1;
+	unsigned int uiBucket = (unsigned int)_ullKey & uiMask;
+
+	//Probe until an empty bucket, the full key is compared first so names are only checked on a real hit
+	while(m_vecBuckets[uiBucket].uiSlot != sm_kuiEmpty)
+	{
+		const TBucket& rBucket = m_vecBuckets[uiBucket];
+		if(rBucket.uiSlot != sm_kuiTombstone && rBucket.ullKey == _ullKey)
+		{
+			const TSlot& rSlot = GetSlot(rBucket.uiSlot);
+			if(rSlot.eType == _eType && PathEquals(rSlot.strName, _kpcName)) return(uiBucket);
+		}
+
+		uiBucket = (uiBucket + 1) & uiMask;
+	}
+
+	return(sm_kuiEmpty);
+}
+
+void
+CAssetRegistry::Grow()
+{
+	//Count live entries, if tombstones make up most of the table rebuild at the same size
+	unsigned int uiLive = 0;
+	for(unsigned int i = 0; i < EAssetType_MAX; ++i) uiLive += m_uiCount[i];
+
+	unsigned int uiSize = m_vecBuckets.empty() ? 64 : (unsigned int)m_vecBuckets.size();
+	while((uiLive + 1) * 2 > uiSize) uiSize *= 2;
+
+	std::vector<TBucket> vecOld;
+	vecOld.swap(m_vecBuckets);
+
+	TBucket tEmpty;
+	tEmpty.ullKey = 0;
+	tEmpty.uiSlot = sm_kuiEmpty;
+	m_vecBuckets.assign(uiSize, tEmpty);
+	m_uiUsedBuckets = 0;
+
+	//Reinsert the live buckets, slots don't move so handles stay valid
+	unsigned int uiMask = uiSize - 1;
+	for(const TBucket& rBucket : vecOld)
+	{
+		if(rBucket.uiSlot == sm_kuiEmpty || rBucket.uiSlot == sm_kuiTombstone) continue;
+
+		unsigned int uiBucket = (unsigned int)rBucket.ullKey & uiMask;
+		while(m_vecBuckets[uiBucket].uiSlot != sm_kuiEmpty) uiBucket = (uiBucket + 1) & uiMask;
+		m_vecBuckets[uiBucket] = rBucket;
+		++m_uiUsedBuckets;
+	}
+}
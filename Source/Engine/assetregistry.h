@@ -0,0 +1,82 @@
+#pragma once
+#ifndef __ASSET_REGISTRY_H__
+#define __ASSET_REGISTRY_H__
+
+//Library Includes
+#include <vector>
+#include <string>
+#include <shared_mutex>
+#include <functional>
+
+//Local Includes
+#include "asset.h"
+
+//Prototypes
+class CAssetRegistry
+{
+	//Types
+private:
+	struct TSlot
+	{
+		unsigned long long ullKey;
+		std::string strName; //Interned copy, the asset's own name may change
+		IAsset* pAsset;
+		EAssetType eType;
+		unsigned int uiGeneration;
+	};
+
+	struct TBucket
+	{
+		unsigned long long ullKey;
+		unsigned int uiSlot;
+	};
+
+	//Member Functions
+public:
+	CAssetRegistry();
+	~CAssetRegistry();
+
+	//FNV-1a over the path, case and slash direction folded so "A/b.png" and "a\B.png" match
+	static unsigned long long HashName(const char* _kpcName, EAssetType _eType);
+
+	//Main thread only. Fails if the name is already registered for this type
+	TAssetHandle Insert(EAssetType _eType, const char* _kpcName, IAsset* _pAsset);
+	bool Remove(TAssetHandle _tHandle);
+
+	//Safe from any thread
+	IAsset* Find(EAssetType _eType, const char* _kpcName) const;
+	IAsset* Get(TAssetHandle _tHandle) const;
+	EAssetType GetType(TAssetHandle _tHandle) const; //EAssetType_ERROR for a stale handle
+	unsigned int GetCount(EAssetType _eType) const;
+
+	//Visits every registered asset under a shared lock, _fpVisit must not insert or remove
+	void ForEach(std::function<void(IAsset*)> _fpVisit) const;
+	void Clear();
+
+private:
+	CAssetRegistry(const CAssetRegistry& _rhs) = delete;
+
+	TSlot& GetSlot(unsigned int _uiSlot) const;
+	unsigned int FindBucket(unsigned long long _ullKey, EAssetType _eType, const char* _kpcName) const;
+	void Grow();
+
+	//Member Variables
+private:
+	static const unsigned int sm_kuiChunkSize = 1024; //Slots never move once allocated, handles index straight into them
+	static const unsigned int sm_kuiEmpty = 0xFFFFFFFF;
+	static const unsigned int sm_kuiTombstone = 0xFFFFFFFE;
+
+	mutable std::shared_timed_mutex m_mutexRegistry;
+
+	std::vector<TBucket> m_vecBuckets; //Power of two, linear probing
+	unsigned int m_uiUsedBuckets; //Live and tombstoned, drives the resize
+
+	std::vector<TSlot*> m_vecChunks;
+	std::vector<unsigned int> m_vecFreeSlots;
+	unsigned int m_uiSlotCount;
+
+	unsigned int m_uiCount[EAssetType_MAX];
+
+};
+
+#endif //__ASSET_REGISTRY_H__
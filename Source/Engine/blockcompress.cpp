@@ -0,0 +1,468 @@
+//Library Includes
+#include <math.h>
+#include <string.h>
+#include <float.h>
+#include <limits.h>
+
+//This Include
+#include "blockcompress.h"
+
+//Types
+typedef uint8_t TBlockPixels[16][4]; //4x4 RGBA, row major
+
+//Helpers
+static inline int ClampInt(int _i, int _iMin, int _iMax)
+{
+	return(_i < _iMin ? _iMin : (_i > _iMax ? _iMax : _i));
+}
+
+//Copy a 4x4 block out of the image, clamping at the right and bottom edges
+static void LoadBlock(const uint8_t* _pRGBA, unsigned int _uiWidth, unsigned int _uiHeight, unsigned int _uiRowPitch, unsigned int _uiBlockX, unsigned int _uiBlockY, TBlockPixels& _rPixels)
+{
+	for(unsigned int y = 0; y < 4; ++y)
+	{
+		unsigned int uiY = min(_uiBlockY * 4 + y, _uiHeight - 1);
+		const uint8_t* pRow = _pRGBA + uiY * _uiRowPitch;
+
+		for(unsigned int x = 0; x < 4; ++x)
+		{
+			unsigned int uiX = min(_uiBlockX * 4 + x, _uiWidth - 1);
+			memcpy(_rPixels[y * 4 + x], pRow + uiX * 4, 4);
+		}
+	}
+}
+
+//Dominant direction of the block in the first _iChannels channels, a few rounds of power iteration on the covariance
+static void PrincipalAxis(const TBlockPixels& _rPixels, int _iChannels, float* _pfMean, float* _pfAxis)
+{
+	for(int c = 0; c < _iChannels; ++c)
+	{
+		_pfMean[c] = 0.0f;
+		for(int i = 0; i < 16; ++i) _pfMean[c] += _rPixels[i][c];
+		_pfMean[c] /= 16.0f;
+	}
+
+	float fCovariance[4][4] = {};
+	for(int i = 0; i < 16; ++i)
+	{
+		for(int a = 0; a < _iChannels; ++a)
+		{
+			for(int b = a; b < _iChannels; ++b) fCovariance[a][b] += (_rPixels[i][a] - _pfMean[a]) * (_rPixels[i][b] - _pfMean[b]);
+		}
+	}
+	for(int a = 0; a < _iChannels; ++a) for(int b = 0; b < a; ++b) fCovariance[a][b] = fCovariance[b][a];
+
+	//Start on the luminance-ish diagonal, flat blocks keep it
+	for(int c = 0; c < _iChannels; ++c) _pfAxis[c] = 1.0f;
+	for(int iIteration = 0; iIteration < 8; ++iIteration)
+	{
+		float fNext[4] = {};
+		float fLength = 0.0f;
+		for(int a = 0; a < _iChannels; ++a)
+		{
+			for(int b = 0; b < _iChannels; ++b) fNext[a] += fCovariance[a][b] * _pfAxis[b];
+			fLength = max(fLength, fabsf(fNext[a]));
+		}
+
+		if(fLength < 1e-6f) break;
+		for(int c = 0; c < _iChannels; ++c) _pfAxis[c] = fNext[c] / fLength;
+	}
+}
+
+//Furthest pixels either side of the mean along the axis
+static void AxisExtents(const TBlockPixels& _rPixels, int _iChannels, const float* _pfMean, const float* _pfAxis, float* _pfLow, float* _pfHigh)
+{
+	float fMin = FLT_MAX;
+	float fMax = -FLT_MAX;
+	for(int i = 0; i < 16; ++i)
+	{
+		float fProjection = 0.0f;
+		for(int c = 0; c < _iChannels; ++c) fProjection += (_rPixels[i][c] - _pfMean[c]) * _pfAxis[c];
+		fMin = min(fMin, fProjection);
+		fMax = max(fMax, fProjection);
+	}
+
+	//Normalise so the extents are in channel units
+	float fLengthSq = 0.0f;
+	for(int c = 0; c < _iChannels; ++c) fLengthSq += _pfAxis[c] * _pfAxis[c];
+	if(fLengthSq > 0.0f)
+	{
+		fMin /= fLengthSq;
+		fMax /= fLengthSq;
+	}
+
+	for(int c = 0; c < _iChannels; ++c)
+	{
+		_pfLow[c] = _pfMean[c] + _pfAxis[c] * fMin;
+		_pfHigh[c] = _pfMean[c] + _pfAxis[c] * fMax;
+	}
+}
+
+//BC1 colour block
+static inline uint16_t Pack565(const float* _pfColour)
+{
+	int r = ClampInt((int)(_pfColour[0] * 31.0f / 255.0f + 0.5f), 0, 31);
+	int g = ClampInt((int)(_pfColour[1] * 63.0f / 255.0f + 0.5f), 0, 63);
+	int b = ClampInt((int)(_pfColour[2] * 31.0f / 255.0f + 0.5f), 0, 31);
+	return((uint16_t)((r << 11) | (g << 5) | b));
+}
+
+static inline void Unpack565(uint16_t _usColour, int* _piColour)
+{
+	int r = (_usColour >> 11) & 31;
+	int g = (_usColour >> 5) & 63;
+	int b = _usColour & 31;
+	_piColour[0] = (r << 3) | (r >> 2);
+	_piColour[1] = (g << 2) | (g >> 4);
+	_piColour[2] = (b << 3) | (b >> 2);
+}
+
+//Indexes the block against the 4 colour palette, returns the squared error
+static int IndexColourBlock(const TBlockPixels& _rPixels, uint16_t _usColour0, uint16_t _usColour1, uint32_t& _ruiIndices)
+{
+	int iPalette[4][3];
+	Unpack565(_usColour0, iPalette[0]);
+	Unpack565(_usColour1, iPalette[1]);
+	for(int c = 0; c < 3; ++c)
+	{
+		iPalette[2][c] = (2 * iPalette[0][c] + iPalette[1][c]) / 3;
+		iPalette[3][c] = (iPalette[0][c] + 2 * iPalette[1][c]) / 3;
+	}
+
+	int iError = 0;
+	_ruiIndices = 0;
+	for(int i = 0; i < 16; ++i)
+	{
+		int iBest = 0;
+		int iBestError = INT_MAX;
+		for(int p = 0; p < 4; ++p)
+		{
+			int dr = _rPixels[i][0] - iPalette[p][0];
+			int dg = _rPixels[i][1] - iPalette[p][1];
+			int db = _rPixels[i][2] - iPalette[p][2];
+			int iDistance = dr * dr + dg * dg + db * db;
+			if(iDistance < iBestError)
+			{
+				iBestError = iDistance;
+				iBest = p;
+			}
+		}
+
+		_ruiIndices |= (uint32_t)iBest << (i * 2);
+		iError += iBestError;
+	}
+
+	return(iError);
+}
+
+//Least squares fit of the endpoints to the chosen indices, often pulls them closer than the extents
+static bool RefitColourEndpoints(const TBlockPixels& _rPixels, uint32_t _uiIndices, float* _pfColour0, float* _pfColour1)
+{
+	static const float s_kfWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+	float fAA = 0.0f, fBB = 0.0f, fAB = 0.0f;
+	float fAX[3] = {}, fBX[3] = {};
+	for(int i = 0; i < 16; ++i)
+	{
+		float a = s_kfWeights[(_uiIndices >> (i * 2)) & 3];
+		float b = 1.0f - a;
+		fAA += a * a;
+		fBB += b * b;
+		fAB += a * b;
+		for(int c = 0; c < 3; ++c)
+		{
+			fAX[c] += a * _rPixels[i][c];
+			fBX[c] += b * _rPixels[i][c];
+		}
+	}
+
+	float fDeterminant = fAA * fBB - fAB * fAB;
+	if(fabsf(fDeterminant) < 1e-6f) return(false);
+
+	for(int c = 0; c < 3; ++c)
+	{
+		_pfColour0[c] = (fAX[c] * fBB - fBX[c] * fAB) / fDeterminant;
+		_pfColour1[c] = (fBX[c] * fAA - fAX[c] * fAB) / fDeterminant;
+	}
+
+	return(true);
+}
+
+static void EncodeColourBlock(const TBlockPixels& _rPixels, uint8_t* _pBlock)
+{
+	float fMean[4], fAxis[4], fLow[4], fHigh[4];
+	PrincipalAxis(_rPixels, 3, fMean, fAxis);
+	AxisExtents(_rPixels, 3, fMean, fAxis, fLow, fHigh);
+
+	uint16_t usColour0 = Pack565(fHigh);
+	uint16_t usColour1 = Pack565(fLow);
+	uint32_t uiIndices = 0;
+	int iError = 0;
+
+	//Colour0 > Colour1 selects the 4 colour mode, equal endpoints are a solid block
+	if(usColour0 < usColour1)
+	{
+		uint16_t usTemp = usColour0;
+		usColour0 = usColour1;
+		usColour1 = usTemp;
+	}
+
+	if(usColour0 != usColour1)
+	{
+		iError = IndexColourBlock(_rPixels, usColour0, usColour1, uiIndices);
+
+		//One refinement pass, kept only if it helps
+		float fRefit0[3], fRefit1[3];
+		if(iError > 0 && RefitColourEndpoints(_rPixels, uiIndices, fRefit0, fRefit1))
+		{
+			uint16_t usRefit0 = Pack565(fRefit0);
+			uint16_t usRefit1 = Pack565(fRefit1);
+			if(usRefit0 < usRefit1)
+			{
+				uint16_t usTemp = usRefit0;
+				usRefit0 = usRefit1;
+				usRefit1 = usTemp;
+			}
+
+			uint32_t uiRefitIndices = 0;
+			if(usRefit0 != usRefit1 && IndexColourBlock(_rPixels, usRefit0, usRefit1, uiRefitIndices) < iError)
+			{
+				usColour0 = usRefit0;
+				usColour1 = usRefit1;
+				uiIndices = uiRefitIndices;
+			}
+		}
+	}
+
+	memcpy(_pBlock + 0, &usColour0, 2);
+	memcpy(_pBlock + 2, &usColour1, 2);
+	memcpy(_pBlock + 4, &uiIndices, 4);
+}
+
+//BC4 single channel block, used for BC3 alpha and both BC5 channels
+static void EncodeChannelBlock(const TBlockPixels& _rPixels, int _iChannel, uint8_t* _pBlock)
+{
+	int iMin = 255;
+	int iMax = 0;
+	for(int i = 0; i < 16; ++i)
+	{
+		iMin = min(iMin, (int)_rPixels[i][_iChannel]);
+		iMax = max(iMax, (int)_rPixels[i][_iChannel]);
+	}
+
+	//Endpoint0 > Endpoint1 selects 8 interpolated values
+	_pBlock[0] = (uint8_t)iMax;
+	_pBlock[1] = (uint8_t)iMin;
+
+	int iPalette[8] = { iMax, iMin };
+	for(int p = 1; p < 7; ++p) iPalette[p + 1] = ((7 - p) * iMax + p * iMin) / 7;
+
+	uint64_t ullIndices = 0;
+	if(iMax != iMin)
+	{
+		for(int i = 0; i < 16; ++i)
+		{
+			int iBest = 0;
+			int iBestError = INT_MAX;
+			for(int p = 0; p < 8; ++p)
+			{
+				int iDistance = abs(_rPixels[i][_iChannel] - iPalette[p]);
+				if(iDistance < iBestError)
+				{
+					iBestError = iDistance;
+					iBest = p;
+				}
+			}
+
+			ullIndices |= (uint64_t)iBest << (i * 3);
+		}
+	}
+
+	for(int b = 0; b < 6; ++b) _pBlock[2 + b] = (uint8_t)(ullIndices >> (b * 8));
+}
+
+//BC7 mode 6, one RGBA endpoint pair with 7 bits per channel plus a p-bit each, 4 bit indices
+static const int s_kiBC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+static void QuantizeBC7Endpoint(const float* _pfEndpoint, int* _piQuantized, int& _riPBit)
+{
+	//Pick the p-bit that lands closest over all four channels
+	float fBestError = FLT_MAX;
+	for(int p = 0; p < 2; ++p)
+	{
+		int iCandidate[4];
+		float fError = 0.0f;
+		for(int c = 0; c < 4; ++c)
+		{
+			iCandidate[c] = ClampInt((int)((_pfEndpoint[c] - p) / 2.0f + 0.5f), 0, 127);
+			float fDelta = (float)((iCandidate[c] << 1) | p) - _pfEndpoint[c];
+			fError += fDelta * fDelta;
+		}
+
+		if(fError < fBestError)
+		{
+			fBestError = fError;
+			_riPBit = p;
+			memcpy(_piQuantized, iCandidate, sizeof(iCandidate));
+		}
+	}
+}
+
+static void EncodeBC7Block(const TBlockPixels& _rPixels, uint8_t* _pBlock)
+{
+	float fMean[4], fAxis[4], fLow[4], fHigh[4];
+	PrincipalAxis(_rPixels, 4, fMean, fAxis);
+	AxisExtents(_rPixels, 4, fMean, fAxis, fLow, fHigh);
+
+	int iEndpoint[2][4];
+	int iPBit[2];
+	QuantizeBC7Endpoint(fLow, iEndpoint[0], iPBit[0]);
+	QuantizeBC7Endpoint(fHigh, iEndpoint[1], iPBit[1]);
+
+	//Palette from the reconstructed 8 bit endpoints
+	int iPalette[16][4];
+	for(int c = 0; c < 4; ++c)
+	{
+		int e0 = (iEndpoint[0][c] << 1) | iPBit[0];
+		int e1 = (iEndpoint[1][c] << 1) | iPBit[1];
+		for(int w = 0; w < 16; ++w) iPalette[w][c] = ((64 - s_kiBC7Weights4[w]) * e0 + s_kiBC7Weights4[w] * e1 + 32) >> 6;
+	}
+
+	int iIndices[16];
+	for(int i = 0; i < 16; ++i)
+	{
+		int iBestError = INT_MAX;
+		for(int w = 0; w < 16; ++w)
+		{
+			int iDistance = 0;
+			for(int c = 0; c < 4; ++c)
+			{
+				int d = _rPixels[i][c] - iPalette[w][c];
+				iDistance += d * d;
+			}
+
+			if(iDistance < iBestError)
+			{
+				iBestError = iDistance;
+				iIndices[i] = w;
+			}
+		}
+	}
+
+	//The anchor index is stored with its top bit implied zero, swap the endpoints if it isn't
+	if(iIndices[0] & 8)
+	{
+		for(int c = 0; c < 4; ++c)
+		{
+			int iTemp = iEndpoint[0][c];
+			iEndpoint[0][c] = iEndpoint[1][c];
+			iEndpoint[1][c] = iTemp;
+		}
+
+		int iTemp = iPBit[0];
+		iPBit[0] = iPBit[1];
+		iPBit[1] = iTemp;
+
+		for(int i = 0; i < 16; ++i) iIndices[i] = 15 - iIndices[i];
+	}
+
+	//Pack LSB first: mode, R0 R1 G0 G1 B0 B1 A0 A1, P0 P1, indices
+	uint64_t ullBits[2] = { 0, 0 };
+	unsigned int uiBit = 0;
+	auto fnWrite = [&ullBits, &uiBit](uint64_t _ullValue, unsigned int _uiCount)
+	{
+		for(unsigned int b = 0; b < _uiCount; ++b, ++uiBit) ullBits[uiBit >> 6] |= ((_ullValue >> b) & 1) << (uiBit & 63);
+	};
+
+	fnWrite(1ULL << 6, 7);
+	for(int c = 0; c < 4; ++c)
+	{
+		fnWrite(iEndpoint[0][c], 7);
+		fnWrite(iEndpoint[1][c], 7);
+	}
+	fnWrite(iPBit[0], 1);
+	fnWrite(iPBit[1], 1);
+	for(int i = 0; i < 16; ++i) fnWrite(iIndices[i], i == 0 ? 3 : 4);
+
+	memcpy(_pBlock, ullBits, 16);
+}
+
+//Implementation
+bool
+IsBlockCompressed(DXGI_FORMAT _eFormat)
+{
+	return(GetBlockBytes(_eFormat) != 0);
+}
+
+unsigned int
+GetBlockBytes(DXGI_FORMAT _eFormat)
+{
+	switch(_eFormat)
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+		return(8);
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		return(16);
+	default:
+		return(0);
+	}
+}
+
+unsigned int
+GetBlockRowPitch(DXGI_FORMAT _eFormat, unsigned int _uiWidth)
+{
+	return(max(1u, (_uiWidth + 3) / 4) * GetBlockBytes(_eFormat));
+}
+
+unsigned int
+GetBlockImageSize(DXGI_FORMAT _eFormat, unsigned int _uiWidth, unsigned int _uiHeight)
+{
+	return(GetBlockRowPitch(_eFormat, _uiWidth) * max(1u, (_uiHeight + 3) / 4));
+}
+
+bool
+BlockCompress(DXGI_FORMAT _eFormat, const uint8_t* _pRGBA, unsigned int _uiWidth, unsigned int _uiHeight, unsigned int _uiRowPitch, uint8_t* _pBlocks)
+{
+	unsigned int uiBlockBytes = GetBlockBytes(_eFormat);
+	if(!uiBlockBytes || !_pRGBA || !_pBlocks || !_uiWidth || !_uiHeight) return(false);
+
+	unsigned int uiBlocksX = (_uiWidth + 3) / 4;
+	unsigned int uiBlocksY = (_uiHeight + 3) / 4;
+
+	TBlockPixels tPixels;
+	for(unsigned int by = 0; by < uiBlocksY; ++by)
+	{
+		for(unsigned int bx = 0; bx < uiBlocksX; ++bx)
+		{
+			LoadBlock(_pRGBA, _uiWidth, _uiHeight, _uiRowPitch, bx, by, tPixels);
+			uint8_t* pBlock = _pBlocks + (by * uiBlocksX + bx) * uiBlockBytes;
+
+			switch(_eFormat)
+			{
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+				EncodeColourBlock(tPixels, pBlock);
+				break;
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+				EncodeChannelBlock(tPixels, 3, pBlock);
+				EncodeColourBlock(tPixels, pBlock + 8);
+				break;
+			case DXGI_FORMAT_BC5_UNORM:
+				EncodeChannelBlock(tPixels, 0, pBlock);
+				EncodeChannelBlock(tPixels, 1, pBlock + 8);
+				break;
+			default:
+				EncodeBC7Block(tPixels, pBlock);
+				break;
+			}
+		}
+	}
+
+	return(true);
+}
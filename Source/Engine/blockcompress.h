@@ -0,0 +1,29 @@
+#pragma once
+#ifndef __BLOCK_COMPRESS_H__
+#define __BLOCK_COMPRESS_H__
+
+//Library Includes
+#include <d3d11.h>
+#include <stdint.h>
+
+//CPU block compression for the texture cooker, RGBA8 in, BC blocks out
+//	BC1 - RGB, 4bpp
+//	BC3 - RGB + interpolated alpha, 8bpp
+//	BC5 - two channel (RG), 8bpp, for normal maps
+//	BC7 - RGBA through mode 6 only, 8bpp. Better colour than BC1/BC3 at the cost of encode time
+//Edge blocks of images that aren't a multiple of 4 are padded by clamping to the last row/column
+
+//Prototypes
+bool IsBlockCompressed(DXGI_FORMAT _eFormat);
+
+//Bytes per 4x4 block, 0 if not a supported BC format
+unsigned int GetBlockBytes(DXGI_FORMAT _eFormat);
+
+//Row pitch and total size of a compressed image
+unsigned int GetBlockRowPitch(DXGI_FORMAT _eFormat, unsigned int _uiWidth);
+unsigned int GetBlockImageSize(DXGI_FORMAT _eFormat, unsigned int _uiWidth, unsigned int _uiHeight);
+
+//_pBlocks must hold GetBlockImageSize() bytes. Returns false for unsupported formats
+bool BlockCompress(DXGI_FORMAT _eFormat, const uint8_t* _pRGBA, unsigned int _uiWidth, unsigned int _uiHeight, unsigned int _uiRowPitch, uint8_t* _pBlocks);
+
+#endif //__BLOCK_COMPRESS_H__
@@ -75,7 +75,7 @@ CCamera::Process(float _fDeltaTick)
 	if(m_bUpdateViewport && bActiveCamera) //Only update when we are active as it changes the viewport on the renderer
 	{
 		//Set the viewport on the renderer
-		m_pRenderer->GetDeviceContext()->RSSetViewports(1, &m_tViewport);
+		m_pRenderer->SetViewports(1, &m_tViewport);
 		m_bUpdateViewport = false; //Nothing else required
 	}
 
@@ -331,6 +331,18 @@ CCamera::GetBoundingFrustum() const
 	return(m_tViewFrustum);
 }
 
+float
+CCamera::GetPixelsPerUnit(const DirectX::BoundingSphere& _rtWorldSphere) const
+{
+	//Clamped to the near plane so bounds around the eye don't divide by zero
+	float fX = _rtWorldSphere.Center.x - m_vec3Position.x;
+	float fY = _rtWorldSphere.Center.y - m_vec3Position.y;
+	float fZ = _rtWorldSphere.Center.z - m_vec3Position.z;
+	float fDistance = max(sqrtf(fX * fX + fY * fY + fZ * fZ) - _rtWorldSphere.Radius, max(m_vec2NearFar.x, 0.001f));
+
+	return(m_tViewport.Height / (2.0f * fDistance * tanf(m_fFOV * 0.5f)));
+}
+
 void
 CCamera::BuildViewMatrix()
 {
@@ -59,6 +59,9 @@ public:
 	//Bounding view frustum
 	const DirectX::BoundingFrustum& GetBoundingFrustum() const;
 
+	//Screen pixels per world unit at the nearest point of _rtWorldSphere, perspective only
+	float GetPixelsPerUnit(const DirectX::BoundingSphere& _rtWorldSphere) const;
+
 protected:
 	void BuildViewMatrix();
 
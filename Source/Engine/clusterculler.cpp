@@ -0,0 +1,200 @@
+//Local Includes
+#include "common.h"
+#include "camera.h"
+#include "logmanager.h"
+#include "meshbounds.h"
+
+//This Include
+#include "clusterculler.h"
+
+//Static Variables
+static const float s_kfUniformScaleTolerance = 0.01f; //Normal cones are only carried through a scale this close to uniform
+
+//Implementation
+CClusterCuller::CClusterCuller()
+	: m_bBackfaceCulling(true)
+{
+	//Constructor
+}
+
+CClusterCuller::~CClusterCuller()
+{
+	//Destructor
+}
+
+bool
+CClusterCuller::Cull(const IMesh* _pMesh, const float4x4& _rmatWorld, std::vector<TRange<unsigned int>>& _rvecRanges)
+{
+	_rvecRanges.clear();
+	if(!CanCull(_pMesh)) return(false);
+
+	CCamera* pCamera = CCamera::GetActiveCamera();
+
+	const TMeshCluster* ptClusters = _pMesh->GetClusters();
+	unsigned int uiClusterCount = _pMesh->GetClusterCount();
+	TClusterCullStats& rtStats = GetStats(pCamera);
+	++rtStats.uiMeshes;
+	rtStats.uiClusters += uiClusterCount;
+
+	XMMATRIX xmmatWorld = XMLoadFloat4x4(&_rmatWorld);
+	const DirectX::BoundingFrustum& rtFrustum = pCamera->GetBoundingFrustum();
+
+	//Whole mesh first, most meshes are either all in or all out
+	DirectX::BoundingSphere tMeshSphere;
+	_pMesh->GetBoundingSphere().Transform(tMeshSphere, xmmatWorld);
+	DirectX::ContainmentType eMeshContainment = rtFrustum.Contains(tMeshSphere);
+
+	//A sphere only partly in gets the oriented box too, which hugs long thin meshes where the sphere leaves a lot of room
+	if(eMeshContainment == DirectX::INTERSECTS)
+	{
+		DirectX::BoundingOrientedBox tMeshBox;
+		TransformOrientedBox(_pMesh->GetOrientedBox(), xmmatWorld, tMeshBox);
+		eMeshContainment = rtFrustum.Contains(tMeshBox);
+	}
+
+	if(eMeshContainment == DirectX::DISJOINT)
+	{
+		rtStats.uiFrustumCulled += uiClusterCount;
+		rtStats.uiTrianglesCulled += _pMesh->GetLod(0).uiIndexCount / 3;
+		return(true);
+	}
+
+	//Spheres grow by the largest axis scale, cones only survive a uniform scale that keeps the winding
+	float fScaleX = XMVectorGetX(XMVector3Length(xmmatWorld.r[0]));
+	float fScaleY = XMVectorGetX(XMVector3Length(xmmatWorld.r[1]));
+	float fScaleZ = XMVectorGetX(XMVector3Length(xmmatWorld.r[2]));
+	float fScale = max(max(fScaleX, fScaleY), fScaleZ);
+	bool bUniform = fScale > 0.0f && (fScale - min(min(fScaleX, fScaleY), fScaleZ)) <= fScale * s_kfUniformScaleTolerance;
+	bool bCones = m_bBackfaceCulling && bUniform && XMVectorGetX(XMMatrixDeterminant(xmmatWorld)) > 0.0f;
+
+	float3 vec3Eye = pCamera->GetEyePos();
+	XMVECTOR vecEye = XMLoadFloat3(&vec3Eye);
+
+	for(unsigned int i = 0; i < uiClusterCount; ++i)
+	{
+		const TMeshCluster& rtCluster = ptClusters[i];
+
+		XMVECTOR vecCenter = XMVector3TransformCoord(XMLoadFloat3(&rtCluster.vec3Center), xmmatWorld);
+		float fRadius = rtCluster.fRadius * fScale;
+
+		bool bVisible = true;
+		if(eMeshContainment != DirectX::CONTAINS)
+		{
+			DirectX::BoundingSphere tSphere;
+			XMStoreFloat3(&tSphere.Center, vecCenter);
+			tSphere.Radius = fRadius;
+
+			if(!rtFrustum.Intersects(tSphere))
+			{
+				bVisible = false;
+				++rtStats.uiFrustumCulled;
+			}
+		}
+
+		if(bVisible && bCones && rtCluster.fConeCutoff < 1.0f)
+		{
+			XMVECTOR vecAxis = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&rtCluster.vec3ConeAxis), xmmatWorld));
+			XMVECTOR vecToCluster = vecCenter - vecEye;
+
+			float fDot = XMVectorGetX(XMVector3Dot(vecToCluster, vecAxis));
+			float fDistance = XMVectorGetX(XMVector3Length(vecToCluster));
+			if(fDot >= rtCluster.fConeCutoff * fDistance + fRadius)
+			{
+				bVisible = false;
+				++rtStats.uiBackfaceCulled;
+			}
+		}
+
+		if(!bVisible)
+		{
+			rtStats.uiTrianglesCulled += rtCluster.uiIndexCount / 3;
+			continue;
+		}
+
+		//Clusters are stored in index order, neighbours that both survive are drawn as one
+		if(!_rvecRanges.empty() && _rvecRanges.back().a + _rvecRanges.back().b == rtCluster.uiIndexStart)
+		{
+			_rvecRanges.back().b += rtCluster.uiIndexCount;
+		}
+		else
+		{
+			_rvecRanges.push_back({rtCluster.uiIndexStart, rtCluster.uiIndexCount});
+		}
+	}
+
+	rtStats.uiRanges += (unsigned int)_rvecRanges.size();
+
+	return(true);
+}
+
+bool
+CClusterCuller::CanCull(const IMesh* _pMesh) const
+{
+	CCamera* pCamera = CCamera::GetActiveCamera();
+	return(_pMesh && _pMesh->GetClusterCount() && pCamera && !pCamera->IsOrthogonal());
+}
+
+void
+CClusterCuller::SetBackfaceCulling(bool _bEnabled)
+{
+	m_bBackfaceCulling = _bEnabled;
+}
+
+bool
+CClusterCuller::GetBackfaceCulling() const
+{
+	return(m_bBackfaceCulling);
+}
+
+void
+CClusterCuller::EndFrame()
+{
+	m_vecLastFrameStats.swap(m_vecFrameStats);
+	m_vecFrameStats.clear();
+}
+
+const std::vector<TClusterCullStats>&
+CClusterCuller::GetViewStats() const
+{
+	return(m_vecLastFrameStats);
+}
+
+void
+CClusterCuller::WriteReport() const
+{
+	CLogManager& rLog = CLogManager::GetInstance();
+
+	char pcLine[512];
+	if(m_vecLastFrameStats.empty())
+	{
+		rLog.WriteDebug("No views culled clusters last frame\n", "Cluster Culling");
+		return;
+	}
+
+	for(unsigned int i = 0; i < m_vecLastFrameStats.size(); ++i)
+	{
+		const TClusterCullStats& rtStats = m_vecLastFrameStats[i];
+		unsigned int uiCulled = rtStats.uiFrustumCulled + rtStats.uiBackfaceCulled;
+
+		sprintf_s(pcLine, "View %u: %u meshes, %u of %u clusters culled (%.1f%%), %u by frustum, %u back facing. %u triangles culled, %u ranges drawn\n",
+			i, rtStats.uiMeshes, uiCulled, rtStats.uiClusters, rtStats.uiClusters ? 100.0f * uiCulled / rtStats.uiClusters : 0.0f,
+			rtStats.uiFrustumCulled, rtStats.uiBackfaceCulled, rtStats.uiTrianglesCulled, rtStats.uiRanges);
+		rLog.WriteDebug(pcLine, "Cluster Culling");
+	}
+}
+
+TClusterCullStats&
+CClusterCuller::GetStats(const void* _pView)
+{
+	//Only a couple of views a frame, a search is fine
+	for(TClusterCullStats& rtStats : m_vecFrameStats)
+	{
+		if(rtStats.pView == _pView) return(rtStats);
+	}
+
+	TClusterCullStats tStats = {};
+	tStats.pView = _pView;
+	m_vecFrameStats.push_back(tStats);
+
+	return(m_vecFrameStats.back());
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef __CLUSTER_CULLER_H__
+#define __CLUSTER_CULLER_H__
+
+//Library Includes
+#include <vector>
+#include <DirectXCollision.h>
+
+//Local Includes
+#include "dxcommon.h"
+#include "numrange.h"
+#include "imesh.h"
+
+//Per draw CPU culling of a mesh's clusters against the active camera
+//	Clusters outside the view frustum and clusters whose normal cone faces away from the eye are dropped,
+//	the ones left are merged into as few index ranges as their order allows and drawn with IMesh::DrawRanges
+//	Only perspective views are culled, orthographic views such as the shadow pass draw everything as the
+//	shadow pass keeps casters behind the near plane and the sun's frustum isn't the one the clusters are seen from
+//Main thread only, stats are kept per camera and latched by EndFrame
+
+//Types
+struct TClusterCullStats
+{
+	const void* pView; //Camera the stats belong to, only used as a key
+	unsigned int uiMeshes; //Draws that went through the culler
+	unsigned int uiClusters; //Clusters tested
+	unsigned int uiFrustumCulled;
+	unsigned int uiBackfaceCulled;
+	unsigned int uiTrianglesCulled;
+	unsigned int uiRanges; //Index ranges drawn in place of the meshes' single range
+};
+
+//Prototypes
+class CClusterCuller
+{
+	//Member Functions
+public:
+	CClusterCuller();
+	~CClusterCuller();
+
+	//Fills _rvecRanges with the visible parts of LOD 0 and returns true, an empty list means nothing is visible.
+	//Returns false when the mesh has no clusters or there is no perspective camera, the mesh should then be drawn whole
+	bool Cull(const IMesh* _pMesh, const float4x4& _rmatWorld, std::vector<TRange<unsigned int>>& _rvecRanges);
+
+	//True when Cull would work on _pMesh, lets a caller keep a batched draw for meshes it can't cull
+	bool CanCull(const IMesh* _pMesh) const;
+
+	//The normal cone test is only right while the rasterizer drops back faces, turned off for wireframe
+	void SetBackfaceCulling(bool _bEnabled);
+	bool GetBackfaceCulling() const;
+
+	//Latches this frame's stats and starts the next
+	void EndFrame();
+
+	//One entry per view culled in the last frame
+	const std::vector<TClusterCullStats>& GetViewStats() const;
+	void WriteReport() const;
+
+private:
+	CClusterCuller(const CClusterCuller& _rhs) = delete;
+
+	TClusterCullStats& GetStats(const void* _pView);
+
+	//Member Variables
+protected:
+	bool m_bBackfaceCulling;
+	std::vector<TClusterCullStats> m_vecFrameStats;
+	std::vector<TClusterCullStats> m_vecLastFrameStats;
+
+};
+
+#endif //__CLUSTER_CULLER_H__
@@ -0,0 +1,58 @@
+#pragma once
+#ifndef __COOKED_MODEL_H__
+#define __COOKED_MODEL_H__
+
+//Cooked model file layout, written by CModel after an Assimp import and read back with a single mapping
+//
+//	TCookedModelHeader
+//	TCookedMesh[uiMeshCount]
+//	TModelMeshInstance[uiInstanceCount]
+//	Vertex, index and cluster blobs, each aligned to COOKED_MODEL_ALIGNMENT
+//
+//Blobs are stored in the runtime vertex/index layout so they go straight to CMesh::Initialize
+
+//Types
+#define COOKED_MODEL_MAGIC 0x4C444D43 //"CMDL"
+#define COOKED_MODEL_VERSION 8 //2: indices and vertices in optimized order, 3: 16 bit indices per mesh, 4: packed vertices per mesh, 5: LOD chain per mesh, 6: culling clusters per mesh, 7: welded vertices and repeated meshes folded, 8: bounding sphere and oriented box per mesh
+#define COOKED_MODEL_EXTENSION ".cmdl"
+#define COOKED_MODEL_ALIGNMENT 16
+#define COOKED_MODEL_MAX_LODS 5 //Matches MESH_MAX_LODS, kept separate so the file layout doesn't follow it silently
+
+struct TCookedModelHeader
+{
+	unsigned int uiMagic;
+	unsigned int uiVersion;
+	unsigned int uiVertexSize; //Vertex/index/instance sizes at cook time, a layout change invalidates the file. Full vertex, each mesh records its format
+	unsigned int uiIndexSize; //Widest index, each mesh records its own
+	unsigned int uiInstanceSize;
+	unsigned int uiMeshCount;
+	unsigned int uiInstanceCount;
+	int iMaterialCount;
+	unsigned long long ullSourceWriteTime; //Source file write time, the cook is stale if the source changes
+	unsigned long long ullFileSize; //Catches truncated writes
+};
+
+struct TCookedMesh
+{
+	unsigned long long ullVertexOffset; //From the start of the file
+	unsigned long long ullIndexOffset;
+	unsigned long long ullClusterOffset; //TMeshCluster[uiClusterCount], ranges within LOD 0
+	unsigned int uiVertexCount;
+	unsigned int uiIndexCount;
+	int iMaterialId;
+	float fBBCenter[3];
+	float fBBExtends[3];
+	float fSphere[4]; //Center then radius
+	float fOBBCenter[3];
+	float fOBBExtends[3];
+	float fOBBOrientation[4]; //Quaternion
+	unsigned int uiIndexSize; //2 or 4, 16 bit when every vertex can be indexed with it
+	unsigned int uiVertexFormat; //EVertexFormat, TEX_NORM or PACKED when the round trip was within tolerance
+	float fUVDensity; //Measured on the full vertices at import, packed ones aren't unpacked to find it again
+	unsigned int uiLodCount; //Levels stored back to back in the index blob from LOD 0, each starts where the one before ends
+	unsigned int puiLodIndexCount[COOKED_MODEL_MAX_LODS];
+	float pfLodError[COOKED_MODEL_MAX_LODS];
+	unsigned int uiClusterCount; //0 when the mesh is drawn whole
+};
+
+#endif //__COOKED_MODEL_H__
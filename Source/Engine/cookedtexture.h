@@ -0,0 +1,40 @@
+#pragma once
+#ifndef __COOKED_TEXTURE_H__
+#define __COOKED_TEXTURE_H__
+
+//Cooked texture file layout, written by CTexture after a WIC decode and read back with a single mapping
+//
+//	TCookedTextureHeader
+//	TCookedSubresource[uiMipLevels * uiArraySize], in D3D11 subresource order (slice major, mip minor)
+//	Pixel blobs in the final DXGI format, each aligned to COOKED_TEXTURE_ALIGNMENT
+//
+//Blobs are handed straight to CreateTexture2D as the initial data
+
+//Types
+#define COOKED_TEXTURE_MAGIC 0x58455443 //"CTEX"
+#define COOKED_TEXTURE_VERSION 1
+#define COOKED_TEXTURE_EXTENSION ".ctex"
+#define COOKED_TEXTURE_ALIGNMENT 16
+
+struct TCookedTextureHeader
+{
+	unsigned int uiMagic;
+	unsigned int uiVersion;
+	unsigned int uiFormat; //DXGI_FORMAT
+	unsigned int uiWidth;
+	unsigned int uiHeight;
+	unsigned int uiMipLevels;
+	unsigned int uiArraySize;
+	unsigned int uiPadding;
+	unsigned long long ullSourceWriteTime; //Source file write time, the cook is stale if the source changes
+	unsigned long long ullFileSize; //Catches truncated writes
+};
+
+struct TCookedSubresource
+{
+	unsigned long long ullOffset; //From the start of the file
+	unsigned int uiRowPitch; //Bytes per row, or per row of 4x4 blocks for BC formats
+	unsigned int uiSlicePitch;
+};
+
+#endif //__COOKED_TEXTURE_H__
@@ -172,12 +172,12 @@ CDebugShader::DrawSphere(float3 _vec3pos, float3 _vec3rot, float _fRadius)
 }
 
 bool
-CDebugShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced)
+CDebugShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced, const TMaterial* _ptMaterial)
 {
 	bool bSuccessful = false;
 
 	bool bIsActiveShader = (sm_pActiveShader == this);
-	bool bRendererReady = m_pRenderer && m_pRenderer->GetDeviceContext() && m_pRenderer->IsSceneActive();
+	bool bRendererReady = m_pRenderer && m_pRenderer->IsSceneActive();
 	bool bValidParams = _pMesh && _ptWorldMatrix; //nullptr check
 
 	if(bIsActiveShader && bRendererReady && bValidParams)
@@ -186,7 +186,7 @@ CDebugShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool
 		TShaderPass tPass = m_vecPasses[0];
 
 		//Bind vertex layout
-		m_pRenderer->GetDeviceContext()->IASetInputLayout(tPass.pVertexLayout);
+		m_pRenderer->SetInputLayout(tPass.pVertexLayout);
 
 		//Build the cbuffer
 		TCBufferDebugPerObject tCBPerObject;
@@ -194,17 +194,17 @@ CDebugShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool
 
 		//Fill the per-object cbuffer
 		D3D11_MAPPED_SUBRESOURCE MappedResource;
-		HRESULT hrMapped = m_pRenderer->GetDeviceContext()->Map(m_pCBuffers[0], 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedResource);
-		if(SUCCEEDED(hrMapped))
+		bool bMapped = m_pRenderer->Map(m_pCBuffers[0], D3D11_MAP_WRITE_DISCARD, &MappedResource);
+		if(bMapped)
 		{
 			memcpy_s(MappedResource.pData, sizeof(TCBufferDebugPerObject), &tCBPerObject, sizeof(TCBufferDebugPerObject));
-			m_pRenderer->GetDeviceContext()->Unmap(m_pCBuffers[0], 0);
+			m_pRenderer->Unmap(m_pCBuffers[0]);
 		}
 
 		//Apply the per-object cbuffer data to register(b2)
 		int iCbSlot = (int)EDebugShaderBindings::CB_PEROBJECT;
-		if(tPass.pVertexShader) m_pRenderer->GetDeviceContext()->VSSetConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
-		if(tPass.pPixelShader) m_pRenderer->GetDeviceContext()->PSSetConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
+		if(tPass.pVertexShader) m_pRenderer->SetVSConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
+		if(tPass.pPixelShader) m_pRenderer->SetPSConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
 
 		bSuccessful = true; //TODO: Add checks, but only the Map/Unmap returns a state
 	}
@@ -34,7 +34,7 @@ public:
 	//void DrawPoly();
 
 	//Direct drawing of primitives
-	bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false);
+	bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false, const TMaterial* _ptMaterial = nullptr);
 
 private:
 	//Not used, default or empty
@@ -0,0 +1,3 @@
+//This file exists to ensure proper compilation of the default passes
+//The only issue with doing it this way is that there is non-standard entrypoints; main_vsp0 instead of main() etc.
+#include "default_vs.hlsli"
\ No newline at end of file
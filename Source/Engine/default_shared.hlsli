@@ -44,6 +44,21 @@ struct VS_IN_INSTANCED: VS_IN
 	float4 vInstanceRot		: I_ROTATION; //quaternion
 };
 
+//TVertexPacked, the input layout converts to floats so only the octahedral unfold and position rescale are left. See DecodePackedVertex
+struct VS_IN_PACKED
+{
+	float4 vPosQ : POSITION0; //0..1 across the mesh's bounding box, w unused
+	float4 vNormalTangent : NORMAL0; //Octahedral normal in xy, tangent in zw
+	float2 vTexCoord : TEXCOORD0;
+};
+
+struct VS_IN_PACKED_INSTANCED: VS_IN_PACKED
+{
+	float3 vInstancePos		: I_POSITION;
+	float3 vInstanceScale	: I_SCALE;
+	float4 vInstanceRot		: I_ROTATION; //quaternion
+};
+
 struct VS_OUT
 {
 	float4 vPosH : SV_POSITION;
@@ -67,6 +82,8 @@ cbuffer cbPerFrame: register(b1)
 cbuffer cbPerObject: register(b2)
 {
 	float4x4 matWorld;
+	float3 vec3PosScale; float fPosPad0; //Packed position decode, identity for full vertices
+	float3 vec3PosOffset; float fPosPad1;
 	bool bRenderUnlit; bool3 pack1; //packs to equiv. float1
 	float3 packing; //brings the bools up to float4 total
 };
@@ -74,4 +91,26 @@ cbuffer cbPerObject: register(b2)
 float3 RotateVectorByQuaternion(float4 Q, float3 V)
 {
 	return(V + 2.0f * cross(Q.xyz, cross(Q.xyz, V) + Q.w * V));
+}
+
+//Inverse of EncodeOctahedral in vertexpack.cpp
+float3 DecodeOctahedral(float2 _vec2Encoded)
+{
+	float3 vec3Normal = float3(_vec2Encoded, 1.0f - abs(_vec2Encoded.x) - abs(_vec2Encoded.y));
+	float fFold = saturate(-vec3Normal.z);
+	vec3Normal.xy += (vec3Normal.xy >= 0.0f) ? -fFold : fFold;
+
+	return(normalize(vec3Normal));
+}
+
+//Back to a full vertex, everything after this is shared with the unpacked passes
+VS_IN DecodePackedVertex(VS_IN_PACKED _input)
+{
+	VS_IN vertex;
+	vertex.vPosL = _input.vPosQ.xyz * vec3PosScale + vec3PosOffset;
+	vertex.vNormalL = DecodeOctahedral(_input.vNormalTangent.xy);
+	vertex.vTangentL = DecodeOctahedral(_input.vNormalTangent.zw);
+	vertex.vTexCoord = _input.vTexCoord;
+
+	return(vertex);
 }
\ No newline at end of file
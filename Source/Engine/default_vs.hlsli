@@ -85,6 +85,47 @@ VS_OUT main_vsinstp1(VS_IN_INSTANCED _input)
 	return(calculateVertex(vertex));
 }
 
+//Packed vertices, decoded then run through the passes above
+VS_IN_INSTANCED DecodePackedInstance(VS_IN_PACKED_INSTANCED _input)
+{
+	VS_IN vertex = DecodePackedVertex((VS_IN_PACKED)_input);
+
+	VS_IN_INSTANCED output;
+	output.vPosL = vertex.vPosL;
+	output.vNormalL = vertex.vNormalL;
+	output.vTangentL = vertex.vTangentL;
+	output.vTexCoord = vertex.vTexCoord;
+	output.vInstancePos = _input.vInstancePos;
+	output.vInstanceScale = _input.vInstanceScale;
+	output.vInstanceRot = _input.vInstanceRot;
+
+	return(output);
+}
+
+//Shadowmap pass for packed meshes (pass0)
+float4 main_vspackedp0(VS_IN_PACKED _input): SV_POSITION
+{
+	return(main_vsp0(DecodePackedVertex(_input)));
+}
+
+//Shadowmap pass for instanced packed meshes (pass0)
+float4 main_vsinstpackedp0(VS_IN_PACKED_INSTANCED _input): SV_POSITION
+{
+	return(main_vsinstp0(DecodePackedInstance(_input)));
+}
+
+//Default pass for packed meshes (pass1)
+VS_OUT main_vspackedp1(VS_IN_PACKED _input)
+{
+	return(calculateVertex(DecodePackedVertex(_input)));
+}
+
+//Default pass for instanced packed meshes (pass1)
+VS_OUT main_vsinstpackedp1(VS_IN_PACKED_INSTANCED _input)
+{
+	return(main_vsinstp1(DecodePackedInstance(_input)));
+}
+
 VS_OUT main_vsriggedp1(RIGGED_VS_IN _input)
 {
 	//Calculate bone manipulation/weights etc. here
@@ -5,7 +5,9 @@
 #include "imesh.h"
 #include "material.h"
 #include "texture.h"
+#include "assetmanager.hpp"
 #include "shaderglobals.h"
+#include "vertexpack.h"
 
 //This Include
 #include "defaultshader.h"
@@ -21,9 +23,6 @@ CDefaultShader::CDefaultShader()
 	, m_prsShadow(nullptr)
 	, m_iActivePass(-1)
 	, m_iCBufferCount(0)
-	, m_pErrorTex(nullptr)
-	, m_pBlackTex(nullptr)
-	, m_pWhiteTex(nullptr)
 {
 	//Constructor
 }
@@ -35,9 +34,9 @@ CDefaultShader::~CDefaultShader()
 	SafeDelete(m_pSunLight);
 	m_iActivePass = -1;
 
-	m_pBlackTex = nullptr;
-	m_pErrorTex = nullptr;
-	m_pWhiteTex = nullptr;
+	m_pBlackTex.Reset();
+	m_pErrorTex.Reset();
+	m_pWhiteTex.Reset();
 
 	//Release the constant buffers
 	if(m_pCBuffers)
@@ -95,6 +94,29 @@ CDefaultShader::Initialize(CRenderer* _pRenderer, CCamera* _pSceneCamera)
 	LoadFromFile(EShaderType::VERTEX, 2, tPass0vsinstance, tInstanceLayout, SizeofArray(tInstanceLayout));
 	LoadFromFile(EShaderType::VERTEX, 3, tPass1vsinstance, tInstanceLayout, SizeofArray(tInstanceLayout));
 
+	//Fifth to eighth passes take TVertexPacked, the same passes again offset by 4. The formats unpack to floats before the shader sees them
+	TVertexLayoutSemantic tPackedLayout[] =
+	{
+		{"POSITION", DXGI_FORMAT_R16G16B16A16_UNORM},
+		{"NORMAL", DXGI_FORMAT_R16G16B16A16_SNORM},
+		{"TEXCOORD", DXGI_FORMAT_R16G16_FLOAT},
+	};
+
+	TVertexLayoutSemantic tPackedInstanceLayout[] =
+	{
+		tPackedLayout[0], tPackedLayout[1], tPackedLayout[2],
+		tInstanceLayout[4], tInstanceLayout[5], tInstanceLayout[6],
+	};
+
+	TShaderFileDesc tPass0vspacked("Resources\\Shaders\\default_p0_vspacked.cso");
+	TShaderFileDesc tPass1vspacked("Resources\\Shaders\\default_p1_vspacked.cso");
+	TShaderFileDesc tPass0vsinstpacked("Resources\\Shaders\\default_p0_vsinstpacked.cso");
+	TShaderFileDesc tPass1vsinstpacked("Resources\\Shaders\\default_p1_vsinstpacked.cso");
+	LoadFromFile(EShaderType::VERTEX, 4, tPass0vspacked, tPackedLayout, SizeofArray(tPackedLayout));
+	LoadFromFile(EShaderType::VERTEX, 5, tPass1vspacked, tPackedLayout, SizeofArray(tPackedLayout));
+	LoadFromFile(EShaderType::VERTEX, 6, tPass0vsinstpacked, tPackedInstanceLayout, SizeofArray(tPackedInstanceLayout));
+	LoadFromFile(EShaderType::VERTEX, 7, tPass1vsinstpacked, tPackedInstanceLayout, SizeofArray(tPackedInstanceLayout));
+
 	//Empty CBuffer fills
 	TCBufferScenePerFrame tCBPerFrame;
 	TCBufferScenePerObject tCBPerObject;
@@ -143,9 +165,11 @@ CDefaultShader::Initialize(CRenderer* _pRenderer, CCamera* _pSceneCamera)
 		1,
 		D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE);
 
-	m_pRenderer->GetDevice()->CreateTexture2D(&dtd, nullptr, &m_pShadowMapTexture);
-	m_pRenderer->GetDevice()->CreateDepthStencilView(m_pShadowMapTexture, &dsvd, &m_pShadowMapDSV);
-	m_pRenderer->GetDevice()->CreateShaderResourceView(m_pShadowMapTexture, &dsrvd, &m_pShadowMapSRV);
+	m_pRenderer->CreateTexture2D(&dtd, nullptr, &m_pShadowMapTexture);
+	m_pRenderer->CreateShaderResourceView(m_pShadowMapTexture, &dsrvd, &m_pShadowMapSRV);
+
+	//Depth views only exist on a real device, the recording backend clears and binds a null view
+	if(m_pRenderer->GetDevice()) m_pRenderer->GetDevice()->CreateDepthStencilView(m_pShadowMapTexture, &dsvd, &m_pShadowMapDSV);
 
 	//Create the raster state
 	CD3D11_RASTERIZER_DESC drd(D3D11_FILL_SOLID,
@@ -163,7 +187,7 @@ CDefaultShader::Initialize(CRenderer* _pRenderer, CCamera* _pSceneCamera)
 	drd.SlopeScaledDepthBias = 1.0;
 	drd.CullMode = D3D11_CULL_NONE;
 	drd.DepthClipEnable = false; //For pancaking
-	m_pRenderer->GetDevice()->CreateRasterizerState(&drd, &m_prsShadow);
+	if(m_pRenderer->GetDevice()) m_pRenderer->GetDevice()->CreateRasterizerState(&drd, &m_prsShadow);
 
 	//TODO: fix this
 	return false;
@@ -198,17 +222,17 @@ CDefaultShader::ApplyShader(int _iPass)
 
 	//Memcpy
 	D3D11_MAPPED_SUBRESOURCE MappedResource;
-	HRESULT hrMapped = m_pRenderer->GetDeviceContext()->Map(m_pCBuffers[0], 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedResource);
-	if(SUCCEEDED(hrMapped))
+	bool bMapped = m_pRenderer->Map(m_pCBuffers[0], D3D11_MAP_WRITE_DISCARD, &MappedResource);
+	if(bMapped)
 	{
 		memcpy_s(MappedResource.pData, sizeof(TCBufferScenePerFrame), &tCBPerFrame, sizeof(TCBufferScenePerFrame));
-		m_pRenderer->GetDeviceContext()->Unmap(m_pCBuffers[0], 0);
+		m_pRenderer->Unmap(m_pCBuffers[0]);
 	}
 
 	//Apply the per-frame cbuffer data to register(b1)
 	int iCbSlot = (int)EDefaultShaderBindings::CB_PERFRAME;
-	m_pRenderer->GetDeviceContext()->VSSetConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
-	m_pRenderer->GetDeviceContext()->PSSetConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
+	m_pRenderer->SetVSConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
+	m_pRenderer->SetPSConstantBuffers(iCbSlot, 1, &m_pCBuffers[0]);
 
 	//TODO: fix this
 	return(false);
@@ -238,13 +262,13 @@ CDefaultShader::SetPass(int _iPass)
 			//Assume m_pShadowMapSRV is not bound to t1, calling unbind here is a potential waste of cycles if other shaders have been running
 
 			//Clear depth
-			m_pRenderer->GetDeviceContext()->ClearDepthStencilView(m_pShadowMapDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
+			m_pRenderer->ClearDepthStencil(m_pShadowMapDSV, D3D11_CLEAR_DEPTH, 1.0f, 0);
 
 			//Set a null render target as we are not writing color, only depth
-			m_pRenderer->GetDeviceContext()->OMSetRenderTargets(1, &pNullView, m_pShadowMapDSV);
+			m_pRenderer->SetRenderTargets(1, &pNullView, m_pShadowMapDSV);
 
 			//Set the raster state
-			m_pRenderer->GetDeviceContext()->RSSetState(m_prsShadow);
+			m_pRenderer->SetRasterState(m_prsShadow);
 
 			//Apply sun camera and force it to update
 			m_pSunLight->SetAsActiveCamera();
@@ -257,7 +281,7 @@ CDefaultShader::SetPass(int _iPass)
 			m_pSceneCamera->SetAsActiveCamera();
 
 			//Copy the shadow depth map texture to the shader
-			if(m_pShadowMapSRV) m_pRenderer->GetDeviceContext()->PSSetShaderResources((int)EDefaultShaderBindings::TX_SHADOWMAP, 1, &m_pShadowMapSRV);
+			if(m_pShadowMapSRV) m_pRenderer->SetPSShaderResources((int)EDefaultShaderBindings::TX_SHADOWMAP, 1, &m_pShadowMapSRV);
 			break;
 
 			//Error state
@@ -289,7 +313,7 @@ CDefaultShader::FinishShader()
 		//Normal render pass
 	case 1:
 		//Unbind slot 1 (m_pShadowMapSRV) for the next frame so pass0 can run normally
-		m_pRenderer->GetDeviceContext()->PSSetShaderResources((int)EDefaultShaderBindings::TX_SHADOWMAP, 1, &nullRes);
+		m_pRenderer->SetPSShaderResources((int)EDefaultShaderBindings::TX_SHADOWMAP, 1, &nullRes);
 		break;
 
 		//Error state
@@ -303,44 +327,57 @@ CDefaultShader::FinishShader()
 }
 
 bool
-CDefaultShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced)
+CDefaultShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced, const TMaterial* _ptMaterial)
 {
 	bool bSuccessful = false;
 	bool bIsActiveShader = (sm_pActiveShader == this);
-	bool bRendererReady = m_pRenderer && m_pRenderer->GetDeviceContext() && m_pRenderer->IsSceneActive();
+	bool bRendererReady = m_pRenderer && m_pRenderer->IsSceneActive();
 	bool bValidParams = _pMesh; //nullptr check
 	bool bShouldDraw = true;
 
-	bShouldDraw = m_iActivePass || (!m_iActivePass && _pMesh->GetMaterial().bCastShadow);
+	//Meshes shared between models draw with the material of the model drawing them
+	const TMaterial& tMat = _ptMaterial ? *_ptMaterial : _pMesh->GetMaterial();
+	bShouldDraw = m_iActivePass || (!m_iActivePass && tMat.bCastShadow);
 
 	if(bIsActiveShader && bRendererReady && bValidParams && bShouldDraw)
 	{
 		//TODO: Use an enum for swapping here instead of this garbage
 		//Calling to super (CDX11SHADER) ignores a lot of sets and only affects the GPU bindings
-		m_pRenderer->GetDeviceContext()->VSSetShader(m_vecPasses[m_iActivePass + (_bInstanced ? 2 : 0)].pVertexShader, nullptr, 0);
-		m_pRenderer->GetDeviceContext()->IASetInputLayout(m_vecPasses[m_iActivePass + (_bInstanced ? 2 : 0)].pVertexLayout);
+		bool bPacked = _pMesh->GetVertexFormat() == EVertexFormat::PACKED;
+		int iVertexPass = m_iActivePass + (_bInstanced ? 2 : 0) + (bPacked ? 4 : 0);
+		m_pRenderer->SetVertexShader(m_vecPasses[iVertexPass].pVertexShader);
+		m_pRenderer->SetInputLayout(m_vecPasses[iVertexPass].pVertexLayout);
 
 		//Build the cbuffer
 		TCBufferScenePerObject tCBPerObject;
 
 		//_ptWorldMatrix can sometimes be null when drawing instanced, replace with identity matrix if null
 		tCBPerObject.matWorld = _ptWorldMatrix ? _ptWorldMatrix->Transpose() : float4x4::Identity();
+
+		//Packed positions were quantized across the mesh's bounds, the shader scales them back
+		tCBPerObject.vec3PosScale = float3(1.0f, 1.0f, 1.0f);
+		if(bPacked)
+		{
+			const BoundingBox& rtBox = _pMesh->GetBoundingBox();
+			GetPackedPositionDecode(float3(rtBox.Center.x, rtBox.Center.y, rtBox.Center.z), float3(rtBox.Extents.x, rtBox.Extents.y, rtBox.Extents.z),
+				tCBPerObject.vec3PosScale, tCBPerObject.vec3PosOffset);
+		}
 		tCBPerObject.bRenderUnlit = false; //TODO: Find a home for this to work properly. Consider removing Predraw from CMesh
 
 		//Fill the per-object cbuffer
 		D3D11_MAPPED_SUBRESOURCE MappedResource;
-		HRESULT hrMapped = m_pRenderer->GetDeviceContext()->Map(m_pCBuffers[1], 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedResource);
-		if(SUCCEEDED(hrMapped))
+		bool bMapped = m_pRenderer->Map(m_pCBuffers[1], D3D11_MAP_WRITE_DISCARD, &MappedResource);
+		if(bMapped)
 		{
 			memcpy_s(MappedResource.pData, sizeof(TCBufferScenePerObject), &tCBPerObject, sizeof(TCBufferScenePerObject));
-			m_pRenderer->GetDeviceContext()->Unmap(m_pCBuffers[1], 0);
+			m_pRenderer->Unmap(m_pCBuffers[1]);
 		}
 
 		//Apply the per-object cbuffer data to register(b2)
 		//TODO: Use a better system than this for keeping track of shader bindings, preferably through CRenderer, using a Dictionary maybe
 		int iCbSlot = (int)EDefaultShaderBindings::CB_PEROBJECT;
-		if(m_vecPasses[m_iActivePass].pVertexShader) m_pRenderer->GetDeviceContext()->VSSetConstantBuffers(iCbSlot, 1, &m_pCBuffers[1]);
-		if(m_vecPasses[m_iActivePass].pPixelShader) m_pRenderer->GetDeviceContext()->PSSetConstantBuffers(iCbSlot, 1, &m_pCBuffers[1]);
+		if(m_vecPasses[m_iActivePass].pVertexShader) m_pRenderer->SetVSConstantBuffers(iCbSlot, 1, &m_pCBuffers[1]);
+		if(m_vecPasses[m_iActivePass].pPixelShader) m_pRenderer->SetPSConstantBuffers(iCbSlot, 1, &m_pCBuffers[1]);
 
 		//Textured normal render pass (pass1)
 		if(m_iActivePass == 1)
@@ -352,14 +389,30 @@ CDefaultShader::Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, boo
 			auto pWhiteTex = AssetLoaded(m_pWhiteTex) ? m_pWhiteTex->GetSRV() : nullptr;
 
 			//Bind valid material parts to the SRV
-			TMaterial tMat = _pMesh->GetMaterial();
-			pSRVs[0] = AssetLoaded(tMat.pDiffuseTex)	? tMat.pDiffuseTex->GetSRV()	: pErrorTex;
-			pSRVs[1] = AssetLoaded(tMat.pNormalTex)		? tMat.pNormalTex->GetSRV()		: pBlackTex;
-			pSRVs[2] = AssetLoaded(tMat.pSpecularTex)	? tMat.pSpecularTex->GetSRV()	: pBlackTex;
-			pSRVs[3] = AssetLoaded(tMat.pAOTex)			? tMat.pAOTex->GetSRV()			: pWhiteTex;
+			pSRVs[0] = AssetLoaded(tMat.pDiffuseTex)	? tMat.pDiffuseTex->GetSRV()	: nullptr;
+			pSRVs[1] = AssetLoaded(tMat.pNormalTex)		? tMat.pNormalTex->GetSRV()		: nullptr;
+			pSRVs[2] = AssetLoaded(tMat.pSpecularTex)	? tMat.pSpecularTex->GetSRV()	: nullptr;
+			pSRVs[3] = AssetLoaded(tMat.pAOTex)			? tMat.pAOTex->GetSRV()			: nullptr;
+
+			//Still loading or waiting on the upload queue
+			if(!pSRVs[0]) pSRVs[0] = pErrorTex;
+			if(!pSRVs[1]) pSRVs[1] = pBlackTex;
+			if(!pSRVs[2]) pSRVs[2] = pBlackTex;
+			if(!pSRVs[3]) pSRVs[3] = pWhiteTex;
 
 			//Bind
-			m_pRenderer->GetDeviceContext()->PSSetShaderResources(ShaderGlobals::TX_DIFFUSE, 4, pSRVs);
+			m_pRenderer->SetPSShaderResources(ShaderGlobals::TX_DIFFUSE, 4, pSRVs);
+
+			//Ask for the mips this draw needs, instanced draws are requested by their instancer
+			if(_ptWorldMatrix)
+			{
+				XMMATRIX matWorld = XMLoadFloat4x4(_ptWorldMatrix);
+				BoundingSphere tWorldSphere;
+				_pMesh->GetBoundingSphere().Transform(tWorldSphere, matWorld);
+
+				float fScale = max(max(XMVectorGetX(XMVector3Length(matWorld.r[0])), XMVectorGetX(XMVector3Length(matWorld.r[1]))), XMVectorGetX(XMVector3Length(matWorld.r[2])));
+				CAssetManager::GetInstance().GetTextureStreamer().RequestMesh(_pMesh, tMat, tWorldSphere, fScale);
+			}
 		}
 
 		//Reset to normal pass
@@ -429,18 +482,27 @@ CDefaultShader::CalculateSceneShadow(std::vector<CEntity3D*> _vecpEntities)
 		if(fAngleBetween <= fFOV * 0.5f)
 		{
 			//Bounding Sphere, Faster than box due to GetCorners() doing transforms. Rougher but it saves a lot of computational time
-			if(tCameraFrustum.Contains(tSphere))
-			{
-				//scene bb min
-				vec3SceneMin.x = min(vec3SceneMin.x, tSphere.Center.x - tSphere.Radius);
-				vec3SceneMin.y = min(vec3SceneMin.y, tSphere.Center.y - tSphere.Radius);
-				vec3SceneMin.z = min(vec3SceneMin.z, tSphere.Center.z - tSphere.Radius);
-
-				//scene bb max
-				vec3SceneMax.x = max(vec3SceneMax.x, tSphere.Center.x + tSphere.Radius);
-				vec3SceneMax.y = max(vec3SceneMax.y, tSphere.Center.y + tSphere.Radius);
-				vec3SceneMax.z = max(vec3SceneMax.z, tSphere.Center.z + tSphere.Radius);
-			}
+			DirectX::ContainmentType eContainment = tCameraFrustum.Contains(tSphere);
+			if(eContainment == DirectX::DISJOINT) continue;
+
+			//Oriented box for the ones on the edge, long thin entities often only have their sphere in view
+			DirectX::BoundingOrientedBox tOBB = _vecpEntities[i]->GetOBB();
+			if(eContainment == DirectX::INTERSECTS && tCameraFrustum.Contains(tOBB) == DirectX::DISJOINT) continue;
+
+			//World extents of the box, the rotated axes' reach along each world axis. Whichever of it and the sphere is closer counts
+			XMMATRIX matRotation = XMMatrixRotationQuaternion(XMLoadFloat4(&tOBB.Orientation));
+			float3 vec3BoxReach;
+			XMStoreFloat3(&vec3BoxReach, XMVectorAbs(matRotation.r[0]) * tOBB.Extents.x + XMVectorAbs(matRotation.r[1]) * tOBB.Extents.y + XMVectorAbs(matRotation.r[2]) * tOBB.Extents.z);
+
+			//scene bb min
+			vec3SceneMin.x = min(vec3SceneMin.x, max(tSphere.Center.x - tSphere.Radius, tOBB.Center.x - vec3BoxReach.x));
+			vec3SceneMin.y = min(vec3SceneMin.y, max(tSphere.Center.y - tSphere.Radius, tOBB.Center.y - vec3BoxReach.y));
+			vec3SceneMin.z = min(vec3SceneMin.z, max(tSphere.Center.z - tSphere.Radius, tOBB.Center.z - vec3BoxReach.z));
+
+			//scene bb max
+			vec3SceneMax.x = max(vec3SceneMax.x, min(tSphere.Center.x + tSphere.Radius, tOBB.Center.x + vec3BoxReach.x));
+			vec3SceneMax.y = max(vec3SceneMax.y, min(tSphere.Center.y + tSphere.Radius, tOBB.Center.y + vec3BoxReach.y));
+			vec3SceneMax.z = max(vec3SceneMax.z, min(tSphere.Center.z + tSphere.Radius, tOBB.Center.z + vec3BoxReach.z));
 		}
 	}
 
@@ -6,6 +6,7 @@
 #include "dx11shader.h"
 #include "light.h" //Used in the cbuffer
 #include "shaderglobals.h"
+#include "assetref.hpp"
 
 //Prototypes
 class CCamera;
@@ -23,7 +24,7 @@ public:
 	bool SetPass(int _iPass);
 	void FinishShader();
 
-	bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false);
+	bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false, const TMaterial* _ptMaterial = nullptr);
 
 	//Default Textures
 	void SetDefaultTextures(CTexture* _pError, CTexture* _pBlack = nullptr, CTexture* _pWhite = nullptr);
@@ -46,9 +47,9 @@ protected:
 	int m_iActivePass; //Storage of what pass we are working with
 
 	//For missing textures
-	CTexture* m_pErrorTex;
-	CTexture* m_pBlackTex;
-	CTexture* m_pWhiteTex;
+	CAssetRef<CTexture> m_pErrorTex;
+	CAssetRef<CTexture> m_pBlackTex;
+	CAssetRef<CTexture> m_pWhiteTex;
 
 	//Constant Buffer
 	ID3D11Buffer** m_pCBuffers;
@@ -76,6 +77,8 @@ protected:
 	struct TCBufferScenePerObject
 	{
 		float4x4 matWorld;
+		float3 vec3PosScale; float fPosPad0; //Packed position decode, identity for full vertices
+		float3 vec3PosOffset; float fPosPad1;
 		bool bRenderUnlit; bool bPadding[3]; //Render without using lighting
 		float3 padding;
 		//TODO: Consider bRecieveShadows for rendering meshes with normal lighting but unaffected by shadowmap tests?
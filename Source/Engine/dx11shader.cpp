@@ -59,12 +59,8 @@ CDX11Shader::SetPass(int _iPass)
 	if(bSuccessful && sm_pActiveShader == this)
 	{
 		//Bind Shaders (Shaders set to NULL will be disabled)
-		m_pRenderer->GetDeviceContext()->VSSetShader(m_vecPasses[_iPass].pVertexShader, nullptr, 0);
-		m_pRenderer->GetDeviceContext()->PSSetShader(m_vecPasses[_iPass].pPixelShader, nullptr, 0);
-		m_pRenderer->GetDeviceContext()->GSSetShader(m_vecPasses[_iPass].pGeometryShader, nullptr, 0);
-		m_pRenderer->GetDeviceContext()->HSSetShader(m_vecPasses[_iPass].pHullShader, nullptr, 0);
-		m_pRenderer->GetDeviceContext()->DSSetShader(m_vecPasses[_iPass].pDomainShader, nullptr, 0);
-		m_pRenderer->GetDeviceContext()->CSSetShader(m_vecPasses[_iPass].pComputeShader, nullptr, 0); //TODO: Future support for multiple Compute Shaders
+		m_pRenderer->SetShaders(m_vecPasses[_iPass].pVertexShader, m_vecPasses[_iPass].pPixelShader, m_vecPasses[_iPass].pGeometryShader,
+			m_vecPasses[_iPass].pHullShader, m_vecPasses[_iPass].pDomainShader, m_vecPasses[_iPass].pComputeShader); //TODO: Future support for multiple Compute Shaders
 
 		//Nothing fancy, consider this a success
 		bSuccessful = true;
@@ -93,6 +89,9 @@ CDX11Shader::LoadFromFile(EShaderType _eShaderSlot, int _iPass, TShaderFileDesc
 	FILE* theFile = nullptr;
 	bool bSuccessful = false;
 
+	//Make sure the pass vector scales to support new passes, done before the file is opened so a missing shader still leaves an empty pass to bind
+	while((int)m_vecPasses.size() <= _iPass) m_vecPasses.push_back(TShaderPass());
+
 	//Open the file as binary if the shader file is compiled, otherwise ascii
 	fopen_s(&theFile, _tDesc.strFilename, _tDesc.bUncompiled ? "r" : "rb");
 
@@ -151,25 +150,22 @@ CDX11Shader::CreateShader(EShaderType _eShaderSlot, int _iPass, LPVOID _shaderBu
 {
 	bool bSuccessful = false;
 
-	//Make sure the pass vector scales to support new passes
-	while((int)m_vecPasses.size() <= _iPass) m_vecPasses.push_back(TShaderPass());
-
 	//Per type creation
 	switch(_eShaderSlot)
 	{
 		case EShaderType::VERTEX:
 			ReleaseCOM(m_vecPasses[_iPass].pVertexShader); //In case of recreation
-			bSuccessful = SUCCEEDED(m_pRenderer->GetDevice()->CreateVertexShader(_shaderBuffer, _shaderSize, nullptr, &m_vecPasses[_iPass].pVertexShader));
+			bSuccessful = m_pRenderer->CreateVertexShader(_shaderBuffer, _shaderSize, &m_vecPasses[_iPass].pVertexShader);
 			break;
 
 		case EShaderType::GEOMETRY:
 			ReleaseCOM(m_vecPasses[_iPass].pGeometryShader); //In case of recreation
-			bSuccessful = SUCCEEDED(m_pRenderer->GetDevice()->CreateGeometryShader(_shaderBuffer, _shaderSize, nullptr, &m_vecPasses[_iPass].pGeometryShader));
+			bSuccessful = m_pRenderer->CreateGeometryShader(_shaderBuffer, _shaderSize, &m_vecPasses[_iPass].pGeometryShader);
 			break;
 
 		case EShaderType::PIXEL:
 			ReleaseCOM(m_vecPasses[_iPass].pPixelShader); //In case of recreation
-			bSuccessful = SUCCEEDED(m_pRenderer->GetDevice()->CreatePixelShader(_shaderBuffer, _shaderSize, nullptr, &m_vecPasses[_iPass].pPixelShader));
+			bSuccessful = m_pRenderer->CreatePixelShader(_shaderBuffer, _shaderSize, &m_vecPasses[_iPass].pPixelShader);
 			break;
 
 		default:
@@ -210,7 +206,7 @@ CDX11Shader::CreateShader(EShaderType _eShaderSlot, int _iPass, LPVOID _shaderBu
 			}
 
 			//Attempt to create the vertex input layout.
-			bSuccessful = SUCCEEDED(m_pRenderer->GetDevice()->CreateInputLayout(pLayoutDesc, _iSemanticCount, _shaderBuffer, _shaderSize, &m_vecPasses[_iPass].pVertexLayout));
+			bSuccessful = m_pRenderer->CreateInputLayout(pLayoutDesc, _iSemanticCount, _shaderBuffer, _shaderSize, &m_vecPasses[_iPass].pVertexLayout);
 
 			//Release the layout description
 			SafeDeleteArray(pLayoutDesc);
@@ -139,7 +139,7 @@ public:
 	virtual bool SetPass(int _iPass) = 0; //Set current pass
 	virtual void FinishShader() = 0; //OPT: Called when ApplyShader() is called to cleanup bound resources
 
-	virtual bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false) = 0;
+	virtual bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false, const TMaterial* _ptMaterial = nullptr) = 0;
 
 protected:
 	bool LoadFromFile(EShaderType _eShaderSlot, int _iPass, TShaderFileDesc _tDesc, TVertexLayoutSemantic* _ptSemantics = nullptr, int _iSemanticCount = 0);
@@ -208,6 +208,11 @@ struct TFloat3XM: public XMFLOAT3
 		return((x * _rhs.x) + (y * _rhs.y) + (z * _rhs.z));
 	}
 
+	TFloat3XM Cross(const TFloat3XM& _rhs) const
+	{
+		return(TFloat3XM((y * _rhs.z) - (z * _rhs.y), (z * _rhs.x) - (x * _rhs.z), (x * _rhs.y) - (y * _rhs.x)));
+	}
+
 	TFloat3XM Normalize() const
 	{
 		TFloat3XM vec3Result = *this;
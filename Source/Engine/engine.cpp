@@ -7,7 +7,9 @@
 #include "clock.h"
 #include "inputmanager.h"
 #include "renderer.h"
+#include "headlessrenderer.h"
 #include "logmanager.h"
+#include "assetmanager.hpp"
 
 //This Include
 #include "engine.h"
@@ -26,6 +28,9 @@ CEngine::CEngine()
 
 CEngine::~CEngine()
 {
+	//Assets hold renderer resources, normally the game has already done this
+	CAssetManager::DestroyInstance();
+
 	SafeDelete(m_pRenderer);
 	SafeDelete(m_pClock);
 
@@ -86,6 +91,10 @@ CEngine::Initialize(TWindowData _tWindowData)
 			m_pRenderer = new CRenderer();
 			break;
 
+		case RENDERER_HEADLESS:
+			m_pRenderer = new CHeadlessRenderer();
+			break;
+
 		default:
 			DebugBreak(); //TODO: Fix this switch
 			bSafe = false;
@@ -144,9 +153,15 @@ CEngine::GameLoop(bool _fpGameFunc(float _fDeltaTick), void _fpDraw())
 				//Update the input
 				CInputManager::GetInstance().Process();
 
+				//Continuations for assets that finished since last frame, so the game logic sees them this frame
+				CAssetManager::GetInstance().DispatchCompletions();
+
 				//Process the game logic
 				bGameOk = (bGameOk && _fpGameFunc(m_pClock->GetDeltaTime()));
 
+				//Stream texture mips and evict unreferenced assets if over budget
+				CAssetManager::GetInstance().Process();
+
 				//Only draw if the game is running okay
 				if(bGameOk)
 				{
@@ -22,6 +22,7 @@ enum ERendererVersion
 {
 	//RENDERER_DX10,
 	RENDERER_DX11,
+	RENDERER_HEADLESS, //No device, records traffic only. Used for profiling the engine without a GPU
 	//RENDERER_DX12
 	//RENDERER_OPENGL
 	//RENDERER_VULKAN
@@ -1,3 +1,6 @@
+//Local Includes
+#include "meshbounds.h"
+
 //This Include
 #include "entity3d.h"
 
@@ -7,8 +10,9 @@ CEntity3D::CEntity3D()
 	, m_vec3Rotation(0.0f, 0.0f, 0.0f)
 	, m_vec3Scale(1.0f, 1.0f, 1.0f)
 	, m_bUpdateWorldMatrix(true)
-	, m_bReceiveShadow(true)
+	, m_tOriginalSphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f)
 	, m_bCastShadow(true)
+	, m_bReceiveShadow(true)
 	, m_bVisible(true)
 {
 	//Constructor
@@ -38,9 +42,15 @@ CEntity3D::Process(float _fDeltaTick)
 		matWorld = XMMatrixMultiply(matWorld, XMMatrixTranslationFromVector(xvecPos));
 		XMStoreFloat4x4(&m_matWorld, matWorld);
 
-		//Update OBB 
-		m_tOriginalOBB.Transform(m_tOBB, matWorld);
+		//Update OBB, the sphere is the tighter of the fitted one and the one around the box
+		TransformOrientedBox(m_tOriginalOBB, matWorld, m_tOBB);
 		m_tBoundingSphere.CreateFromBoundingBox(m_tBoundingSphere, m_tOBB);
+		if(m_tOriginalSphere.Radius > 0.0f)
+		{
+			DirectX::BoundingSphere tSphere;
+			m_tOriginalSphere.Transform(tSphere, matWorld);
+			if(tSphere.Radius < m_tBoundingSphere.Radius) m_tBoundingSphere = tSphere;
+		}
 
 		m_bUpdateWorldMatrix = false; //Revert
 	}
@@ -55,6 +55,7 @@ protected:
 	DirectX::BoundingOrientedBox m_tOriginalOBB;
 	DirectX::BoundingOrientedBox m_tOBB;
 	DirectX::BoundingSphere m_tBoundingSphere;
+	DirectX::BoundingSphere m_tOriginalSphere; //Fitted sphere before the transform, radius 0 when there is only the box
 
 	bool m_bCastShadow;
 	bool m_bReceiveShadow;
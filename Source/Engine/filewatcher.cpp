@@ -0,0 +1,282 @@
+//Library Includes
+#include <ctype.h>
+
+//Local Includes
+#include "mappedfile.h"
+#include "logmanager.h"
+
+//This Include
+#include "filewatcher.h"
+
+//Static Variables
+static const DWORD s_kdwNotifyFilter = FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE;
+static const DWORD s_kdwNotifyBufferSize = 32 * 1024;
+
+//Implementation
+CFileWatcher::CFileWatcher()
+	: m_uiDebounceMs(0)
+	, m_hDirectory(INVALID_HANDLE_VALUE)
+	, m_hStopEvent(NULL)
+	, m_bRunning(false)
+	, m_bPolling(false)
+{
+	//Constructor
+}
+
+CFileWatcher::~CFileWatcher()
+{
+	//Destructor
+	Shutdown();
+}
+
+bool
+CFileWatcher::Initialize(const char* _kpcDirectory, unsigned int _uiDebounceMs, bool _bForcePolling)
+{
+	if(m_bRunning || !_kpcDirectory) return(false);
+
+	m_strDirectoryKey = GetKey(_kpcDirectory);
+	if(!m_strDirectoryKey.empty() && m_strDirectoryKey.back() != '\\') m_strDirectoryKey += '\\';
+	if(m_strDirectoryKey == ".\\") m_strDirectoryKey.clear(); //Working directory, keys are already relative to it
+	m_uiDebounceMs = _uiDebounceMs;
+
+	m_hStopEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	if(!m_hStopEvent) return(false);
+
+	//Overlapped so the thread can wait on the stop event as well
+	if(!_bForcePolling)
+	{
+		m_hDirectory = CreateFileA(_kpcDirectory, FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+			OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+	}
+
+	m_bPolling = (m_hDirectory == INVALID_HANDLE_VALUE);
+	m_bRunning = true;
+	m_thread = std::thread(&CFileWatcher::WatchThread, this);
+
+	std::string debug = std::string("Watching ") + _kpcDirectory + (m_bPolling ? " by polling\n" : " for change notifications\n");
+	CLogManager::GetInstance().WriteDebug(debug.c_str(), "File Watcher");
+
+	return(true);
+}
+
+void
+CFileWatcher::Shutdown()
+{
+	if(m_bRunning)
+	{
+		m_bRunning = false;
+		SetEvent(m_hStopEvent);
+		if(m_thread.joinable()) m_thread.join();
+	}
+
+	if(m_hDirectory != INVALID_HANDLE_VALUE) CloseHandle(m_hDirectory);
+	if(m_hStopEvent) CloseHandle(m_hStopEvent);
+	m_hDirectory = INVALID_HANDLE_VALUE;
+	m_hStopEvent = NULL;
+
+	m_mutexFiles.lock();
+	m_mapFiles.clear();
+	m_mutexFiles.unlock();
+}
+
+void
+CFileWatcher::AddFile(const char* _kpcFilename)
+{
+	if(!_kpcFilename) return;
+
+	std::string strKey = GetKey(_kpcFilename);
+	if(strKey.compare(0, m_strDirectoryKey.size(), m_strDirectoryKey) != 0) return;
+
+	//Stamped now so only changes from here on are reported
+	TWatchedFile tFile;
+	tFile.strName = _kpcFilename;
+	tFile.ullSeenWriteTime = CMappedFile::GetWriteTime(_kpcFilename);
+	tFile.ullReportedWriteTime = tFile.ullSeenWriteTime;
+	tFile.bChanged = false;
+
+	std::lock_guard<std::mutex> lockFiles(m_mutexFiles);
+	m_mapFiles.emplace(strKey, tFile);
+}
+
+void
+CFileWatcher::RemoveFile(const char* _kpcFilename)
+{
+	if(!_kpcFilename) return;
+
+	std::lock_guard<std::mutex> lockFiles(m_mutexFiles);
+	m_mapFiles.erase(GetKey(_kpcFilename));
+}
+
+void
+CFileWatcher::GetChangedFiles(std::vector<std::string>& _rvecFiles)
+{
+	auto tNow = std::chrono::steady_clock::now();
+	std::lock_guard<std::mutex> lockFiles(m_mutexFiles);
+
+	for(auto& rPair : m_mapFiles)
+	{
+		TWatchedFile& rtFile = rPair.second;
+		if(!rtFile.bChanged || std::chrono::duration<double, std::milli>(tNow - rtFile.tLastChange).count() < m_uiDebounceMs) continue;
+
+		//Settled. Only reported if the contents were written, a rename over the file counts as that too
+		rtFile.bChanged = false;
+		unsigned long long ullWriteTime = CMappedFile::GetWriteTime(rtFile.strName.c_str());
+		if(ullWriteTime == 0 || ullWriteTime == rtFile.ullReportedWriteTime) continue;
+
+		rtFile.ullReportedWriteTime = ullWriteTime;
+		_rvecFiles.push_back(rtFile.strName);
+	}
+}
+
+bool
+CFileWatcher::IsPolling() const
+{
+	return(m_bPolling);
+}
+
+bool
+CFileWatcher::IsRunning() const
+{
+	return(m_bRunning);
+}
+
+void
+CFileWatcher::WatchThread()
+{
+	if(!m_bPolling) WatchNotifications();
+	if(m_bRunning) WatchPolling();
+}
+
+void
+CFileWatcher::WatchNotifications()
+{
+	//DWORD aligned as ReadDirectoryChangesW requires
+	std::vector<DWORD> vecBuffer(s_kdwNotifyBufferSize / sizeof(DWORD));
+
+	OVERLAPPED tOverlapped;
+	ZeroMemory(&tOverlapped, sizeof(OVERLAPPED));
+	tOverlapped.hEvent = CreateEventA(nullptr, TRUE, FALSE, nullptr);
+	HANDLE pWaitHandles[2] = { m_hStopEvent, tOverlapped.hEvent };
+
+	bool bFailed = (tOverlapped.hEvent == NULL);
+	while(m_bRunning && !bFailed)
+	{
+		ResetEvent(tOverlapped.hEvent);
+		if(!ReadDirectoryChangesW(m_hDirectory, vecBuffer.data(), s_kdwNotifyBufferSize, TRUE, s_kdwNotifyFilter, nullptr, &tOverlapped, nullptr))
+		{
+			bFailed = true;
+			break;
+		}
+
+		//Stopping, cancel the read and wait for it to let go of the buffer
+		DWORD dwBytes = 0;
+		if(WaitForMultipleObjects(2, pWaitHandles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+		{
+			CancelIoEx(m_hDirectory, &tOverlapped);
+			GetOverlappedResult(m_hDirectory, &tOverlapped, &dwBytes, TRUE);
+			break;
+		}
+
+		if(!GetOverlappedResult(m_hDirectory, &tOverlapped, &dwBytes, FALSE))
+		{
+			bFailed = true;
+			break;
+		}
+
+		//Too many changes at once for the buffer, the details are lost so check everything
+		if(dwBytes == 0)
+		{
+			MarkAllChanged();
+			continue;
+		}
+
+		const BYTE* pEntry = reinterpret_cast<const BYTE*>(vecBuffer.data());
+		while(true)
+		{
+			const FILE_NOTIFY_INFORMATION* ptInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pEntry);
+
+			//Relative to the watched directory
+			char pcName[MAX_PATH * 2];
+			int iLength = WideCharToMultiByte(CP_ACP, 0, ptInfo->FileName, (int)(ptInfo->FileNameLength / sizeof(WCHAR)), pcName, sizeof(pcName) - 1, nullptr, nullptr);
+			if(iLength > 0)
+			{
+				pcName[iLength] = '\0';
+				MarkChanged(m_strDirectoryKey + GetKey(pcName));
+			}
+
+			if(ptInfo->NextEntryOffset == 0) break;
+			pEntry += ptInfo->NextEntryOffset;
+		}
+	}
+
+	if(tOverlapped.hEvent) CloseHandle(tOverlapped.hEvent);
+
+	if(bFailed && m_bRunning)
+	{
+		m_bPolling = true;
+		CLogManager::GetInstance().WriteDebug("Change notifications failed, falling back to polling\n", "File Watcher");
+	}
+}
+
+void
+CFileWatcher::WatchPolling()
+{
+	std::vector<std::pair<std::string, std::string>> vecFiles;
+
+	//Sleeps on the stop event so shutdown doesn't wait out the interval
+	while(m_bRunning && WaitForSingleObject(m_hStopEvent, sm_kuiPollIntervalMs) == WAIT_TIMEOUT)
+	{
+		//Copied out, the write times are read without holding the lock
+		vecFiles.clear();
+		m_mutexFiles.lock();
+		for(auto& rPair : m_mapFiles) vecFiles.push_back(std::make_pair(rPair.first, rPair.second.strName));
+		m_mutexFiles.unlock();
+
+		for(auto& rFile : vecFiles)
+		{
+			unsigned long long ullWriteTime = CMappedFile::GetWriteTime(rFile.second.c_str());
+
+			std::lock_guard<std::mutex> lockFiles(m_mutexFiles);
+			auto it = m_mapFiles.find(rFile.first);
+			if(it == m_mapFiles.end() || it->second.ullSeenWriteTime == ullWriteTime) continue;
+
+			it->second.ullSeenWriteTime = ullWriteTime;
+			it->second.bChanged = true;
+			it->second.tLastChange = std::chrono::steady_clock::now();
+		}
+	}
+}
+
+void
+CFileWatcher::MarkChanged(const std::string& _rstrKey)
+{
+	//Anything we aren't watching is dropped here, cooks written next to the sources included
+	std::lock_guard<std::mutex> lockFiles(m_mutexFiles);
+	auto it = m_mapFiles.find(_rstrKey);
+	if(it == m_mapFiles.end()) return;
+
+	it->second.bChanged = true;
+	it->second.tLastChange = std::chrono::steady_clock::now();
+}
+
+void
+CFileWatcher::MarkAllChanged()
+{
+	std::lock_guard<std::mutex> lockFiles(m_mutexFiles);
+	for(auto& rPair : m_mapFiles)
+	{
+		rPair.second.bChanged = true;
+		rPair.second.tLastChange = std::chrono::steady_clock::now();
+	}
+}
+
+std::string
+CFileWatcher::GetKey(const char* _kpcFilename)
+{
+	std::string strKey = _kpcFilename ? _kpcFilename : "";
+	for(char& c : strKey) c = (c == '/') ? '\\' : (char)tolower((unsigned char)c);
+
+	while(strKey.compare(0, 2, ".\\") == 0) strKey.erase(0, 2);
+
+	return(strKey);
+}
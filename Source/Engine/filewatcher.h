@@ -0,0 +1,84 @@
+#pragma once
+#ifndef __FILE_WATCHER_H__
+#define __FILE_WATCHER_H__
+
+//Library Includes
+#include <windows.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+
+//Watches a directory tree for changes to a set of files on a background thread
+//Change notifications come from ReadDirectoryChangesW, if they can't be set up (or stop working, e.g. on some network shares)
+//the thread falls back to polling the write time of every watched file
+//
+//Editors tend to write a file several times per save, a change is only reported once the file has been quiet for the debounce time
+
+//Prototypes
+class CFileWatcher
+{
+	//Types
+private:
+	struct TWatchedFile
+	{
+		std::string strName; //As added, handed back as is
+		unsigned long long ullSeenWriteTime; //Last time seen by the watch thread
+		unsigned long long ullReportedWriteTime; //Last time handed out by GetChangedFiles
+		bool bChanged;
+		std::chrono::steady_clock::time_point tLastChange;
+	};
+
+	//Member Functions
+public:
+	CFileWatcher();
+	~CFileWatcher();
+
+	//Watches _kpcDirectory and everything below it, _bForcePolling skips change notifications entirely
+	bool Initialize(const char* _kpcDirectory, unsigned int _uiDebounceMs = 250, bool _bForcePolling = false);
+	void Shutdown();
+
+	//Any thread. Files outside the watched directory are ignored, case and slash direction don't matter
+	void AddFile(const char* _kpcFilename);
+	void RemoveFile(const char* _kpcFilename);
+
+	//Files that changed and have since settled, each reported once per change. Names come back as they were added
+	void GetChangedFiles(std::vector<std::string>& _rvecFiles);
+
+	bool IsPolling() const;
+	bool IsRunning() const;
+
+private:
+	CFileWatcher(const CFileWatcher& _rhs) = delete;
+
+	void WatchThread();
+	void WatchNotifications(); //Returns on shutdown, or on failure after switching to polling
+	void WatchPolling();
+	void MarkChanged(const std::string& _rstrKey);
+	void MarkAllChanged();
+
+	//Lower case with backslashes, leading ".\" removed. Watched files are keyed by this
+	static std::string GetKey(const char* _kpcFilename);
+
+	//Member Variables
+private:
+	static const unsigned int sm_kuiPollIntervalMs = 500;
+
+	std::string m_strDirectoryKey; //Keyed form with a trailing backslash
+	unsigned int m_uiDebounceMs;
+
+	std::mutex m_mutexFiles;
+	std::unordered_map<std::string, TWatchedFile> m_mapFiles;
+
+	std::thread m_thread;
+	HANDLE m_hDirectory;
+	HANDLE m_hStopEvent;
+	std::atomic_bool m_bRunning;
+	std::atomic_bool m_bPolling;
+
+};
+
+#endif //__FILE_WATCHER_H__
@@ -0,0 +1,260 @@
+//Library Includes
+#include <vector>
+#include <atomic>
+
+//Local Includes
+#include "shaderglobals.h"
+
+//This Include
+#include "headlessrenderer.h"
+
+//Types
+//Reference counted stand-in for any device child, no device, no private data. Counted atomically, loader and pool threads hold them too
+template<class TInterface>
+class THeadlessDeviceChild : public TInterface
+{
+public:
+	THeadlessDeviceChild() : m_ulRefCount(1) {}
+	virtual ~THeadlessDeviceChild() {}
+
+	//IUnknown
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID _riid, void** _ppvObject) { if(_ppvObject) *_ppvObject = nullptr; return(E_NOINTERFACE); }
+	ULONG STDMETHODCALLTYPE AddRef() { return(++m_ulRefCount); }
+	ULONG STDMETHODCALLTYPE Release()
+	{
+		ULONG ulRefCount = --m_ulRefCount;
+		if(ulRefCount == 0) delete this;
+		return(ulRefCount);
+	}
+
+	//ID3D11DeviceChild
+	void STDMETHODCALLTYPE GetDevice(ID3D11Device** _ppDevice) { if(_ppDevice) *_ppDevice = nullptr; }
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID _guid, UINT* _puiDataSize, void* _pData) { return(E_NOTIMPL); }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID _guid, UINT _uiDataSize, const void* _pData) { return(E_NOTIMPL); }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID _guid, const IUnknown* _pData) { return(E_NOTIMPL); }
+
+private:
+	std::atomic<ULONG> m_ulRefCount;
+};
+
+class CHeadlessBuffer : public THeadlessDeviceChild<ID3D11Buffer>
+{
+public:
+	CHeadlessBuffer(const D3D11_BUFFER_DESC& _tDesc, const void* _pData) : m_tDesc(_tDesc), m_vecData(_tDesc.ByteWidth, 0)
+	{
+		if(_pData && !m_vecData.empty()) memcpy_s(m_vecData.data(), m_vecData.size(), _pData, m_vecData.size());
+	}
+
+	//ID3D11Resource
+	void STDMETHODCALLTYPE GetType(D3D11_RESOURCE_DIMENSION* _peDimension) { *_peDimension = D3D11_RESOURCE_DIMENSION_BUFFER; }
+	void STDMETHODCALLTYPE SetEvictionPriority(UINT _uiEvictionPriority) {}
+	UINT STDMETHODCALLTYPE GetEvictionPriority() { return(0); }
+
+	//ID3D11Buffer
+	void STDMETHODCALLTYPE GetDesc(D3D11_BUFFER_DESC* _ptDesc) { *_ptDesc = m_tDesc; }
+
+	void* GetData() { return(m_vecData.empty() ? nullptr : m_vecData.data()); }
+
+private:
+	D3D11_BUFFER_DESC m_tDesc;
+	std::vector<BYTE> m_vecData;
+};
+
+class CHeadlessTexture2D : public THeadlessDeviceChild<ID3D11Texture2D>
+{
+public:
+	CHeadlessTexture2D(const D3D11_TEXTURE2D_DESC& _tDesc) : m_tDesc(_tDesc) {}
+
+	//ID3D11Resource
+	void STDMETHODCALLTYPE GetType(D3D11_RESOURCE_DIMENSION* _peDimension) { *_peDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D; }
+	void STDMETHODCALLTYPE SetEvictionPriority(UINT _uiEvictionPriority) {}
+	UINT STDMETHODCALLTYPE GetEvictionPriority() { return(0); }
+
+	//ID3D11Texture2D
+	void STDMETHODCALLTYPE GetDesc(D3D11_TEXTURE2D_DESC* _ptDesc) { *_ptDesc = m_tDesc; }
+
+private:
+	D3D11_TEXTURE2D_DESC m_tDesc; //Pixel data is not kept, nothing reads it back
+};
+
+class CHeadlessShaderResourceView : public THeadlessDeviceChild<ID3D11ShaderResourceView>
+{
+public:
+	CHeadlessShaderResourceView(ID3D11Resource* _pResource, const D3D11_SHADER_RESOURCE_VIEW_DESC* _ptDesc) : m_pResource(_pResource)
+	{
+		if(_ptDesc) m_tDesc = *_ptDesc;
+		else ZeroMemory(&m_tDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC));
+
+		m_pResource->AddRef();
+	}
+
+	virtual ~CHeadlessShaderResourceView()
+	{
+		ReleaseCOM(m_pResource);
+	}
+
+	//ID3D11View
+	void STDMETHODCALLTYPE GetResource(ID3D11Resource** _ppResource) { m_pResource->AddRef(); *_ppResource = m_pResource; }
+
+	//ID3D11ShaderResourceView
+	void STDMETHODCALLTYPE GetDesc(D3D11_SHADER_RESOURCE_VIEW_DESC* _ptDesc) { *_ptDesc = m_tDesc; }
+
+private:
+	ID3D11Resource* m_pResource;
+	D3D11_SHADER_RESOURCE_VIEW_DESC m_tDesc;
+};
+
+//Implementation
+CHeadlessRenderer::CHeadlessRenderer()
+{
+	//Constructor
+	m_bInitialized = false;
+}
+
+CHeadlessRenderer::~CHeadlessRenderer()
+{
+	//Destructor
+	//CRenderer::Shutdown() releases the global cbuffer, everything else is null
+}
+
+bool CHeadlessRenderer::Initialize(HWND _hWindow, int _iWidth, int _iHeight, bool _bWindowed)
+{
+	//Window is kept for the message pump, it is never drawn to
+	m_hWnd = _hWindow;
+	m_iWidth = _iWidth;
+	m_iHeight = _iHeight;
+
+	//Create the global cbuffer, the only resource the base renderer owns that callers bind
+	m_pGlobalCBuffer = CreateBuffer(D3D11_BIND_CONSTANT_BUFFER, &ShaderGlobals::gGlobalCBuffer, sizeof(ShaderGlobals::TCBufferGlobal), D3D11_USAGE_DYNAMIC);
+	m_bInitialized = (m_pGlobalCBuffer != nullptr);
+
+	return(m_bInitialized);
+}
+
+bool CHeadlessRenderer::IsDeviceReady() const
+{
+	return(m_bInitialized);
+}
+
+ID3D11Buffer* CHeadlessRenderer::CreateBuffer(UINT _uiBufferType, void* _pData, size_t _uiStructSize, D3D11_USAGE _eBufferUsage, unsigned long long* _pullUploadFence)
+{
+	if(_pullUploadFence) *_pullUploadFence = 0;
+
+	D3D11_BUFFER_DESC tBufferDescription;
+	ZeroMemory(&tBufferDescription, sizeof(D3D11_BUFFER_DESC));
+
+	tBufferDescription.Usage = _eBufferUsage;
+	tBufferDescription.BindFlags = _uiBufferType;
+	tBufferDescription.ByteWidth = (UINT)_uiStructSize;
+	if(_eBufferUsage == D3D11_USAGE_DYNAMIC) tBufferDescription.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	//Matches the device, zero sized buffers are invalid
+	ID3D11Buffer* pBuffer = nullptr;
+	if(_uiStructSize) pBuffer = new CHeadlessBuffer(tBufferDescription, _pData);
+	if(pBuffer) RecordBufferCreated(_pData ? _uiStructSize : 0);
+
+	return(pBuffer);
+}
+
+bool CHeadlessRenderer::CreateTexture2D(const D3D11_TEXTURE2D_DESC* _ptDesc, const D3D11_SUBRESOURCE_DATA* _ptInitialData, ID3D11Texture2D** _ppTexture, unsigned long long* _pullUploadFence)
+{
+	if(_pullUploadFence) *_pullUploadFence = 0;
+
+	bool bSuccess = _ptDesc && _ppTexture && _ptDesc->Width && _ptDesc->Height;
+
+	if(bSuccess)
+	{
+		*_ppTexture = new CHeadlessTexture2D(*_ptDesc);
+
+		//Same accounting as the device path
+		size_t uiBytes = 0;
+		if(_ptInitialData)
+		{
+			for(UINT i = 0; i < _ptDesc->MipLevels * _ptDesc->ArraySize; ++i) uiBytes += _ptInitialData[i].SysMemSlicePitch;
+		}
+
+		RecordTextureCreated(uiBytes);
+	}
+
+	return(bSuccess);
+}
+
+bool CHeadlessRenderer::CreateShaderResourceView(ID3D11Resource* _pResource, const D3D11_SHADER_RESOURCE_VIEW_DESC* _ptDesc, ID3D11ShaderResourceView** _ppView)
+{
+	bool bSuccess = _pResource && _ppView;
+	if(bSuccess) *_ppView = new CHeadlessShaderResourceView(_pResource, _ptDesc);
+	return(bSuccess);
+}
+
+bool CHeadlessRenderer::CreateVertexShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11VertexShader** _ppShader)
+{
+	bool bSuccess = _pByteCode && _uiByteCodeSize && _ppShader;
+	if(bSuccess) *_ppShader = new THeadlessDeviceChild<ID3D11VertexShader>();
+	return(bSuccess);
+}
+
+bool CHeadlessRenderer::CreatePixelShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11PixelShader** _ppShader)
+{
+	bool bSuccess = _pByteCode && _uiByteCodeSize && _ppShader;
+	if(bSuccess) *_ppShader = new THeadlessDeviceChild<ID3D11PixelShader>();
+	return(bSuccess);
+}
+
+bool CHeadlessRenderer::CreateGeometryShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11GeometryShader** _ppShader)
+{
+	bool bSuccess = _pByteCode && _uiByteCodeSize && _ppShader;
+	if(bSuccess) *_ppShader = new THeadlessDeviceChild<ID3D11GeometryShader>();
+	return(bSuccess);
+}
+
+bool CHeadlessRenderer::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* _ptElements, UINT _uiElementCount, const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11InputLayout** _ppLayout)
+{
+	bool bSuccess = _ptElements && _uiElementCount && _ppLayout;
+	if(bSuccess) *_ppLayout = new THeadlessDeviceChild<ID3D11InputLayout>();
+	return(bSuccess);
+}
+
+unsigned int CHeadlessRenderer::GetMaxTextureSize() const
+{
+	return(D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION);
+}
+
+bool CHeadlessRenderer::IsFormatSupported(DXGI_FORMAT _eFormat, UINT _uiRequiredSupport) const
+{
+	return(true);
+}
+
+bool CHeadlessRenderer::Map(ID3D11Resource* _pResource, D3D11_MAP _eMapType, D3D11_MAPPED_SUBRESOURCE* _ptMapped, UINT _uiSubresource)
+{
+	bool bSuccess = false;
+	RecordMap(_pResource, _eMapType);
+
+	//Only buffers are mapped by the engine, hand back the CPU copy
+	D3D11_RESOURCE_DIMENSION eDimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+	if(_pResource) _pResource->GetType(&eDimension);
+
+	if(eDimension == D3D11_RESOURCE_DIMENSION_BUFFER && _ptMapped)
+	{
+		CHeadlessBuffer* pBuffer = static_cast<CHeadlessBuffer*>(static_cast<ID3D11Buffer*>(_pResource));
+		D3D11_BUFFER_DESC tDesc;
+		pBuffer->GetDesc(&tDesc);
+
+		_ptMapped->pData = pBuffer->GetData();
+		_ptMapped->RowPitch = tDesc.ByteWidth;
+		_ptMapped->DepthPitch = tDesc.ByteWidth;
+		bSuccess = (_ptMapped->pData != nullptr);
+	}
+
+	return(bSuccess);
+}
+
+void CHeadlessRenderer::Unmap(ID3D11Resource* _pResource, UINT _uiSubresource)
+{
+	//Nothing to flush, writes went straight to the CPU copy
+}
+
+bool CHeadlessRenderer::Present()
+{
+	//Frame boundary only, stats are closed off by CRenderer::SceneEnd()
+	return(true);
+}
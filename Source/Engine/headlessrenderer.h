@@ -0,0 +1,45 @@
+#pragma once
+#ifndef __HEADLESS_RENDERER_H__
+#define __HEADLESS_RENDERER_H__
+
+//Local Includes
+#include "renderer.h"
+
+//Prototypes
+class CHeadlessRenderer : public CRenderer
+{
+	//Member Functions
+public:
+	CHeadlessRenderer();
+	virtual ~CHeadlessRenderer();
+
+	//Window handle is ignored, no device or swap chain is created
+	virtual bool Initialize(HWND _hWindow, int _iWidth, int _iHeight, bool _bWindowed);
+
+	virtual bool IsDeviceReady() const;
+
+	//Resources are CPU backed stand-ins, enough for the engine to hold, map and release them
+	//Initial data is always taken at creation, there is no context to upload through so fences come back as 0
+	virtual ID3D11Buffer* CreateBuffer(UINT _uiBufferType, void* _pData, size_t _uiStructSize, D3D11_USAGE _eBufferUsage = D3D11_USAGE_DEFAULT, unsigned long long* _pullUploadFence = nullptr);
+	virtual bool CreateTexture2D(const D3D11_TEXTURE2D_DESC* _ptDesc, const D3D11_SUBRESOURCE_DATA* _ptInitialData, ID3D11Texture2D** _ppTexture, unsigned long long* _pullUploadFence = nullptr);
+	virtual bool CreateShaderResourceView(ID3D11Resource* _pResource, const D3D11_SHADER_RESOURCE_VIEW_DESC* _ptDesc, ID3D11ShaderResourceView** _ppView);
+	virtual bool CreateVertexShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11VertexShader** _ppShader);
+	virtual bool CreatePixelShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11PixelShader** _ppShader);
+	virtual bool CreateGeometryShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11GeometryShader** _ppShader);
+	virtual bool CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* _ptElements, UINT _uiElementCount, const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11InputLayout** _ppLayout);
+
+	virtual unsigned int GetMaxTextureSize() const;
+	virtual bool IsFormatSupported(DXGI_FORMAT _eFormat, UINT _uiRequiredSupport) const;
+
+	virtual bool Map(ID3D11Resource* _pResource, D3D11_MAP _eMapType, D3D11_MAPPED_SUBRESOURCE* _ptMapped, UINT _uiSubresource = 0);
+	virtual void Unmap(ID3D11Resource* _pResource, UINT _uiSubresource = 0);
+
+protected:
+	virtual bool Present();
+
+	//Member Variables
+private:
+	bool m_bInitialized;
+};
+
+#endif //__HEADLESS_RENDERER_H__
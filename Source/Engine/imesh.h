@@ -2,6 +2,9 @@
 #ifndef __IMESH_H__
 #define __IMESH_H__
 
+//Types
+#define MESH_MAX_LODS 5 //LOD 0 is the full mesh
+
 //Enums
 enum class EMeshAccess
 {
@@ -14,6 +17,46 @@ enum class EMeshAccess
 };
 
 //Structures
+//Part of the index buffer drawn for one level of detail, every level shares the vertex buffer
+struct TMeshLod
+{
+	//Variables
+	UINT uiIndexStart;
+	UINT uiIndexCount;
+	float fError; //Furthest the level strays from the full mesh in object space units, 0 for LOD 0
+
+	//Functions
+	TMeshLod()
+		: uiIndexStart(0)
+		, uiIndexCount(0)
+		, fError(0.0f)
+	{
+		//Constructor
+	}
+};
+
+//Run of LOD 0's triangles culled as one, object space bounds. Stored as is in cooked models
+struct TMeshCluster
+{
+	//Variables
+	UINT uiIndexStart;
+	UINT uiIndexCount;
+	float3 vec3Center;
+	float fRadius;
+	float3 vec3ConeAxis; //Average facing of the triangles
+	float fConeCutoff; //Back facing from every point of the bounds when dot(center - eye, axis) >= cutoff * |center - eye| + radius, 1 never is
+
+	//Functions
+	TMeshCluster()
+		: uiIndexStart(0)
+		, uiIndexCount(0)
+		, fRadius(0.0f)
+		, fConeCutoff(1.0f)
+	{
+		//Constructor
+	}
+};
+
 template <typename TVertexType, typename TIndexType = DWORD>
 struct TMeshData
 {
@@ -40,10 +83,28 @@ struct TMeshData
 	float3 vec3BBCenter;
 	float3 vec3BBExtends; //Generate sphere from max x/y/z
 
+	//Tighter volumes from ComputeMeshBounds. A radius of 0 or extends of 0 has CMesh build them around the box instead
+	float3 vec3SphereCenter;
+	float fSphereRadius;
+	float3 vec3OBBCenter;
+	float3 vec3OBBExtends;
+	float4 vec4OBBOrientation; //Quaternion
+
+	//Object space units per UV unit, 0 if unknown. Texture streaming uses it to pick mips from distance
+	float fUVDensity;
+
 	//TODO: Add in ID/name?
 	//const char* pcName[64]; //64 is quite long, consider 32 (the quick brown fox jumped over)
 	int iMaterialId;
 
+	//Levels of detail stored back to back in the index buffer, 0 for a single level covering every index
+	TMeshLod ptLods[MESH_MAX_LODS];
+	UINT uiLodCount;
+
+	//Clusters over LOD 0 in index order, copied by CMesh::Initialize. Never owned
+	const TMeshCluster* ptClusters;
+	UINT uiClusterCount;
+
 	//Functions
 	//Empty Struct
 	TMeshData()
@@ -57,7 +118,16 @@ struct TMeshData
 		, bPointerOwnership(false)
 		, vec3BBCenter(0.0f, 0.0f, 0.0f)
 		, vec3BBExtends(0.0f, 0.0f, 0.0f)
+		, vec3SphereCenter(0.0f, 0.0f, 0.0f)
+		, fSphereRadius(0.0f)
+		, vec3OBBCenter(0.0f, 0.0f, 0.0f)
+		, vec3OBBExtends(0.0f, 0.0f, 0.0f)
+		, vec4OBBOrientation(0.0f, 0.0f, 0.0f, 1.0f)
+		, fUVDensity(0.0f)
 		, iMaterialId(-1)
+		, uiLodCount(0)
+		, ptClusters(nullptr)
+		, uiClusterCount(0)
 	{
 		//Constructor
 	}
@@ -74,7 +144,16 @@ struct TMeshData
 		, bPointerOwnership(_bPointerOwnership)
 		, vec3BBCenter(0.0f, 0.0f, 0.0f)
 		, vec3BBExtends(0.0f, 0.0f, 0.0f)
+		, vec3SphereCenter(0.0f, 0.0f, 0.0f)
+		, fSphereRadius(0.0f)
+		, vec3OBBCenter(0.0f, 0.0f, 0.0f)
+		, vec3OBBExtends(0.0f, 0.0f, 0.0f)
+		, vec4OBBOrientation(0.0f, 0.0f, 0.0f, 1.0f)
+		, fUVDensity(0.0f)
 		, iMaterialId(-1)
+		, uiLodCount(0)
+		, ptClusters(nullptr)
+		, uiClusterCount(0)
 	{
 		//Constructor
 	}
@@ -91,13 +170,23 @@ struct TMeshData
 		, bPointerOwnership(_bPointerOwnership)
 		, vec3BBCenter(0.0f, 0.0f, 0.0f)
 		, vec3BBExtends(0.0f, 0.0f, 0.0f)
+		, vec3SphereCenter(0.0f, 0.0f, 0.0f)
+		, fSphereRadius(0.0f)
+		, vec3OBBCenter(0.0f, 0.0f, 0.0f)
+		, vec3OBBExtends(0.0f, 0.0f, 0.0f)
+		, vec4OBBOrientation(0.0f, 0.0f, 0.0f, 1.0f)
+		, fUVDensity(0.0f)
 		, iMaterialId(-1)
+		, uiLodCount(0)
+		, ptClusters(nullptr)
+		, uiClusterCount(0)
 	{
 		//Constructor
 	}
 };
 
 //Prototypes
+enum class EVertexFormat;
 class IShader;
 struct TMaterial;
 class IInstancePool;
@@ -105,17 +194,28 @@ template<typename T> struct TRange;
 class IMesh
 {
 	//Member Functions
-protected:
-	~IMesh() = default;
-
 public:
-	virtual bool Draw(float4x4* _pmatWorld, IShader* _pShader = nullptr) = 0;
-	virtual bool DrawInstanced(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, IShader* _pShader = nullptr) = 0;
+	virtual ~IMesh() = default; //Owners such as CModel hold meshes of more than one index type through this
+
+	//LOD 0 draws the index range, any other level draws its own part of the index buffer
+	//_ptMaterial replaces the mesh's own material for this draw, meshes shared between models are drawn with the owner's
+	virtual bool Draw(float4x4* _pmatWorld, IShader* _pShader = nullptr, unsigned int _uiLod = 0, const TMaterial* _ptMaterial = nullptr) = 0;
+	virtual bool DrawInstanced(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, IShader* _pShader = nullptr, unsigned int _uiLod = 0,
+		const TMaterial* _ptMaterial = nullptr) = 0;
+
+	//Only the given parts of the index buffer, one draw each. Used for the clusters left after culling, no ranges draws nothing
+	virtual bool DrawRanges(float4x4* _pmatWorld, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount, IShader* _pShader = nullptr,
+		const TMaterial* _ptMaterial = nullptr) = 0;
+	virtual bool DrawInstancedRanges(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount,
+		IShader* _pShader = nullptr, const TMaterial* _ptMaterial = nullptr) = 0;
 
 	virtual void BindToIA(IInstancePool* _pInstancePool = nullptr) = 0;
 
+	//False until the upload queue has put the buffer data on the GPU
+	virtual bool IsUploaded() const = 0;
+
 	virtual void SetMaterial(const TMaterial& _rtMaterial) = 0;
-	virtual TMaterial GetMaterial() const = 0;
+	virtual const TMaterial& GetMaterial() const = 0; //By reference, copying a material touches every texture's ref count
 	virtual int GetMaterialId() const = 0;
 
 	virtual bool SetVertexRange(unsigned int _uiStart, unsigned int _uiLength = -1) = 0;
@@ -123,17 +223,36 @@ public:
 	virtual const TRange<unsigned int>& GetVertexRange() const = 0;
 	virtual const TRange<unsigned int>& GetIndexRange() const = 0;
 
-	//Gets number of Vertices/Indices
+	//Gets number of Vertices/Indices, the index count covers every level of detail
 	virtual unsigned int GetVertexCount() const = 0;
 	virtual unsigned int GetIndexCount() const = 0;
 
+	//Levels of detail, always at least one
+	virtual unsigned int GetLodCount() const = 0;
+	virtual TMeshLod GetLod(unsigned int _uiLod) const = 0;
+
+	//Clusters over LOD 0, none for meshes too small to be worth culling by part
+	virtual unsigned int GetClusterCount() const = 0;
+	virtual const TMeshCluster* GetClusters() const = 0;
+
 	//Get size of types
 	virtual size_t GetVertexSize() const = 0;
 	virtual size_t GetIndexSize() const = 0;
 
+	//Which input layout the vertices need, see vertexdefs.h
+	virtual EVertexFormat GetVertexFormat() const = 0;
+
+	//Read checks, readable meshes keep a copy of their data on the CPU
+	virtual bool CanReadVB() const = 0;
+	virtual bool CanReadIB() const = 0;
+
 	//AABB and Bounding Sphere get functions
 	virtual const DirectX::BoundingBox& GetBoundingBox() const = 0;
 	virtual const DirectX::BoundingSphere& GetBoundingSphere() const = 0;
+	virtual const DirectX::BoundingOrientedBox& GetOrientedBox() const = 0;
+
+	//Object space units per UV unit, 0 if unknown
+	virtual float GetUVDensity() const = 0;
 
 };
 
@@ -129,15 +129,13 @@ bool CInstancePool<CINSTANCEPOOL_INSERT>::Initialize(CRenderer* _pRenderer, TIns
 	}
 
 	//Create the instance buffer
-	if(m_pRenderer && m_pRenderer->GetDeviceContext())
+	if(m_pRenderer && m_pRenderer->IsDeviceReady())
 	{
 		//TODO: if _ptInstanceData is null, consider using zero'd out m_ptInstanceData and then delete if !_bReadable
 		//		I am unsure if this will cause an error until I test it, if it doesn't crash then we good
 		//TODO: Consider D3D11_USAGE_DEFAULT/IMMUTABLE vs. D3D11_USAGE_DYNAMIC in the case of instance data that will never change
 		//		This could be useful for pre-configured instance scenes where they use a grid layout for optimized drawing
-		m_pRenderer->GetGPUMutex().lock(); //Required for CreateBuffer as we may conflict with multi-threaded parts of code
 		m_pBuffer = m_pRenderer->CreateBuffer(D3D11_BIND_VERTEX_BUFFER, _ptInstanceData, _uiInstanceCount * sizeof(TInstanceType), D3D11_USAGE_DYNAMIC);
-		m_pRenderer->GetGPUMutex().unlock();
 	}
 
 	return(m_pBuffer != nullptr);
@@ -147,13 +145,13 @@ CINSTANCEPOOL_TEMPLATE
 bool CInstancePool<CINSTANCEPOOL_INSERT>::Unlock(bool _bWriteDiscard)
 {
 	//Pointer check, also skip if buffer is already unlocked
-	if(m_pRenderer && m_pRenderer->GetDeviceContext() && m_pBuffer && !m_pMappedBuffer.pData)
+	if(m_pRenderer && m_pRenderer->IsDeviceReady() && m_pBuffer && !m_pMappedBuffer.pData)
 	{
 		//If _bWriteDiscard, or if we are not readable (buffer opens in WD anyway...), reset the prev index to 0
 		if(_bWriteDiscard || !m_ptInstanceData) m_uiPrevIndex = 0; //Reset instance index to 0
 
 		//Ignore HR as we can test against pData
-		m_pRenderer->GetDeviceContext()->Map(m_pBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &m_pMappedBuffer);
+		m_pRenderer->Map(m_pBuffer, D3D11_MAP_WRITE_DISCARD, &m_pMappedBuffer);
 	}
 
 	//Return true if buffer is unlocked
@@ -182,7 +180,7 @@ bool CInstancePool<CINSTANCEPOOL_INSERT>::Lock(unsigned int _uiTotalCount)
 	//}
 
 	//Pointer check, also skip if buffer is already locked as it's uneditable
-	if(m_pRenderer && m_pRenderer->GetDeviceContext() && m_pBuffer && m_pMappedBuffer.pData)
+	if(m_pRenderer && m_pRenderer->IsDeviceReady() && m_pBuffer && m_pMappedBuffer.pData)
 	{
 		//If we're given a specific number, match that number or our max, whichever is lesser
 		if(_uiTotalCount != (unsigned int)(-1)) m_uiPrevIndex = _uiTotalCount > m_uiInstanceCount ? m_uiInstanceCount : _uiTotalCount;
@@ -196,7 +194,7 @@ bool CInstancePool<CINSTANCEPOOL_INSERT>::Lock(unsigned int _uiTotalCount)
 		}
 
 		//Ignore HR as we can test against pData
-		m_pRenderer->GetDeviceContext()->Unmap(m_pBuffer, 0);
+		m_pRenderer->Unmap(m_pBuffer);
 		m_pMappedBuffer.pData = nullptr;
 	}
 
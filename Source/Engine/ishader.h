@@ -7,6 +7,7 @@
 
 //Prototypes
 class IMesh;
+struct TMaterial;
 class IShader
 {
 	//Member Functions
@@ -15,7 +16,7 @@ public:
 	virtual bool SetPass(int _iPass) = 0;
 	virtual void FinishShader() = 0;
 
-	virtual bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false) = 0;
+	virtual bool Predraw(const IMesh* _pMesh, const float4x4* _ptWorldMatrix, bool _bInstanced = false, const TMaterial* _ptMaterial = nullptr) = 0;
 
 	//TODO: Consider why this is here and not in DX11Shader
 	static IShader* GetActiveShader()
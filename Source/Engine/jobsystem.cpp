@@ -0,0 +1,249 @@
+//Local Includes
+#include "common.h"
+
+//This Include
+#include "jobsystem.h"
+
+//Static Variables
+//Lets Submit() tell if it is being called from one of our own workers, and by which
+static thread_local const CJobSystem* tl_pOwnerPool = nullptr;
+static thread_local unsigned int tl_uiWorkerIndex = 0;
+
+//Implementation
+CJobSystem::CJobSystem()
+	: m_uiNextWorker(0)
+	, m_uiPendingJobs(0)
+	, m_bRunning(false)
+{
+	//Constructor
+}
+
+CJobSystem::~CJobSystem()
+{
+	//Destructor
+	Shutdown();
+}
+
+bool
+CJobSystem::Initialize(unsigned int _uiWorkerCount, std::function<void()> _fpThreadInit, std::function<void()> _fpThreadExit)
+{
+	//Already running or nothing to run
+	if(m_bRunning || _uiWorkerCount == 0) return(false);
+
+	m_fpThreadInit = _fpThreadInit;
+	m_fpThreadExit = _fpThreadExit;
+	m_bRunning = true;
+
+	//Create all the deques before any thread starts so stealing never sees a partial list
+	for(unsigned int i = 0; i < _uiWorkerCount; ++i) m_vecWorkers.push_back(new TWorker);
+	for(unsigned int i = 0; i < _uiWorkerCount; ++i) m_vecWorkers[i]->thread = std::thread(&CJobSystem::WorkerThread, this, i);
+
+	return(true);
+}
+
+void
+CJobSystem::Shutdown()
+{
+	if(m_vecWorkers.empty()) return;
+
+	//Flag under the sleep lock so no worker can miss the wake up between its check and its wait
+	m_mutexSleep.lock();
+	m_bRunning = false;
+	m_mutexSleep.unlock();
+	m_cvWork.notify_all();
+
+	//Workers finish the job they are on and exit
+	for(TWorker* pWorker : m_vecWorkers)
+	{
+		if(pWorker->thread.joinable()) pWorker->thread.join();
+	}
+
+	//Discard anything left over
+	for(TWorker* pWorker : m_vecWorkers) SafeDelete(pWorker);
+	m_vecWorkers.clear();
+	m_uiPendingJobs = 0;
+}
+
+bool
+CJobSystem::Submit(TJob _fpJob)
+{
+	if(!m_bRunning || !_fpJob) return(false);
+
+	//Workers keep their own jobs local, everything else is spread round robin
+	unsigned int uiTarget = (tl_pOwnerPool == this) ? tl_uiWorkerIndex : (m_uiNextWorker++ % (unsigned int)m_vecWorkers.size());
+
+	//The count moves with the deque under its lock, so it never claims a job that isn't there
+	TWorker* pWorker = m_vecWorkers[uiTarget];
+	pWorker->mutexJobs.lock();
+	pWorker->dequeJobs.push_back(_fpJob);
+	++m_uiPendingJobs;
+	pWorker->mutexJobs.unlock();
+
+	//A worker checking the count before the increment is already waiting by the time we get the lock, so it gets the notify
+	m_mutexSleep.lock();
+	m_mutexSleep.unlock();
+	m_cvWork.notify_one();
+
+	return(true);
+}
+
+unsigned int
+CJobSystem::ParallelFor(unsigned int _uiCount, unsigned int _uiMaxThreads, std::function<void(unsigned int)> _fpTask)
+{
+	if(_uiCount == 0) return(0);
+
+	//Helpers that start after everything has been claimed just return, the shared state outlives the call for them
+	std::shared_ptr<TParallelFor> pState = std::make_shared<TParallelFor>();
+	pState->fpTask = _fpTask;
+	pState->uiCount = _uiCount;
+	pState->uiNext = 0;
+	pState->uiDone = 0;
+
+	unsigned int uiHelpers = m_bRunning ? (unsigned int)m_vecWorkers.size() : 0;
+	if(uiHelpers > _uiCount - 1) uiHelpers = _uiCount - 1;
+	if(_uiMaxThreads && uiHelpers > _uiMaxThreads - 1) uiHelpers = _uiMaxThreads - 1;
+
+	unsigned int uiSubmitted = 0;
+	while(uiSubmitted < uiHelpers && Submit([pState]() { RunParallelTasks(*pState); })) ++uiSubmitted;
+
+	RunParallelTasks(*pState);
+
+	std::unique_lock<std::mutex> lockDone(pState->mutexDone);
+	pState->cvDone.wait(lockDone, [&pState]() { return(pState->uiDone == pState->uiCount); });
+
+	return(1 + uiSubmitted);
+}
+
+CJobSystem&
+CJobSystem::GetParallelPool()
+{
+	static CJobSystem s_jobSystem;
+	static std::once_flag s_onceInit;
+
+	std::call_once(s_onceInit, []()
+	{
+		unsigned int uiCores = std::thread::hardware_concurrency();
+		if(uiCores > 1) s_jobSystem.Initialize(uiCores - 1);
+	});
+
+	return(s_jobSystem);
+}
+
+unsigned int
+CJobSystem::GetPendingCount() const
+{
+	return(m_uiPendingJobs);
+}
+
+unsigned int
+CJobSystem::GetWorkerCount() const
+{
+	return((unsigned int)m_vecWorkers.size());
+}
+
+int
+CJobSystem::GetCurrentWorker() const
+{
+	return(tl_pOwnerPool == this ? (int)tl_uiWorkerIndex : -1);
+}
+
+bool
+CJobSystem::IsRunning() const
+{
+	return(m_bRunning);
+}
+
+void
+CJobSystem::WorkerThread(unsigned int _uiWorkerIndex)
+{
+	tl_pOwnerPool = this;
+	tl_uiWorkerIndex = _uiWorkerIndex;
+
+	if(m_fpThreadInit) m_fpThreadInit();
+
+	TJob fpJob;
+	while(m_bRunning)
+	{
+		if(PopJob(_uiWorkerIndex, fpJob))
+		{
+			fpJob();
+			fpJob = nullptr; //Release captures now rather than on the next job
+		}
+		else
+		{
+			//Nothing local or to steal, sleep until something is submitted
+			std::unique_lock<std::mutex> lockSleep(m_mutexSleep);
+			m_cvWork.wait(lockSleep, [this]() { return(!m_bRunning || m_uiPendingJobs > 0); });
+		}
+	}
+
+	if(m_fpThreadExit) m_fpThreadExit();
+
+	tl_pOwnerPool = nullptr;
+}
+
+void
+CJobSystem::RunParallelTasks(TParallelFor& _rState)
+{
+	for(unsigned int i = _rState.uiNext++; i < _rState.uiCount; i = _rState.uiNext++)
+	{
+		_rState.fpTask(i);
+
+		//Last task out wakes the caller
+		if(++_rState.uiDone == _rState.uiCount)
+		{
+			std::lock_guard<std::mutex> lockDone(_rState.mutexDone);
+			_rState.cvDone.notify_all();
+		}
+	}
+}
+
+bool
+CJobSystem::PopJob(unsigned int _uiWorkerIndex, TJob& _rJob)
+{
+	bool bFound = false;
+	unsigned int uiWorkerCount = (unsigned int)m_vecWorkers.size();
+
+	//Own deque first, newest job first while its data is still in cache
+	TWorker* pOwn = m_vecWorkers[_uiWorkerIndex];
+	pOwn->mutexJobs.lock();
+	if(!pOwn->dequeJobs.empty())
+	{
+		_rJob = std::move(pOwn->dequeJobs.back());
+		pOwn->dequeJobs.pop_back();
+		--m_uiPendingJobs;
+		bFound = true;
+	}
+	pOwn->mutexJobs.unlock();
+
+	//Steal the oldest job of the other workers, starting with our neighbour. The first pass skips a busy victim rather than
+	//wait on it, a second pass blocks on each so a worker never goes back to sleep with jobs still counted
+	for(unsigned int uiPass = 0; !bFound && uiPass < 2; ++uiPass)
+	{
+		if(uiPass == 1 && m_uiPendingJobs == 0) break;
+
+		for(unsigned int i = 1; !bFound && i < uiWorkerCount; ++i)
+		{
+			TWorker* pVictim = m_vecWorkers[(_uiWorkerIndex + i) % uiWorkerCount];
+			if(uiPass == 0)
+			{
+				if(!pVictim->mutexJobs.try_lock()) continue;
+			}
+			else
+			{
+				pVictim->mutexJobs.lock();
+			}
+
+			if(!pVictim->dequeJobs.empty())
+			{
+				_rJob = std::move(pVictim->dequeJobs.front());
+				pVictim->dequeJobs.pop_front();
+				--m_uiPendingJobs;
+				bFound = true;
+			}
+			pVictim->mutexJobs.unlock();
+		}
+	}
+
+	return(bFound);
+}
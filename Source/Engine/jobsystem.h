@@ -0,0 +1,92 @@
+#pragma once
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__
+
+//Library Includes
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+//Types
+typedef std::function<void()> TJob;
+
+//Prototypes
+class CJobSystem
+{
+	//Types
+private:
+	struct TWorker
+	{
+		std::deque<TJob> dequeJobs;
+		std::mutex mutexJobs;
+		std::thread thread;
+	};
+
+	struct TParallelFor
+	{
+		std::function<void(unsigned int)> fpTask;
+		unsigned int uiCount;
+		std::atomic<unsigned int> uiNext;
+		std::atomic<unsigned int> uiDone;
+		std::mutex mutexDone;
+		std::condition_variable cvDone;
+	};
+
+	//Member Functions
+public:
+	CJobSystem();
+	~CJobSystem();
+
+	//_fpThreadInit/_fpThreadExit run on each worker as it starts and stops (e.g. CoInitialize for WIC)
+	bool Initialize(unsigned int _uiWorkerCount, std::function<void()> _fpThreadInit = nullptr, std::function<void()> _fpThreadExit = nullptr);
+
+	//Stops and joins all workers, jobs that have not started are discarded
+	void Shutdown();
+
+	//Safe from any thread. Jobs submitted from a worker go to that worker's own deque
+	bool Submit(TJob _fpJob);
+
+	//Runs _fpTask for every index below _uiCount and returns once all of them have finished, on at most _uiMaxThreads (0 for no limit)
+	//The caller claims indices alongside the workers so it only ever waits on tasks that are running, safe from inside any job
+	//Returns the number of threads that took part
+	unsigned int ParallelFor(unsigned int _uiCount, unsigned int _uiMaxThreads, std::function<void(unsigned int)> _fpTask);
+
+	//Fork/join pool for work split up inside a load (mip rows, mesh conversion), one worker per extra core
+	//Kept apart from the asset loading pool, a loader waiting on its tasks never blocks other loads
+	static CJobSystem& GetParallelPool();
+
+	unsigned int GetPendingCount() const;
+	unsigned int GetWorkerCount() const;
+	int GetCurrentWorker() const; //Index of the calling worker, -1 if the caller isn't one of ours
+	bool IsRunning() const;
+
+private:
+	CJobSystem(const CJobSystem& _rhs) = delete;
+
+	void WorkerThread(unsigned int _uiWorkerIndex);
+	bool PopJob(unsigned int _uiWorkerIndex, TJob& _rJob);
+
+	static void RunParallelTasks(TParallelFor& _rState);
+
+	//Member Variables
+private:
+	std::vector<TWorker*> m_vecWorkers;
+	std::atomic<unsigned int> m_uiNextWorker; //Round robin target for jobs from outside the pool
+	std::atomic<unsigned int> m_uiPendingJobs;
+	std::atomic_bool m_bRunning;
+
+	//Idle workers sleep here until a job is submitted or the pool shuts down
+	std::mutex m_mutexSleep;
+	std::condition_variable m_cvWork;
+
+	std::function<void()> m_fpThreadInit;
+	std::function<void()> m_fpThreadExit;
+
+};
+
+#endif //__JOB_SYSTEM_H__
@@ -0,0 +1,242 @@
+//Library Includes
+#include <stdio.h>
+#include <algorithm>
+
+//Local Includes
+#include "common.h"
+#include "logmanager.h"
+
+//This Include
+#include "loadtelemetry.h"
+
+//Static Variables
+static const std::chrono::steady_clock::time_point s_ktClockStart = std::chrono::steady_clock::now();
+static thread_local TLoadRecord* tl_ptCurrentRecord = nullptr;
+
+static const char* s_kpcStageNames[ELoadStage_MAX] = { "read", "decode", "convert", "upload", "cook" };
+static const unsigned int s_kuiSlowestShown = 5;
+
+//Helpers
+//Asset names are paths, backslashes and quotes need escaping
+static std::string EscapeJSON(const std::string& _rstrText)
+{
+	std::string strEscaped;
+	strEscaped.reserve(_rstrText.size() + 8);
+
+	for(char c : _rstrText)
+	{
+		if(c == '\\' || c == '"') strEscaped += '\\';
+		if((unsigned char)c >= 0x20) strEscaped += c;
+	}
+
+	return(strEscaped);
+}
+
+//Implementation
+double
+TLoadRecord::GetStageMs(ELoadStage _eStage) const
+{
+	double dTotalMs = 0.0;
+	for(const TLoadStage& rtStage : vecStages)
+	{
+		if(rtStage.eStage == _eStage) dTotalMs += rtStage.dDurationMs;
+	}
+
+	return(dTotalMs);
+}
+
+CLoadTelemetry::CLoadTelemetry()
+{
+	//Constructor
+}
+
+CLoadTelemetry::~CLoadTelemetry()
+{
+	//Destructor
+}
+
+double
+CLoadTelemetry::GetTimeMs()
+{
+	return(GetTimeMs(std::chrono::steady_clock::now()));
+}
+
+double
+CLoadTelemetry::GetTimeMs(const std::chrono::steady_clock::time_point& _rtTime)
+{
+	return(std::chrono::duration<double, std::milli>(_rtTime - s_ktClockStart).count());
+}
+
+TLoadRecord*
+CLoadTelemetry::SetCurrentRecord(TLoadRecord* _ptRecord)
+{
+	TLoadRecord* ptPrevious = tl_ptCurrentRecord;
+	tl_ptCurrentRecord = _ptRecord;
+
+	return(ptPrevious);
+}
+
+void
+CLoadTelemetry::AddStage(ELoadStage _eStage, const std::chrono::steady_clock::time_point& _rtStart)
+{
+	if(!tl_ptCurrentRecord) return;
+
+	TLoadStage tStage;
+	tStage.eStage = _eStage;
+	tStage.dStartMs = GetTimeMs(_rtStart);
+	tStage.dDurationMs = GetTimeMs() - tStage.dStartMs;
+	tl_ptCurrentRecord->vecStages.push_back(tStage);
+}
+
+void
+CLoadTelemetry::AddBytesIn(size_t _uiBytes)
+{
+	if(tl_ptCurrentRecord) tl_ptCurrentRecord->uiBytesIn += _uiBytes;
+}
+
+void
+CLoadTelemetry::AddRecord(const TLoadRecord& _rtRecord)
+{
+	std::lock_guard<std::mutex> lockRecords(m_mutexRecords);
+	if(m_dequeRecords.size() >= sm_kuiMaxRecords) m_dequeRecords.pop_front();
+	m_dequeRecords.push_back(_rtRecord);
+}
+
+void
+CLoadTelemetry::GetRecords(std::vector<TLoadRecord>& _rvecRecords) const
+{
+	std::lock_guard<std::mutex> lockRecords(m_mutexRecords);
+	_rvecRecords.assign(m_dequeRecords.begin(), m_dequeRecords.end());
+}
+
+bool
+CLoadTelemetry::FindRecord(const char* _kpcName, TLoadRecord& _rtRecord) const
+{
+	if(!_kpcName) return(false);
+
+	std::lock_guard<std::mutex> lockRecords(m_mutexRecords);
+	for(auto it = m_dequeRecords.rbegin(); it != m_dequeRecords.rend(); ++it)
+	{
+		if(it->strName != _kpcName) continue;
+
+		_rtRecord = *it;
+		return(true);
+	}
+
+	return(false);
+}
+
+void
+CLoadTelemetry::Clear()
+{
+	std::lock_guard<std::mutex> lockRecords(m_mutexRecords);
+	m_dequeRecords.clear();
+}
+
+void
+CLoadTelemetry::WriteSummary() const
+{
+	std::vector<TLoadRecord> vecRecords;
+	GetRecords(vecRecords);
+	if(vecRecords.empty()) return;
+
+	double pdStageMs[ELoadStage_MAX] = {};
+	double dQueueMs = 0.0;
+	double dFirstQueuedMs = vecRecords[0].dQueuedMs;
+	double dLastEndMs = vecRecords[0].dEndMs;
+	size_t uiBytesIn = 0;
+	size_t uiBytesOut = 0;
+	unsigned int uiFailed = 0;
+
+	for(const TLoadRecord& rtRecord : vecRecords)
+	{
+		for(unsigned int i = 0; i < ELoadStage_MAX; ++i) pdStageMs[i] += rtRecord.GetStageMs((ELoadStage)i);
+		dQueueMs += rtRecord.GetQueueMs();
+		dFirstQueuedMs = min(dFirstQueuedMs, rtRecord.dQueuedMs);
+		dLastEndMs = max(dLastEndMs, rtRecord.dEndMs);
+		uiBytesIn += rtRecord.uiBytesIn;
+		uiBytesOut += rtRecord.uiBytesOut;
+		if(!rtRecord.bLoaded) ++uiFailed;
+	}
+
+	//Stage totals are summed over every worker, so together they can add up to more than the wall time
+	char pcLine[512];
+	sprintf_s(pcLine, "%zu loads (%u failed) over %.2fms wall, %.2fMB in, %.2fMB out\n", vecRecords.size(), uiFailed,
+		dLastEndMs - dFirstQueuedMs, uiBytesIn / (1024.0 * 1024.0), uiBytesOut / (1024.0 * 1024.0));
+	CLogManager::GetInstance().WriteDebug(pcLine, "Load Telemetry");
+
+	sprintf_s(pcLine, "  queued %.2fms, read %.2fms, decode %.2fms, convert %.2fms, upload %.2fms, cook %.2fms\n", dQueueMs,
+		pdStageMs[LOAD_STAGE_READ], pdStageMs[LOAD_STAGE_DECODE], pdStageMs[LOAD_STAGE_CONVERT], pdStageMs[LOAD_STAGE_UPLOAD], pdStageMs[LOAD_STAGE_COOK]);
+	CLogManager::GetInstance().WriteDebug(pcLine, "Load Telemetry");
+
+	//Slowest first
+	std::sort(vecRecords.begin(), vecRecords.end(), [](const TLoadRecord& _rtLeft, const TLoadRecord& _rtRight) { return(_rtLeft.GetLoadMs() > _rtRight.GetLoadMs()); });
+	for(unsigned int i = 0; i < vecRecords.size() && i < s_kuiSlowestShown; ++i)
+	{
+		const TLoadRecord& rtRecord = vecRecords[i];
+		sprintf_s(pcLine, "  %.2fms after %.2fms queued on worker %d: %s\n", rtRecord.GetLoadMs(), rtRecord.GetQueueMs(), rtRecord.iWorker, rtRecord.strName.c_str());
+		CLogManager::GetInstance().WriteDebug(pcLine, "Load Telemetry");
+	}
+}
+
+bool
+CLoadTelemetry::ExportChromeTrace(const char* _kpcFilename) const
+{
+	std::vector<TLoadRecord> vecRecords;
+	GetRecords(vecRecords);
+
+	FILE* pFile = nullptr;
+	if(fopen_s(&pFile, _kpcFilename, "w") != 0 || !pFile) return(false);
+
+	//Workers get a track each, tid 0 is whichever thread loaded without the pool
+	int iMaxWorker = -1;
+	for(const TLoadRecord& rtRecord : vecRecords) iMaxWorker = max(iMaxWorker, rtRecord.iWorker);
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	fprintf(pFile, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Asset Loading\"}},\n");
+	fprintf(pFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"Calling thread\"}}");
+	for(int i = 0; i <= iMaxWorker; ++i)
+	{
+		fprintf(pFile, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Loader %d\"}}", i + 1, i);
+	}
+
+	//Timestamps are in microseconds
+	for(unsigned int i = 0; i < vecRecords.size(); ++i)
+	{
+		const TLoadRecord& rtRecord = vecRecords[i];
+		std::string strName = EscapeJSON(rtRecord.strName);
+		int iThread = rtRecord.iWorker + 1;
+
+		//Waits overlap each other, async spans keep them off the worker tracks
+		if(rtRecord.GetQueueMs() > 0.0)
+		{
+			fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"queue\",\"ph\":\"b\",\"id\":%u,\"ts\":%.3f,\"pid\":1,\"tid\":%d}", strName.c_str(), i, rtRecord.dQueuedMs * 1000.0, iThread);
+			fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"queue\",\"ph\":\"e\",\"id\":%u,\"ts\":%.3f,\"pid\":1,\"tid\":%d}", strName.c_str(), i, rtRecord.dStartMs * 1000.0, iThread);
+		}
+
+		fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"loaded\":%s,\"queueMs\":%.3f,\"bytesIn\":%zu,\"bytesOut\":%zu}}",
+			strName.c_str(), GetAssetTypeName(rtRecord.eType), rtRecord.dStartMs * 1000.0, rtRecord.GetLoadMs() * 1000.0, iThread,
+			rtRecord.bLoaded ? "true" : "false", rtRecord.GetQueueMs(), rtRecord.uiBytesIn, rtRecord.uiBytesOut);
+
+		for(const TLoadStage& rtStage : rtRecord.vecStages)
+		{
+			fprintf(pFile, ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+				GetStageName(rtStage.eStage), rtStage.dStartMs * 1000.0, rtStage.dDurationMs * 1000.0, iThread);
+		}
+	}
+
+	fprintf(pFile, "\n]}\n");
+	bool bWritten = ferror(pFile) == 0;
+	fclose(pFile);
+
+	std::string debug = std::string(bWritten ? "Wrote load trace: " : "Failed to write load trace: ") + _kpcFilename + "\n";
+	CLogManager::GetInstance().WriteDebug(debug.c_str(), "Load Telemetry");
+
+	return(bWritten);
+}
+
+const char*
+CLoadTelemetry::GetStageName(ELoadStage _eStage)
+{
+	return((_eStage >= 0 && _eStage < ELoadStage_MAX) ? s_kpcStageNames[_eStage] : "unknown");
+}
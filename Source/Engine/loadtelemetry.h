@@ -0,0 +1,108 @@
+#pragma once
+#ifndef __LOAD_TELEMETRY_H__
+#define __LOAD_TELEMETRY_H__
+
+//Library Includes
+#include <vector>
+#include <deque>
+#include <string>
+#include <mutex>
+#include <chrono>
+
+//Local Includes
+#include "asset.h"
+
+//Timeline of every asset load: time spent queued, each loader stage, bytes read and bytes left resident, and the worker it ran on
+//The asset manager opens a record around IAsset::Load, loaders add their stages to whatever record is open on their thread
+//Loads outside the asset manager (the cooker, mip streaming) have no record open and aren't tracked
+//
+//Records can be read back at runtime or exported as Chrome trace events, open the file in chrome://tracing or Perfetto
+
+//Types
+enum ELoadStage
+{
+	LOAD_STAGE_READ,	//Opening or mapping the file
+	LOAD_STAGE_DECODE,	//Assimp import or WIC decode, these read the file themselves
+	LOAD_STAGE_CONVERT,	//CPU side conversion, mesh copies and mip generation
+	LOAD_STAGE_UPLOAD,	//Creating GPU resources and queueing their data, the data itself goes up between frames
+	LOAD_STAGE_COOK,	//Writing the cook for the next launch
+
+	ELoadStage_MAX
+};
+
+struct TLoadStage
+{
+	ELoadStage eStage;
+	double dStartMs;
+	double dDurationMs;
+};
+
+struct TLoadRecord
+{
+	std::string strName;
+	EAssetType eType;
+	int iWorker;		//Asset manager worker, -1 for loads run on the calling thread
+	bool bLoaded;
+
+	//Milliseconds since the telemetry clock started, a load that never queued has dQueuedMs == dStartMs
+	double dQueuedMs;
+	double dStartMs;
+	double dEndMs;
+
+	size_t uiBytesIn;	//Read or mapped from disk
+	size_t uiBytesOut;	//Resident once loaded, CPU and GPU
+	std::vector<TLoadStage> vecStages;
+
+	TLoadRecord() : eType(EAssetType_ERROR), iWorker(-1), bLoaded(false), dQueuedMs(0.0), dStartMs(0.0), dEndMs(0.0), uiBytesIn(0), uiBytesOut(0) {}
+
+	double GetQueueMs() const { return(dStartMs - dQueuedMs); }
+	double GetLoadMs() const { return(dEndMs - dStartMs); }
+	double GetStageMs(ELoadStage _eStage) const;
+};
+
+//Prototypes
+class CLoadTelemetry
+{
+	//Member Functions
+public:
+	CLoadTelemetry();
+	~CLoadTelemetry();
+
+	//Telemetry clock, shared by every record
+	static double GetTimeMs();
+	static double GetTimeMs(const std::chrono::steady_clock::time_point& _rtTime);
+
+	//Opens a record on this thread, returns the one it replaces so nested loads can put it back
+	static TLoadRecord* SetCurrentRecord(TLoadRecord* _ptRecord);
+
+	//Loader side, both do nothing when no record is open on this thread. A stage runs from _rtStart until now
+	static void AddStage(ELoadStage _eStage, const std::chrono::steady_clock::time_point& _rtStart);
+	static void AddBytesIn(size_t _uiBytes);
+
+	//Finished records, the oldest are dropped past sm_kuiMaxRecords
+	void AddRecord(const TLoadRecord& _rtRecord);
+	void GetRecords(std::vector<TLoadRecord>& _rvecRecords) const;
+	bool FindRecord(const char* _kpcName, TLoadRecord& _rtRecord) const; //Most recent load of the asset
+	void Clear();
+
+	//Per stage totals and the slowest loads to the debug log
+	void WriteSummary() const;
+
+	//Chrome trace event JSON, one track per worker with each load's stages nested under it and queue waits as async spans
+	bool ExportChromeTrace(const char* _kpcFilename) const;
+
+	static const char* GetStageName(ELoadStage _eStage);
+
+private:
+	CLoadTelemetry(const CLoadTelemetry& _rhs) = delete;
+
+	//Member Variables
+private:
+	static const size_t sm_kuiMaxRecords = 8192;
+
+	mutable std::mutex m_mutexRecords;
+	std::deque<TLoadRecord> m_dequeRecords;
+
+};
+
+#endif //__LOAD_TELEMETRY_H__
@@ -0,0 +1,175 @@
+//Library Includes
+#include <string.h>
+
+//This Include
+#include "lzcompress.h"
+
+//Static Variables
+static const size_t s_kuiMinMatch = 4;
+static const size_t s_kuiLastLiterals = 5;		//The format ends every block on at least this many literals
+static const size_t s_kuiMatchStartLimit = 12;	//and starts no match closer to the end than this
+static const size_t s_kuiMaxOffset = 65535;
+static const unsigned int s_kuiHashBits = 12;
+static const unsigned int s_kuiSkipShift = 6;	//Steps further through data that isn't matching, every 64 misses adds a byte
+
+//Helpers
+static inline uint32_t Read32(const uint8_t* _pData)
+{
+	uint32_t uiValue;
+	memcpy(&uiValue, _pData, sizeof(uint32_t));
+	return(uiValue);
+}
+
+static inline uint32_t HashSequence(uint32_t _uiSequence)
+{
+	return((_uiSequence * 2654435761u) >> (32 - s_kuiHashBits));
+}
+
+//Lengths past the token's nibble go on as 255s and a final byte below that
+static inline void WriteLength(uint8_t*& _rpOutput, size_t _uiLength)
+{
+	for(; _uiLength >= 255; _uiLength -= 255) *_rpOutput++ = 255;
+	*_rpOutput++ = (uint8_t)_uiLength;
+}
+
+static inline bool ReadLength(const uint8_t*& _rpInput, const uint8_t* _pInputEnd, size_t& _ruiLength)
+{
+	uint8_t uiByte = 255;
+	while(uiByte == 255)
+	{
+		if(_rpInput >= _pInputEnd) return(false);
+		uiByte = *_rpInput++;
+		_ruiLength += uiByte;
+	}
+
+	return(true);
+}
+
+//Token, literals, then the match. The last sequence of a block has no match, _uiMatch == 0
+static bool WriteSequence(uint8_t*& _rpOutput, const uint8_t* _pOutputEnd, const uint8_t* _pLiterals, size_t _uiLiterals, size_t _uiOffset, size_t _uiMatch)
+{
+	size_t uiMatchCode = _uiMatch ? _uiMatch - s_kuiMinMatch : 0;
+	size_t uiNeeded = 1 + _uiLiterals / 255 + 1 + _uiLiterals + (_uiMatch ? 2 + uiMatchCode / 255 + 1 : 0);
+	if(uiNeeded > (size_t)(_pOutputEnd - _rpOutput)) return(false);
+
+	uint8_t* pToken = _rpOutput++;
+	*pToken = (uint8_t)((_uiLiterals < 15 ? _uiLiterals : 15) << 4);
+	if(_uiLiterals >= 15) WriteLength(_rpOutput, _uiLiterals - 15);
+
+	memcpy(_rpOutput, _pLiterals, _uiLiterals);
+	_rpOutput += _uiLiterals;
+	if(!_uiMatch) return(true);
+
+	//Little endian offset back from the start of the match
+	*_rpOutput++ = (uint8_t)(_uiOffset & 0xFF);
+	*_rpOutput++ = (uint8_t)(_uiOffset >> 8);
+
+	*pToken |= (uint8_t)(uiMatchCode < 15 ? uiMatchCode : 15);
+	if(uiMatchCode >= 15) WriteLength(_rpOutput, uiMatchCode - 15);
+
+	return(true);
+}
+
+//Implementation
+size_t
+LZCompressBound(size_t _uiSize)
+{
+	return(_uiSize + _uiSize / 255 + 16);
+}
+
+size_t
+LZCompress(const uint8_t* _pSource, size_t _uiSourceSize, uint8_t* _pDest, size_t _uiDestCapacity)
+{
+	if(!_pSource || !_pDest) return(0);
+
+	const uint8_t* pInput = _pSource;
+	const uint8_t* pInputEnd = _pSource + _uiSourceSize;
+	const uint8_t* pAnchor = _pSource;
+	uint8_t* pOutput = _pDest;
+	const uint8_t* pOutputEnd = _pDest + _uiDestCapacity;
+
+	//Last position seen for each hashed 4 byte sequence, offset by one so zero is empty
+	static const size_t s_kuiTableSize = (size_t)1 << s_kuiHashBits;
+	uint32_t puiTable[s_kuiTableSize] = {};
+
+	if(_uiSourceSize > s_kuiMatchStartLimit)
+	{
+		const uint8_t* pMatchStartLimit = pInputEnd - s_kuiMatchStartLimit;
+		const uint8_t* pMatchEndLimit = pInputEnd - s_kuiLastLiterals;
+		unsigned int uiMisses = 0;
+
+		while(pInput < pMatchStartLimit)
+		{
+			uint32_t uiSequence = Read32(pInput);
+			uint32_t& ruiSlot = puiTable[HashSequence(uiSequence)];
+			const uint8_t* pCandidate = ruiSlot ? _pSource + ruiSlot - 1 : nullptr;
+			ruiSlot = (uint32_t)(pInput - _pSource) + 1;
+
+			if(!pCandidate || (size_t)(pInput - pCandidate) > s_kuiMaxOffset || Read32(pCandidate) != uiSequence)
+			{
+				pInput += 1 + (uiMisses++ >> s_kuiSkipShift);
+				continue;
+			}
+
+			//Greedy, take the whole match and move on
+			size_t uiMatch = s_kuiMinMatch;
+			while(pInput + uiMatch < pMatchEndLimit && pCandidate[uiMatch] == pInput[uiMatch]) ++uiMatch;
+
+			if(!WriteSequence(pOutput, pOutputEnd, pAnchor, pInput - pAnchor, pInput - pCandidate, uiMatch)) return(0);
+
+			pInput += uiMatch;
+			pAnchor = pInput;
+			uiMisses = 0;
+		}
+	}
+
+	//Everything after the last match goes out as literals
+	if(!WriteSequence(pOutput, pOutputEnd, pAnchor, pInputEnd - pAnchor, 0, 0)) return(0);
+
+	return(pOutput - _pDest);
+}
+
+bool
+LZDecompress(const uint8_t* _pSource, size_t _uiSourceSize, uint8_t* _pDest, size_t _uiDestSize)
+{
+	if(!_pSource || !_pDest || !_uiSourceSize) return(false);
+
+	const uint8_t* pInput = _pSource;
+	const uint8_t* pInputEnd = _pSource + _uiSourceSize;
+	uint8_t* pOutput = _pDest;
+	uint8_t* pOutputEnd = _pDest + _uiDestSize;
+
+	while(true)
+	{
+		if(pInput >= pInputEnd) return(false);
+		uint8_t uiToken = *pInput++;
+
+		size_t uiLiterals = uiToken >> 4;
+		if(uiLiterals == 15 && !ReadLength(pInput, pInputEnd, uiLiterals)) return(false);
+		if(uiLiterals > (size_t)(pInputEnd - pInput) || uiLiterals > (size_t)(pOutputEnd - pOutput)) return(false);
+
+		memcpy(pOutput, pInput, uiLiterals);
+		pInput += uiLiterals;
+		pOutput += uiLiterals;
+
+		//The last sequence ends on its literals
+		if(pInput == pInputEnd) break;
+
+		if(pInputEnd - pInput < 2) return(false);
+		size_t uiOffset = pInput[0] | ((size_t)pInput[1] << 8);
+		pInput += 2;
+		if(uiOffset == 0 || uiOffset > (size_t)(pOutput - _pDest)) return(false);
+
+		size_t uiMatch = uiToken & 0x0F;
+		if(uiMatch == 15 && !ReadLength(pInput, pInputEnd, uiMatch)) return(false);
+		uiMatch += s_kuiMinMatch;
+		if(uiMatch > (size_t)(pOutputEnd - pOutput)) return(false);
+
+		//Byte at a time, matches may overlap what they are writing
+		const uint8_t* pMatch = pOutput - uiOffset;
+		for(size_t i = 0; i < uiMatch; ++i) pOutput[i] = pMatch[i];
+		pOutput += uiMatch;
+	}
+
+	return(pOutput == pOutputEnd);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef __LZ_COMPRESS_H__
+#define __LZ_COMPRESS_H__
+
+//Library Includes
+#include <stdint.h>
+#include <stddef.h>
+
+//LZ4 block format, used for pak chunks
+//Greedy matching through a small hash table, built for decode speed over ratio. Blocks are independent, there is no frame or checksum
+//Decompression checks every length against both buffers, a corrupt block fails instead of reading or writing out of bounds
+
+//Prototypes
+//Worst case compressed size for _uiSize bytes of input
+size_t LZCompressBound(size_t _uiSize);
+
+//Returns the compressed size, 0 if it didn't fit in _uiDestCapacity
+size_t LZCompress(const uint8_t* _pSource, size_t _uiSourceSize, uint8_t* _pDest, size_t _uiDestCapacity);
+
+//_uiDestSize is the exact decompressed size, false if the block is malformed or decompresses to any other size
+bool LZDecompress(const uint8_t* _pSource, size_t _uiSourceSize, uint8_t* _pDest, size_t _uiDestSize);
+
+#endif //__LZ_COMPRESS_H__
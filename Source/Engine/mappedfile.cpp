@@ -0,0 +1,115 @@
+//This Include
+#include "mappedfile.h"
+
+//Implementation
+CMappedFile::CMappedFile()
+	: m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(NULL)
+	, m_pData(nullptr)
+	, m_uiSize(0)
+{
+	//Constructor
+}
+
+CMappedFile::~CMappedFile()
+{
+	//Destructor
+	Close();
+}
+
+bool
+CMappedFile::Open(const char* _kpcFilename)
+{
+	Close();
+	if(!_kpcFilename) return(false);
+
+	//Sequential scan hints read ahead, cooked files are read front to back
+	m_hFile = CreateFileA(_kpcFilename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(m_hFile == INVALID_HANDLE_VALUE) return(false);
+
+	//Zero sized files can't be mapped
+	LARGE_INTEGER liSize;
+	if(GetFileSizeEx(m_hFile, &liSize) && liSize.QuadPart > 0)
+	{
+		m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if(m_hMapping) m_pData = static_cast<const BYTE*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+		if(m_pData) m_uiSize = (size_t)liSize.QuadPart;
+	}
+
+	if(!m_pData) Close();
+	return(m_pData != nullptr);
+}
+
+void
+CMappedFile::OpenView(const BYTE* _pData, size_t _uiSize)
+{
+	Close();
+	m_pData = _pData;
+	m_uiSize = _pData ? _uiSize : 0;
+}
+
+void
+CMappedFile::OpenBuffer(std::vector<BYTE>&& _rvecData)
+{
+	Close();
+	m_vecBuffer = std::move(_rvecData);
+	m_pData = m_vecBuffer.empty() ? nullptr : m_vecBuffer.data();
+	m_uiSize = m_vecBuffer.size();
+}
+
+void
+CMappedFile::Close()
+{
+	//Views and buffers have no mapping of their own
+	if(m_pData && m_hMapping) UnmapViewOfFile(m_pData);
+	if(m_hMapping) CloseHandle(m_hMapping);
+	if(m_hFile != INVALID_HANDLE_VALUE) CloseHandle(m_hFile);
+
+	m_pData = nullptr;
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+	m_uiSize = 0;
+	std::vector<BYTE>().swap(m_vecBuffer);
+}
+
+const BYTE*
+CMappedFile::GetData() const
+{
+	return(m_pData);
+}
+
+size_t
+CMappedFile::GetSize() const
+{
+	return(m_uiSize);
+}
+
+bool
+CMappedFile::IsOpen() const
+{
+	return(m_pData != nullptr);
+}
+
+size_t
+CMappedFile::GetHeapBytes() const
+{
+	return(m_vecBuffer.size());
+}
+
+unsigned long long
+CMappedFile::GetWriteTime(const char* _kpcFilename)
+{
+	WIN32_FILE_ATTRIBUTE_DATA tAttributes;
+	if(!_kpcFilename || !GetFileAttributesExA(_kpcFilename, GetFileExInfoStandard, &tAttributes)) return(0);
+
+	return(((unsigned long long)tAttributes.ftLastWriteTime.dwHighDateTime << 32) | tAttributes.ftLastWriteTime.dwLowDateTime);
+}
+
+unsigned long long
+CMappedFile::GetFileBytes(const char* _kpcFilename)
+{
+	WIN32_FILE_ATTRIBUTE_DATA tAttributes;
+	if(!_kpcFilename || !GetFileAttributesExA(_kpcFilename, GetFileExInfoStandard, &tAttributes)) return(0);
+
+	return(((unsigned long long)tAttributes.nFileSizeHigh << 32) | tAttributes.nFileSizeLow);
+}
@@ -0,0 +1,52 @@
+#pragma once
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+//Library Includes
+#include <windows.h>
+#include <vector>
+
+//Prototypes
+class CMappedFile
+{
+	//Member Functions
+public:
+	CMappedFile();
+	~CMappedFile();
+
+	//Maps the whole file read only, fails on missing or empty files
+	bool Open(const char* _kpcFilename);
+	void Close();
+
+	//Files that don't map one to one onto disk, both are used for pak entries
+	void OpenView(const BYTE* _pData, size_t _uiSize); //Borrowed, must outlive this
+	void OpenBuffer(std::vector<BYTE>&& _rvecData); //Owned, e.g. a decompressed file
+
+	//Valid until Close(), pages are read in by the OS as they are touched
+	const BYTE* GetData() const;
+	size_t GetSize() const;
+	bool IsOpen() const;
+
+	//System memory this holds on to, only owned buffers count. Mapped pages are backed by the file and the OS can drop them
+	size_t GetHeapBytes() const;
+
+	//Last write time as a 64bit FILETIME, 0 if the file doesn't exist
+	static unsigned long long GetWriteTime(const char* _kpcFilename);
+
+	//Size on disk without opening the file, 0 if it doesn't exist
+	static unsigned long long GetFileBytes(const char* _kpcFilename);
+
+private:
+	CMappedFile(const CMappedFile& _rhs) = delete;
+
+	//Member Variables
+private:
+	HANDLE m_hFile;
+	HANDLE m_hMapping;
+	const BYTE* m_pData;
+	size_t m_uiSize;
+	std::vector<BYTE> m_vecBuffer;
+
+};
+
+#endif //__MAPPED_FILE_H__
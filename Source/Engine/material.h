@@ -4,26 +4,24 @@
 
 //Local Includes
 #include "texture.h"
+#include "assetref.hpp"
 
 struct TMaterial
 {
 	//Variables
 	//TODO: support colors, methods or specific shader settings?
-	CTexture* pDiffuseTex;
-	CTexture* pNormalTex;
-	CTexture* pSpecularTex;
-	CTexture* pAOTex;
+	//Referenced so textures in use by a material are never evicted
+	CAssetRef<CTexture> pDiffuseTex;
+	CAssetRef<CTexture> pNormalTex;
+	CAssetRef<CTexture> pSpecularTex;
+	CAssetRef<CTexture> pAOTex;
 	bool bCastShadow;
 	bool bReceiveShadow;
 	bool bTransparent;
 
 	//Functions
 	TMaterial()
-		: pDiffuseTex(nullptr)
-		, pNormalTex(nullptr)
-		, pSpecularTex(nullptr)
-		, pAOTex(nullptr)
-		, bCastShadow(true)
+		: bCastShadow(true)
 		, bReceiveShadow(true)
 		, bTransparent(false)
 	{
@@ -5,11 +5,13 @@
 //Library Includes
 #include <DirectXCollision.h> //Included for Bounding Box/Sphere
 #include <vector>
+#include <utility>
 
 //Local Includes
 #include "common.h"
 #include "dxcommon.h"
 #include "imesh.h"
+#include "vertexdefs.h"
 #include "iinstancepool.h"
 #include "renderer.h"
 #include "ishader.h"
@@ -23,29 +25,47 @@
 template <typename TVertexType, typename TIndexType = DWORD>
 class CMesh final: public IMesh
 {
+	static_assert(sizeof(TIndexType) == sizeof(WORD) || sizeof(TIndexType) == sizeof(DWORD), "Index buffers are 16 or 32 bit");
+
 	//Member Functions
 public:
 	CMesh();
 	~CMesh();
 
-	//Init and create the buffer
+	//Init and create the buffer, safe from any thread. Non-writable data is queued for upload and the mesh draws once it is up
 	bool Initialize(CRenderer* _pRenderer, const TMeshData<CMESH_INSERT>& _rtMeshData);
 
-	//Draw functions
-	bool Draw(float4x4* _pmatWorld, IShader* _pShader = nullptr);
-	bool DrawInstanced(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, IShader* _pShader = nullptr);
+	//Trades buffers, data, bounds and material with _rOther so a reload can replace the mesh behind existing pointers
+	//Main thread, between frames. Both meshes are closed first
+	void Swap(CMesh& _rOther);
+
+	//False until the upload queue has put the buffer data on the GPU
+	bool IsUploaded() const;
+
+	//Draw functions, LOD 0 draws the index range
+	bool Draw(float4x4* _pmatWorld, IShader* _pShader = nullptr, unsigned int _uiLod = 0, const TMaterial* _ptMaterial = nullptr);
+	bool DrawInstanced(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, IShader* _pShader = nullptr, unsigned int _uiLod = 0,
+		const TMaterial* _ptMaterial = nullptr);
+	bool DrawRanges(float4x4* _pmatWorld, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount, IShader* _pShader = nullptr,
+		const TMaterial* _ptMaterial = nullptr);
+	bool DrawInstancedRanges(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount,
+		IShader* _pShader = nullptr, const TMaterial* _ptMaterial = nullptr);
 
 	//Binds the mesh to the Input Assembler Stage in prep for drawing
 	void BindToIA(IInstancePool* _pInstancePool = nullptr);
 
 	//Assign texture to mesh primitive
 	void SetMaterial(const TMaterial& _rtMaterial);
-	TMaterial GetMaterial() const;
+	const TMaterial& GetMaterial() const;
 	int GetMaterialId() const;
 
 	//TODO: BoundingBox/Sphere Gen
 	const DirectX::BoundingBox& GetBoundingBox() const;
 	const DirectX::BoundingSphere& GetBoundingSphere() const;
+	const DirectX::BoundingOrientedBox& GetOrientedBox() const;
+
+	//Object space units per UV unit, set from the mesh data
+	float GetUVDensity() const;
 
 	//Update topology
 	void SetTopology(D3D11_PRIMITIVE_TOPOLOGY _eTopology);
@@ -64,9 +84,18 @@ public:
 	unsigned int GetVertexCount() const;
 	unsigned int GetIndexCount() const;
 
+	//Levels of detail, a mesh created without any has LOD 0 over every index
+	unsigned int GetLodCount() const;
+	TMeshLod GetLod(unsigned int _uiLod) const;
+
+	//Clusters over LOD 0 for culling
+	unsigned int GetClusterCount() const;
+	const TMeshCluster* GetClusters() const;
+
 	//Get size of types
 	size_t GetVertexSize() const;
 	size_t GetIndexSize() const;
+	EVertexFormat GetVertexFormat() const;
 
 	//Read functions, returns NULL if not a readable mesh, or out of bounds
 	const TVertexType* GetVertex(unsigned int _uiVertex) const; //Returns single TVertexType
@@ -85,10 +114,12 @@ public:
 	bool CanWriteIB() const;
 
 protected:
-	bool InternalDraw(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, float4x4* _pmatWorld, IShader* _pShader);
+	bool InternalDraw(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, float4x4* _pmatWorld, IShader* _pShader, unsigned int _uiLod,
+		const TMaterial* _ptMaterial, const TRange<unsigned int>* _ptIndexRanges = nullptr, unsigned int _uiRangeCount = 0);
 	bool OpenBuffers(bool _bVBuffer, bool _bIBuffer = false);
 	bool CopyBuffers(bool _bVBuffer, bool _bIBuffer = false);
 	void CloseBuffers(bool _bVBuffer = true, bool _bIBuffer = true);
+	void CancelUploads(); //Before the buffers are released
 
 	//Member Variables
 protected:
@@ -98,6 +129,7 @@ protected:
 	//Primitive used for buffers and rendering
 	ID3D11Buffer* m_pVertexBuffer;
 	ID3D11Buffer* m_pIndexBuffer;
+	unsigned long long m_ullUploadFence; //Drawn once this completes
 	TRange<unsigned int> m_tVertexRange;
 	TRange<unsigned int> m_tIndexRange;
 
@@ -108,9 +140,11 @@ protected:
 	//BB and Bounding Sphere
 	DirectX::BoundingBox m_tBoundingBox;
 	DirectX::BoundingSphere m_tBoundingSphere;
+	DirectX::BoundingOrientedBox m_tOrientedBox;
 
 	//Readable Mesh Data
 	TMeshData<CMESH_INSERT> m_tMesh;
+	std::vector<TMeshCluster> m_vecClusters; //m_tMesh never points at clusters, they are kept here
 
 	//State for supporting write access
 	D3D11_MAPPED_SUBRESOURCE m_pMappedVBuffer;
@@ -129,6 +163,7 @@ CMesh<CMESH_INSERT>::CMesh()
 	: m_pRenderer(nullptr)
 	, m_pVertexBuffer(nullptr)
 	, m_pIndexBuffer(nullptr)
+	, m_ullUploadFence(0)
 	, m_tVertexRange(0, 0)
 	, m_tIndexRange(0, 0)
 	, m_iMaterialId(-1)
@@ -136,12 +171,12 @@ CMesh<CMESH_INSERT>::CMesh()
 	, m_bUpdateIBuffer(false)
 {
 	//Constructor
-	ZeroMemory(&m_tMaterial, sizeof(TMaterial));
 	ZeroMemory(&m_tMesh, sizeof(TMeshData<CMESH_INSERT>));
 	ZeroMemory(&m_pMappedVBuffer, sizeof(D3D11_MAPPED_SUBRESOURCE));
 	ZeroMemory(&m_pMappedIBuffer, sizeof(D3D11_MAPPED_SUBRESOURCE));
 	ZeroMemory(&m_tBoundingBox, sizeof(DirectX::BoundingBox));
 	ZeroMemory(&m_tBoundingSphere, sizeof(DirectX::BoundingSphere));
+	ZeroMemory(&m_tOrientedBox, sizeof(DirectX::BoundingOrientedBox));
 }
 
 CMESH_TEMPLATE
@@ -149,6 +184,7 @@ CMesh<CMESH_INSERT>::~CMesh()
 {
 	//Destructor
 	CloseBuffers(); //Close the buffers if they were open
+	CancelUploads(); //Data still queued for the buffers is dropped
 
 	m_pRenderer = nullptr;
 
@@ -156,8 +192,8 @@ CMesh<CMESH_INSERT>::~CMesh()
 	ReleaseCOM(m_pVertexBuffer);
 	ReleaseCOM(m_pIndexBuffer);
 
-	//Textures are handled by the Asset Manager, do not release or call delete[]
-	ZeroMemory(&m_tMaterial, sizeof(TMaterial));
+	//Textures are handled by the Asset Manager, only drop our references
+	m_tMaterial = TMaterial();
 
 	//Delete mesh data if any and zero the structure
 	SafeDeleteArray(m_tMesh.pVertices);
@@ -167,6 +203,7 @@ CMesh<CMESH_INSERT>::~CMesh()
 	ZeroMemory(&m_pMappedIBuffer, sizeof(D3D11_MAPPED_SUBRESOURCE));
 	ZeroMemory(&m_tBoundingBox, sizeof(DirectX::BoundingBox));
 	ZeroMemory(&m_tBoundingSphere, sizeof(DirectX::BoundingSphere));
+	ZeroMemory(&m_tOrientedBox, sizeof(DirectX::BoundingOrientedBox));
 }
 
 CMESH_TEMPLATE
@@ -187,11 +224,53 @@ bool CMesh<CMESH_INSERT>::Initialize(CRenderer* _pRenderer, const TMeshData<CMES
 	m_tVertexRange = {0, m_tMesh.uiVertexCount};
 	m_tIndexRange = {0, m_tMesh.uiIndexCount};
 	m_iMaterialId = _rtMeshData.iMaterialId;
+	m_tMesh.fUVDensity = _rtMeshData.fUVDensity;
 
-	//Set up bounding box and bounding sphere
+	//Levels must sit inside the index buffer, otherwise the mesh is a single level
+	m_tMesh.uiLodCount = min(_rtMeshData.uiLodCount, (UINT)MESH_MAX_LODS);
+	for(UINT i = 0; i < m_tMesh.uiLodCount; ++i)
+	{
+		m_tMesh.ptLods[i] = _rtMeshData.ptLods[i];
+		if(m_tMesh.ptLods[i].uiIndexStart + m_tMesh.ptLods[i].uiIndexCount > m_tMesh.uiIndexCount) m_tMesh.uiLodCount = 0;
+	}
+	if(m_tMesh.uiLodCount) m_tIndexRange = {m_tMesh.ptLods[0].uiIndexStart, m_tMesh.ptLods[0].uiIndexCount};
+
+	//Clusters must sit inside LOD 0, otherwise the mesh is only ever drawn whole
+	m_vecClusters.clear();
+	if(_rtMeshData.ptClusters) m_vecClusters.assign(_rtMeshData.ptClusters, _rtMeshData.ptClusters + _rtMeshData.uiClusterCount);
+	for(const TMeshCluster& rtCluster : m_vecClusters)
+	{
+		if(rtCluster.uiIndexStart < m_tIndexRange.a || rtCluster.uiIndexStart + rtCluster.uiIndexCount > m_tIndexRange.a + m_tIndexRange.b)
+		{
+			m_vecClusters.clear();
+			break;
+		}
+	}
+
+	//Set up bounding box, sphere and oriented box, the last two fall back to ones around the box when the data has none
 	m_tBoundingBox.Center = _rtMeshData.vec3BBCenter;
 	m_tBoundingBox.Extents = _rtMeshData.vec3BBExtends;
-	DirectX::BoundingSphere::CreateFromBoundingBox(m_tBoundingSphere, m_tBoundingBox);
+	if(_rtMeshData.fSphereRadius > 0.0f)
+	{
+		m_tBoundingSphere.Center = _rtMeshData.vec3SphereCenter;
+		m_tBoundingSphere.Radius = _rtMeshData.fSphereRadius;
+	}
+	else
+	{
+		DirectX::BoundingSphere::CreateFromBoundingBox(m_tBoundingSphere, m_tBoundingBox);
+	}
+
+	const float3& rvec3OBBExtends = _rtMeshData.vec3OBBExtends;
+	if(rvec3OBBExtends.x + rvec3OBBExtends.y + rvec3OBBExtends.z > 0.0f)
+	{
+		m_tOrientedBox.Center = _rtMeshData.vec3OBBCenter;
+		m_tOrientedBox.Extents = _rtMeshData.vec3OBBExtends;
+		m_tOrientedBox.Orientation = _rtMeshData.vec4OBBOrientation;
+	}
+	else
+	{
+		DirectX::BoundingOrientedBox::CreateFromBoundingBox(m_tOrientedBox, m_tBoundingBox);
+	}
 
 	//Buffer usage type, if mesh is writable, it needs to be a dynamic buffer
 	//TODO: Support staging and immutable?
@@ -223,15 +302,9 @@ bool CMesh<CMESH_INSERT>::Initialize(CRenderer* _pRenderer, const TMeshData<CMES
 			m_tMesh.pVertices = _rtMeshData.pVertices;
 		}
 
-		//Request GPU Lock as creating a buffer needs exclusive gpu access
-		m_pRenderer->GetGPUMutex().lock();
-
-		//Create vertex buffer
+		//Create vertex buffer, the data is copied by the upload queue so it can be freed once this returns
 		unsigned int uiVBufferSize = _rtMeshData.uiVertexCount * sizeof(TVertexType);
-		m_pVertexBuffer = m_pRenderer->CreateBuffer(D3D11_BIND_FLAG::D3D11_BIND_VERTEX_BUFFER, _rtMeshData.pVertices, uiVBufferSize, eVBufferUsage);
-
-		//Release GPU Lock here as other threads may need it while we continue logic here
-		m_pRenderer->GetGPUMutex().unlock();
+		m_pVertexBuffer = m_pRenderer->CreateBuffer(D3D11_BIND_FLAG::D3D11_BIND_VERTEX_BUFFER, _rtMeshData.pVertices, uiVBufferSize, eVBufferUsage, &m_ullUploadFence);
 
 		//Clean-up vertex array if we own it and don't need to read it, as we are now done with the vertex buffer
 		if(!CanReadVB() && _rtMeshData.bPointerOwnership) SafeDelete(m_tMesh.pVertices);
@@ -261,15 +334,11 @@ bool CMesh<CMESH_INSERT>::Initialize(CRenderer* _pRenderer, const TMeshData<CMES
 					m_tMesh.pIndices = _rtMeshData.pIndices;
 				}
 
-				//Request GPU Lock as creating a buffer needs exclusive gpu access
-				m_pRenderer->GetGPUMutex().lock();
-
-				//Create index buffer
+				//Create index buffer, queued after the vertices so its fence covers both
+				unsigned long long ullIndexFence = 0;
 				unsigned int uiIBufferSize = _rtMeshData.uiIndexCount * sizeof(TIndexType);
-				m_pIndexBuffer = m_pRenderer->CreateBuffer(D3D11_BIND_FLAG::D3D11_BIND_INDEX_BUFFER, _rtMeshData.pIndices, uiIBufferSize, eIBufferUsage);
-
-				//Release GPU Lock
-				m_pRenderer->GetGPUMutex().unlock();
+				m_pIndexBuffer = m_pRenderer->CreateBuffer(D3D11_BIND_FLAG::D3D11_BIND_INDEX_BUFFER, _rtMeshData.pIndices, uiIBufferSize, eIBufferUsage, &ullIndexFence);
+				if(ullIndexFence) m_ullUploadFence = ullIndexFence;
 
 				//Clean-up the index array if we own it and don't need to read it, as we are now done with the index buffer
 				if(!CanReadIB() && _rtMeshData.bPointerOwnership) SafeDelete(m_tMesh.pIndices);
@@ -290,6 +359,7 @@ bool CMesh<CMESH_INSERT>::Initialize(CRenderer* _pRenderer, const TMeshData<CMES
 	if(!bSuccessful)
 	{
 		ZeroMemory(&m_tMesh, sizeof(TMeshData<CMESH_INSERT>));
+		CancelUploads();
 		ReleaseCOM(m_pVertexBuffer);
 		ReleaseCOM(m_pIndexBuffer);
 	}
@@ -298,21 +368,72 @@ bool CMesh<CMESH_INSERT>::Initialize(CRenderer* _pRenderer, const TMeshData<CMES
 }
 
 CMESH_TEMPLATE
-bool CMesh<CMESH_INSERT>::Draw(float4x4* _pmatWorld, IShader* _pShader)
+void CMesh<CMESH_INSERT>::Swap(CMesh& _rOther)
+{
+	//Pending writes would land in the wrong buffer
+	CloseBuffers();
+	_rOther.CloseBuffers();
+
+	std::swap(m_pVertexBuffer, _rOther.m_pVertexBuffer);
+	std::swap(m_pIndexBuffer, _rOther.m_pIndexBuffer);
+	std::swap(m_ullUploadFence, _rOther.m_ullUploadFence);
+	std::swap(m_tVertexRange, _rOther.m_tVertexRange);
+	std::swap(m_tIndexRange, _rOther.m_tIndexRange);
+	std::swap(m_tMaterial, _rOther.m_tMaterial);
+	std::swap(m_iMaterialId, _rOther.m_iMaterialId);
+	std::swap(m_tBoundingBox, _rOther.m_tBoundingBox);
+	std::swap(m_tBoundingSphere, _rOther.m_tBoundingSphere);
+	std::swap(m_tOrientedBox, _rOther.m_tOrientedBox);
+	std::swap(m_tMesh, _rOther.m_tMesh);
+	std::swap(m_vecClusters, _rOther.m_vecClusters);
+	std::swap(m_bUpdateVBuffer, _rOther.m_bUpdateVBuffer);
+	std::swap(m_bUpdateIBuffer, _rOther.m_bUpdateIBuffer);
+
+	//An empty mesh has no renderer yet
+	if(!m_pRenderer) m_pRenderer = _rOther.m_pRenderer;
+}
+
+CMESH_TEMPLATE
+bool CMesh<CMESH_INSERT>::IsUploaded() const
+{
+	return(m_pRenderer && m_pRenderer->GetUploadQueue().IsComplete(m_ullUploadFence));
+}
+
+CMESH_TEMPLATE
+bool CMesh<CMESH_INSERT>::Draw(float4x4* _pmatWorld, IShader* _pShader, unsigned int _uiLod, const TMaterial* _ptMaterial)
 {
 	//Non-instanced draw call, ignoring the instancer and instance range
-	return(InternalDraw(nullptr, {0, 0}, _pmatWorld, _pShader));
+	return(InternalDraw(nullptr, {0, 0}, _pmatWorld, _pShader, _uiLod, _ptMaterial));
 }
 
 CMESH_TEMPLATE
-bool CMesh<CMESH_INSERT>::DrawInstanced(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, IShader* _pShader)
+bool CMesh<CMESH_INSERT>::DrawInstanced(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, IShader* _pShader, unsigned int _uiLod,
+	const TMaterial* _ptMaterial)
 {
 	//Call to draw ignoring matWorld
-	return(InternalDraw(_pInstancePool, _tInstanceRange, nullptr, _pShader));
+	return(InternalDraw(_pInstancePool, _tInstanceRange, nullptr, _pShader, _uiLod, _ptMaterial));
+}
+
+CMESH_TEMPLATE
+bool CMesh<CMESH_INSERT>::DrawRanges(float4x4* _pmatWorld, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount, IShader* _pShader,
+	const TMaterial* _ptMaterial)
+{
+	//Everything culled, nothing to set up
+	if(!_uiRangeCount) return(true);
+	return(InternalDraw(nullptr, {0, 0}, _pmatWorld, _pShader, 0, _ptMaterial, _ptIndexRanges, _uiRangeCount));
 }
 
 CMESH_TEMPLATE
-bool CMesh<CMESH_INSERT>::InternalDraw(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, float4x4* _pmatWorld, IShader* _pShader)
+bool CMesh<CMESH_INSERT>::DrawInstancedRanges(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount,
+	IShader* _pShader, const TMaterial* _ptMaterial)
+{
+	if(!_uiRangeCount) return(true);
+	return(InternalDraw(_pInstancePool, _tInstanceRange, nullptr, _pShader, 0, _ptMaterial, _ptIndexRanges, _uiRangeCount));
+}
+
+CMESH_TEMPLATE
+bool CMesh<CMESH_INSERT>::InternalDraw(IInstancePool* _pInstancePool, TRange<unsigned int> _tInstanceRange, float4x4* _pmatWorld, IShader* _pShader, unsigned int _uiLod,
+	const TMaterial* _ptMaterial, const TRange<unsigned int>* _ptIndexRanges, unsigned int _uiRangeCount)
 {
 	//This function is convoluted because separating both to Draw/DrawInstanced just duplicates code for no valid reason
 	bool bSuccessful = false;
@@ -327,11 +448,11 @@ bool CMesh<CMESH_INSERT>::InternalDraw(IInstancePool* _pInstancePool, TRange<uns
 	//	Calling CloseBuffers() has minimal perf impact as it silently fails if buffers are already closed.
 	CloseBuffers();
 
-	//Pointer checks for renderer and the incoming params
-	if(m_pRenderer && m_pRenderer->GetDeviceContext() && pShader)
+	//Pointer checks for renderer and the incoming params, skipped until the buffers have been uploaded
+	if(m_pRenderer && m_pRenderer->IsDeviceReady() && pShader && m_pRenderer->GetUploadQueue().IsComplete(m_ullUploadFence))
 	{
 		//Prep the shader for drawing us
-		if(pShader->Predraw(this, _pmatWorld, (_pInstancePool != nullptr)))
+		if(pShader->Predraw(this, _pmatWorld, (_pInstancePool != nullptr), _ptMaterial))
 		{
 			//Bind our mesh to the Input assembler stage
 			BindToIA(_pInstancePool);
@@ -339,13 +460,22 @@ bool CMesh<CMESH_INSERT>::InternalDraw(IInstancePool* _pInstancePool, TRange<uns
 			//Select appropriate draw function
 			if(m_pIndexBuffer)
 			{
-				if(!_pInstancePool) m_pRenderer->GetDeviceContext()->DrawIndexed(m_tIndexRange.b, m_tIndexRange.a, 0);
-				else m_pRenderer->GetDeviceContext()->DrawIndexedInstanced(m_tIndexRange.b, _tInstanceRange.b, m_tIndexRange.a, 0, _tInstanceRange.a);
+				TRange<unsigned int> tIndexRange = m_tIndexRange;
+				if(_uiLod && _uiLod < m_tMesh.uiLodCount) tIndexRange = {m_tMesh.ptLods[_uiLod].uiIndexStart, m_tMesh.ptLods[_uiLod].uiIndexCount};
+
+				//Given ranges replace the index range, one draw each
+				const TRange<unsigned int>* ptRanges = _ptIndexRanges ? _ptIndexRanges : &tIndexRange;
+				unsigned int uiRangeCount = _ptIndexRanges ? _uiRangeCount : 1;
+				for(unsigned int i = 0; i < uiRangeCount; ++i)
+				{
+					if(!_pInstancePool) m_pRenderer->DrawIndexed(ptRanges[i].b, ptRanges[i].a, 0);
+					else m_pRenderer->DrawIndexedInstanced(ptRanges[i].b, _tInstanceRange.b, ptRanges[i].a, 0, _tInstanceRange.a);
+				}
 			}
 			else
 			{
-				if(!_pInstancePool) m_pRenderer->GetDeviceContext()->Draw(m_tVertexRange.b, m_tVertexRange.a);
-				else m_pRenderer->GetDeviceContext()->DrawInstanced(m_tVertexRange.b, _tInstanceRange.b, m_tVertexRange.a, _tInstanceRange.a);
+				if(!_pInstancePool) m_pRenderer->Draw(m_tVertexRange.b, m_tVertexRange.a);
+				else m_pRenderer->DrawInstanced(m_tVertexRange.b, _tInstanceRange.b, m_tVertexRange.a, _tInstanceRange.a);
 			}
 
 			bSuccessful = true; //Assume success as there are no checks past here to determine that
@@ -360,9 +490,9 @@ CMESH_TEMPLATE
 void CMesh<CMESH_INSERT>::BindToIA(IInstancePool* _pInstancePool)
 {
 	//Verify renderer and context are available
-	if(m_pRenderer && m_pRenderer->GetDeviceContext())
+	if(m_pRenderer && m_pRenderer->IsDeviceReady())
 	{
-		DXGI_FORMAT eIndexFormat = DXGI_FORMAT_R32_UINT; //TODO: Match this to TIndexType
+		DXGI_FORMAT eIndexFormat = (sizeof(TIndexType) == sizeof(WORD)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
 		
 		//_pMeshInstancer may be null, but having [2] doesn't harm anything performance/memory wise, so this works fine
 		unsigned int uiStrides[2] = {sizeof(TVertexType), _pInstancePool ? _pInstancePool->GetStride() : 0};
@@ -370,9 +500,9 @@ void CMesh<CMESH_INSERT>::BindToIA(IInstancePool* _pInstancePool)
 		ID3D11Buffer* const pBuffers[2] = {m_pVertexBuffer, _pInstancePool ? _pInstancePool->GetBuffer() : nullptr};
 
 		//Bind this mesh to the IA Stage for rendering. Only need to set if we use it during draw, set buffers are ignored if not drawn
-		m_pRenderer->GetDeviceContext()->IASetPrimitiveTopology(m_tMesh.tVertexTopology);
-		if(m_pVertexBuffer) m_pRenderer->GetDeviceContext()->IASetVertexBuffers(0, _pInstancePool ? 2 : 1, pBuffers, uiStrides, uiOffsets);
-		if(m_pIndexBuffer) m_pRenderer->GetDeviceContext()->IASetIndexBuffer(m_pIndexBuffer, eIndexFormat, 0);
+		m_pRenderer->SetPrimitiveTopology(m_tMesh.tVertexTopology);
+		if(m_pVertexBuffer) m_pRenderer->SetVertexBuffers(0, _pInstancePool ? 2 : 1, pBuffers, uiStrides, uiOffsets);
+		if(m_pIndexBuffer) m_pRenderer->SetIndexBuffer(m_pIndexBuffer, eIndexFormat, 0);
 	}
 }
 
@@ -383,7 +513,7 @@ void CMesh<CMESH_INSERT>::SetMaterial(const TMaterial& _rtMaterial)
 }
 
 CMESH_TEMPLATE
-TMaterial CMesh<CMESH_INSERT>::GetMaterial() const
+const TMaterial& CMesh<CMESH_INSERT>::GetMaterial() const
 {
 	return(m_tMaterial);
 }
@@ -406,6 +536,18 @@ const DirectX::BoundingSphere& CMesh<CMESH_INSERT>::GetBoundingSphere() const
 	return(m_tBoundingSphere);
 }
 
+CMESH_TEMPLATE
+const DirectX::BoundingOrientedBox& CMesh<CMESH_INSERT>::GetOrientedBox() const
+{
+	return(m_tOrientedBox);
+}
+
+CMESH_TEMPLATE
+float CMesh<CMESH_INSERT>::GetUVDensity() const
+{
+	return(m_tMesh.fUVDensity);
+}
+
 CMESH_TEMPLATE
 void CMesh<CMESH_INSERT>::SetTopology(D3D11_PRIMITIVE_TOPOLOGY _eTopology)
 {
@@ -478,6 +620,35 @@ unsigned int CMesh<CMESH_INSERT>::GetIndexCount() const
 	return(m_tMesh.uiIndexCount);
 }
 
+CMESH_TEMPLATE
+unsigned int CMesh<CMESH_INSERT>::GetLodCount() const
+{
+	return(max(m_tMesh.uiLodCount, 1u));
+}
+
+CMESH_TEMPLATE
+TMeshLod CMesh<CMESH_INSERT>::GetLod(unsigned int _uiLod) const
+{
+	if(_uiLod < m_tMesh.uiLodCount) return(m_tMesh.ptLods[_uiLod]);
+
+	//Single level over the whole buffer, counted in vertices when there are no indices
+	TMeshLod tLod;
+	tLod.uiIndexCount = m_pIndexBuffer ? m_tMesh.uiIndexCount : m_tMesh.uiVertexCount;
+	return(tLod);
+}
+
+CMESH_TEMPLATE
+unsigned int CMesh<CMESH_INSERT>::GetClusterCount() const
+{
+	return((unsigned int)m_vecClusters.size());
+}
+
+CMESH_TEMPLATE
+const TMeshCluster* CMesh<CMESH_INSERT>::GetClusters() const
+{
+	return(m_vecClusters.empty() ? nullptr : m_vecClusters.data());
+}
+
 CMESH_TEMPLATE
 size_t CMesh<CMESH_INSERT>::GetVertexSize() const
 {
@@ -490,6 +661,12 @@ size_t CMesh<CMESH_INSERT>::GetIndexSize() const
 	return(sizeof(TIndexType));
 }
 
+CMESH_TEMPLATE
+EVertexFormat CMesh<CMESH_INSERT>::GetVertexFormat() const
+{
+	return(TVertexFormatOf<TVertexType>::keFormat);
+}
+
 CMESH_TEMPLATE
 const TVertexType* CMesh<CMESH_INSERT>::GetVertex(unsigned int _uiVertex) const
 {
@@ -619,18 +796,18 @@ CMESH_TEMPLATE
 bool CMesh<CMESH_INSERT>::OpenBuffers(bool _bVBuffer, bool _bIBuffer)
 {
 	//Verify renderer and context are available
-	if(m_pRenderer && m_pRenderer->GetDeviceContext())
+	if(m_pRenderer && m_pRenderer->IsDeviceReady())
 	{
 		//If _bVBuffer, check to see if we can write and that the buffer isn't already open
 		if(_bVBuffer && CanWriteVB() && !m_pMappedVBuffer.pData)
 		{
-			m_pRenderer->GetDeviceContext()->Map(m_pVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &m_pMappedVBuffer);
+			m_pRenderer->Map(m_pVertexBuffer, D3D11_MAP_WRITE_DISCARD, &m_pMappedVBuffer);
 		}
 
 		//If _bIBuffer, check to see if we can write and that the buffer isn't already open
 		if(_bIBuffer && CanWriteIB() && !m_pMappedIBuffer.pData)
 		{
-			m_pRenderer->GetDeviceContext()->Map(m_pIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &m_pMappedIBuffer);
+			m_pRenderer->Map(m_pIndexBuffer, D3D11_MAP_WRITE_DISCARD, &m_pMappedIBuffer);
 		}
 	}
 
@@ -679,22 +856,33 @@ CMESH_TEMPLATE
 void CMesh<CMESH_INSERT>::CloseBuffers(bool _bVBuffer, bool _bIBuffer)
 {
 	//Verify renderer and context are available
-	if(m_pRenderer && m_pRenderer->GetDeviceContext())
+	if(m_pRenderer && m_pRenderer->IsDeviceReady())
 	{
 		//If buffer is open/mapped, close/unmap it
 		if(_bVBuffer && m_pMappedVBuffer.pData)
 		{
-			m_pRenderer->GetDeviceContext()->Unmap(m_pVertexBuffer, 0);
+			m_pRenderer->Unmap(m_pVertexBuffer);
 			m_pMappedVBuffer.pData = nullptr; //unset to prevent issues
 		}
 
 		//If buffer is open/mapped, close/unmap it
 		if(_bIBuffer && m_pMappedIBuffer.pData)
 		{
-			m_pRenderer->GetDeviceContext()->Unmap(m_pIndexBuffer, 0);
+			m_pRenderer->Unmap(m_pIndexBuffer);
 			m_pMappedIBuffer.pData = nullptr; //unset to prevent issues
 		}
 	}
 }
 
+CMESH_TEMPLATE
+void CMesh<CMESH_INSERT>::CancelUploads()
+{
+	if(!m_pRenderer) return;
+
+	//Queue holds its own reference, drop whatever it still has for these buffers
+	CUploadQueue& rUploadQueue = m_pRenderer->GetUploadQueue();
+	if(m_pVertexBuffer) rUploadQueue.Cancel(m_pVertexBuffer);
+	if(m_pIndexBuffer) rUploadQueue.Cancel(m_pIndexBuffer);
+}
+
 #endif //__MESH_H__
@@ -0,0 +1,384 @@
+//Library Includes
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+#include <utility>
+
+//This Include
+#include "meshbounds.h"
+
+//Static Variables
+static const unsigned int s_kuiJacobiSweeps = 16;
+static const unsigned int s_kuiExtremeDirections = 7; //EPOS-14, each direction gives two extreme vertices
+static const float s_kfRightAngleTolerance = 0.0001f; //Cosine below which transformed axes still count as perpendicular
+
+//Helpers
+static inline XMVECTOR LoadPosition(const unsigned char* _pPositions, size_t _uiStride, unsigned int _uiIndex)
+{
+	return(XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(_pPositions + _uiStride * _uiIndex)));
+}
+
+static void ComputeBox(const unsigned char* _pPositions, unsigned int _uiCount, size_t _uiStride, XMVECTOR& _rvecMin, XMVECTOR& _rvecMax)
+{
+	//Two running pairs so neighbouring vertices don't wait on each other's result
+	XMVECTOR vecMinA = XMVectorReplicate(FLT_MAX);
+	XMVECTOR vecMaxA = XMVectorReplicate(-FLT_MAX);
+	XMVECTOR vecMinB = vecMinA;
+	XMVECTOR vecMaxB = vecMaxA;
+
+	unsigned int i = 0;
+	for(; i + 1 < _uiCount; i += 2)
+	{
+		XMVECTOR vecA = LoadPosition(_pPositions, _uiStride, i);
+		XMVECTOR vecB = LoadPosition(_pPositions, _uiStride, i + 1);
+		vecMinA = XMVectorMin(vecMinA, vecA);
+		vecMaxA = XMVectorMax(vecMaxA, vecA);
+		vecMinB = XMVectorMin(vecMinB, vecB);
+		vecMaxB = XMVectorMax(vecMaxB, vecB);
+	}
+	if(i < _uiCount)
+	{
+		XMVECTOR vecA = LoadPosition(_pPositions, _uiStride, i);
+		vecMinA = XMVectorMin(vecMinA, vecA);
+		vecMaxA = XMVectorMax(vecMaxA, vecA);
+	}
+
+	_rvecMin = XMVectorMin(vecMinA, vecMinB);
+	_rvecMax = XMVectorMax(vecMaxA, vecMaxB);
+}
+
+//Squared distance from _vecCenter to the farthest vertex
+static float GetMaxDistanceSq(const unsigned char* _pPositions, unsigned int _uiCount, size_t _uiStride, GXMVECTOR _vecCenter)
+{
+	XMVECTOR vecMaxSq = XMVectorZero();
+	for(unsigned int i = 0; i < _uiCount; ++i)
+	{
+		vecMaxSq = XMVectorMax(vecMaxSq, XMVector3LengthSq(LoadPosition(_pPositions, _uiStride, i) - _vecCenter));
+	}
+
+	return(XMVectorGetX(vecMaxSq));
+}
+
+//Lowest and highest vertex along each EPOS-14 direction: the 3 axes, then the diagonals (1,1,1), (1,1,-1), (1,-1,1) and (1,-1,-1).
+//The position is the axis projections and one transform gives all four diagonal ones, the indices ride along in integer lanes
+static void FindExtremeVertices(const unsigned char* _pPositions, unsigned int _uiCount, size_t _uiStride,
+	uint32_t _puiMin[s_kuiExtremeDirections + 1], uint32_t _puiMax[s_kuiExtremeDirections + 1])
+{
+	XMMATRIX matDiagonals = XMMatrixSet(
+		1.0f, 1.0f, 1.0f, 1.0f,
+		1.0f, 1.0f, -1.0f, -1.0f,
+		1.0f, -1.0f, 1.0f, -1.0f,
+		0.0f, 0.0f, 0.0f, 0.0f);
+
+	XMVECTOR vecAxisMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR vecAxisMax = XMVectorReplicate(-FLT_MAX);
+	XMVECTOR vecDiagonalMin = vecAxisMin;
+	XMVECTOR vecDiagonalMax = vecAxisMax;
+	XMVECTOR vecAxisMinIndex = XMVectorZero();
+	XMVECTOR vecAxisMaxIndex = XMVectorZero();
+	XMVECTOR vecDiagonalMinIndex = XMVectorZero();
+	XMVECTOR vecDiagonalMaxIndex = XMVectorZero();
+
+	for(unsigned int i = 0; i < _uiCount; ++i)
+	{
+		XMVECTOR vecIndex = XMVectorReplicateInt(i);
+		XMVECTOR vecAxis = LoadPosition(_pPositions, _uiStride, i);
+		XMVECTOR vecDiagonal = XMVector3TransformNormal(vecAxis, matDiagonals);
+
+		XMVECTOR vecMask = XMVectorLess(vecAxis, vecAxisMin);
+		vecAxisMin = XMVectorSelect(vecAxisMin, vecAxis, vecMask);
+		vecAxisMinIndex = XMVectorSelect(vecAxisMinIndex, vecIndex, vecMask);
+
+		vecMask = XMVectorGreater(vecAxis, vecAxisMax);
+		vecAxisMax = XMVectorSelect(vecAxisMax, vecAxis, vecMask);
+		vecAxisMaxIndex = XMVectorSelect(vecAxisMaxIndex, vecIndex, vecMask);
+
+		vecMask = XMVectorLess(vecDiagonal, vecDiagonalMin);
+		vecDiagonalMin = XMVectorSelect(vecDiagonalMin, vecDiagonal, vecMask);
+		vecDiagonalMinIndex = XMVectorSelect(vecDiagonalMinIndex, vecIndex, vecMask);
+
+		vecMask = XMVectorGreater(vecDiagonal, vecDiagonalMax);
+		vecDiagonalMax = XMVectorSelect(vecDiagonalMax, vecDiagonal, vecMask);
+		vecDiagonalMaxIndex = XMVectorSelect(vecDiagonalMaxIndex, vecIndex, vecMask);
+	}
+
+	//Axis lanes fill 0 to 3, the unused w lane is then written over by the diagonals
+	XMStoreInt4(_puiMin, vecAxisMinIndex);
+	XMStoreInt4(_puiMax, vecAxisMaxIndex);
+	XMStoreInt4(_puiMin + 3, vecDiagonalMinIndex);
+	XMStoreInt4(_puiMax + 3, vecDiagonalMaxIndex);
+}
+
+static void ComputeSphere(const unsigned char* _pPositions, unsigned int _uiCount, size_t _uiStride, XMVECTOR& _rvecCenter, float& _rfRadius)
+{
+	uint32_t puiMin[s_kuiExtremeDirections + 1];
+	uint32_t puiMax[s_kuiExtremeDirections + 1];
+	FindExtremeVertices(_pPositions, _uiCount, _uiStride, puiMin, puiMax);
+
+	//The farthest apart pair is the first guess at a diameter
+	XMVECTOR vecA = LoadPosition(_pPositions, _uiStride, puiMin[0]);
+	XMVECTOR vecB = LoadPosition(_pPositions, _uiStride, puiMax[0]);
+	float fDiameterSq = XMVectorGetX(XMVector3LengthSq(vecB - vecA));
+	for(unsigned int i = 1; i < s_kuiExtremeDirections; ++i)
+	{
+		XMVECTOR vecMin = LoadPosition(_pPositions, _uiStride, puiMin[i]);
+		XMVECTOR vecMax = LoadPosition(_pPositions, _uiStride, puiMax[i]);
+		float fLengthSq = XMVectorGetX(XMVector3LengthSq(vecMax - vecMin));
+		if(fLengthSq <= fDiameterSq) continue;
+
+		vecA = vecMin;
+		vecB = vecMax;
+		fDiameterSq = fLengthSq;
+	}
+
+	XMVECTOR vecCenter = (vecA + vecB) * 0.5f;
+	float fRadius = sqrtf(fDiameterSq) * 0.5f;
+
+	//Ritter, a vertex outside moves the sphere toward it and grows it just enough to hold it and everything held before
+	for(unsigned int i = 0; i < _uiCount; ++i)
+	{
+		XMVECTOR vecOffset = LoadPosition(_pPositions, _uiStride, i) - vecCenter;
+		float fDistanceSq = XMVectorGetX(XMVector3LengthSq(vecOffset));
+		if(fDistanceSq <= fRadius * fRadius) continue;
+
+		float fDistance = sqrtf(fDistanceSq);
+		float fNewRadius = (fRadius + fDistance) * 0.5f;
+		vecCenter = vecCenter + vecOffset * ((fNewRadius - fRadius) / fDistance);
+		fRadius = fNewRadius;
+	}
+
+	//Each step overshoots a little, only the farthest vertex from where the center settled matters
+	_rvecCenter = vecCenter;
+	_rfRadius = sqrtf(GetMaxDistanceSq(_pPositions, _uiCount, _uiStride, vecCenter));
+}
+
+//Cyclic Jacobi on a symmetric 3x3, every rotation zeroes one off diagonal term. The columns of _pdVectors end up the eigenvectors,
+//sorted by their eigenvalue left on the diagonal from largest to smallest
+static void SolveEigenVectors(double _pdMatrix[3][3], double _pdVectors[3][3])
+{
+	for(unsigned int i = 0; i < 3; ++i)
+	{
+		for(unsigned int j = 0; j < 3; ++j) _pdVectors[i][j] = (i == j) ? 1.0 : 0.0;
+	}
+
+	for(unsigned int uiSweep = 0; uiSweep < s_kuiJacobiSweeps; ++uiSweep)
+	{
+		double dOff = _pdMatrix[0][1] * _pdMatrix[0][1] + _pdMatrix[0][2] * _pdMatrix[0][2] + _pdMatrix[1][2] * _pdMatrix[1][2];
+		double dDiagonal = _pdMatrix[0][0] * _pdMatrix[0][0] + _pdMatrix[1][1] * _pdMatrix[1][1] + _pdMatrix[2][2] * _pdMatrix[2][2];
+		if(dOff <= dDiagonal * 1e-24) break;
+
+		for(unsigned int p = 0; p < 2; ++p)
+		{
+			for(unsigned int q = p + 1; q < 3; ++q)
+			{
+				if(_pdMatrix[p][q] == 0.0) continue;
+
+				double dTheta = (_pdMatrix[q][q] - _pdMatrix[p][p]) / (2.0 * _pdMatrix[p][q]);
+				double dTan = (dTheta >= 0.0 ? 1.0 : -1.0) / (fabs(dTheta) + sqrt(dTheta * dTheta + 1.0));
+				double dCos = 1.0 / sqrt(dTan * dTan + 1.0);
+				double dSin = dTan * dCos;
+
+				for(unsigned int k = 0; k < 3; ++k)
+				{
+					double dKP = _pdMatrix[k][p];
+					double dKQ = _pdMatrix[k][q];
+					_pdMatrix[k][p] = dCos * dKP - dSin * dKQ;
+					_pdMatrix[k][q] = dSin * dKP + dCos * dKQ;
+				}
+				for(unsigned int k = 0; k < 3; ++k)
+				{
+					double dPK = _pdMatrix[p][k];
+					double dQK = _pdMatrix[q][k];
+					_pdMatrix[p][k] = dCos * dPK - dSin * dQK;
+					_pdMatrix[q][k] = dSin * dPK + dCos * dQK;
+				}
+				for(unsigned int k = 0; k < 3; ++k)
+				{
+					double dKP = _pdVectors[k][p];
+					double dKQ = _pdVectors[k][q];
+					_pdVectors[k][p] = dCos * dKP - dSin * dKQ;
+					_pdVectors[k][q] = dSin * dKP + dCos * dKQ;
+				}
+			}
+		}
+	}
+
+	//Three columns, a swap for each pair out of order sorts them
+	for(unsigned int p = 0; p < 2; ++p)
+	{
+		for(unsigned int q = p + 1; q < 3; ++q)
+		{
+			if(_pdMatrix[q][q] <= _pdMatrix[p][p]) continue;
+
+			std::swap(_pdMatrix[p][p], _pdMatrix[q][q]);
+			for(unsigned int k = 0; k < 3; ++k) std::swap(_pdVectors[k][p], _pdVectors[k][q]);
+		}
+	}
+}
+
+//Box volume, padded by a sliver of its size so flat meshes still compare
+static float GetBoxVolume(FXMVECTOR _vecExtents)
+{
+	XMFLOAT3 vec3Extents;
+	XMStoreFloat3(&vec3Extents, _vecExtents);
+	float fPad = max(max(vec3Extents.x, vec3Extents.y), vec3Extents.z) * 0.001f;
+
+	return((vec3Extents.x + fPad) * (vec3Extents.y + fPad) * (vec3Extents.z + fPad));
+}
+
+//Oriented box along the principal axes, false if it is no smaller than the box from _vecBoxExtents
+static bool ComputeOrientedBox(const unsigned char* _pPositions, unsigned int _uiCount, size_t _uiStride, GXMVECTOR _vecBoxCenter,
+	HXMVECTOR _vecBoxExtents, TMeshBounds& _rtBounds)
+{
+	//Mean taken about the box center, keeps the float sums small
+	XMVECTOR vecSum = XMVectorZero();
+	for(unsigned int i = 0; i < _uiCount; ++i) vecSum += LoadPosition(_pPositions, _uiStride, i) - _vecBoxCenter;
+	XMVECTOR vecMean = _vecBoxCenter + vecSum / static_cast<float>(_uiCount);
+
+	//Covariance, xx yy zz in one vector and xy yz zx in the other
+	XMVECTOR vecSquares = XMVectorZero();
+	XMVECTOR vecProducts = XMVectorZero();
+	for(unsigned int i = 0; i < _uiCount; ++i)
+	{
+		XMVECTOR vecOffset = LoadPosition(_pPositions, _uiStride, i) - vecMean;
+		vecSquares += vecOffset * vecOffset;
+		vecProducts += vecOffset * XMVectorSwizzle(vecOffset, 1, 2, 0, 3);
+	}
+
+	XMFLOAT3 vec3Squares, vec3Products;
+	XMStoreFloat3(&vec3Squares, vecSquares);
+	XMStoreFloat3(&vec3Products, vecProducts);
+	double pdCovariance[3][3] = {
+		{ vec3Squares.x, vec3Products.x, vec3Products.z },
+		{ vec3Products.x, vec3Squares.y, vec3Products.y },
+		{ vec3Products.z, vec3Products.y, vec3Squares.z }};
+
+	double pdVectors[3][3];
+	SolveEigenVectors(pdCovariance, pdVectors);
+
+	//Two largest spread axes, the third crossed from them so the axes always form a rotation
+	XMVECTOR vecAxisX = XMVector3Normalize(XMVectorSet((float)pdVectors[0][0], (float)pdVectors[1][0], (float)pdVectors[2][0], 0.0f));
+	XMVECTOR vecAxisY = XMVector3Normalize(XMVectorSet((float)pdVectors[0][1], (float)pdVectors[1][1], (float)pdVectors[2][1], 0.0f));
+	XMVECTOR vecAxisZ = XMVector3Normalize(XMVector3Cross(vecAxisX, vecAxisY));
+	vecAxisY = XMVector3Cross(vecAxisZ, vecAxisX);
+
+	XMMATRIX matAxes;
+	matAxes.r[0] = vecAxisX;
+	matAxes.r[1] = vecAxisY;
+	matAxes.r[2] = vecAxisZ;
+	matAxes.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+	//Rows of the transpose project a position onto all three axes at once
+	XMMATRIX matToAxes = XMMatrixTranspose(matAxes);
+	XMVECTOR vecMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR vecMax = XMVectorReplicate(-FLT_MAX);
+	for(unsigned int i = 0; i < _uiCount; ++i)
+	{
+		XMVECTOR vecProjected = XMVector3TransformNormal(LoadPosition(_pPositions, _uiStride, i), matToAxes);
+		vecMin = XMVectorMin(vecMin, vecProjected);
+		vecMax = XMVectorMax(vecMax, vecProjected);
+	}
+
+	XMVECTOR vecExtents = (vecMax - vecMin) * 0.5f;
+	if(GetBoxVolume(vecExtents) >= GetBoxVolume(_vecBoxExtents)) return(false);
+
+	XMStoreFloat3(&_rtBounds.vec3OBBCenter, XMVector3TransformNormal((vecMin + vecMax) * 0.5f, matAxes));
+	XMStoreFloat3(&_rtBounds.vec3OBBExtends, vecExtents);
+	XMStoreFloat4(&_rtBounds.vec4OBBOrientation, XMQuaternionRotationMatrix(matAxes));
+
+	return(true);
+}
+
+//Implementation
+void
+ComputeMeshBounds(const void* _pPositions, unsigned int _uiCount, size_t _uiStride, TMeshBounds& _rtBounds)
+{
+	_rtBounds = TMeshBounds();
+	if(!_pPositions || !_uiCount) return;
+
+	const unsigned char* pPositions = static_cast<const unsigned char*>(_pPositions);
+
+	XMVECTOR vecMin, vecMax;
+	ComputeBox(pPositions, _uiCount, _uiStride, vecMin, vecMax);
+	XMVECTOR vecBoxCenter = (vecMin + vecMax) * 0.5f;
+	XMVECTOR vecBoxExtents = (vecMax - vecMin) * 0.5f;
+	XMStoreFloat3(&_rtBounds.vec3BoxCenter, vecBoxCenter);
+	XMStoreFloat3(&_rtBounds.vec3BoxExtends, vecBoxExtents);
+
+	//Sphere, the box's center does better on some shapes so it gets a turn too
+	XMVECTOR vecSphereCenter;
+	float fSphereRadius;
+	ComputeSphere(pPositions, _uiCount, _uiStride, vecSphereCenter, fSphereRadius);
+
+	float fBoxCenterRadius = sqrtf(GetMaxDistanceSq(pPositions, _uiCount, _uiStride, vecBoxCenter));
+	if(fBoxCenterRadius < fSphereRadius)
+	{
+		vecSphereCenter = vecBoxCenter;
+		fSphereRadius = fBoxCenterRadius;
+	}
+	XMStoreFloat3(&_rtBounds.vec3SphereCenter, vecSphereCenter);
+	_rtBounds.fSphereRadius = fSphereRadius;
+
+	//Oriented box, or the box itself when the principal axes don't beat it
+	if(!ComputeOrientedBox(pPositions, _uiCount, _uiStride, vecBoxCenter, vecBoxExtents, _rtBounds))
+	{
+		_rtBounds.vec3OBBCenter = _rtBounds.vec3BoxCenter;
+		_rtBounds.vec3OBBExtends = _rtBounds.vec3BoxExtends;
+		_rtBounds.vec4OBBOrientation = float4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+}
+
+void
+TransformOrientedBox(const DirectX::BoundingOrientedBox& _rtBox, FXMMATRIX _matWorld, DirectX::BoundingOrientedBox& _rtOut)
+{
+	//The box's axes once moved, scaled by the transform
+	XMMATRIX matBox = XMMatrixRotationQuaternion(XMLoadFloat4(&_rtBox.Orientation));
+	XMVECTOR pvecAxes[3];
+	float pfScales[3];
+	for(unsigned int i = 0; i < 3; ++i)
+	{
+		pvecAxes[i] = XMVector3TransformNormal(matBox.r[i], _matWorld);
+		pfScales[i] = XMVectorGetX(XMVector3Length(pvecAxes[i]));
+	}
+
+	bool bRightAngles = pfScales[0] > 0.0f && pfScales[1] > 0.0f && pfScales[2] > 0.0f;
+	for(unsigned int i = 0; i < 3 && bRightAngles; ++i)
+	{
+		unsigned int j = (i + 1) % 3;
+		float fDot = fabsf(XMVectorGetX(XMVector3Dot(pvecAxes[i], pvecAxes[j])));
+		bRightAngles = fDot <= s_kfRightAngleTolerance * pfScales[i] * pfScales[j];
+	}
+
+	if(bRightAngles)
+	{
+		XMMATRIX matAxes;
+		matAxes.r[0] = pvecAxes[0] / pfScales[0];
+		matAxes.r[1] = pvecAxes[1] / pfScales[1];
+		matAxes.r[2] = pvecAxes[2] / pfScales[2];
+		matAxes.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+		//A mirroring transform leaves the axes left handed, which no quaternion holds. The box is symmetric so one flips back
+		if(XMVectorGetX(XMVector3Dot(XMVector3Cross(matAxes.r[0], matAxes.r[1]), matAxes.r[2])) < 0.0f) matAxes.r[2] = -matAxes.r[2];
+
+		XMStoreFloat3(&_rtOut.Center, XMVector3Transform(XMLoadFloat3(&_rtBox.Center), _matWorld));
+		XMStoreFloat3(&_rtOut.Extents, XMLoadFloat3(&_rtBox.Extents) * XMVectorSet(pfScales[0], pfScales[1], pfScales[2], 0.0f));
+		XMStoreFloat4(&_rtOut.Orientation, XMQuaternionRotationMatrix(matAxes));
+		return;
+	}
+
+	//Sheared, the world aligned box around the moved corners still holds it
+	XMFLOAT3 pCorners[8];
+	_rtBox.GetCorners(pCorners);
+	XMVECTOR vecMin = XMVectorReplicate(FLT_MAX);
+	XMVECTOR vecMax = XMVectorReplicate(-FLT_MAX);
+	for(unsigned int i = 0; i < 8; ++i)
+	{
+		XMVECTOR vecCorner = XMVector3Transform(XMLoadFloat3(&pCorners[i]), _matWorld);
+		vecMin = XMVectorMin(vecMin, vecCorner);
+		vecMax = XMVectorMax(vecMax, vecCorner);
+	}
+
+	XMStoreFloat3(&_rtOut.Center, (vecMin + vecMax) * 0.5f);
+	XMStoreFloat3(&_rtOut.Extents, (vecMax - vecMin) * 0.5f);
+	_rtOut.Orientation = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+}
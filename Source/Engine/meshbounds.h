@@ -0,0 +1,67 @@
+#pragma once
+#ifndef __MESH_BOUNDS_H__
+#define __MESH_BOUNDS_H__
+
+//Library Includes
+#include <DirectXCollision.h>
+
+//Local Includes
+#include "dxcommon.h"
+#include "vertexdefs.h"
+#include "imesh.h"
+
+//Import time bounding volumes of a mesh's vertices, run through DirectXMath so every pass works on whole vectors
+//	Box: per component min and max
+//	Sphere: EPOS-14, the farthest apart pair of extreme vertices along 3 axes and 4 diagonals seeds a Ritter pass that grows the
+//	sphere over every vertex left outside. The radius is then cut down to the farthest vertex from the center it ended on, and the
+//	sphere around the box is kept instead if that is smaller
+//	Oriented box: axes are the eigenvectors of the positions' covariance (PCA), falling back to the box when that is no smaller
+//Positions are three floats at the start of every vertex
+
+//Types
+struct TMeshBounds
+{
+	float3 vec3BoxCenter;
+	float3 vec3BoxExtends;
+
+	float3 vec3SphereCenter;
+	float fSphereRadius;
+
+	float3 vec3OBBCenter;
+	float3 vec3OBBExtends;
+	float4 vec4OBBOrientation; //Quaternion taking the box's axes into object space
+
+	TMeshBounds()
+		: vec3BoxCenter(0.0f, 0.0f, 0.0f)
+		, vec3BoxExtends(0.0f, 0.0f, 0.0f)
+		, vec3SphereCenter(0.0f, 0.0f, 0.0f)
+		, fSphereRadius(0.0f)
+		, vec3OBBCenter(0.0f, 0.0f, 0.0f)
+		, vec3OBBExtends(0.0f, 0.0f, 0.0f)
+		, vec4OBBOrientation(0.0f, 0.0f, 0.0f, 1.0f)
+	{
+	}
+};
+
+//Prototypes
+//Bounds of the first _uiCount vertices, _uiStride bytes apart
+void ComputeMeshBounds(const void* _pPositions, unsigned int _uiCount, size_t _uiStride, TMeshBounds& _rtBounds);
+
+//_rtBox moved by _matWorld. BoundingOrientedBox::Transform scales along the box's own axes, which is wrong for a scale along
+//others, that case gets the box around the moved corners instead
+void TransformOrientedBox(const DirectX::BoundingOrientedBox& _rtBox, FXMMATRIX _matWorld, DirectX::BoundingOrientedBox& _rtOut);
+
+//Copies _rtBounds into the mesh data CMesh::Initialize reads them from
+template<typename TVertexType, typename TIndexType>
+inline void SetMeshBounds(const TMeshBounds& _rtBounds, TMeshData<TVertexType, TIndexType>& _rtMeshData)
+{
+	_rtMeshData.vec3BBCenter = _rtBounds.vec3BoxCenter;
+	_rtMeshData.vec3BBExtends = _rtBounds.vec3BoxExtends;
+	_rtMeshData.vec3SphereCenter = _rtBounds.vec3SphereCenter;
+	_rtMeshData.fSphereRadius = _rtBounds.fSphereRadius;
+	_rtMeshData.vec3OBBCenter = _rtBounds.vec3OBBCenter;
+	_rtMeshData.vec3OBBExtends = _rtBounds.vec3OBBExtends;
+	_rtMeshData.vec4OBBOrientation = _rtBounds.vec4OBBOrientation;
+}
+
+#endif //__MESH_BOUNDS_H__
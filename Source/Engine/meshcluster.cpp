@@ -0,0 +1,229 @@
+//Library Includes
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+//Local Includes
+#include "meshoptimizer.h"
+
+//This Include
+#include "meshcluster.h"
+
+//Static Variables
+static const unsigned int s_kuiSeedSearch = 256; //Free triangles looked at down the stream when a cluster has no neighbours left
+static const float s_kfFacingWeight = 2.0f; //How far a triangle turned 90 degrees from the cluster counts against it, in multiples of its distance
+static const float s_kfMinConeDot = 0.1f; //Triangles spread wider than this around the axis leave the cluster without a cone
+
+//Helpers
+//Front facing for clockwise triangles in the left handed space the importer converts to, zero for degenerate ones
+static inline float3 GetTriangleNormal(const DWORD* _pTriangle, const TVertexTexNorm* _pVertices)
+{
+	const float3& rvec3A = _pVertices[_pTriangle[0]].pos;
+	return((_pVertices[_pTriangle[1]].pos - rvec3A).Cross(_pVertices[_pTriangle[2]].pos - rvec3A).Normalize());
+}
+
+//Implementation
+unsigned int
+BuildMeshClusters(DWORD* _pIndices, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount,
+	std::vector<TMeshCluster>& _rvecClusters)
+{
+	_rvecClusters.clear();
+	unsigned int uiTriangleCount = _uiIndexCount / 3;
+	if(!_pIndices || !_pVertices || uiTriangleCount < MESH_CLUSTER_MIN_MESH_TRIANGLES) return(0);
+
+	for(unsigned int i = 0; i < uiTriangleCount * 3; ++i)
+	{
+		if(_pIndices[i] >= _uiVertexCount) return(0);
+	}
+
+	//Triangles around each vertex
+	std::vector<unsigned int> vecTriangleStart(_uiVertexCount + 1, 0);
+	for(unsigned int i = 0; i < uiTriangleCount * 3; ++i) ++vecTriangleStart[_pIndices[i] + 1];
+	for(unsigned int i = 0; i < _uiVertexCount; ++i) vecTriangleStart[i + 1] += vecTriangleStart[i];
+
+	std::vector<unsigned int> vecCursor(vecTriangleStart.begin(), vecTriangleStart.end() - 1);
+	std::vector<unsigned int> vecTriangles(uiTriangleCount * 3);
+	for(unsigned int i = 0; i < uiTriangleCount * 3; ++i) vecTriangles[vecCursor[_pIndices[i]]++] = i / 3;
+
+	//Centroid and facing of every triangle, and the radius a full cluster would have if the mesh were spread evenly
+	std::vector<float3> vecCentroids(uiTriangleCount);
+	std::vector<float3> vecNormals(uiTriangleCount);
+	float3 vec3Min(FLT_MAX, FLT_MAX, FLT_MAX);
+	float3 vec3Max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for(unsigned int i = 0; i < uiTriangleCount; ++i)
+	{
+		const DWORD* pTriangle = _pIndices + i * 3;
+		vecCentroids[i] = (_pVertices[pTriangle[0]].pos + _pVertices[pTriangle[1]].pos + _pVertices[pTriangle[2]].pos) / 3.0f;
+		vecNormals[i] = GetTriangleNormal(pTriangle, _pVertices);
+
+		vec3Min = float3(min(vec3Min.x, vecCentroids[i].x), min(vec3Min.y, vecCentroids[i].y), min(vec3Min.z, vecCentroids[i].z));
+		vec3Max = float3(max(vec3Max.x, vecCentroids[i].x), max(vec3Max.y, vecCentroids[i].y), max(vec3Max.z, vecCentroids[i].z));
+	}
+	float fClusterRadius = (vec3Max - vec3Min).Mag() * 0.5f * sqrtf((float)MESH_CLUSTER_MAX_TRIANGLES / uiTriangleCount);
+
+	//Stamped with the cluster they were last seen by, saves clearing them per cluster
+	std::vector<unsigned int> vecVertexStamp(_uiVertexCount, (unsigned int)-1);
+	std::vector<unsigned int> vecFrontierStamp(uiTriangleCount, (unsigned int)-1);
+	std::vector<bool> vecAssigned(uiTriangleCount, false);
+	std::vector<unsigned int> vecFrontier;
+	std::vector<DWORD> vecOrdered;
+	vecOrdered.reserve(uiTriangleCount * 3);
+	std::vector<DWORD> vecLocal;
+	std::vector<DWORD> vecLocalVertices;
+	std::vector<unsigned int> vecVertexLocal(_uiVertexCount, 0);
+
+	unsigned int uiFirstFree = 0;
+	for(unsigned int uiCluster = 0; ; ++uiCluster)
+	{
+		while(uiFirstFree < uiTriangleCount && vecAssigned[uiFirstFree]) ++uiFirstFree;
+		if(uiFirstFree == uiTriangleCount) break;
+
+		unsigned int uiIndexStart = (unsigned int)vecOrdered.size();
+		unsigned int uiNext = uiFirstFree;
+		unsigned int uiCount = 0;
+		float3 vec3CentroidSum;
+		float3 vec3NormalSum;
+		vecFrontier.clear();
+
+		for(;;)
+		{
+			//Take the triangle and queue the free ones around its corners
+			vecAssigned[uiNext] = true;
+			vecOrdered.insert(vecOrdered.end(), _pIndices + uiNext * 3, _pIndices + uiNext * 3 + 3);
+			vec3CentroidSum += vecCentroids[uiNext];
+			vec3NormalSum += vecNormals[uiNext];
+			if(++uiCount == MESH_CLUSTER_MAX_TRIANGLES) break;
+
+			for(int k = 0; k < 3; ++k)
+			{
+				DWORD dwVertex = _pIndices[uiNext * 3 + k];
+				vecVertexStamp[dwVertex] = uiCluster;
+				for(unsigned int t = vecTriangleStart[dwVertex]; t < vecTriangleStart[dwVertex + 1]; ++t)
+				{
+					unsigned int uiTriangle = vecTriangles[t];
+					if(vecAssigned[uiTriangle] || vecFrontierStamp[uiTriangle] == uiCluster) continue;
+
+					vecFrontierStamp[uiTriangle] = uiCluster;
+					vecFrontier.push_back(uiTriangle);
+				}
+			}
+
+			//Fewest new vertices first, then nearest the centre with turning away from the cluster counted as distance
+			float3 vec3Center = vec3CentroidSum / (float)uiCount;
+			float3 vec3Axis = vec3NormalSum.Normalize();
+			unsigned int uiBestNew = 4;
+			float fBestScore = FLT_MAX;
+			unsigned int uiBest = uiTriangleCount;
+
+			for(size_t i = 0; i < vecFrontier.size();)
+			{
+				unsigned int uiTriangle = vecFrontier[i];
+				if(vecAssigned[uiTriangle])
+				{
+					vecFrontier[i] = vecFrontier.back();
+					vecFrontier.pop_back();
+					continue;
+				}
+				++i;
+
+				unsigned int uiNew = 0;
+				for(int k = 0; k < 3; ++k) uiNew += vecVertexStamp[_pIndices[uiTriangle * 3 + k]] != uiCluster;
+
+				float fScore = (vecCentroids[uiTriangle] - vec3Center).Mag() * (1.0f + s_kfFacingWeight * (1.0f - vecNormals[uiTriangle].Dot(vec3Axis)));
+				if(uiNew < uiBestNew || (uiNew == uiBestNew && fScore < fBestScore))
+				{
+					uiBestNew = uiNew;
+					fBestScore = fScore;
+					uiBest = uiTriangle;
+				}
+			}
+
+			//Out of neighbours, the nearest free triangle a little way down the stream if it is within a cluster's reach
+			if(uiBest == uiTriangleCount)
+			{
+				float fNearest = fClusterRadius;
+				for(unsigned int i = uiFirstFree, uiSeen = 0; i < uiTriangleCount && uiSeen < s_kuiSeedSearch; ++i)
+				{
+					if(vecAssigned[i]) continue;
+					++uiSeen;
+
+					float fDistance = (vecCentroids[i] - vec3Center).Mag();
+					if(fDistance <= fNearest)
+					{
+						fNearest = fDistance;
+						uiBest = i;
+					}
+				}
+			}
+
+			if(uiBest == uiTriangleCount) break;
+			uiNext = uiBest;
+		}
+
+		//Growth order isn't cache order, reorder inside the cluster over its own small vertex numbering
+		vecLocal.assign(vecOrdered.begin() + uiIndexStart, vecOrdered.end());
+		vecLocalVertices.clear();
+		for(DWORD& rdwIndex : vecLocal)
+		{
+			if(vecVertexLocal[rdwIndex] >= vecLocalVertices.size() || vecLocalVertices[vecVertexLocal[rdwIndex]] != rdwIndex)
+			{
+				vecVertexLocal[rdwIndex] = (unsigned int)vecLocalVertices.size();
+				vecLocalVertices.push_back(rdwIndex);
+			}
+			rdwIndex = vecVertexLocal[rdwIndex];
+		}
+		OptimizeVertexCache(vecLocal.data(), (unsigned int)vecLocal.size(), (unsigned int)vecLocalVertices.size());
+		for(size_t i = 0; i < vecLocal.size(); ++i) vecOrdered[uiIndexStart + i] = vecLocalVertices[vecLocal[i]];
+
+		_rvecClusters.push_back(ComputeClusterBounds(vecOrdered.data(), uiIndexStart, uiCount * 3, _pVertices));
+	}
+
+	std::copy(vecOrdered.begin(), vecOrdered.end(), _pIndices);
+
+	return((unsigned int)_rvecClusters.size());
+}
+
+TMeshCluster
+ComputeClusterBounds(const DWORD* _pIndices, unsigned int _uiIndexStart, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices)
+{
+	TMeshCluster tCluster;
+	tCluster.uiIndexStart = _uiIndexStart;
+	tCluster.uiIndexCount = _uiIndexCount;
+	if(!_uiIndexCount) return(tCluster);
+
+	//Sphere around the box, close enough for culling and cheap
+	float3 vec3Min(FLT_MAX, FLT_MAX, FLT_MAX);
+	float3 vec3Max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for(unsigned int i = _uiIndexStart; i < _uiIndexStart + _uiIndexCount; ++i)
+	{
+		const float3& rvec3Pos = _pVertices[_pIndices[i]].pos;
+		vec3Min = float3(min(vec3Min.x, rvec3Pos.x), min(vec3Min.y, rvec3Pos.y), min(vec3Min.z, rvec3Pos.z));
+		vec3Max = float3(max(vec3Max.x, rvec3Pos.x), max(vec3Max.y, rvec3Pos.y), max(vec3Max.z, rvec3Pos.z));
+	}
+
+	tCluster.vec3Center = (vec3Min + vec3Max) * 0.5f;
+	for(unsigned int i = _uiIndexStart; i < _uiIndexStart + _uiIndexCount; ++i)
+	{
+		tCluster.fRadius = max(tCluster.fRadius, (_pVertices[_pIndices[i]].pos - tCluster.vec3Center).Mag());
+	}
+
+	//Cone around the average facing, wide enough for the triangle furthest from it
+	float3 vec3NormalSum;
+	for(unsigned int i = _uiIndexStart; i + 2 < _uiIndexStart + _uiIndexCount; i += 3) vec3NormalSum += GetTriangleNormal(_pIndices + i, _pVertices);
+
+	float3 vec3Axis = vec3NormalSum.Normalize();
+	if(vec3Axis.Mag() == 0.0f) return(tCluster);
+
+	float fMinDot = 1.0f;
+	for(unsigned int i = _uiIndexStart; i + 2 < _uiIndexStart + _uiIndexCount; i += 3)
+	{
+		float3 vec3Normal = GetTriangleNormal(_pIndices + i, _pVertices);
+		if(vec3Normal.Mag() > 0.0f) fMinDot = min(fMinDot, vec3Normal.Dot(vec3Axis));
+	}
+
+	//The cutoff is the sine of the spread, so the test needs no trigonometry at draw time
+	tCluster.vec3ConeAxis = vec3Axis;
+	tCluster.fConeCutoff = fMinDot <= s_kfMinConeDot ? 1.0f : sqrtf(1.0f - fMinDot * fMinDot);
+
+	return(tCluster);
+}
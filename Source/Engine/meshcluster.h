@@ -0,0 +1,35 @@
+#pragma once
+#ifndef __MESH_CLUSTER_H__
+#define __MESH_CLUSTER_H__
+
+//Library Includes
+#include <windows.h>
+#include <vector>
+#include <DirectXCollision.h>
+
+//Local Includes
+#include "dxcommon.h"
+#include "vertexdefs.h"
+#include "imesh.h"
+
+//Import time partitioning of a mesh into clusters the CPU can cull on their own
+//	Clusters grow greedily over shared vertices from the first free triangle in the optimized order, preferring triangles that
+//	add the fewest new vertices and then those nearest and facing closest to the cluster, so they stay compact and cache friendly
+//	When a cluster runs out of neighbours it picks up the nearest free triangle a little way down the stream
+//	Each cluster gets a bounding sphere and a normal cone, the cone lets a cluster facing away from the eye be dropped
+//Index buffers are triangle lists
+
+//Types
+#define MESH_CLUSTER_MAX_TRIANGLES 128
+#define MESH_CLUSTER_MIN_MESH_TRIANGLES 1024 //Smaller meshes are drawn whole, culling them by part costs more than it saves
+
+//Prototypes
+//Regroups the triangles in place so each cluster is a contiguous run of indices and fills _rvecClusters in index order.
+//Meshes under MESH_CLUSTER_MIN_MESH_TRIANGLES are left as they are. Returns the cluster count
+unsigned int BuildMeshClusters(DWORD* _pIndices, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount,
+	std::vector<TMeshCluster>& _rvecClusters);
+
+//Bounding sphere and normal cone of the triangles from _uiIndexStart
+TMeshCluster ComputeClusterBounds(const DWORD* _pIndices, unsigned int _uiIndexStart, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices);
+
+#endif //__MESH_CLUSTER_H__
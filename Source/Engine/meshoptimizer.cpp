@@ -0,0 +1,364 @@
+//Library Includes
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <algorithm>
+
+//This Include
+#include "meshoptimizer.h"
+
+//Types
+struct TOverdrawCluster
+{
+	unsigned int uiFirstTriangle;
+	unsigned int uiTriangleCount;
+	float fSortKey;
+};
+
+//Helpers
+static inline const float* GetPosition(const void* _pVertices, size_t _uiVertexStride, DWORD _dwIndex)
+{
+	return(reinterpret_cast<const float*>(static_cast<const BYTE*>(_pVertices) + _dwIndex * _uiVertexStride));
+}
+
+//Next vertex to fan around once the last fan has nothing left to offer, the most recent dead end first, then the lowest unfinished vertex
+static unsigned int SkipDeadEnd(const std::vector<unsigned int>& _rvecLive, std::vector<DWORD>& _rvecDeadEnds, unsigned int& _ruiCursor, unsigned int _uiVertexCount)
+{
+	while(!_rvecDeadEnds.empty())
+	{
+		DWORD dwVertex = _rvecDeadEnds.back();
+		_rvecDeadEnds.pop_back();
+		if(_rvecLive[dwVertex] > 0) return(dwVertex);
+	}
+
+	for(; _ruiCursor < _uiVertexCount; ++_ruiCursor)
+	{
+		if(_rvecLive[_ruiCursor] > 0) return(_ruiCursor);
+	}
+
+	return(_uiVertexCount);
+}
+
+//Sorts the clusters so those facing away from the mesh centre draw first and writes the triangles out in that order
+static void SortClusters(DWORD* _pIndices, unsigned int _uiTriangleCount, const void* _pVertices, size_t _uiVertexStride, std::vector<TOverdrawCluster>& _rvecClusters)
+{
+	//Area weighted centroids, the mesh's and each cluster's, with each cluster's area weighted normal
+	std::vector<float> vecCentroids(_rvecClusters.size() * 6, 0.0f);
+	double pdMeshCentroid[3] = { 0.0, 0.0, 0.0 };
+	double dMeshArea = 0.0;
+	for(unsigned int i = 0; i < _rvecClusters.size(); ++i)
+	{
+		const TOverdrawCluster& rtCluster = _rvecClusters[i];
+		float* pfCentroid = &vecCentroids[i * 6];
+		float* pfNormal = pfCentroid + 3;
+		double dClusterArea = 0.0;
+
+		for(unsigned int uiTriangle = rtCluster.uiFirstTriangle; uiTriangle < rtCluster.uiFirstTriangle + rtCluster.uiTriangleCount; ++uiTriangle)
+		{
+			const float* pfA = GetPosition(_pVertices, _uiVertexStride, _pIndices[uiTriangle * 3]);
+			const float* pfB = GetPosition(_pVertices, _uiVertexStride, _pIndices[uiTriangle * 3 + 1]);
+			const float* pfC = GetPosition(_pVertices, _uiVertexStride, _pIndices[uiTriangle * 3 + 2]);
+
+			float pfAB[3] = { pfB[0] - pfA[0], pfB[1] - pfA[1], pfB[2] - pfA[2] };
+			float pfAC[3] = { pfC[0] - pfA[0], pfC[1] - pfA[1], pfC[2] - pfA[2] };
+			float pfCross[3] = { pfAB[1] * pfAC[2] - pfAB[2] * pfAC[1], pfAB[2] * pfAC[0] - pfAB[0] * pfAC[2], pfAB[0] * pfAC[1] - pfAB[1] * pfAC[0] };
+			float fArea = 0.5f * sqrtf(pfCross[0] * pfCross[0] + pfCross[1] * pfCross[1] + pfCross[2] * pfCross[2]);
+
+			for(unsigned int j = 0; j < 3; ++j)
+			{
+				float fCentre = (pfA[j] + pfB[j] + pfC[j]) / 3.0f;
+				pfCentroid[j] += fCentre * fArea;
+				pfNormal[j] += pfCross[j];
+				pdMeshCentroid[j] += fCentre * fArea;
+			}
+
+			dClusterArea += fArea;
+		}
+
+		if(dClusterArea > 0.0)
+		{
+			for(unsigned int j = 0; j < 3; ++j) pfCentroid[j] = (float)(pfCentroid[j] / dClusterArea);
+		}
+		dMeshArea += dClusterArea;
+	}
+
+	if(dMeshArea > 0.0)
+	{
+		for(unsigned int j = 0; j < 3; ++j) pdMeshCentroid[j] /= dMeshArea;
+	}
+
+	//Clusters further out along their own normal are more likely to hide the rest of the mesh, they go first
+	for(unsigned int i = 0; i < _rvecClusters.size(); ++i)
+	{
+		const float* pfCentroid = &vecCentroids[i * 6];
+		const float* pfNormal = pfCentroid + 3;
+		float fLength = sqrtf(pfNormal[0] * pfNormal[0] + pfNormal[1] * pfNormal[1] + pfNormal[2] * pfNormal[2]);
+		if(fLength <= 0.0f) continue;
+
+		float fDot = 0.0f;
+		for(unsigned int j = 0; j < 3; ++j) fDot += (float)(pfCentroid[j] - pdMeshCentroid[j]) * pfNormal[j];
+		_rvecClusters[i].fSortKey = fDot / fLength;
+	}
+
+	std::stable_sort(_rvecClusters.begin(), _rvecClusters.end(), [](const TOverdrawCluster& _rtLeft, const TOverdrawCluster& _rtRight) { return(_rtLeft.fSortKey > _rtRight.fSortKey); });
+
+	std::vector<DWORD> vecOutput;
+	vecOutput.reserve(_uiTriangleCount * 3);
+	for(const TOverdrawCluster& rtCluster : _rvecClusters)
+	{
+		vecOutput.insert(vecOutput.end(), _pIndices + rtCluster.uiFirstTriangle * 3, _pIndices + (rtCluster.uiFirstTriangle + rtCluster.uiTriangleCount) * 3);
+	}
+	memcpy(_pIndices, vecOutput.data(), vecOutput.size() * sizeof(DWORD));
+}
+
+//Implementation
+TVertexCacheStats
+AnalyzeVertexCache(const DWORD* _pIndices, unsigned int _uiIndexCount, unsigned int _uiVertexCount, unsigned int _uiCacheSize)
+{
+	TVertexCacheStats tStats;
+	unsigned int uiTriangleCount = _uiIndexCount / 3;
+	if(!_pIndices || !uiTriangleCount || !_uiVertexCount) return(tStats);
+
+	//A vertex is still in the FIFO if fewer than _uiCacheSize misses have happened since it went in
+	std::vector<unsigned int> vecTimestamps(_uiVertexCount, 0);
+	std::vector<bool> vecUsed(_uiVertexCount, false);
+	unsigned int uiTime = _uiCacheSize + 1;
+	unsigned int uiMisses = 0;
+	unsigned int uiUsed = 0;
+
+	for(unsigned int i = 0; i < uiTriangleCount * 3; ++i)
+	{
+		DWORD dwVertex = _pIndices[i];
+		if(dwVertex >= _uiVertexCount) continue;
+
+		if(uiTime - vecTimestamps[dwVertex] > _uiCacheSize)
+		{
+			vecTimestamps[dwVertex] = uiTime++;
+			++uiMisses;
+		}
+
+		if(!vecUsed[dwVertex])
+		{
+			vecUsed[dwVertex] = true;
+			++uiUsed;
+		}
+	}
+
+	tStats.fACMR = (float)uiMisses / uiTriangleCount;
+	tStats.fATVR = uiUsed ? (float)uiMisses / uiUsed : 0.0f;
+
+	return(tStats);
+}
+
+void
+OptimizeVertexCache(DWORD* _pIndices, unsigned int _uiIndexCount, unsigned int _uiVertexCount, std::vector<unsigned int>* _pvecClusters, unsigned int _uiCacheSize)
+{
+	if(_pvecClusters) _pvecClusters->clear();
+
+	unsigned int uiTriangleCount = _uiIndexCount / 3;
+	if(!_pIndices || !uiTriangleCount || !_uiVertexCount) return;
+
+	//Triangles around each vertex, and how many of those are still to be emitted
+	std::vector<unsigned int> vecLive(_uiVertexCount, 0);
+	for(unsigned int i = 0; i < uiTriangleCount * 3; ++i) ++vecLive[_pIndices[i]];
+
+	std::vector<unsigned int> vecOffsets(_uiVertexCount + 1, 0);
+	for(unsigned int i = 0; i < _uiVertexCount; ++i) vecOffsets[i + 1] = vecOffsets[i] + vecLive[i];
+
+	std::vector<unsigned int> vecAdjacency(uiTriangleCount * 3);
+	std::vector<unsigned int> vecFill(vecOffsets.begin(), vecOffsets.end() - 1);
+	for(unsigned int i = 0; i < uiTriangleCount * 3; ++i) vecAdjacency[vecFill[_pIndices[i]]++] = i / 3;
+
+	std::vector<unsigned int> vecTimestamps(_uiVertexCount, 0);
+	std::vector<bool> vecEmitted(uiTriangleCount, false);
+	std::vector<DWORD> vecDeadEnds;
+	std::vector<DWORD> vecCandidates;
+	std::vector<DWORD> vecOutput(uiTriangleCount * 3);
+	unsigned int uiOutput = 0;
+	unsigned int uiTime = _uiCacheSize + 1;
+	unsigned int uiCursor = 0;
+
+	unsigned int uiFanning = SkipDeadEnd(vecLive, vecDeadEnds, uiCursor, _uiVertexCount);
+	bool bColdStart = true;
+	while(uiFanning < _uiVertexCount)
+	{
+		if(bColdStart && _pvecClusters) _pvecClusters->push_back(uiOutput);
+
+		//Emit every remaining triangle around the fanning vertex
+		vecCandidates.clear();
+		for(unsigned int i = vecOffsets[uiFanning]; i < vecOffsets[uiFanning + 1]; ++i)
+		{
+			unsigned int uiTriangle = vecAdjacency[i];
+			if(vecEmitted[uiTriangle]) continue;
+			vecEmitted[uiTriangle] = true;
+
+			for(unsigned int j = 0; j < 3; ++j)
+			{
+				DWORD dwVertex = _pIndices[uiTriangle * 3 + j];
+				vecOutput[uiOutput++] = dwVertex;
+				vecDeadEnds.push_back(dwVertex);
+				vecCandidates.push_back(dwVertex);
+				--vecLive[dwVertex];
+
+				if(uiTime - vecTimestamps[dwVertex] > _uiCacheSize) vecTimestamps[dwVertex] = uiTime++;
+			}
+		}
+
+		//Prefer the candidate that has been in the cache longest but will still be there once its own fan is emitted
+		unsigned int uiNext = _uiVertexCount;
+		int iBestPriority = -1;
+		for(DWORD dwVertex : vecCandidates)
+		{
+			if(!vecLive[dwVertex]) continue;
+
+			int iPriority = 0;
+			if(uiTime - vecTimestamps[dwVertex] + 2 * vecLive[dwVertex] <= _uiCacheSize) iPriority = (int)(uiTime - vecTimestamps[dwVertex]);
+			if(iPriority > iBestPriority)
+			{
+				iBestPriority = iPriority;
+				uiNext = dwVertex;
+			}
+		}
+
+		bColdStart = (uiNext == _uiVertexCount);
+		uiFanning = bColdStart ? SkipDeadEnd(vecLive, vecDeadEnds, uiCursor, _uiVertexCount) : uiNext;
+	}
+
+	memcpy(_pIndices, vecOutput.data(), uiTriangleCount * 3 * sizeof(DWORD));
+}
+
+unsigned int
+OptimizeOverdraw(DWORD* _pIndices, unsigned int _uiIndexCount, const void* _pVertices, unsigned int _uiVertexCount, size_t _uiVertexStride,
+	const std::vector<unsigned int>& _rvecClusters, float _fThreshold, unsigned int _uiCacheSize)
+{
+	unsigned int uiTriangleCount = _uiIndexCount / 3;
+	if(!_pIndices || !_pVertices || !uiTriangleCount || !_uiVertexCount) return(0);
+
+	//Each cluster starts from a cold cache once reordered, so cut where the cluster so far costs no more than the threshold allows
+	float fMaxACMR = AnalyzeVertexCache(_pIndices, _uiIndexCount, _uiVertexCount, _uiCacheSize).fACMR * _fThreshold;
+	std::vector<unsigned int> vecTimestamps(_uiVertexCount, 0);
+	unsigned int uiTime = _uiCacheSize + 1;
+
+	std::vector<TOverdrawCluster> vecClusters;
+	for(unsigned int i = 0; i < _rvecClusters.size(); ++i)
+	{
+		unsigned int uiFirst = _rvecClusters[i] / 3;
+		unsigned int uiEnd = (i + 1 < _rvecClusters.size()) ? _rvecClusters[i + 1] / 3 : uiTriangleCount;
+		if(uiFirst >= uiEnd) continue;
+
+		TOverdrawCluster tCluster = { uiFirst, 0, 0.0f };
+		unsigned int uiMisses = 0;
+		uiTime += _uiCacheSize + 1;
+
+		for(unsigned int uiTriangle = uiFirst; uiTriangle < uiEnd; ++uiTriangle)
+		{
+			for(unsigned int j = 0; j < 3; ++j)
+			{
+				DWORD dwVertex = _pIndices[uiTriangle * 3 + j];
+				if(uiTime - vecTimestamps[dwVertex] > _uiCacheSize)
+				{
+					vecTimestamps[dwVertex] = uiTime++;
+					++uiMisses;
+				}
+			}
+			++tCluster.uiTriangleCount;
+
+			if(uiTriangle + 1 < uiEnd && uiMisses <= fMaxACMR * tCluster.uiTriangleCount)
+			{
+				vecClusters.push_back(tCluster);
+				tCluster.uiFirstTriangle = uiTriangle + 1;
+				tCluster.uiTriangleCount = 0;
+				uiMisses = 0;
+				uiTime += _uiCacheSize + 1;
+			}
+		}
+
+		vecClusters.push_back(tCluster);
+	}
+
+	SortClusters(_pIndices, uiTriangleCount, _pVertices, _uiVertexStride, vecClusters);
+
+	return((unsigned int)vecClusters.size());
+}
+
+void
+SortOverdrawClusters(DWORD* _pIndices, unsigned int _uiIndexCount, const void* _pVertices, size_t _uiVertexStride,
+	const std::vector<unsigned int>& _rvecClusters, std::vector<unsigned int>& _rvecOrder)
+{
+	_rvecOrder.clear();
+	unsigned int uiTriangleCount = _uiIndexCount / 3;
+	if(!_pIndices || !_pVertices || !uiTriangleCount) return;
+
+	//Same key as the overdraw pass, but every run is kept whole
+	std::vector<TOverdrawCluster> vecClusters;
+	for(unsigned int i = 0; i < _rvecClusters.size(); ++i)
+	{
+		unsigned int uiFirst = _rvecClusters[i] / 3;
+		unsigned int uiEnd = (i + 1 < _rvecClusters.size()) ? _rvecClusters[i + 1] / 3 : uiTriangleCount;
+		if(uiFirst >= uiEnd) continue;
+
+		TOverdrawCluster tCluster = { uiFirst, uiEnd - uiFirst, 0.0f };
+		vecClusters.push_back(tCluster);
+	}
+
+	SortClusters(_pIndices, uiTriangleCount, _pVertices, _uiVertexStride, vecClusters);
+
+	//Runs are given by their first index in ascending order, so each sorted one can be found again
+	for(const TOverdrawCluster& rtCluster : vecClusters)
+	{
+		_rvecOrder.push_back((unsigned int)(std::lower_bound(_rvecClusters.begin(), _rvecClusters.end(), rtCluster.uiFirstTriangle * 3) - _rvecClusters.begin()));
+	}
+}
+
+unsigned int
+OptimizeVertexFetch(void* _pVertices, unsigned int _uiVertexCount, size_t _uiVertexStride, DWORD* _pIndices, unsigned int _uiIndexCount)
+{
+	if(!_pVertices || !_pIndices || !_uiVertexCount) return(_uiVertexCount);
+
+	const DWORD dwUnused = ~(DWORD)0;
+	std::vector<DWORD> vecRemap(_uiVertexCount, dwUnused);
+	DWORD dwNext = 0;
+	for(unsigned int i = 0; i < _uiIndexCount; ++i)
+	{
+		DWORD& rdwRemap = vecRemap[_pIndices[i]];
+		if(rdwRemap == dwUnused) rdwRemap = dwNext++;
+		_pIndices[i] = rdwRemap;
+	}
+
+	BYTE* pVertices = static_cast<BYTE*>(_pVertices);
+	std::vector<BYTE> vecSource(pVertices, pVertices + _uiVertexCount * _uiVertexStride);
+	for(unsigned int i = 0; i < _uiVertexCount; ++i)
+	{
+		if(vecRemap[i] != dwUnused) memcpy(pVertices + vecRemap[i] * _uiVertexStride, vecSource.data() + i * _uiVertexStride, _uiVertexStride);
+	}
+
+	return(dwNext);
+}
+
+void
+OptimizeMesh(void* _pVertices, unsigned int& _ruiVertexCount, size_t _uiVertexStride, DWORD* _pIndices, unsigned int _uiIndexCount, TMeshOptimizeStats* _ptStats)
+{
+	auto tStart = std::chrono::steady_clock::now();
+	TMeshOptimizeStats tStats;
+	tStats.uiTriangleCount = _uiIndexCount / 3;
+	tStats.tBefore = AnalyzeVertexCache(_pIndices, _uiIndexCount, _ruiVertexCount);
+
+	//Only whole triangle lists that stay inside the vertex buffer, anything else is left as it came in
+	bool bValid = _pVertices && _pIndices && tStats.uiTriangleCount && _uiIndexCount % 3 == 0;
+	for(unsigned int i = 0; i < _uiIndexCount && bValid; ++i) bValid = _pIndices[i] < _ruiVertexCount;
+
+	if(bValid)
+	{
+		std::vector<unsigned int> vecClusters;
+		OptimizeVertexCache(_pIndices, _uiIndexCount, _ruiVertexCount, &vecClusters);
+		tStats.uiClusterCount = OptimizeOverdraw(_pIndices, _uiIndexCount, _pVertices, _ruiVertexCount, _uiVertexStride, vecClusters);
+
+		unsigned int uiVertexCount = OptimizeVertexFetch(_pVertices, _ruiVertexCount, _uiVertexStride, _pIndices, _uiIndexCount);
+		tStats.uiVerticesRemoved = _ruiVertexCount - uiVertexCount;
+		_ruiVertexCount = uiVertexCount;
+	}
+
+	tStats.tAfter = AnalyzeVertexCache(_pIndices, _uiIndexCount, _ruiVertexCount);
+	tStats.dMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	if(_ptStats) *_ptStats = tStats;
+}
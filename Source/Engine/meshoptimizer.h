@@ -0,0 +1,72 @@
+#pragma once
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__
+
+//Library Includes
+#include <windows.h>
+#include <vector>
+
+//Import time reordering of triangle lists, run on mesh data before it is cooked and handed to CMesh::Initialize
+//	Vertex cache	- Tipsify (Sander, Nehab and Barczak 2007), triangles are fanned around recently used vertices
+//	Overdraw		- the cache ordered stream is cut into clusters which are sorted to draw outward facing ones first
+//	Vertex fetch	- vertices are renumbered in first use order so fetches walk the buffer forwards
+//Index buffers are triangle lists, positions are three floats at the start of each vertex
+
+//Types
+#define MESH_OPTIMIZE_CACHE_SIZE 16 //Post-transform FIFO the optimizer and the stats assume
+#define MESH_OPTIMIZE_OVERDRAW_THRESHOLD 1.05f //Worst ACMR the overdraw pass may trade for a better cluster order, as a multiple of the cache ordered ACMR
+
+struct TVertexCacheStats
+{
+	float fACMR; //Average cache miss ratio, vertices transformed per triangle. 0.5 is the limit for a regular grid, 3 is no reuse at all
+	float fATVR; //Average transformed vertex ratio, vertices transformed per vertex used. 1 is ideal
+
+	TVertexCacheStats()
+		: fACMR(0.0f)
+		, fATVR(0.0f)
+	{
+	}
+};
+
+struct TMeshOptimizeStats
+{
+	TVertexCacheStats tBefore;
+	TVertexCacheStats tAfter;
+	unsigned int uiTriangleCount;
+	unsigned int uiClusterCount; //Clusters the overdraw pass sorted
+	unsigned int uiVerticesRemoved; //Referenced by no triangle, dropped by the fetch remap
+	double dMs;
+
+	TMeshOptimizeStats()
+		: uiTriangleCount(0)
+		, uiClusterCount(0)
+		, uiVerticesRemoved(0)
+		, dMs(0.0)
+	{
+	}
+};
+
+//Prototypes
+//Simulates a FIFO post-transform cache of _uiCacheSize entries over the triangle list
+TVertexCacheStats AnalyzeVertexCache(const DWORD* _pIndices, unsigned int _uiIndexCount, unsigned int _uiVertexCount, unsigned int _uiCacheSize = MESH_OPTIMIZE_CACHE_SIZE);
+
+//Reorders triangles in place. _pvecClusters receives the first index of each run that starts from a cold cache, the overdraw pass keeps those runs whole
+void OptimizeVertexCache(DWORD* _pIndices, unsigned int _uiIndexCount, unsigned int _uiVertexCount, std::vector<unsigned int>* _pvecClusters = nullptr, unsigned int _uiCacheSize = MESH_OPTIMIZE_CACHE_SIZE);
+
+//Splits the clusters from OptimizeVertexCache further while their ACMR stays within _fThreshold of the whole mesh's, then sorts them so
+//clusters facing away from the mesh centre draw first. Returns the number of clusters sorted
+unsigned int OptimizeOverdraw(DWORD* _pIndices, unsigned int _uiIndexCount, const void* _pVertices, unsigned int _uiVertexCount, size_t _uiVertexStride,
+	const std::vector<unsigned int>& _rvecClusters, float _fThreshold = MESH_OPTIMIZE_OVERDRAW_THRESHOLD, unsigned int _uiCacheSize = MESH_OPTIMIZE_CACHE_SIZE);
+
+//Sorts runs of triangles by the same key as OptimizeOverdraw without splitting them, for runs that have to stay whole such as culling clusters.
+//_rvecClusters holds the first index of each run in ascending order, _rvecOrder receives the run now drawn at each position
+void SortOverdrawClusters(DWORD* _pIndices, unsigned int _uiIndexCount, const void* _pVertices, size_t _uiVertexStride,
+	const std::vector<unsigned int>& _rvecClusters, std::vector<unsigned int>& _rvecOrder);
+
+//Renumbers vertices in the order the indices first use them, in place. Unused vertices are dropped, returns the new vertex count
+unsigned int OptimizeVertexFetch(void* _pVertices, unsigned int _uiVertexCount, size_t _uiVertexStride, DWORD* _pIndices, unsigned int _uiIndexCount);
+
+//All three passes in order, _ruiVertexCount is updated if vertices were dropped
+void OptimizeMesh(void* _pVertices, unsigned int& _ruiVertexCount, size_t _uiVertexStride, DWORD* _pIndices, unsigned int _uiIndexCount, TMeshOptimizeStats* _ptStats = nullptr);
+
+#endif //__MESH_OPTIMIZER_H__
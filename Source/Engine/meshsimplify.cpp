@@ -0,0 +1,393 @@
+//Library Includes
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <numeric>
+
+//Local Includes
+#include "meshoptimizer.h"
+
+//This Include
+#include "meshsimplify.h"
+
+//Types
+//Planes a position has to stay close to, summed as one symmetric 3x3 system
+struct TQuadric
+{
+	double pdA[6]; //xx, xy, xz, yy, yz, zz
+	double pdB[3];
+	double dC;
+	double dArea; //Face area only, border planes add none so the error stays a distance
+};
+
+struct TCollapse
+{
+	float fCost;
+	unsigned int uiSource; //Positions, the source moves onto the target
+	unsigned int uiTarget;
+};
+
+//Static Variables
+static const double s_kdBorderWeight = 10.0; //Border planes against face planes, per unit of squared edge length
+static const float s_kfMinNormalCos = 0.25f; //A collapse that turns a triangle further than this is refused
+
+//Helpers
+static void AddPlane(TQuadric& _rtQuadric, double _dX, double _dY, double _dZ, double _dD, double _dWeight)
+{
+	_rtQuadric.pdA[0] += _dWeight * _dX * _dX;
+	_rtQuadric.pdA[1] += _dWeight * _dX * _dY;
+	_rtQuadric.pdA[2] += _dWeight * _dX * _dZ;
+	_rtQuadric.pdA[3] += _dWeight * _dY * _dY;
+	_rtQuadric.pdA[4] += _dWeight * _dY * _dZ;
+	_rtQuadric.pdA[5] += _dWeight * _dZ * _dZ;
+	_rtQuadric.pdB[0] += _dWeight * _dD * _dX;
+	_rtQuadric.pdB[1] += _dWeight * _dD * _dY;
+	_rtQuadric.pdB[2] += _dWeight * _dD * _dZ;
+	_rtQuadric.dC += _dWeight * _dD * _dD;
+}
+
+static void AddQuadric(TQuadric& _rtQuadric, const TQuadric& _rtOther)
+{
+	for(int i = 0; i < 6; ++i) _rtQuadric.pdA[i] += _rtOther.pdA[i];
+	for(int i = 0; i < 3; ++i) _rtQuadric.pdB[i] += _rtOther.pdB[i];
+	_rtQuadric.dC += _rtOther.dC;
+	_rtQuadric.dArea += _rtOther.dArea;
+}
+
+//Mean squared distance from _rvec3Point to the planes of both quadrics
+static float EvaluateCollapse(const TQuadric& _rtSource, const TQuadric& _rtTarget, const float3& _rvec3Point)
+{
+	TQuadric tQuadric = _rtSource;
+	AddQuadric(tQuadric, _rtTarget);
+
+	double dX = _rvec3Point.x, dY = _rvec3Point.y, dZ = _rvec3Point.z;
+	double dError = tQuadric.pdA[0] * dX * dX + tQuadric.pdA[3] * dY * dY + tQuadric.pdA[5] * dZ * dZ
+		+ 2.0 * (tQuadric.pdA[1] * dX * dY + tQuadric.pdA[2] * dX * dZ + tQuadric.pdA[4] * dY * dZ)
+		+ 2.0 * (tQuadric.pdB[0] * dX + tQuadric.pdB[1] * dY + tQuadric.pdB[2] * dZ) + tQuadric.dC;
+
+	return((float)(max(dError, 0.0) / (tQuadric.dArea > 0.0 ? tQuadric.dArea : 1.0)));
+}
+
+//Vertex at the target position that _dwWedge shares a triangle with, it takes the wedge's place after the collapse.
+//Returns _uiVertexCount when there is none, moving the wedge would then tear a UV seam or hard edge open
+static unsigned int FindMatchingWedge(const std::vector<DWORD>& _rvecIndices, const std::vector<unsigned int>& _rvecPosition, const unsigned int* _puiTriangles,
+	unsigned int _uiTriangleCount, DWORD _dwWedge, unsigned int _uiTarget, unsigned int _uiVertexCount)
+{
+	for(unsigned int t = 0; t < _uiTriangleCount; ++t)
+	{
+		const DWORD* pdwTriangle = &_rvecIndices[_puiTriangles[t] * 3];
+		if(pdwTriangle[0] != _dwWedge && pdwTriangle[1] != _dwWedge && pdwTriangle[2] != _dwWedge) continue;
+
+		for(int k = 0; k < 3; ++k)
+		{
+			if(_rvecPosition[pdwTriangle[k]] == _uiTarget) return(pdwTriangle[k]);
+		}
+	}
+
+	return(_uiVertexCount);
+}
+
+//Indices through the remap with triangles that collapsed to a line or point dropped
+static void CompactTriangles(std::vector<DWORD>& _rvecIndices, std::vector<DWORD>& _rvecRemap, const std::vector<unsigned int>& _rvecPosition)
+{
+	size_t uiWrite = 0;
+	for(size_t i = 0; i + 2 < _rvecIndices.size(); i += 3)
+	{
+		DWORD pdwCorners[3];
+		for(int k = 0; k < 3; ++k)
+		{
+			DWORD dwVertex = _rvecIndices[i + k];
+			while(_rvecRemap[dwVertex] != dwVertex) dwVertex = _rvecRemap[dwVertex];
+			_rvecRemap[_rvecIndices[i + k]] = dwVertex; //Shortens the chain for the next pass
+			pdwCorners[k] = dwVertex;
+		}
+
+		unsigned int uiA = _rvecPosition[pdwCorners[0]], uiB = _rvecPosition[pdwCorners[1]], uiC = _rvecPosition[pdwCorners[2]];
+		if(uiA == uiB || uiB == uiC || uiA == uiC) continue;
+
+		_rvecIndices[uiWrite++] = pdwCorners[0];
+		_rvecIndices[uiWrite++] = pdwCorners[1];
+		_rvecIndices[uiWrite++] = pdwCorners[2];
+	}
+
+	_rvecIndices.resize(uiWrite);
+}
+
+static inline unsigned long long EdgeKey(unsigned int _uiA, unsigned int _uiB)
+{
+	return(_uiA < _uiB ? ((unsigned long long)_uiA << 32) | _uiB : ((unsigned long long)_uiB << 32) | _uiA);
+}
+
+//Implementation
+unsigned int
+SimplifyMesh(DWORD* _pDestination, const DWORD* _pIndices, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount,
+	unsigned int _uiTargetIndexCount, float* _pfError)
+{
+	if(_pfError) *_pfError = 0.0f;
+	if(!_pDestination || !_pIndices || !_pVertices || _uiIndexCount < 3 || !_uiVertexCount) return(0);
+
+	//Vertices sharing a position (UV seams, hard edges) are grouped, the groups are what collapse
+	std::vector<unsigned int> vecWedges(_uiVertexCount);
+	std::iota(vecWedges.begin(), vecWedges.end(), 0);
+	std::sort(vecWedges.begin(), vecWedges.end(), [_pVertices](unsigned int _uiA, unsigned int _uiB)
+	{
+		const float3& rvec3A = _pVertices[_uiA].pos;
+		const float3& rvec3B = _pVertices[_uiB].pos;
+		if(rvec3A.x != rvec3B.x) return(rvec3A.x < rvec3B.x);
+		if(rvec3A.y != rvec3B.y) return(rvec3A.y < rvec3B.y);
+		return(rvec3A.z < rvec3B.z);
+	});
+
+	std::vector<unsigned int> vecPosition(_uiVertexCount);
+	std::vector<unsigned int> vecWedgeStart;
+	std::vector<float3> vecPoints;
+	for(unsigned int i = 0; i < _uiVertexCount; ++i)
+	{
+		const float3& rvec3Pos = _pVertices[vecWedges[i]].pos;
+		if(vecPoints.empty() || rvec3Pos.x != vecPoints.back().x || rvec3Pos.y != vecPoints.back().y || rvec3Pos.z != vecPoints.back().z)
+		{
+			vecWedgeStart.push_back(i);
+			vecPoints.push_back(rvec3Pos);
+		}
+
+		vecPosition[vecWedges[i]] = (unsigned int)vecPoints.size() - 1;
+	}
+	unsigned int uiPositionCount = (unsigned int)vecPoints.size();
+	vecWedgeStart.push_back(_uiVertexCount);
+
+	std::vector<DWORD> vecIndices;
+	vecIndices.reserve(_uiIndexCount);
+	for(unsigned int i = 0; i + 2 < _uiIndexCount; i += 3)
+	{
+		if(_pIndices[i] < _uiVertexCount && _pIndices[i + 1] < _uiVertexCount && _pIndices[i + 2] < _uiVertexCount) vecIndices.insert(vecIndices.end(), _pIndices + i, _pIndices + i + 3);
+	}
+
+	//Face planes weighted by area, then planes standing up along the open borders to hold them in place
+	std::vector<TQuadric> vecQuadrics(uiPositionCount, TQuadric());
+	std::vector<unsigned long long> vecEdges;
+	vecEdges.reserve(vecIndices.size());
+	for(size_t i = 0; i < vecIndices.size(); i += 3)
+	{
+		for(int k = 0; k < 3; ++k) vecEdges.push_back(EdgeKey(vecPosition[vecIndices[i + k]], vecPosition[vecIndices[i + (k + 1) % 3]]));
+	}
+	std::sort(vecEdges.begin(), vecEdges.end());
+
+	for(size_t i = 0; i < vecIndices.size(); i += 3)
+	{
+		unsigned int puiCorners[3] = { vecPosition[vecIndices[i]], vecPosition[vecIndices[i + 1]], vecPosition[vecIndices[i + 2]] };
+		float3 vec3Normal = (vecPoints[puiCorners[1]] - vecPoints[puiCorners[0]]).Cross(vecPoints[puiCorners[2]] - vecPoints[puiCorners[0]]);
+		double dLength = sqrt((double)vec3Normal.Dot(vec3Normal));
+		if(dLength <= 0.0) continue;
+
+		double dX = vec3Normal.x / dLength, dY = vec3Normal.y / dLength, dZ = vec3Normal.z / dLength;
+		double dD = -(dX * vecPoints[puiCorners[0]].x + dY * vecPoints[puiCorners[0]].y + dZ * vecPoints[puiCorners[0]].z);
+		for(int k = 0; k < 3; ++k)
+		{
+			AddPlane(vecQuadrics[puiCorners[k]], dX, dY, dZ, dD, dLength * 0.5);
+			vecQuadrics[puiCorners[k]].dArea += dLength * 0.5;
+		}
+
+		for(int k = 0; k < 3; ++k)
+		{
+			unsigned int uiA = puiCorners[k], uiB = puiCorners[(k + 1) % 3];
+			auto tRange = std::equal_range(vecEdges.begin(), vecEdges.end(), EdgeKey(uiA, uiB));
+			if(tRange.second - tRange.first != 1) continue;
+
+			float3 vec3Edge = vecPoints[uiB] - vecPoints[uiA];
+			float3 vec3Side = vec3Edge.Cross(float3((float)dX, (float)dY, (float)dZ));
+			double dSideLength = sqrt((double)vec3Side.Dot(vec3Side));
+			if(dSideLength <= 0.0) continue;
+
+			double dSX = vec3Side.x / dSideLength, dSY = vec3Side.y / dSideLength, dSZ = vec3Side.z / dSideLength;
+			double dSD = -(dSX * vecPoints[uiA].x + dSY * vecPoints[uiA].y + dSZ * vecPoints[uiA].z);
+			double dWeight = vec3Edge.Dot(vec3Edge) * s_kdBorderWeight;
+			AddPlane(vecQuadrics[uiA], dSX, dSY, dSZ, dSD, dWeight);
+			AddPlane(vecQuadrics[uiB], dSX, dSY, dSZ, dSD, dWeight);
+		}
+	}
+
+	//Collapsed vertices point at the vertex that replaced them
+	std::vector<DWORD> vecRemap(_uiVertexCount);
+	std::iota(vecRemap.begin(), vecRemap.end(), 0);
+
+	std::vector<unsigned int> vecTriangleStart(uiPositionCount + 1);
+	std::vector<unsigned int> vecTriangles;
+	std::vector<bool> vecUsed(_uiVertexCount);
+	std::vector<bool> vecBorder(uiPositionCount);
+	std::vector<bool> vecTouched(uiPositionCount);
+	std::vector<TCollapse> vecCollapses;
+	float fMaxCost = 0.0f;
+
+	//Each pass collapses the cheapest edges that don't touch each other, then the topology is rebuilt
+	for(;;)
+	{
+		CompactTriangles(vecIndices, vecRemap, vecPosition);
+		if(vecIndices.size() <= _uiTargetIndexCount) break;
+
+		//Triangles around each position
+		std::fill(vecTriangleStart.begin(), vecTriangleStart.end(), 0);
+		for(DWORD dwVertex : vecIndices) ++vecTriangleStart[vecPosition[dwVertex] + 1];
+		std::partial_sum(vecTriangleStart.begin(), vecTriangleStart.end(), vecTriangleStart.begin());
+
+		std::vector<unsigned int> vecCursor(vecTriangleStart.begin(), vecTriangleStart.end() - 1);
+		vecTriangles.resize(vecIndices.size());
+		for(size_t i = 0; i < vecIndices.size(); ++i) vecTriangles[vecCursor[vecPosition[vecIndices[i]]]++] = (unsigned int)(i / 3);
+
+		std::fill(vecUsed.begin(), vecUsed.end(), false);
+		for(DWORD dwVertex : vecIndices) vecUsed[dwVertex] = true;
+
+		//Edges used by anything other than two triangles are borders
+		vecEdges.clear();
+		for(size_t i = 0; i < vecIndices.size(); i += 3)
+		{
+			for(int k = 0; k < 3; ++k) vecEdges.push_back(EdgeKey(vecPosition[vecIndices[i + k]], vecPosition[vecIndices[i + (k + 1) % 3]]));
+		}
+		std::sort(vecEdges.begin(), vecEdges.end());
+
+		std::fill(vecBorder.begin(), vecBorder.end(), false);
+		for(size_t i = 0, j = 0; i < vecEdges.size(); i = j)
+		{
+			for(j = i; j < vecEdges.size() && vecEdges[j] == vecEdges[i]; ++j);
+			if(j - i == 2) continue;
+
+			vecBorder[(unsigned int)(vecEdges[i] >> 32)] = true;
+			vecBorder[(unsigned int)(vecEdges[i] & 0xFFFFFFFF)] = true;
+		}
+
+		//Cheapest allowed direction of every edge
+		vecCollapses.clear();
+		for(size_t i = 0, j = 0; i < vecEdges.size(); i = j)
+		{
+			for(j = i; j < vecEdges.size() && vecEdges[j] == vecEdges[i]; ++j);
+			bool bBorderEdge = (j - i) != 2;
+			unsigned int puiEnds[2] = { (unsigned int)(vecEdges[i] >> 32), (unsigned int)(vecEdges[i] & 0xFFFFFFFF) };
+
+			TCollapse tBest = { FLT_MAX, 0, 0 };
+			for(int iDirection = 0; iDirection < 2; ++iDirection)
+			{
+				unsigned int uiSource = puiEnds[iDirection], uiTarget = puiEnds[1 - iDirection];
+
+				//Border vertices only slide along the border
+				if(vecBorder[uiSource] && !bBorderEdge) continue;
+
+				//Every vertex still in use at the source needs a partner at the target, so a seam only collapses along itself
+				bool bSeamSafe = true;
+				for(unsigned int w = vecWedgeStart[uiSource]; w < vecWedgeStart[uiSource + 1] && bSeamSafe; ++w)
+				{
+					if(!vecUsed[vecWedges[w]]) continue;
+					bSeamSafe = FindMatchingWedge(vecIndices, vecPosition, &vecTriangles[vecTriangleStart[uiSource]],
+						vecTriangleStart[uiSource + 1] - vecTriangleStart[uiSource], vecWedges[w], uiTarget, _uiVertexCount) != _uiVertexCount;
+				}
+				if(!bSeamSafe) continue;
+
+				float fCost = EvaluateCollapse(vecQuadrics[uiSource], vecQuadrics[uiTarget], vecPoints[uiTarget]);
+				if(fCost < tBest.fCost) tBest = { fCost, uiSource, uiTarget };
+			}
+
+			if(tBest.fCost < FLT_MAX) vecCollapses.push_back(tBest);
+		}
+
+		std::sort(vecCollapses.begin(), vecCollapses.end(), [](const TCollapse& _rtA, const TCollapse& _rtB) { return(_rtA.fCost < _rtB.fCost); });
+
+		//Cheapest first. Anything next to a collapse waits for the next pass, so the triangle lists above stay true for the rest
+		std::fill(vecTouched.begin(), vecTouched.end(), false);
+		unsigned int uiTrianglesLeft = (unsigned int)vecIndices.size() / 3;
+		unsigned int uiCollapses = 0;
+		for(const TCollapse& rtCollapse : vecCollapses)
+		{
+			if(uiTrianglesLeft * 3 <= _uiTargetIndexCount) break;
+			if(vecTouched[rtCollapse.uiSource] || vecTouched[rtCollapse.uiTarget]) continue;
+
+			//Refuse collapses that flip or fold a triangle around the source
+			bool bFlips = false;
+			unsigned int uiRemoved = 0;
+			for(unsigned int t = vecTriangleStart[rtCollapse.uiSource]; t < vecTriangleStart[rtCollapse.uiSource + 1] && !bFlips; ++t)
+			{
+				const DWORD* pdwTriangle = &vecIndices[vecTriangles[t] * 3];
+				unsigned int puiCorners[3] = { vecPosition[pdwTriangle[0]], vecPosition[pdwTriangle[1]], vecPosition[pdwTriangle[2]] };
+				if(puiCorners[0] == rtCollapse.uiTarget || puiCorners[1] == rtCollapse.uiTarget || puiCorners[2] == rtCollapse.uiTarget)
+				{
+					++uiRemoved;
+					continue;
+				}
+
+				float3 pvec3Before[3], pvec3After[3];
+				for(int k = 0; k < 3; ++k)
+				{
+					pvec3Before[k] = vecPoints[puiCorners[k]];
+					pvec3After[k] = vecPoints[puiCorners[k] == rtCollapse.uiSource ? rtCollapse.uiTarget : puiCorners[k]];
+				}
+
+				float3 vec3Before = (pvec3Before[1] - pvec3Before[0]).Cross(pvec3Before[2] - pvec3Before[0]);
+				float3 vec3After = (pvec3After[1] - pvec3After[0]).Cross(pvec3After[2] - pvec3After[0]);
+				float fLengths = sqrtf(vec3Before.Dot(vec3Before) * vec3After.Dot(vec3After));
+				bFlips = fLengths <= 0.0f || vec3Before.Dot(vec3After) < s_kfMinNormalCos * fLengths;
+			}
+			if(bFlips) continue;
+
+			//Source vertices move to their partners at the target, the target takes on the source's planes
+			for(unsigned int w = vecWedgeStart[rtCollapse.uiSource]; w < vecWedgeStart[rtCollapse.uiSource + 1]; ++w)
+			{
+				DWORD dwWedge = vecWedges[w];
+				unsigned int uiPartner = FindMatchingWedge(vecIndices, vecPosition, &vecTriangles[vecTriangleStart[rtCollapse.uiSource]],
+					vecTriangleStart[rtCollapse.uiSource + 1] - vecTriangleStart[rtCollapse.uiSource], dwWedge, rtCollapse.uiTarget, _uiVertexCount);
+				vecRemap[dwWedge] = (uiPartner != _uiVertexCount) ? uiPartner : vecWedges[vecWedgeStart[rtCollapse.uiTarget]]; //Unused vertices go anywhere
+			}
+			AddQuadric(vecQuadrics[rtCollapse.uiTarget], vecQuadrics[rtCollapse.uiSource]);
+
+			vecTouched[rtCollapse.uiSource] = vecTouched[rtCollapse.uiTarget] = true;
+			for(unsigned int t = vecTriangleStart[rtCollapse.uiSource]; t < vecTriangleStart[rtCollapse.uiSource + 1]; ++t)
+			{
+				for(int k = 0; k < 3; ++k) vecTouched[vecPosition[vecIndices[vecTriangles[t] * 3 + k]]] = true;
+			}
+
+			uiTrianglesLeft -= uiRemoved;
+			fMaxCost = max(fMaxCost, rtCollapse.fCost);
+			++uiCollapses;
+		}
+
+		if(!uiCollapses) break;
+	}
+
+	std::copy(vecIndices.begin(), vecIndices.end(), _pDestination);
+	if(_pfError) *_pfError = sqrtf(fMaxCost);
+
+	return((unsigned int)vecIndices.size());
+}
+
+unsigned int
+BuildMeshLods(const DWORD* _pIndices, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount,
+	std::vector<DWORD>& _rvecLodIndices, TMeshLod* _ptLods)
+{
+	_rvecLodIndices.assign(_pIndices, _pIndices + _uiIndexCount);
+	_ptLods[0] = TMeshLod();
+	_ptLods[0].uiIndexCount = _uiIndexCount;
+
+	unsigned int uiLodCount = 1;
+	if(_uiIndexCount / 3 < MESH_LOD_MIN_TRIANGLES) return(uiLodCount);
+
+	std::vector<DWORD> vecLod(_uiIndexCount);
+	while(uiLodCount < MESH_MAX_LODS)
+	{
+		//Simplified from the level before, so the errors add up
+		TMeshLod tPrevious = _ptLods[uiLodCount - 1];
+		float fError = 0.0f;
+		unsigned int uiIndexCount = SimplifyMesh(vecLod.data(), _rvecLodIndices.data() + tPrevious.uiIndexStart, tPrevious.uiIndexCount, _pVertices, _uiVertexCount,
+			(tPrevious.uiIndexCount / 6) * 3, &fError);
+
+		//Not worth a level if it barely shrank
+		if(!uiIndexCount || uiIndexCount > tPrevious.uiIndexCount * MESH_LOD_MIN_REDUCTION) break;
+
+		OptimizeVertexCache(vecLod.data(), uiIndexCount, _uiVertexCount);
+
+		TMeshLod& rtLod = _ptLods[uiLodCount++];
+		rtLod.uiIndexStart = (UINT)_rvecLodIndices.size();
+		rtLod.uiIndexCount = uiIndexCount;
+		rtLod.fError = tPrevious.fError + fError;
+		_rvecLodIndices.insert(_rvecLodIndices.end(), vecLod.begin(), vecLod.begin() + uiIndexCount);
+
+		if(uiIndexCount / 3 < MESH_LOD_MIN_TRIANGLES) break;
+	}
+
+	return(uiLodCount);
+}
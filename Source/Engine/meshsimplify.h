@@ -0,0 +1,37 @@
+#pragma once
+#ifndef __MESH_SIMPLIFY_H__
+#define __MESH_SIMPLIFY_H__
+
+//Library Includes
+#include <windows.h>
+#include <vector>
+#include <DirectXCollision.h>
+
+//Local Includes
+#include "dxcommon.h"
+#include "vertexdefs.h"
+#include "imesh.h"
+
+//Import time level of detail generation by quadric error edge collapse (Garland and Heckbert 1997)
+//	Vertices sharing a position collapse together, each one moves to the vertex at the target it shares a triangle with
+//	Collapses only land on an existing vertex, so every level indexes the same vertex buffer as LOD 0
+//	UV seams and open borders are kept, a vertex on one can only slide along it
+//Index buffers are triangle lists
+
+//Types
+#define MESH_LOD_MIN_TRIANGLES 64 //Levels stop once they get this small, meshes below it keep LOD 0 only
+#define MESH_LOD_MIN_REDUCTION 0.85f //A level must get under this fraction of the triangles of the one before, otherwise the chain stops
+
+//Prototypes
+//Collapses edges cheapest first until at most _uiTargetIndexCount indices are left or nothing more can go without breaking a seam,
+//a border or flipping a triangle. Writes to _pDestination, which needs room for _uiIndexCount, and returns the new index count.
+//_pfError receives the largest collapse error as a root mean square distance in object space units
+unsigned int SimplifyMesh(DWORD* _pDestination, const DWORD* _pIndices, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount,
+	unsigned int _uiTargetIndexCount, float* _pfError = nullptr);
+
+//LOD 0 is _pIndices as given, each level after it aims for half the triangles of the one before and is cache ordered.
+//_rvecLodIndices receives every level back to back, _ptLods at least MESH_MAX_LODS entries. Returns the level count
+unsigned int BuildMeshLods(const DWORD* _pIndices, unsigned int _uiIndexCount, const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount,
+	std::vector<DWORD>& _rvecLodIndices, TMeshLod* _ptLods);
+
+#endif //__MESH_SIMPLIFY_H__
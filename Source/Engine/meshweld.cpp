@@ -0,0 +1,185 @@
+//Library Includes
+#include <math.h>
+#include <string.h>
+#include <float.h>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+
+//This Include
+#include "meshweld.h"
+
+//Static Variables
+static const unsigned long long s_kullFnvPrime = 0x100000001B3ULL;
+static const unsigned int s_kuiNoVertex = 0xFFFFFFFF;
+
+//Helpers
+//Grid cell of a coordinate, the grid is twice the tolerance wide so a vertex's tolerance reaches at most two cells an axis
+static inline long long GetCell(float _fValue, float _fCellSize)
+{
+	return((long long)floor((double)_fValue / _fCellSize));
+}
+
+static inline unsigned long long GetCellKey(long long _llX, long long _llY, long long _llZ)
+{
+	unsigned long long ullKey = HashMeshBytes(&_llX, sizeof(_llX));
+	ullKey = HashMeshBytes(&_llY, sizeof(_llY), ullKey);
+	return(HashMeshBytes(&_llZ, sizeof(_llZ), ullKey));
+}
+
+//Directions within _fMinDot of each other, zero length vectors only match zero length vectors
+static bool IsDirectionNear(const float3& _rvec3A, const float3& _rvec3B, float _fMinDot)
+{
+	float fLengthA = sqrtf(_rvec3A.x * _rvec3A.x + _rvec3A.y * _rvec3A.y + _rvec3A.z * _rvec3A.z);
+	float fLengthB = sqrtf(_rvec3B.x * _rvec3B.x + _rvec3B.y * _rvec3B.y + _rvec3B.z * _rvec3B.z);
+	if(fLengthA < FLT_EPSILON || fLengthB < FLT_EPSILON) return(fLengthA < FLT_EPSILON && fLengthB < FLT_EPSILON);
+
+	return((_rvec3A.x * _rvec3B.x + _rvec3A.y * _rvec3B.y + _rvec3A.z * _rvec3B.z) >= _fMinDot * fLengthA * fLengthB);
+}
+
+static bool IsVertexNear(const TVertexTexNorm& _rtA, const TVertexTexNorm& _rtB, const TMeshWeldTolerance& _rtTolerance, float _fMinDot)
+{
+	return(fabsf(_rtA.pos.x - _rtB.pos.x) <= _rtTolerance.fPosition
+		&& fabsf(_rtA.pos.y - _rtB.pos.y) <= _rtTolerance.fPosition
+		&& fabsf(_rtA.pos.z - _rtB.pos.z) <= _rtTolerance.fPosition
+		&& fabsf(_rtA.texcoord.x - _rtB.texcoord.x) <= _rtTolerance.fTexcoord
+		&& fabsf(_rtA.texcoord.y - _rtB.texcoord.y) <= _rtTolerance.fTexcoord
+		&& IsDirectionNear(_rtA.normal, _rtB.normal, _fMinDot)
+		&& IsDirectionNear(_rtA.tangent, _rtB.tangent, _fMinDot));
+}
+
+//Implementation
+unsigned int
+WeldVertices(TVertexTexNorm* _pVertices, unsigned int _uiVertexCount, DWORD* _pIndices, unsigned int& _ruiIndexCount,
+	const TMeshWeldTolerance& _rtTolerance, TMeshWeldStats* _ptStats)
+{
+	auto tStart = std::chrono::steady_clock::now();
+
+	TMeshWeldStats tStats;
+	tStats.uiVerticesBefore = _uiVertexCount;
+	tStats.uiVerticesAfter = _uiVertexCount;
+	if(!_pVertices || !_pIndices || !_uiVertexCount || _ruiIndexCount < 3)
+	{
+		if(_ptStats) *_ptStats = tStats;
+		return(_uiVertexCount);
+	}
+
+	float fCellSize = max(_rtTolerance.fPosition * 2.0f, 1e-6f); //Keeps cell numbers in range for a zero tolerance
+	float fMinDot = cosf(_rtTolerance.fNormalDegrees * 3.14159265f / 180.0f);
+
+	//Each cell holds a chain of the vertices kept so far, newest first
+	std::unordered_map<unsigned long long, unsigned int> mapCells;
+	mapCells.reserve(_uiVertexCount);
+	std::vector<unsigned int> vecNext(_uiVertexCount, s_kuiNoVertex);
+	std::vector<DWORD> vecRemap(_uiVertexCount);
+
+	for(unsigned int i = 0; i < _uiVertexCount; ++i)
+	{
+		const TVertexTexNorm& rtVertex = _pVertices[i];
+		vecRemap[i] = i;
+
+		//Nothing to compare a broken position against, it stays on its own
+		if(!_finite(rtVertex.pos.x) || !_finite(rtVertex.pos.y) || !_finite(rtVertex.pos.z)) continue;
+
+		const float pfPos[3] = { rtVertex.pos.x, rtVertex.pos.y, rtVertex.pos.z };
+		long long pllLow[3], pllHigh[3];
+		for(unsigned int k = 0; k < 3; ++k)
+		{
+			pllLow[k] = GetCell(pfPos[k] - _rtTolerance.fPosition, fCellSize);
+			pllHigh[k] = GetCell(pfPos[k] + _rtTolerance.fPosition, fCellSize);
+		}
+
+		unsigned int uiMatch = s_kuiNoVertex;
+		for(long long x = pllLow[0]; x <= pllHigh[0] && uiMatch == s_kuiNoVertex; ++x)
+		{
+			for(long long y = pllLow[1]; y <= pllHigh[1] && uiMatch == s_kuiNoVertex; ++y)
+			{
+				for(long long z = pllLow[2]; z <= pllHigh[2] && uiMatch == s_kuiNoVertex; ++z)
+				{
+					auto itCell = mapCells.find(GetCellKey(x, y, z));
+					if(itCell == mapCells.end()) continue;
+
+					for(unsigned int uiKept = itCell->second; uiKept != s_kuiNoVertex; uiKept = vecNext[uiKept])
+					{
+						if(!IsVertexNear(_pVertices[uiKept], rtVertex, _rtTolerance, fMinDot)) continue;
+						uiMatch = uiKept;
+						break;
+					}
+				}
+			}
+		}
+
+		if(uiMatch != s_kuiNoVertex)
+		{
+			vecRemap[i] = uiMatch;
+			if(memcmp(&_pVertices[uiMatch], &rtVertex, sizeof(TVertexTexNorm)) == 0) ++tStats.uiBitIdentical;
+			continue;
+		}
+
+		//Kept, filed under its own cell
+		unsigned long long ullKey = GetCellKey(GetCell(pfPos[0], fCellSize), GetCell(pfPos[1], fCellSize), GetCell(pfPos[2], fCellSize));
+		auto itCell = mapCells.find(ullKey);
+		if(itCell != mapCells.end())
+		{
+			vecNext[i] = itCell->second;
+			itCell->second = i;
+		}
+		else
+		{
+			mapCells[ullKey] = i;
+		}
+	}
+
+	//Kept vertices move down over the merged ones, in the order they were
+	unsigned int uiVertexCount = 0;
+	for(unsigned int i = 0; i < _uiVertexCount; ++i)
+	{
+		if(vecRemap[i] != i)
+		{
+			vecRemap[i] = vecRemap[vecRemap[i]]; //Always an earlier vertex, already moved
+			continue;
+		}
+
+		if(uiVertexCount != i) _pVertices[uiVertexCount] = _pVertices[i];
+		vecRemap[i] = uiVertexCount++;
+	}
+
+	//Remapped indices, triangles with two corners on one vertex have no area left
+	unsigned int uiIndexCount = 0;
+	for(unsigned int i = 0; i + 2 < _ruiIndexCount; i += 3)
+	{
+		DWORD dwA = _pIndices[i] < _uiVertexCount ? vecRemap[_pIndices[i]] : _pIndices[i];
+		DWORD dwB = _pIndices[i + 1] < _uiVertexCount ? vecRemap[_pIndices[i + 1]] : _pIndices[i + 1];
+		DWORD dwC = _pIndices[i + 2] < _uiVertexCount ? vecRemap[_pIndices[i + 2]] : _pIndices[i + 2];
+		if(dwA == dwB || dwB == dwC || dwA == dwC)
+		{
+			++tStats.uiTrianglesRemoved;
+			continue;
+		}
+
+		_pIndices[uiIndexCount++] = dwA;
+		_pIndices[uiIndexCount++] = dwB;
+		_pIndices[uiIndexCount++] = dwC;
+	}
+	_ruiIndexCount = uiIndexCount;
+
+	tStats.uiVerticesAfter = uiVertexCount;
+	tStats.dMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	if(_ptStats) *_ptStats = tStats;
+
+	return(uiVertexCount);
+}
+
+unsigned long long
+HashMeshBytes(const void* _pData, size_t _uiSize, unsigned long long _ullSeed)
+{
+	const unsigned char* pData = static_cast<const unsigned char*>(_pData);
+	unsigned long long ullHash = _ullSeed;
+	for(size_t i = 0; i < _uiSize; ++i)
+	{
+		ullHash ^= pData[i];
+		ullHash *= s_kullFnvPrime;
+	}
+
+	return(ullHash);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef __MESH_WELD_H__
+#define __MESH_WELD_H__
+
+//Library Includes
+#include <windows.h>
+
+//Local Includes
+#include "dxcommon.h"
+#include "vertexdefs.h"
+
+//Import time welding of duplicate vertices and hashing of geometry
+//	Assimp is run without aiProcess_JoinIdenticalVertices, so most formats arrive with a vertex per face corner.
+//	Vertices are bucketed on a grid of positions twice the tolerance wide, each vertex only checks the cells its tolerance
+//	reaches and is merged into the first earlier vertex whose every attribute is within tolerance. Triangles that
+//	collapse onto an edge are dropped
+//	The hash is a 64 bit FNV-1a, used to find meshes with the same geometry within and across models
+//Index buffers are triangle lists
+
+//Types
+struct TMeshWeldTolerance
+{
+	float fPosition;		//Object space units, well inside the packing tolerance so a welded mesh still packs
+	float fNormalDegrees;	//Angle between normals or tangents, hard edges are far above this
+	float fTexcoord;		//UV units, an eighth of a texel of a 1024 texture so UV seams stay split
+
+	TMeshWeldTolerance()
+		: fPosition(0.0001f)
+		, fNormalDegrees(0.1f)
+		, fTexcoord(1.0f / 8192.0f)
+	{
+	}
+};
+
+struct TMeshWeldStats
+{
+	unsigned int uiVerticesBefore;
+	unsigned int uiVerticesAfter;
+	unsigned int uiBitIdentical; //Merged vertices that matched byte for byte, the rest were within tolerance
+	unsigned int uiTrianglesRemoved; //Collapsed by the weld
+	double dMs;
+
+	TMeshWeldStats()
+		: uiVerticesBefore(0)
+		, uiVerticesAfter(0)
+		, uiBitIdentical(0)
+		, uiTrianglesRemoved(0)
+		, dMs(0.0)
+	{
+	}
+};
+
+#define MESH_HASH_SEED 0xCBF29CE484222325ULL
+
+//Prototypes
+//Merges vertices within _rtTolerance of an earlier one, in place. The vertices left keep their order, the indices are remapped and
+//collapsed triangles removed. Returns the new vertex count, _ruiIndexCount is updated
+unsigned int WeldVertices(TVertexTexNorm* _pVertices, unsigned int _uiVertexCount, DWORD* _pIndices, unsigned int& _ruiIndexCount,
+	const TMeshWeldTolerance& _rtTolerance = TMeshWeldTolerance(), TMeshWeldStats* _ptStats = nullptr);
+
+//Continues _ullSeed over _uiSize bytes, chain calls to hash several arrays as one
+unsigned long long HashMeshBytes(const void* _pData, size_t _uiSize, unsigned long long _ullSeed = MESH_HASH_SEED);
+
+#endif //__MESH_WELD_H__
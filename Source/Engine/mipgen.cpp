@@ -0,0 +1,503 @@
+//Library Includes
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <intrin.h>
+#include <immintrin.h>
+
+//Local Includes
+#include "jobsystem.h"
+#include "logmanager.h"
+
+//This Include
+#include "mipgen.h"
+
+//Types
+struct TColourTables
+{
+	float afToLinear[256];
+	uint8_t aucToSRGB[4096]; //Indexed by linear * 4095, fine enough that every sRGB value survives a round trip
+};
+
+//Static Variables
+static const unsigned int s_kuiFilterTaps = 12;		//Source texels per output texel for the windowed filters, 3 output texels either side
+static const int s_kiFilterOffset = 5;				//First tap of output x is source texel 2x - 5
+static const unsigned int s_kuiBandRows = 16;		//Output rows per task
+
+//Helpers
+static inline unsigned int MinUInt(unsigned int _uiA, unsigned int _uiB)
+{
+	return(_uiA < _uiB ? _uiA : _uiB);
+}
+
+static inline int ClampRow(int _i, unsigned int _uiCount)
+{
+	return(_i < 0 ? 0 : (_i >= (int)_uiCount ? (int)_uiCount - 1 : _i));
+}
+
+static const TColourTables& GetColourTables()
+{
+	static TColourTables s_tTables = []()
+	{
+		TColourTables tTables;
+		for(unsigned int i = 0; i < 256; ++i)
+		{
+			float fColour = i / 255.0f;
+			tTables.afToLinear[i] = (fColour <= 0.04045f) ? fColour / 12.92f : powf((fColour + 0.055f) / 1.055f, 2.4f);
+		}
+
+		for(unsigned int i = 0; i < 4096; ++i)
+		{
+			float fLinear = i / 4095.0f;
+			float fColour = (fLinear <= 0.0031308f) ? fLinear * 12.92f : 1.055f * powf(fLinear, 1.0f / 2.4f) - 0.055f;
+			tTables.aucToSRGB[i] = (uint8_t)(fColour * 255.0f + 0.5f);
+		}
+
+		return(tTables);
+	}();
+
+	return(s_tTables);
+}
+
+static bool HasAVX()
+{
+	//The OS also has to be saving the upper halves of the registers on a context switch
+	int aiInfo[4];
+	__cpuid(aiInfo, 1);
+	bool bAVX = (aiInfo[2] & (1 << 28)) != 0;
+	bool bOSXSave = (aiInfo[2] & (1 << 27)) != 0;
+
+	return(bAVX && bOSXSave && (_xgetbv(0) & 6) == 6);
+}
+
+static inline double SincPi(double _dX)
+{
+	const double kdPi = 3.14159265358979323846;
+	return(_dX == 0.0 ? 1.0 : sin(kdPi * _dX) / (kdPi * _dX));
+}
+
+static double BesselI0(double _dX)
+{
+	//Power series, converges quickly for the small arguments the window uses
+	double dSum = 1.0;
+	double dTerm = 1.0;
+	for(int k = 1; k < 32 && dTerm > dSum * 1e-12; ++k)
+	{
+		dTerm *= (_dX * 0.5 / k) * (_dX * 0.5 / k);
+		dSum += dTerm;
+	}
+
+	return(dSum);
+}
+
+static void BuildFilterWeights(EMipFilter _eFilter, float* _pfWeights)
+{
+	//Both filters span 3 output texels either side, sampled at the source texel centres
+	const double kdRadius = 3.0;
+	const double kdKaiserAlpha = 4.0;
+	double dTotal = 0.0;
+	double adWeights[s_kuiFilterTaps];
+
+	for(unsigned int k = 0; k < s_kuiFilterTaps; ++k)
+	{
+		//Distance from the output texel centre, in output texels
+		double dT = ((double)k - s_kiFilterOffset - 0.5) * 0.5;
+		double dWindow = 0.0;
+
+		if(_eFilter == MIP_FILTER_LANCZOS)
+		{
+			dWindow = SincPi(dT / kdRadius);
+		}
+		else
+		{
+			double dRatio = dT / kdRadius;
+			dWindow = BesselI0(kdKaiserAlpha * sqrt(1.0 - dRatio * dRatio)) / BesselI0(kdKaiserAlpha);
+		}
+
+		adWeights[k] = SincPi(dT) * dWindow;
+		dTotal += adWeights[k];
+	}
+
+	for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) _pfWeights[k] = (float)(adWeights[k] / dTotal);
+}
+
+static void DecodeRow(const uint8_t* _pSource, unsigned int _uiWidth, bool _bSRGB, float* _pfDest)
+{
+	const __m128 kvScale = _mm_set1_ps(1.0f / 255.0f);
+
+	if(_bSRGB)
+	{
+		//No gather before AVX2, the table lookups stay scalar
+		const float* pfToLinear = GetColourTables().afToLinear;
+		for(unsigned int x = 0; x < _uiWidth; ++x, _pSource += 4, _pfDest += 4)
+		{
+			_mm_storeu_ps(_pfDest, _mm_set_ps(_pSource[3] * (1.0f / 255.0f), pfToLinear[_pSource[2]], pfToLinear[_pSource[1]], pfToLinear[_pSource[0]]));
+		}
+	}
+	else
+	{
+		//Four texels at a time, bytes widened to 32bit and converted
+		const __m128i kvZero = _mm_setzero_si128();
+		unsigned int x = 0;
+		for(; x + 4 <= _uiWidth; x += 4)
+		{
+			__m128i vBytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_pSource + x * 4));
+			__m128i vLow = _mm_unpacklo_epi8(vBytes, kvZero);
+			__m128i vHigh = _mm_unpackhi_epi8(vBytes, kvZero);
+
+			_mm_storeu_ps(_pfDest + x * 4 + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(vLow, kvZero)), kvScale));
+			_mm_storeu_ps(_pfDest + x * 4 + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(vLow, kvZero)), kvScale));
+			_mm_storeu_ps(_pfDest + x * 4 + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(vHigh, kvZero)), kvScale));
+			_mm_storeu_ps(_pfDest + x * 4 + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(vHigh, kvZero)), kvScale));
+		}
+
+		for(; x < _uiWidth; ++x)
+		{
+			__m128i vTexel = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(_pSource + x * 4));
+			vTexel = _mm_unpacklo_epi16(_mm_unpacklo_epi8(vTexel, kvZero), kvZero);
+			_mm_storeu_ps(_pfDest + x * 4, _mm_mul_ps(_mm_cvtepi32_ps(vTexel), kvScale));
+		}
+	}
+}
+
+static void EncodeRow(const float* _pfSource, unsigned int _uiWidth, bool _bSRGB, uint8_t* _pDest)
+{
+	//Windowed filters overshoot, clamp before converting
+	const __m128 kvZero = _mm_setzero_ps();
+	const __m128 kvOne = _mm_set1_ps(1.0f);
+
+	if(_bSRGB)
+	{
+		const __m128 kvScale = _mm_set_ps(255.0f, 4095.0f, 4095.0f, 4095.0f);
+		const uint8_t* pucToSRGB = GetColourTables().aucToSRGB;
+		alignas(16) int aiIndex[4];
+
+		for(unsigned int x = 0; x < _uiWidth; ++x, _pfSource += 4, _pDest += 4)
+		{
+			__m128 vTexel = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(_pfSource), kvZero), kvOne);
+			_mm_store_si128(reinterpret_cast<__m128i*>(aiIndex), _mm_cvtps_epi32(_mm_mul_ps(vTexel, kvScale)));
+
+			_pDest[0] = pucToSRGB[aiIndex[0]];
+			_pDest[1] = pucToSRGB[aiIndex[1]];
+			_pDest[2] = pucToSRGB[aiIndex[2]];
+			_pDest[3] = (uint8_t)aiIndex[3];
+		}
+	}
+	else
+	{
+		//Four texels at a time, narrowed back down with saturating packs
+		const __m128 kvScale = _mm_set1_ps(255.0f);
+		unsigned int x = 0;
+		for(; x + 4 <= _uiWidth; x += 4)
+		{
+			__m128i vTexel0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(_pfSource + x * 4 + 0), kvZero), kvOne), kvScale));
+			__m128i vTexel1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(_pfSource + x * 4 + 4), kvZero), kvOne), kvScale));
+			__m128i vTexel2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(_pfSource + x * 4 + 8), kvZero), kvOne), kvScale));
+			__m128i vTexel3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(_pfSource + x * 4 + 12), kvZero), kvOne), kvScale));
+
+			__m128i vBytes = _mm_packus_epi16(_mm_packs_epi32(vTexel0, vTexel1), _mm_packs_epi32(vTexel2, vTexel3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(_pDest + x * 4), vBytes);
+		}
+
+		for(; x < _uiWidth; ++x)
+		{
+			__m128i vTexel = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(_pfSource + x * 4), kvZero), kvOne), kvScale));
+			vTexel = _mm_packs_epi32(vTexel, vTexel);
+			*reinterpret_cast<int*>(_pDest + x * 4) = _mm_cvtsi128_si32(_mm_packus_epi16(vTexel, vTexel));
+		}
+	}
+}
+
+static void BoxRowSSE(const float* _pfRow0, const float* _pfRow1, unsigned int _uiSourceWidth, unsigned int _uiFirst, unsigned int _uiDestWidth, float* _pfDest)
+{
+	const __m128 kvQuarter = _mm_set1_ps(0.25f);
+
+	for(unsigned int x = _uiFirst; x < _uiDestWidth; ++x)
+	{
+		unsigned int uiX0 = x * 2 * 4;
+		unsigned int uiX1 = MinUInt(x * 2 + 1, _uiSourceWidth - 1) * 4;
+
+		__m128 vSum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(_pfRow0 + uiX0), _mm_loadu_ps(_pfRow0 + uiX1)), _mm_add_ps(_mm_loadu_ps(_pfRow1 + uiX0), _mm_loadu_ps(_pfRow1 + uiX1)));
+		_mm_storeu_ps(_pfDest + x * 4, _mm_mul_ps(vSum, kvQuarter));
+	}
+}
+
+static void BoxRowAVX(const float* _pfRow0, const float* _pfRow1, unsigned int _uiSourceWidth, unsigned int _uiDestWidth, float* _pfDest)
+{
+	const __m256 kvQuarter = _mm256_set1_ps(0.25f);
+	unsigned int x = 0;
+
+	//Two output texels per pass, the rows are summed first then each neighbouring pair
+	for(; _uiSourceWidth > 1 && x + 2 <= _uiDestWidth; x += 2)
+	{
+		__m256 vLeft = _mm256_add_ps(_mm256_loadu_ps(_pfRow0 + x * 8), _mm256_loadu_ps(_pfRow1 + x * 8));
+		__m256 vRight = _mm256_add_ps(_mm256_loadu_ps(_pfRow0 + x * 8 + 8), _mm256_loadu_ps(_pfRow1 + x * 8 + 8));
+		__m256 vSum = _mm256_add_ps(_mm256_permute2f128_ps(vLeft, vRight, 0x20), _mm256_permute2f128_ps(vLeft, vRight, 0x31));
+		_mm256_storeu_ps(_pfDest + x * 4, _mm256_mul_ps(vSum, kvQuarter));
+	}
+
+	_mm256_zeroupper();
+	BoxRowSSE(_pfRow0, _pfRow1, _uiSourceWidth, x, _uiDestWidth, _pfDest);
+}
+
+static void FilterRowHorizontal(const float* _pfSource, unsigned int _uiSourceWidth, unsigned int _uiDestWidth, const __m128* _pvWeights, float* _pfDest)
+{
+	for(unsigned int x = 0; x < _uiDestWidth; ++x)
+	{
+		int iFirst = (int)x * 2 - s_kiFilterOffset;
+		__m128 vSum = _mm_setzero_ps();
+
+		if(iFirst >= 0 && iFirst + (int)s_kuiFilterTaps <= (int)_uiSourceWidth)
+		{
+			const float* pfTaps = _pfSource + iFirst * 4;
+			for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) vSum = _mm_add_ps(vSum, _mm_mul_ps(_mm_loadu_ps(pfTaps + k * 4), _pvWeights[k]));
+		}
+		else
+		{
+			//Edges repeat the border texel
+			for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) vSum = _mm_add_ps(vSum, _mm_mul_ps(_mm_loadu_ps(_pfSource + ClampRow(iFirst + (int)k, _uiSourceWidth) * 4), _pvWeights[k]));
+		}
+
+		_mm_storeu_ps(_pfDest + x * 4, vSum);
+	}
+}
+
+static void FilterColumnsSSE(const float* const* _ppfRows, const float* _pfWeights, unsigned int _uiFirst, unsigned int _uiFloats, float* _pfDest)
+{
+	for(unsigned int i = _uiFirst; i < _uiFloats; i += 4)
+	{
+		__m128 vSum = _mm_setzero_ps();
+		for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) vSum = _mm_add_ps(vSum, _mm_mul_ps(_mm_loadu_ps(_ppfRows[k] + i), _mm_set1_ps(_pfWeights[k])));
+		_mm_storeu_ps(_pfDest + i, vSum);
+	}
+}
+
+static void FilterColumnsAVX(const float* const* _ppfRows, const float* _pfWeights, unsigned int _uiFloats, float* _pfDest)
+{
+	unsigned int i = 0;
+	for(; i + 8 <= _uiFloats; i += 8)
+	{
+		__m256 vSum = _mm256_setzero_ps();
+		for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) vSum = _mm256_add_ps(vSum, _mm256_mul_ps(_mm256_loadu_ps(_ppfRows[k] + i), _mm256_set1_ps(_pfWeights[k])));
+		_mm256_storeu_ps(_pfDest + i, vSum);
+	}
+
+	_mm256_zeroupper();
+	FilterColumnsSSE(_ppfRows, _pfWeights, i, _uiFloats, _pfDest);
+}
+
+static void FilterBandBox(const uint8_t* _pSource, unsigned int _uiSourceWidth, unsigned int _uiSourceHeight, unsigned int _uiDestWidth, unsigned int _uiFirstRow, unsigned int _uiEndRow, bool _bSRGB, bool _bAVX, uint8_t* _pDest)
+{
+	std::vector<float> vecRows(_uiSourceWidth * 8 + _uiDestWidth * 4);
+	float* pfRow0 = vecRows.data();
+	float* pfRow1 = pfRow0 + _uiSourceWidth * 4;
+	float* pfOut = pfRow1 + _uiSourceWidth * 4;
+
+	for(unsigned int y = _uiFirstRow; y < _uiEndRow; ++y)
+	{
+		DecodeRow(_pSource + (size_t)(y * 2) * _uiSourceWidth * 4, _uiSourceWidth, _bSRGB, pfRow0);
+		DecodeRow(_pSource + (size_t)MinUInt(y * 2 + 1, _uiSourceHeight - 1) * _uiSourceWidth * 4, _uiSourceWidth, _bSRGB, pfRow1);
+
+		if(_bAVX) BoxRowAVX(pfRow0, pfRow1, _uiSourceWidth, _uiDestWidth, pfOut);
+		else BoxRowSSE(pfRow0, pfRow1, _uiSourceWidth, 0, _uiDestWidth, pfOut);
+
+		EncodeRow(pfOut, _uiDestWidth, _bSRGB, _pDest + (size_t)y * _uiDestWidth * 4);
+	}
+}
+
+static void FilterBandSeparable(const uint8_t* _pSource, unsigned int _uiSourceWidth, unsigned int _uiSourceHeight, unsigned int _uiDestWidth, unsigned int _uiFirstRow, unsigned int _uiEndRow, bool _bSRGB, bool _bAVX, const float* _pfWeights, uint8_t* _pDest)
+{
+	__m128 avWeights[s_kuiFilterTaps];
+	for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) avWeights[k] = _mm_set1_ps(_pfWeights[k]);
+
+	//Every source row under the band is filtered horizontally once, then the columns are filtered from those
+	int iFirstSource = (int)_uiFirstRow * 2 - s_kiFilterOffset;
+	unsigned int uiBandRows = (_uiEndRow - _uiFirstRow) * 2 + s_kuiFilterTaps - 2;
+	unsigned int uiDestFloats = _uiDestWidth * 4;
+
+	std::vector<float> vecDecoded(_uiSourceWidth * 4);
+	std::vector<float> vecBand((size_t)uiBandRows * uiDestFloats);
+	std::vector<float> vecOut(uiDestFloats);
+
+	for(unsigned int r = 0; r < uiBandRows; ++r)
+	{
+		int iRow = ClampRow(iFirstSource + (int)r, _uiSourceHeight);
+		DecodeRow(_pSource + (size_t)iRow * _uiSourceWidth * 4, _uiSourceWidth, _bSRGB, vecDecoded.data());
+		FilterRowHorizontal(vecDecoded.data(), _uiSourceWidth, _uiDestWidth, avWeights, vecBand.data() + (size_t)r * uiDestFloats);
+	}
+
+	const float* apfRows[s_kuiFilterTaps];
+	for(unsigned int y = _uiFirstRow; y < _uiEndRow; ++y)
+	{
+		for(unsigned int k = 0; k < s_kuiFilterTaps; ++k) apfRows[k] = vecBand.data() + (size_t)((y - _uiFirstRow) * 2 + k) * uiDestFloats;
+
+		if(_bAVX) FilterColumnsAVX(apfRows, _pfWeights, uiDestFloats, vecOut.data());
+		else FilterColumnsSSE(apfRows, _pfWeights, 0, uiDestFloats, vecOut.data());
+
+		EncodeRow(vecOut.data(), _uiDestWidth, _bSRGB, _pDest + (size_t)y * uiDestFloats);
+	}
+}
+
+static void AlphaHistogram(const std::vector<uint8_t>& _rvecLevel, size_t* _puiHistogram)
+{
+	for(unsigned int i = 0; i < 256; ++i) _puiHistogram[i] = 0;
+	for(size_t i = 3; i < _rvecLevel.size(); i += 4) ++_puiHistogram[_rvecLevel[i]];
+}
+
+static size_t AlphaCoverage(const size_t* _puiHistogram, float _fReference, float _fScale)
+{
+	//Texels whose scaled alpha lands above the reference
+	size_t uiCovered = 0;
+	for(unsigned int i = 0; i < 256; ++i)
+	{
+		if(i * _fScale > _fReference * 255.0f) uiCovered += _puiHistogram[i];
+	}
+
+	return(uiCovered);
+}
+
+static void PreserveAlphaCoverage(float _fReference, unsigned int _uiSliceCount, unsigned int _uiLevels, unsigned int _uiMaxThreads, std::vector<std::vector<uint8_t>>& _rvecLevels)
+{
+	//Runs once the chain is built so every level is still filtered from unscaled alpha
+	std::vector<double> vecTargets(_uiSliceCount);
+	CJobSystem::GetParallelPool().ParallelFor(_uiSliceCount, _uiMaxThreads, [&](unsigned int _uiSlice)
+	{
+		size_t auiHistogram[256];
+		const std::vector<uint8_t>& rvecTop = _rvecLevels[_uiSlice * _uiLevels];
+		AlphaHistogram(rvecTop, auiHistogram);
+		vecTargets[_uiSlice] = (double)AlphaCoverage(auiHistogram, _fReference, 1.0f) / (rvecTop.size() / 4);
+	});
+
+	CJobSystem::GetParallelPool().ParallelFor(_uiSliceCount * (_uiLevels - 1), _uiMaxThreads, [&](unsigned int _uiTask)
+	{
+		unsigned int uiSlice = _uiTask / (_uiLevels - 1);
+		std::vector<uint8_t>& rvecLevel = _rvecLevels[uiSlice * _uiLevels + 1 + _uiTask % (_uiLevels - 1)];
+		double dTarget = vecTargets[uiSlice];
+
+		//Coverage only grows with the scale, binary search for the one that matches the top level
+		size_t auiHistogram[256];
+		AlphaHistogram(rvecLevel, auiHistogram);
+		double dTexels = (double)(rvecLevel.size() / 4);
+		float fLow = 0.0f;
+		float fHigh = 4.0f;
+		for(unsigned int i = 0; i < 16; ++i)
+		{
+			float fMid = (fLow + fHigh) * 0.5f;
+			if(AlphaCoverage(auiHistogram, _fReference, fMid) / dTexels < dTarget) fLow = fMid;
+			else fHigh = fMid;
+		}
+
+		float fScale = (fLow + fHigh) * 0.5f;
+		for(size_t i = 3; i < rvecLevel.size(); i += 4)
+		{
+			float fAlpha = rvecLevel[i] * fScale + 0.5f;
+			rvecLevel[i] = (uint8_t)(fAlpha > 255.0f ? 255.0f : fAlpha);
+		}
+	});
+}
+
+//Implementation
+unsigned int
+GetMipLevelCount(unsigned int _uiWidth, unsigned int _uiHeight)
+{
+	unsigned int uiLevels = 1;
+	while((_uiWidth >> uiLevels) || (_uiHeight >> uiLevels)) ++uiLevels;
+
+	return(uiLevels);
+}
+
+bool
+GenerateMipChain(const TMipDesc& _rtDesc, const uint8_t* const* _ppSlices, unsigned int _uiSliceCount, unsigned int _uiWidth, unsigned int _uiHeight, std::vector<std::vector<uint8_t>>& _rvecLevels, TMipStats* _ptStats)
+{
+	if(!_ppSlices || _uiSliceCount == 0 || _uiWidth == 0 || _uiHeight == 0) return(false);
+
+	static const bool s_kbAVX = HasAVX();
+	auto tStart = std::chrono::steady_clock::now();
+
+	unsigned int uiLevels = GetMipLevelCount(_uiWidth, _uiHeight);
+	_rvecLevels.clear();
+	_rvecLevels.resize(_uiSliceCount * uiLevels);
+	for(unsigned int i = 0; i < _uiSliceCount; ++i) _rvecLevels[i * uiLevels].assign(_ppSlices[i], _ppSlices[i] + (size_t)_uiWidth * _uiHeight * 4);
+
+	float afWeights[s_kuiFilterTaps];
+	BuildFilterWeights(_rtDesc.eFilter, afWeights);
+
+	size_t uiBytes = 0;
+	unsigned int uiThreads = 1;
+
+	for(unsigned int uiMip = 1; uiMip < uiLevels; ++uiMip)
+	{
+		unsigned int uiSourceWidth = (_uiWidth >> (uiMip - 1)) ? (_uiWidth >> (uiMip - 1)) : 1;
+		unsigned int uiSourceHeight = (_uiHeight >> (uiMip - 1)) ? (_uiHeight >> (uiMip - 1)) : 1;
+		unsigned int uiDestWidth = (uiSourceWidth / 2) ? (uiSourceWidth / 2) : 1;
+		unsigned int uiDestHeight = (uiSourceHeight / 2) ? (uiSourceHeight / 2) : 1;
+
+		for(unsigned int i = 0; i < _uiSliceCount; ++i) _rvecLevels[i * uiLevels + uiMip].resize((size_t)uiDestWidth * uiDestHeight * 4);
+
+		//Bands of every slice go out as one batch
+		unsigned int uiBands = (uiDestHeight + s_kuiBandRows - 1) / s_kuiBandRows;
+		unsigned int uiUsed = CJobSystem::GetParallelPool().ParallelFor(uiBands * _uiSliceCount, _rtDesc.uiMaxThreads, [&](unsigned int _uiTask)
+		{
+			unsigned int uiSlice = _uiTask / uiBands;
+			unsigned int uiFirstRow = (_uiTask % uiBands) * s_kuiBandRows;
+			unsigned int uiEndRow = MinUInt(uiFirstRow + s_kuiBandRows, uiDestHeight);
+			const uint8_t* pSource = _rvecLevels[uiSlice * uiLevels + uiMip - 1].data();
+			uint8_t* pDest = _rvecLevels[uiSlice * uiLevels + uiMip].data();
+
+			if(_rtDesc.eFilter == MIP_FILTER_BOX) FilterBandBox(pSource, uiSourceWidth, uiSourceHeight, uiDestWidth, uiFirstRow, uiEndRow, _rtDesc.bSRGB, s_kbAVX, pDest);
+			else FilterBandSeparable(pSource, uiSourceWidth, uiSourceHeight, uiDestWidth, uiFirstRow, uiEndRow, _rtDesc.bSRGB, s_kbAVX, afWeights, pDest);
+		});
+
+		uiThreads = (uiUsed > uiThreads) ? uiUsed : uiThreads;
+		uiBytes += (size_t)uiSourceWidth * uiSourceHeight * 4 * _uiSliceCount;
+	}
+
+	if(_rtDesc.fAlphaReference > 0.0f && uiLevels > 1) PreserveAlphaCoverage(_rtDesc.fAlphaReference, _uiSliceCount, uiLevels, _rtDesc.uiMaxThreads, _rvecLevels);
+
+	if(_ptStats)
+	{
+		_ptStats->dMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+		_ptStats->uiBytes = uiBytes;
+		_ptStats->uiThreads = uiThreads;
+	}
+
+	return(true);
+}
+
+void
+BenchmarkMipGeneration(unsigned int _uiSize)
+{
+	//Noise over a gradient, roughly what a colour atlas looks like to the filters
+	std::vector<uint8_t> vecImage((size_t)_uiSize * _uiSize * 4);
+	unsigned int uiSeed = 12345;
+	for(size_t i = 0; i < vecImage.size(); ++i)
+	{
+		uiSeed = uiSeed * 1664525u + 1013904223u;
+		vecImage[i] = (uint8_t)((i / 4 % _uiSize) * 127 / _uiSize + (uiSeed >> 25));
+	}
+
+	const uint8_t* pSlice = vecImage.data();
+	const char* apcFilters[] = { "Box", "Kaiser", "Lanczos" };
+	std::vector<std::vector<uint8_t>> vecLevels;
+	char pcStats[256];
+
+	for(unsigned int i = 0; i < 3; ++i)
+	{
+		TMipDesc tDesc;
+		TMipStats tSingle;
+		TMipStats tAll;
+		tDesc.eFilter = (EMipFilter)i;
+		tDesc.bSRGB = true;
+
+		tDesc.uiMaxThreads = 1;
+		GenerateMipChain(tDesc, &pSlice, 1, _uiSize, _uiSize, vecLevels, &tSingle);
+		tDesc.uiMaxThreads = 0;
+		GenerateMipChain(tDesc, &pSlice, 1, _uiSize, _uiSize, vecLevels, &tAll);
+
+		double dSingleMBs = tSingle.uiBytes / (1024.0 * 1024.0) / (tSingle.dMs / 1000.0);
+		double dAllMBs = tAll.uiBytes / (1024.0 * 1024.0) / (tAll.dMs / 1000.0);
+		sprintf_s(pcStats, "%s %ux%u sRGB: %.1f MB/s on 1 core, %.1f MB/s on %u (%.1f MB/s per core)\n",
+			apcFilters[i], _uiSize, _uiSize, dSingleMBs, dAllMBs, tAll.uiThreads, dAllMBs / tAll.uiThreads);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Mip Gen");
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef __MIP_GEN_H__
+#define __MIP_GEN_H__
+
+//Library Includes
+#include <stdint.h>
+#include <vector>
+
+//CPU mip chain generation for RGBA8 images, used by the texture cooker and the uncooked load path
+//Each level is filtered from the one above it in float with SSE kernels, AVX where the CPU has it
+//Rows and array slices are split across a small pool shared by every texture generating at the time
+
+//Types
+enum EMipFilter
+{
+	MIP_FILTER_BOX,		//2x2 average, fastest
+	MIP_FILTER_KAISER,	//Kaiser windowed sinc over 12 taps, sharper with less aliasing than box
+	MIP_FILTER_LANCZOS,	//Lanczos3 over 12 taps, a touch sharper than Kaiser with a little more ringing
+};
+
+struct TMipDesc
+{
+	EMipFilter eFilter;
+	bool bSRGB;					//RGB is sRGB encoded, filter in linear space and encode back. Alpha is always linear
+	float fAlphaReference;		//Above 0, alpha on each level is scaled so the fraction of texels above this matches level 0
+	unsigned int uiMaxThreads;	//0 uses every worker
+
+	TMipDesc()
+		: eFilter(MIP_FILTER_BOX)
+		, bSRGB(false)
+		, fAlphaReference(0.0f)
+		, uiMaxThreads(0)
+	{
+	}
+};
+
+struct TMipStats
+{
+	double dMs;
+	size_t uiBytes;			//Source bytes filtered across every generated level
+	unsigned int uiThreads;	//Threads the work was offered to, including the caller
+};
+
+//Prototypes
+//Levels in a full chain down to 1x1
+unsigned int GetMipLevelCount(unsigned int _uiWidth, unsigned int _uiHeight);
+
+//_ppSlices are _uiSliceCount tightly packed RGBA8 images of the same size
+//_rvecLevels receives every level of every slice in D3D11 subresource order (slice * levels + mip), level 0 included
+//Odd sizes drop the last row/column on the way down, as D3D does when it rounds mip sizes down
+bool GenerateMipChain(const TMipDesc& _rtDesc, const uint8_t* const* _ppSlices, unsigned int _uiSliceCount, unsigned int _uiWidth, unsigned int _uiHeight, std::vector<std::vector<uint8_t>>& _rvecLevels, TMipStats* _ptStats = nullptr);
+
+//Times each filter on a synthetic _uiSize square sRGB image on one core and on all of them, results go to the debug log
+void BenchmarkMipGeneration(unsigned int _uiSize = 4096);
+
+#endif //__MIP_GEN_H__
@@ -1,4 +1,9 @@
 //Library Includes
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+#include <unordered_map>
 #include <assimp\Importer.hpp>
 #include <assimp\scene.h>
 #include <assimp\postprocess.h>
@@ -8,13 +13,645 @@
 #include "renderer.h"
 #include "assetmanager.hpp"
 #include "texture.h"
+#include "mappedfile.h"
+#include "jobsystem.h"
+#include "cookedmodel.h"
+#include "meshoptimizer.h"
+#include "meshsimplify.h"
+#include "meshcluster.h"
+#include "meshweld.h"
+#include "meshbounds.h"
+#include "staticbatch.h"
+#include "vertexpack.h"
+#include "loadtelemetry.h"
+#include "logmanager.h"
 
 //This Include
 #include "model.h"
 
+//Types
+//What ConvertMesh did to a mesh, logged once every mesh has converted
+struct TMeshConvertStats
+{
+	TMeshWeldStats tWeld;
+	TMeshOptimizeStats tOptimize;
+	TVertexPackError tPackError;
+	bool bPacked;
+	TMeshLod ptLods[MESH_MAX_LODS];
+	unsigned int uiLodCount;
+	double dLodMs;
+	unsigned int uiClusterCount; //Culling clusters, once there are any the overdraw pass sorts these instead
+	float fUnclusteredACMR; //LOD 0 before it was regrouped into them
+	double dClusterMs;
+	TMeshBounds tBounds;
+	double dBoundsMs;
+
+	TMeshConvertStats()
+		: bPacked(false)
+		, uiLodCount(0)
+		, dLodMs(0.0)
+		, uiClusterCount(0)
+		, fUnclusteredACMR(0.0f)
+		, dClusterMs(0.0)
+		, dBoundsMs(0.0)
+	{
+	}
+};
+
+static_assert(COOKED_MODEL_MAX_LODS == MESH_MAX_LODS, "Cooked LOD table must hold every level a mesh can have");
+
+//Static Variables
+static const unsigned int s_kuiNoMesh = 0xFFFFFFFF;
+
+bool CModel::sm_bUseCooked = true;
+bool CModel::sm_bUseStaticBatching = true;
+bool CModel::sm_bShareMeshes = true;
+std::mutex CModel::sm_mutexSharedMeshes;
+std::unordered_map<unsigned long long, CModel::TSharedMesh> CModel::sm_mapSharedMeshes;
+
+//Helpers
+//Object space units per UV unit, the square root of surface area over UV area. Degenerate UVs give 0 (unknown)
+template<typename TIndexType>
+static float ComputeUVDensity(const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount, const TIndexType* _pIndices, unsigned int _uiIndexCount)
+{
+	double dSurfaceArea = 0.0;
+	double dUVArea = 0.0;
+	unsigned int uiCount = _pIndices ? _uiIndexCount : _uiVertexCount;
+
+	for(unsigned int i = 0; i + 2 < uiCount; i += 3)
+	{
+		const TVertexTexNorm& rtA = _pVertices[_pIndices ? _pIndices[i] : i];
+		const TVertexTexNorm& rtB = _pVertices[_pIndices ? _pIndices[i + 1] : i + 1];
+		const TVertexTexNorm& rtC = _pVertices[_pIndices ? _pIndices[i + 2] : i + 2];
+
+		float3 vec3AB = rtB.pos - rtA.pos;
+		float3 vec3AC = rtC.pos - rtA.pos;
+		float3 vec3Cross(vec3AB.y * vec3AC.z - vec3AB.z * vec3AC.y, vec3AB.z * vec3AC.x - vec3AB.x * vec3AC.z, vec3AB.x * vec3AC.y - vec3AB.y * vec3AC.x);
+		dSurfaceArea += 0.5 * sqrt((double)vec3Cross.x * vec3Cross.x + (double)vec3Cross.y * vec3Cross.y + (double)vec3Cross.z * vec3Cross.z);
+
+		float2 vec2AB = rtB.texcoord - rtA.texcoord;
+		float2 vec2AC = rtC.texcoord - rtA.texcoord;
+		dUVArea += 0.5 * fabs((double)vec2AB.x * vec2AC.y - (double)vec2AB.y * vec2AC.x);
+	}
+
+	return(dUVArea > 1e-12 ? (float)sqrt(dSurfaceArea / dUVArea) : 0.0f);
+}
+
+//16 bit indices reach the first 65536 vertices
+static inline bool CanUseShortIndices(unsigned int _uiVertexCount)
+{
+	return(_uiVertexCount <= 0x10000);
+}
+
+//Size of one vertex in a cooked mesh's vertex blob
+static inline size_t GetCookedVertexSize(const TCookedMesh& _rtMesh)
+{
+	return(_rtMesh.uiVertexFormat == (unsigned int)EVertexFormat::PACKED ? sizeof(TVertexPacked) : sizeof(TVertexTexNorm));
+}
+
+//Swaps the 32 bit indices for 16 bit ones when every vertex can be reached with them, halving the index buffer
+static void NarrowIndices(TModelMeshData& _rtMeshData)
+{
+	TMeshData<TVertexTexNorm>& rtMesh = _rtMeshData.tMesh;
+	if(!rtMesh.pIndices || !CanUseShortIndices(rtMesh.uiVertexCount)) return;
+
+	_rtMeshData.pShortIndices = new WORD[rtMesh.uiIndexCount];
+	for(unsigned int i = 0; i < rtMesh.uiIndexCount; ++i) _rtMeshData.pShortIndices[i] = (WORD)rtMesh.pIndices[i];
+	SafeDeleteArray(rtMesh.pIndices);
+}
+
+//Packs the vertices when every attribute survives the round trip within tolerance, the full vertices are then freed
+static void PackMeshVertices(TModelMeshData& _rtMeshData, TMeshConvertStats& _rtStats)
+{
+	TMeshData<TVertexTexNorm>& rtMesh = _rtMeshData.tMesh;
+	if(!rtMesh.pVertices || !rtMesh.uiVertexCount) return;
+
+	TVertexPacked* pPacked = new TVertexPacked[rtMesh.uiVertexCount];
+	_rtStats.tPackError = PackVertices(rtMesh.pVertices, rtMesh.uiVertexCount, rtMesh.vec3BBCenter, rtMesh.vec3BBExtends, pPacked);
+	_rtStats.bPacked = _rtStats.tPackError.IsWithin(TVertexPackTolerance());
+
+	if(!_rtStats.bPacked)
+	{
+		delete[] pPacked;
+		return;
+	}
+
+	_rtMeshData.pPackedVertices = pPacked;
+	SafeDeleteArray(rtMesh.pVertices);
+}
+
+//Placement of an instance as the instanced vertex shader applies it, scale then rotate then translate
+static XMMATRIX GetInstanceWorld(const TModelMeshInstance& _rtInstance)
+{
+	return(XMMatrixScaling(_rtInstance.vec3Scale.x, _rtInstance.vec3Scale.y, _rtInstance.vec3Scale.z)
+		* XMMatrixRotationRollPitchYaw(XMConvertToRadians(_rtInstance.vec3Rot.x), XMConvertToRadians(_rtInstance.vec3Rot.y), XMConvertToRadians(_rtInstance.vec3Rot.z))
+		* XMMatrixTranslation(_rtInstance.vec3Pos.x, _rtInstance.vec3Pos.y, _rtInstance.vec3Pos.z));
+}
+
+//Interleaves the low 10 bits of each axis, nearby points get nearby codes
+static unsigned int GetMortonCode(unsigned int _uiX, unsigned int _uiY, unsigned int _uiZ)
+{
+	unsigned int uiCode = 0;
+	for(unsigned int i = 0; i < 10; ++i)
+	{
+		uiCode |= (((_uiX >> i) & 1) << (i * 3)) | (((_uiY >> i) & 1) << (i * 3 + 1)) | (((_uiZ >> i) & 1) << (i * 3 + 2));
+	}
+
+	return(uiCode);
+}
+
+//Frees the arrays of mesh data that was built rather than read, such as a batch
+static void FreeMeshData(TModelMeshData& _rtMeshData)
+{
+	SafeDeleteArray(_rtMeshData.tMesh.pVertices);
+	SafeDeleteArray(_rtMeshData.tMesh.pIndices);
+	SafeDeleteArray(_rtMeshData.tMesh.ptClusters);
+	SafeDeleteArray(_rtMeshData.pShortIndices);
+	SafeDeleteArray(_rtMeshData.pPackedVertices);
+}
+
+//Vertex and index buffer bytes of converted mesh data
+static size_t GetMeshDataBytes(const TModelMeshData& _rtMeshData)
+{
+	const TMeshData<TVertexTexNorm>& rtMesh = _rtMeshData.tMesh;
+	size_t uiBytes = rtMesh.uiVertexCount * (_rtMeshData.pPackedVertices ? sizeof(TVertexPacked) : sizeof(TVertexTexNorm));
+	if(_rtMeshData.pShortIndices || rtMesh.pIndices) uiBytes += rtMesh.uiIndexCount * (_rtMeshData.pShortIndices ? sizeof(WORD) : sizeof(DWORD));
+
+	return(uiBytes);
+}
+
+//Everything a mesh is created from bar its material id, which each model keeps for itself. Meshes with the same bytes draw the same
+static void GetModelMeshBytes(const TModelMeshData& _rtMeshData, std::vector<BYTE>& _rvecBytes)
+{
+	const TMeshData<TVertexTexNorm>& rtMesh = _rtMeshData.tMesh;
+	bool bIndexed = _rtMeshData.pShortIndices || rtMesh.pIndices;
+	unsigned int puiHeader[8] = { rtMesh.uiVertexCount, bIndexed ? rtMesh.uiIndexCount : 0, (unsigned int)rtMesh.tVertexTopology, (unsigned int)rtMesh.eVBufferAccess,
+		(unsigned int)rtMesh.eIBufferAccess, (_rtMeshData.pPackedVertices ? 1u : 0u) | (_rtMeshData.pShortIndices ? 2u : 0u), rtMesh.uiLodCount, rtMesh.ptClusters ? rtMesh.uiClusterCount : 0 };
+
+	auto Append = [&](const void* _pData, size_t _uiBytes)
+	{
+		const BYTE* pBytes = (const BYTE*)_pData;
+		if(pBytes) _rvecBytes.insert(_rvecBytes.end(), pBytes, pBytes + _uiBytes);
+	};
+
+	_rvecBytes.clear();
+	_rvecBytes.reserve(sizeof(puiHeader) + GetMeshDataBytes(_rtMeshData) + rtMesh.uiLodCount * sizeof(TMeshLod) + puiHeader[7] * sizeof(TMeshCluster) + 2 * sizeof(float3));
+	Append(puiHeader, sizeof(puiHeader));
+
+	if(_rtMeshData.pPackedVertices) Append(_rtMeshData.pPackedVertices, rtMesh.uiVertexCount * sizeof(TVertexPacked));
+	else Append(rtMesh.pVertices, rtMesh.uiVertexCount * sizeof(TVertexTexNorm));
+	if(_rtMeshData.pShortIndices) Append(_rtMeshData.pShortIndices, rtMesh.uiIndexCount * sizeof(WORD));
+	else Append(rtMesh.pIndices, rtMesh.uiIndexCount * sizeof(DWORD));
+
+	Append(rtMesh.ptLods, rtMesh.uiLodCount * sizeof(TMeshLod));
+	Append(rtMesh.ptClusters, puiHeader[7] * sizeof(TMeshCluster));
+	Append(&rtMesh.vec3BBCenter, sizeof(float3));
+	Append(&rtMesh.vec3BBExtends, sizeof(float3));
+}
+
+//Everything ConvertMesh reads from an Assimp mesh, meshes that hash and compare the same convert to the same data
+static unsigned long long HashSourceMesh(const aiMesh* _pMesh)
+{
+	unsigned int puiHeader[4] = { _pMesh->mMaterialIndex, _pMesh->mNumVertices, _pMesh->mNumFaces,
+		(_pMesh->HasNormals() ? 1u : 0u) | (_pMesh->HasTangentsAndBitangents() ? 2u : 0u) | (_pMesh->HasTextureCoords(0) ? 4u : 0u) };
+	unsigned long long ullHash = HashMeshBytes(puiHeader, sizeof(puiHeader));
+
+	size_t uiBytes = _pMesh->mNumVertices * sizeof(aiVector3D);
+	ullHash = HashMeshBytes(_pMesh->mVertices, uiBytes, ullHash);
+	if(_pMesh->HasNormals()) ullHash = HashMeshBytes(_pMesh->mNormals, uiBytes, ullHash);
+	if(_pMesh->HasTangentsAndBitangents()) ullHash = HashMeshBytes(_pMesh->mTangents, uiBytes, ullHash);
+	if(_pMesh->HasTextureCoords(0)) ullHash = HashMeshBytes(_pMesh->mTextureCoords[0], uiBytes, ullHash);
+	for(unsigned int i = 0; i < _pMesh->mNumFaces; ++i) ullHash = HashMeshBytes(_pMesh->mFaces[i].mIndices, _pMesh->mFaces[i].mNumIndices * sizeof(unsigned int), ullHash);
+
+	return(ullHash);
+}
+
+static bool IsSameSourceMesh(const aiMesh* _pA, const aiMesh* _pB)
+{
+	if(_pA->mMaterialIndex != _pB->mMaterialIndex || _pA->mNumVertices != _pB->mNumVertices || _pA->mNumFaces != _pB->mNumFaces
+		|| _pA->HasNormals() != _pB->HasNormals() || _pA->HasTangentsAndBitangents() != _pB->HasTangentsAndBitangents()
+		|| _pA->HasTextureCoords(0) != _pB->HasTextureCoords(0)) return(false);
+
+	size_t uiBytes = _pA->mNumVertices * sizeof(aiVector3D);
+	if(memcmp(_pA->mVertices, _pB->mVertices, uiBytes) != 0
+		|| (_pA->HasNormals() && memcmp(_pA->mNormals, _pB->mNormals, uiBytes) != 0)
+		|| (_pA->HasTangentsAndBitangents() && memcmp(_pA->mTangents, _pB->mTangents, uiBytes) != 0)
+		|| (_pA->HasTextureCoords(0) && memcmp(_pA->mTextureCoords[0], _pB->mTextureCoords[0], uiBytes) != 0)) return(false);
+
+	for(unsigned int i = 0; i < _pA->mNumFaces; ++i)
+	{
+		const aiFace& rtA = _pA->mFaces[i];
+		const aiFace& rtB = _pB->mFaces[i];
+		if(rtA.mNumIndices != rtB.mNumIndices || memcmp(rtA.mIndices, rtB.mIndices, rtA.mNumIndices * sizeof(unsigned int)) != 0) return(false);
+	}
+
+	return(true);
+}
+
+//A mesh with _pVertices and _pIndices as its buffers, everything else from _rtMeshData
+template<typename TVertexType, typename TIndexType>
+static IMesh* CreateMeshAs(CRenderer* _pRenderer, const TMeshData<TVertexTexNorm>& _rtMeshData, TVertexType* _pVertices, TIndexType* _pIndices, bool& _rbSuccessful)
+{
+	TMeshData<TVertexType, TIndexType> tMeshInit(_pVertices, _rtMeshData.uiVertexCount, _pIndices, _pIndices ? _rtMeshData.uiIndexCount : 0,
+		_rtMeshData.eVBufferAccess, _rtMeshData.eIBufferAccess, _rtMeshData.bPointerOwnership);
+	tMeshInit.tVertexTopology = _rtMeshData.tVertexTopology;
+	tMeshInit.vec3BBCenter = _rtMeshData.vec3BBCenter;
+	tMeshInit.vec3BBExtends = _rtMeshData.vec3BBExtends;
+	tMeshInit.vec3SphereCenter = _rtMeshData.vec3SphereCenter;
+	tMeshInit.fSphereRadius = _rtMeshData.fSphereRadius;
+	tMeshInit.vec3OBBCenter = _rtMeshData.vec3OBBCenter;
+	tMeshInit.vec3OBBExtends = _rtMeshData.vec3OBBExtends;
+	tMeshInit.vec4OBBOrientation = _rtMeshData.vec4OBBOrientation;
+	tMeshInit.fUVDensity = _rtMeshData.fUVDensity;
+	tMeshInit.iMaterialId = _rtMeshData.iMaterialId;
+	tMeshInit.uiLodCount = _rtMeshData.uiLodCount;
+	for(UINT i = 0; i < _rtMeshData.uiLodCount; ++i) tMeshInit.ptLods[i] = _rtMeshData.ptLods[i];
+	tMeshInit.ptClusters = _rtMeshData.ptClusters;
+	tMeshInit.uiClusterCount = _rtMeshData.uiClusterCount;
+
+	CMesh<TVertexType, TIndexType>* pMesh = new CMesh<TVertexType, TIndexType>();
+	_rbSuccessful = pMesh->Initialize(_pRenderer, tMeshInit);
+
+	return(pMesh);
+}
+
+//The vertex and index types follow whichever arrays _rtMeshData has
+static IMesh* CreateMesh(CRenderer* _pRenderer, const TModelMeshData& _rtMeshData, bool& _rbSuccessful)
+{
+	const TMeshData<TVertexTexNorm>& rtMesh = _rtMeshData.tMesh;
+	if(_rtMeshData.pPackedVertices)
+	{
+		return(_rtMeshData.pShortIndices ? CreateMeshAs(_pRenderer, rtMesh, _rtMeshData.pPackedVertices, _rtMeshData.pShortIndices, _rbSuccessful)
+			: CreateMeshAs(_pRenderer, rtMesh, _rtMeshData.pPackedVertices, rtMesh.pIndices, _rbSuccessful));
+	}
+
+	return(_rtMeshData.pShortIndices ? CreateMeshAs(_pRenderer, rtMesh, rtMesh.pVertices, _rtMeshData.pShortIndices, _rbSuccessful)
+		: CreateMeshAs(_pRenderer, rtMesh, rtMesh.pVertices, rtMesh.pIndices, _rbSuccessful));
+}
+
+template<typename TVertexType>
+static void SwapMeshesAs(IMesh* _pMesh, IMesh* _pOther)
+{
+	if(_pMesh->GetIndexSize() == sizeof(WORD)) static_cast<CMesh<TVertexType, WORD>*>(_pMesh)->Swap(*static_cast<CMesh<TVertexType, WORD>*>(_pOther));
+	else static_cast<CMesh<TVertexType, DWORD>*>(_pMesh)->Swap(*static_cast<CMesh<TVertexType, DWORD>*>(_pOther));
+}
+
+//Reload swaps only work between meshes of the same vertex format and index type
+static bool SwapMeshes(IMesh* _pMesh, IMesh* _pOther)
+{
+	if(_pMesh->GetIndexSize() != _pOther->GetIndexSize() || _pMesh->GetVertexFormat() != _pOther->GetVertexFormat()) return(false);
+
+	if(_pMesh->GetVertexFormat() == EVertexFormat::PACKED) SwapMeshesAs<TVertexPacked>(_pMesh, _pOther);
+	else SwapMeshesAs<TVertexTexNorm>(_pMesh, _pOther);
+
+	return(true);
+}
+
+//Swaps _pMesh with an empty mesh of its own type so it draws nothing
+template<typename TVertexType>
+static void EmptyMeshAs(IMesh* _pMesh)
+{
+	if(_pMesh->GetIndexSize() == sizeof(WORD))
+	{
+		CMesh<TVertexType, WORD> emptyMesh;
+		SwapMeshes(_pMesh, &emptyMesh);
+	}
+	else
+	{
+		CMesh<TVertexType, DWORD> emptyMesh;
+		SwapMeshes(_pMesh, &emptyMesh);
+	}
+}
+
+//Copies an Assimp mesh into engine vertices and indices along with its bounds, safe to run for several meshes at once
+//Duplicate vertices are welded, then triangles and vertices are reordered for the GPU, simplified into a LOD chain and packed when they can be, the cook stores the result
+static void ConvertMesh(const aiMesh* _pSourceMesh, TModelMeshData& _rtModelMeshData, TMeshConvertStats& _rtStats)
+{
+	TMeshData<TVertexTexNorm>& rtMeshData = _rtModelMeshData.tMesh;
+
+	//_pSourceMesh->mBitangents;
+	bool hasbones = _pSourceMesh->HasBones();
+
+	//We should leave the tree processing to CArmature, passing in the mesh so that it can extract itself
+	//We will need to build the weights here for the mesh though
+	if(hasbones)
+	{
+		//TODO:
+		// 
+		// BoneID and weights should be stored in a separate buffer
+		// bound at IA stage to reduce duplicate code here.
+		// 
+		// If we try put the weights into its own TVertexTexRigged then we need to make edge
+		// cases everywhere for selecting which vertex for zero gain where we can
+		// use a second buffer that's independant like the instance buffer.
+		// 
+		// Each vertex of a rigged mesh will require:
+		//  - 4x BoneIDs (used to look up matrix in the bone table such that offsets can be applied)
+		//  - 4x Weights (used to calculate weighting between the affectors)
+		//
+		// that is straight forward, can be done here optimally with CMesh updated for granular control over extra buffers
+		// the shader will be the same, a modification from instancing with little effort
+		// 
+		// On top of that, we need a umap of bones where the key is the bone NAME (string)
+		// Where each value is:
+		//  - bone id, number for reference to the matrix table which allows for shader lookup
+		//  - bone offset, the base offset for the bone, this will be combined with the bone matrix in the animation to produce the final matrix for weighted verts
+		//
+		// this map will most likely be created and held by CArmature. Technically we don't actually
+		// need a bone tree just yet, as the lookup is enough, however in future we will need to produce a tree.
+		// CArmature can be linked to a CAnimator using CAnimation classes for all the required information
+		//
+		//
+		//
+
+		//bones link to an armature, explore armature in the skeleton class
+		//name
+		//numWeights = number of vertices this bone effects
+		//armature is the node tree for the bones, not sure why this exists as it's the parent of the following node pointer
+		//node pointer which links to the current armature node
+		//weights for each vertex
+		//offset matrix for the bone
+		auto bones = _pSourceMesh->mBones;
+		bool test2 = false;
+
+		//root node can be found from traversing the parents of any node
+		//root node has two children
+		//first child seems to be the mesh binding for the armature, it contains the mesh ID and mesh name
+		//second child is the pelvis postrotation (is this caused by an import flag)
+		//	this node has a unique transformation matrix
+		//child of the pelvis_pr is the actual pelvis bone, which contains the identity transform
+		//  the next three children of pelvis are spine and thigh PR's
+
+		//looks like the postrot nodes contain the bone transform and
+		//	the normal node only contains the bone matching info found in mBones
+		//still not sure why they're split up unless the identity transform is for scaling/offset
+		//
+		//most likely have to flatten the armature to easy traversal
+		//check assimp docs to see
+	}
+
+	//Vertices
+	TVertexTexNorm* pVertices = new TVertexTexNorm[_pSourceMesh->mNumVertices];
+	DWORD* pIndices = nullptr;
+
+	bool bHasNormal = _pSourceMesh->HasNormals();
+	bool bHasTangent = _pSourceMesh->HasTangentsAndBitangents();
+	bool bHasUV = _pSourceMesh->HasTextureCoords(0);
+
+	//Debug break for multi-channel UVs, I believe assimp supports up to 8
+	if(_pSourceMesh->GetNumUVChannels() > 1)
+	{
+		//currently unsupported
+		int uvcount = _pSourceMesh->GetNumUVChannels();
+		bool breakHereToFix = true;
+	}
+
+	for(unsigned int j = 0; j < _pSourceMesh->mNumVertices; ++j)
+	{
+		//TODO: Support multiple UV channels
+		pVertices[j].pos = float3(_pSourceMesh->mVertices[j].x, _pSourceMesh->mVertices[j].y, _pSourceMesh->mVertices[j].z);
+		if(bHasNormal)	pVertices[j].normal = float3(_pSourceMesh->mNormals[j].x, _pSourceMesh->mNormals[j].y, _pSourceMesh->mNormals[j].z);
+		if(bHasTangent) pVertices[j].tangent = float3(_pSourceMesh->mTangents[j].x, _pSourceMesh->mTangents[j].y, _pSourceMesh->mTangents[j].z);
+		if(bHasUV)		pVertices[j].texcoord = float2(_pSourceMesh->mTextureCoords[0][j].x, _pSourceMesh->mTextureCoords[0][j].y);
+	}
+
+	//Indices, check if we have faces and that they are triangulated
+	if(_pSourceMesh->HasFaces() && _pSourceMesh->mFaces[0].mNumIndices == 3)
+	{
+		const unsigned int uiFaceCount = _pSourceMesh->mNumFaces;
+		const unsigned int uiIndexCount = _pSourceMesh->mFaces[0].mNumIndices;
+		pIndices = new DWORD[uiFaceCount * uiIndexCount];
+
+		//Could memcpy but UINT to ULONG may cause issues in future
+		//Loop through each face, then loop through each index of face (code supports tri/quad even though we only support tri)
+		for(unsigned int uiFace = 0; uiFace < uiFaceCount; ++uiFace)
+		{
+			for(unsigned int uiIndex = 0; uiIndex < uiIndexCount; ++uiIndex)
+			{
+				pIndices[(uiFace * uiIndexCount) + uiIndex] = _pSourceMesh->mFaces[uiFace].mIndices[uiIndex];
+			}
+		}
+	}
+
+	//Duplicate vertices are welded first, Assimp hands over a vertex per face corner for most formats
+	unsigned int uiVertexCount = _pSourceMesh->mNumVertices;
+	unsigned int uiIndexCount = pIndices ? _pSourceMesh->mNumFaces * 3 : 0;
+	if(pIndices) uiVertexCount = WeldVertices(pVertices, uiVertexCount, pIndices, uiIndexCount, TMeshWeldTolerance(), &_rtStats.tWeld);
+
+	//Vertex cache, overdraw then fetch order. Unused vertices are dropped
+	if(pIndices) OptimizeMesh(pVertices, uiVertexCount, sizeof(TVertexTexNorm), pIndices, uiIndexCount, &_rtStats.tOptimize);
+
+	//LOD 0 regrouped into clusters for culling. That throws away the overdraw order, so the clusters are sorted by the same key as
+	//whole runs and the fetch order is redone to match. The stats are then taken again so they describe what is cooked
+	std::vector<TMeshCluster> vecClusters;
+	if(pIndices)
+	{
+		auto tClusterStart = std::chrono::steady_clock::now();
+		_rtStats.uiClusterCount = BuildMeshClusters(pIndices, uiIndexCount, pVertices, uiVertexCount, vecClusters);
+		if(_rtStats.uiClusterCount)
+		{
+			std::vector<unsigned int> vecClusterStarts(vecClusters.size());
+			for(size_t i = 0; i < vecClusters.size(); ++i) vecClusterStarts[i] = vecClusters[i].uiIndexStart;
+
+			std::vector<unsigned int> vecOrder;
+			SortOverdrawClusters(pIndices, uiIndexCount, pVertices, sizeof(TVertexTexNorm), vecClusterStarts, vecOrder);
+
+			std::vector<TMeshCluster> vecSorted(vecOrder.size());
+			UINT uiIndexStart = 0;
+			for(size_t i = 0; i < vecOrder.size(); ++i)
+			{
+				vecSorted[i] = vecClusters[vecOrder[i]];
+				vecSorted[i].uiIndexStart = uiIndexStart;
+				uiIndexStart += vecSorted[i].uiIndexCount;
+			}
+			vecClusters.swap(vecSorted);
+
+			unsigned int uiFetchedCount = OptimizeVertexFetch(pVertices, uiVertexCount, sizeof(TVertexTexNorm), pIndices, uiIndexCount);
+			_rtStats.tOptimize.uiVerticesRemoved += uiVertexCount - uiFetchedCount;
+			uiVertexCount = uiFetchedCount;
+
+			_rtStats.fUnclusteredACMR = _rtStats.tOptimize.tAfter.fACMR;
+			_rtStats.tOptimize.tAfter = AnalyzeVertexCache(pIndices, uiIndexCount, uiVertexCount);
+			_rtStats.tOptimize.uiClusterCount = (unsigned int)vecClusters.size();
+		}
+		_rtStats.dClusterMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tClusterStart).count();
+	}
+
+	//Simplified levels follow LOD 0 in the same index buffer, all of them over the one vertex buffer
+	if(pIndices)
+	{
+		auto tLodStart = std::chrono::steady_clock::now();
+		std::vector<DWORD> vecLodIndices;
+		_rtStats.uiLodCount = BuildMeshLods(pIndices, uiIndexCount, pVertices, uiVertexCount, vecLodIndices, _rtStats.ptLods);
+		_rtStats.dLodMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tLodStart).count();
+
+		if(_rtStats.uiLodCount > 1)
+		{
+			delete[] pIndices;
+			pIndices = new DWORD[vecLodIndices.size()];
+			memcpy(pIndices, vecLodIndices.data(), vecLodIndices.size() * sizeof(DWORD));
+		}
+	}
+
+	//New mesh data, read only. Freed by the loader once it has been cooked
+	rtMeshData = TMeshData<TVertexTexNorm>(pVertices, uiVertexCount,
+		pIndices, _rtStats.uiLodCount ? _rtStats.ptLods[_rtStats.uiLodCount - 1].uiIndexStart + _rtStats.ptLods[_rtStats.uiLodCount - 1].uiIndexCount : uiIndexCount,
+		EMeshAccess::RAW,
+		EMeshAccess::RAW, false);
+	rtMeshData.uiLodCount = _rtStats.uiLodCount;
+	for(UINT i = 0; i < _rtStats.uiLodCount; ++i) rtMeshData.ptLods[i] = _rtStats.ptLods[i];
+
+	//Owned by the loader like the buffers
+	if(!vecClusters.empty())
+	{
+		TMeshCluster* pClusters = new TMeshCluster[vecClusters.size()];
+		memcpy(pClusters, vecClusters.data(), vecClusters.size() * sizeof(TMeshCluster));
+		rtMeshData.ptClusters = pClusters;
+		rtMeshData.uiClusterCount = (UINT)vecClusters.size();
+	}
+
+	//Material
+	rtMeshData.iMaterialId = _pSourceMesh->mMaterialIndex;
+
+	//Bounds of the vertices kept, the box is exact as packing encodes positions within it
+	auto tBoundsStart = std::chrono::steady_clock::now();
+	ComputeMeshBounds(pVertices, uiVertexCount, sizeof(TVertexTexNorm), _rtStats.tBounds);
+	SetMeshBounds(_rtStats.tBounds, rtMeshData);
+	_rtStats.dBoundsMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tBoundsStart).count();
+
+	rtMeshData.fUVDensity = ComputeUVDensity(pVertices, uiVertexCount, pIndices, uiIndexCount); //LOD 0 only
+
+	NarrowIndices(_rtModelMeshData);
+	PackMeshVertices(_rtModelMeshData, _rtStats);
+}
+
+//Per mesh vertex cache figures before and after optimizing and the packing round trip error, then the whole model
+static void WriteConvertStats(const std::vector<const aiMesh*>& _rvecSourceMeshes, const std::vector<TMeshConvertStats>& _rvecStats, const char* _kpcFile)
+{
+	CLogManager& rLog = CLogManager::GetInstance();
+	char pcStats[512];
+	double pdACMR[2] = { 0.0, 0.0 };
+	double pdATVR[2] = { 0.0, 0.0 };
+	double dOptimizeMs = 0.0;
+	double dLodMs = 0.0;
+	unsigned long long ullTriangles = 0;
+	unsigned long long ullLowestLodTriangles = 0;
+	unsigned int uiPackedMeshes = 0;
+	unsigned long long pullWeldVertices[2] = { 0, 0 };
+	unsigned int uiWeldTriangles = 0;
+	double dWeldMs = 0.0;
+	double pdSphereRadius[2] = { 0.0, 0.0 }; //Around the box, then the fitted sphere
+	double pdBoxVolume[2] = { 0.0, 0.0 }; //Axis aligned, then oriented
+	double dBoundsMs = 0.0;
+
+	for(unsigned int i = 0; i < _rvecStats.size(); ++i)
+	{
+		const TVertexPackError& rtPackError = _rvecStats[i].tPackError;
+		sprintf_s(pcStats, "  mesh %u (%s): %s, round trip error pos %.5f, normal %.3f deg, uv %.5f\n", i, _rvecSourceMeshes[i]->mName.C_Str(),
+			_rvecStats[i].bPacked ? "packed" : "full vertices", rtPackError.fPosition, rtPackError.fNormalDegrees, rtPackError.fTexcoord);
+		rLog.WriteDebug(pcStats, "Model");
+		if(_rvecStats[i].bPacked) ++uiPackedMeshes;
+
+		//Vertices the weld merged, most of them exact copies from Assimp
+		const TMeshConvertStats& rtConvert = _rvecStats[i];
+		const TMeshWeldStats& rtWeld = rtConvert.tWeld;
+		if(rtWeld.uiVerticesAfter < rtWeld.uiVerticesBefore)
+		{
+			sprintf_s(pcStats, "  mesh %u (%s): welded %u to %u vertices, %u bit identical, %u triangles collapsed, %.2fms\n", i, _rvecSourceMeshes[i]->mName.C_Str(),
+				rtWeld.uiVerticesBefore, rtWeld.uiVerticesAfter, rtWeld.uiBitIdentical, rtWeld.uiTrianglesRemoved, rtWeld.dMs);
+			rLog.WriteDebug(pcStats, "Model");
+		}
+		pullWeldVertices[0] += rtWeld.uiVerticesBefore;
+		pullWeldVertices[1] += rtWeld.uiVerticesAfter;
+		uiWeldTriangles += rtWeld.uiTrianglesRemoved;
+		dWeldMs += rtWeld.dMs;
+
+		//How much the fitted volumes shrank from those around the box
+		const TMeshBounds& rtBounds = rtConvert.tBounds;
+		const float3& rvec3Box = rtBounds.vec3BoxExtends;
+		const float3& rvec3OBB = rtBounds.vec3OBBExtends;
+		pdSphereRadius[0] += sqrt((double)rvec3Box.x * rvec3Box.x + (double)rvec3Box.y * rvec3Box.y + (double)rvec3Box.z * rvec3Box.z);
+		pdSphereRadius[1] += rtBounds.fSphereRadius;
+		pdBoxVolume[0] += 8.0 * rvec3Box.x * rvec3Box.y * rvec3Box.z;
+		pdBoxVolume[1] += 8.0 * rvec3OBB.x * rvec3OBB.y * rvec3OBB.z;
+		dBoundsMs += rtConvert.dBoundsMs;
+
+		//Triangles and error of each level, LOD 0 first
+		if(rtConvert.uiLodCount)
+		{
+			int iLength = sprintf_s(pcStats, "  mesh %u (%s): %u LODs,", i, _rvecSourceMeshes[i]->mName.C_Str(), rtConvert.uiLodCount);
+			for(unsigned int j = 0; j < rtConvert.uiLodCount && iLength > 0 && iLength < (int)sizeof(pcStats); ++j)
+			{
+				iLength += sprintf_s(pcStats + iLength, sizeof(pcStats) - iLength, " %u tris (%.4f)", rtConvert.ptLods[j].uiIndexCount / 3, rtConvert.ptLods[j].fError);
+			}
+			sprintf_s(pcStats + iLength, sizeof(pcStats) - iLength, ", %.2fms\n", rtConvert.dLodMs);
+			rLog.WriteDebug(pcStats, "Model");
+
+			ullLowestLodTriangles += rtConvert.ptLods[rtConvert.uiLodCount - 1].uiIndexCount / 3;
+			dLodMs += rtConvert.dLodMs;
+		}
+
+		//Culling clusters and what regrouping into them cost the vertex cache
+		if(rtConvert.uiClusterCount)
+		{
+			sprintf_s(pcStats, "  mesh %u (%s): %u culling clusters, ACMR %.3f to %.3f, %.2fms\n", i, _rvecSourceMeshes[i]->mName.C_Str(),
+				rtConvert.uiClusterCount, rtConvert.fUnclusteredACMR, rtConvert.tOptimize.tAfter.fACMR, rtConvert.dClusterMs);
+			rLog.WriteDebug(pcStats, "Model");
+		}
+
+		const TMeshOptimizeStats& rtStats = _rvecStats[i].tOptimize;
+		if(!rtStats.uiTriangleCount) continue;
+
+		sprintf_s(pcStats, "  mesh %u (%s): %u tris, ACMR %.3f to %.3f, ATVR %.3f to %.3f, %u clusters, %u unused vertices, %.2fms\n", i, _rvecSourceMeshes[i]->mName.C_Str(),
+			rtStats.uiTriangleCount, rtStats.tBefore.fACMR, rtStats.tAfter.fACMR, rtStats.tBefore.fATVR, rtStats.tAfter.fATVR, rtStats.uiClusterCount, rtStats.uiVerticesRemoved, rtStats.dMs);
+		rLog.WriteDebug(pcStats, "Model");
+
+		//ACMR times triangles is the vertex shader runs for the mesh
+		pdACMR[0] += (double)rtStats.tBefore.fACMR * rtStats.uiTriangleCount;
+		pdACMR[1] += (double)rtStats.tAfter.fACMR * rtStats.uiTriangleCount;
+		pdATVR[0] += (double)rtStats.tBefore.fATVR * rtStats.uiTriangleCount;
+		pdATVR[1] += (double)rtStats.tAfter.fATVR * rtStats.uiTriangleCount;
+		dOptimizeMs += rtStats.dMs;
+		ullTriangles += rtStats.uiTriangleCount;
+	}
+
+	sprintf_s(pcStats, "Vertex packing: %u of %u meshes packed to %u bytes a vertex from %u: %s\n", uiPackedMeshes, (unsigned int)_rvecStats.size(),
+		(unsigned int)sizeof(TVertexPacked), (unsigned int)sizeof(TVertexTexNorm), _kpcFile);
+	rLog.WriteDebug(pcStats, "Model");
+
+	sprintf_s(pcStats, "Vertex weld: %llu to %llu vertices, %.1fKB of full vertices saved, %u triangles collapsed, %.2fms across meshes: %s\n", pullWeldVertices[0], pullWeldVertices[1],
+		(pullWeldVertices[0] - pullWeldVertices[1]) * sizeof(TVertexTexNorm) / 1024.0, uiWeldTriangles, dWeldMs, _kpcFile);
+	rLog.WriteDebug(pcStats, "Model");
+
+	sprintf_s(pcStats, "Mesh bounds: sphere radii %.1f%% and oriented box volume %.1f%% of those around the box, %.2fms across meshes: %s\n",
+		pdSphereRadius[0] > 0.0 ? pdSphereRadius[1] / pdSphereRadius[0] * 100.0 : 100.0, pdBoxVolume[0] > 0.0 ? pdBoxVolume[1] / pdBoxVolume[0] * 100.0 : 100.0, dBoundsMs, _kpcFile);
+	rLog.WriteDebug(pcStats, "Model");
+
+	if(!ullTriangles) return;
+
+	sprintf_s(pcStats, "Mesh LODs: %llu tris at LOD 0 down to %llu at each mesh's last level, %.2fms across meshes: %s\n", ullTriangles, ullLowestLodTriangles, dLodMs, _kpcFile);
+	rLog.WriteDebug(pcStats, "Model");
+
+	sprintf_s(pcStats, "Mesh optimize: %llu tris, ACMR %.3f to %.3f, ATVR %.3f to %.3f, %.0f fewer vertex shader runs drawing each mesh once, %.2fms across meshes: %s\n", ullTriangles,
+		pdACMR[0] / ullTriangles, pdACMR[1] / ullTriangles, pdATVR[0] / ullTriangles, pdATVR[1] / ullTriangles, pdACMR[0] - pdACMR[1], dOptimizeMs, _kpcFile);
+	rLog.WriteDebug(pcStats, "Model");
+}
+
+//Milliseconds since _rtStart, which then moves up to now for the next stage. Also added to the load's telemetry
+static double GetStageMs(std::chrono::steady_clock::time_point& _rtStart, ELoadStage _eStage)
+{
+	CLoadTelemetry::AddStage(_eStage, _rtStart);
+	std::chrono::steady_clock::time_point tNow = std::chrono::steady_clock::now();
+	double dElapsedMs = std::chrono::duration<double, std::milli>(tNow - _rtStart).count();
+	_rtStart = tNow;
+
+	return(dElapsedMs);
+}
+
 //Implementation
 CModel::CModel()
-	: m_iMaterialCount(0)
+	: m_bCanShareMeshes(true)
+	, m_iMaterialCount(0)
 {
 	//Constructor
 }
@@ -51,10 +688,16 @@ CModel::GetInstanceCount() const
 void
 CModel::SetMaterial(int _iMatID, const TMaterial& _rtMaterial)
 {
-	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
-	{
-		if(m_vecMeshes[i]->GetMaterialId() == _iMatID) m_vecMeshes[i]->SetMaterial(_rtMaterial);
-	}
+	//Looked up as the meshes are drawn, a mesh shared with another model keeps that model's material out of ours
+	m_mapMaterials[_iMatID] = _rtMaterial;
+	m_mapMaterialTextures.erase(_iMatID);
+}
+
+const TMaterial&
+CModel::GetMeshMaterial(unsigned int _uiIndex) const
+{
+	auto itMaterial = _uiIndex < m_vecMeshMaterialIds.size() ? m_mapMaterials.find(m_vecMeshMaterialIds[_uiIndex]) : m_mapMaterials.end();
+	return(itMaterial != m_mapMaterials.end() ? itMaterial->second : m_vecMeshes[_uiIndex]->GetMaterial());
 }
 
 int
@@ -63,33 +706,637 @@ CModel::GetMaterialCount() const
 	return(m_iMaterialCount);
 }
 
+size_t
+CModel::GetCPUBytes() const
+{
+	size_t uiBytes = m_vecInstances.size() * sizeof(TModelMeshInstance);
+
+	//Readable meshes keep a copy of their data, a shared mesh is split between the models using it
+	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
+	{
+		size_t uiMeshBytes = 0;
+		if(m_vecMeshes[i]->CanReadVB()) uiMeshBytes += m_vecMeshes[i]->GetVertexCount() * m_vecMeshes[i]->GetVertexSize();
+		if(m_vecMeshes[i]->CanReadIB()) uiMeshBytes += m_vecMeshes[i]->GetIndexCount() * m_vecMeshes[i]->GetIndexSize();
+
+		//Shareable meshes also hold the bytes they were made from for later meshes to compare against
+		if(i < m_vecMeshKeys.size() && m_vecMeshKeys[i])
+		{
+			std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+			auto itShared = sm_mapSharedMeshes.find(m_vecMeshKeys[i]);
+			if(itShared != sm_mapSharedMeshes.end()) uiMeshBytes += itShared->second.vecData.size();
+		}
+
+		uiBytes += uiMeshBytes / GetMeshUsers(i);
+	}
+
+	return(uiBytes);
+}
+
+size_t
+CModel::GetGPUBytes() const
+{
+	size_t uiBytes = 0;
+	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
+	{
+		size_t uiMeshBytes = m_vecMeshes[i]->GetVertexCount() * m_vecMeshes[i]->GetVertexSize();
+		uiMeshBytes += m_vecMeshes[i]->GetIndexCount() * m_vecMeshes[i]->GetIndexSize();
+		uiBytes += uiMeshBytes / GetMeshUsers(i);
+	}
+
+	return(uiBytes);
+}
+
+void
+CModel::GetMemoryUsage(TAssetMemory& _rtMemory) const
+{
+	IAsset::GetMemoryUsage(_rtMemory);
+
+	//Buffer data goes up through the upload queue, a mesh is staged until its fence completes
+	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
+	{
+		if(m_vecMeshes[i]->IsUploaded()) continue;
+		_rtMemory.puiBytes[MEMORY_HEAP_CPU_STAGING] += m_vecMeshes[i]->GetVertexCount() * m_vecMeshes[i]->GetVertexSize();
+		_rtMemory.puiBytes[MEMORY_HEAP_CPU_STAGING] += m_vecMeshes[i]->GetIndexCount() * m_vecMeshes[i]->GetIndexSize();
+	}
+}
+
+size_t
+CModel::GetIndexBytesSaved() const
+{
+	size_t uiBytes = 0;
+	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
+	{
+		if(m_vecMeshes[i]->GetIndexSize() == sizeof(WORD)) uiBytes += m_vecMeshes[i]->GetIndexCount() * (sizeof(DWORD) - sizeof(WORD));
+	}
+
+	return(uiBytes);
+}
+
+size_t
+CModel::GetVertexBytesSaved() const
+{
+	size_t uiBytes = 0;
+	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
+	{
+		if(m_vecMeshes[i]->GetVertexFormat() == EVertexFormat::PACKED) uiBytes += m_vecMeshes[i]->GetVertexCount() * (sizeof(TVertexTexNorm) - sizeof(TVertexPacked));
+	}
+
+	return(uiBytes);
+}
+
 EAssetType
 CModel::GetAssetType()
 {
 	return(ASSET_MODEL);
 }
 
+void
+CModel::SetUseCooked(bool _bUseCooked)
+{
+	sm_bUseCooked = _bUseCooked;
+}
+
+void
+CModel::SetUseStaticBatching(bool _bUseStaticBatching)
+{
+	sm_bUseStaticBatching = _bUseStaticBatching;
+}
+
+void
+CModel::SetShareMeshes(bool _bShareMeshes)
+{
+	sm_bShareMeshes = _bShareMeshes;
+}
+
+void
+CModel::GetSharedMeshStats(unsigned int& _ruiMeshesSaved, size_t& _ruiBytesSaved)
+{
+	_ruiMeshesSaved = 0;
+	_ruiBytesSaved = 0;
+
+	std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+	for(const auto& rPair : sm_mapSharedMeshes)
+	{
+		const TSharedMesh& rtShared = rPair.second;
+		size_t uiMeshBytes = rtShared.pMesh->GetVertexCount() * rtShared.pMesh->GetVertexSize() + rtShared.pMesh->GetIndexCount() * rtShared.pMesh->GetIndexSize();
+		_ruiMeshesSaved += rtShared.uiUsers - 1;
+		_ruiBytesSaved += (rtShared.uiUsers - 1) * uiMeshBytes;
+	}
+}
+
+unsigned int
+CModel::GetImportFlags()
+{
+	return(aiProcess_Triangulate |			//Triangulate all quad meshes
+		aiProcess_CalcTangentSpace |		//Calc tangent space for t-space normal maps
+		aiProcess_GlobalScale |				//Fixing the sizing of models
+		aiProcess_MakeLeftHanded |			//For DirectX
+		aiProcess_FlipWindingOrder |		//Fixes normals for LH system
+		aiProcess_OptimizeGraph |			//Collapse empty nodes
+		aiProcess_OptimizeMeshes |			//Collapse empty transform nodes (fixes rotation of child objects)
+		aiProcess_PopulateArmatureData |	//Generates armature info
+		aiProcess_FlipUVs);					//A fix for UV's which saves flipping in the shader
+}
+
+bool
+CModel::Cook(const char* _kpcSourceFile, const char* _kpcCookedFile)
+{
+	//An old cook left behind would look like success
+	remove(_kpcCookedFile);
+
+	CModel model;
+	bool bSuccessful = model.LoadImported(_kpcSourceFile, _kpcCookedFile);
+	model.Release();
+
+	return(bSuccessful && CMappedFile::GetWriteTime(_kpcCookedFile) != 0);
+}
+
+bool
+CModel::Load(const char* _kpcFilename)
+{
+	auto tStart = std::chrono::steady_clock::now();
+
+	//Cooked files can be loaded directly, anything else looks for a cook next to the source
+	std::string strCooked = _kpcFilename;
+	size_t uiExtLength = strlen(COOKED_MODEL_EXTENSION);
+	bool bIsCooked = strCooked.size() > uiExtLength && _stricmp(strCooked.c_str() + strCooked.size() - uiExtLength, COOKED_MODEL_EXTENSION) == 0;
+	if(!bIsCooked) strCooked += COOKED_MODEL_EXTENSION;
+
+	//Fall back to Assimp if the cook is missing, stale or from an older layout, then cook it for next time
+	bool bFromCook = (sm_bUseCooked || bIsCooked) && LoadCooked(strCooked.c_str(), bIsCooked ? nullptr : _kpcFilename);
+	bool bSuccessful = bFromCook || (!bIsCooked && LoadImported(_kpcFilename, sm_bUseCooked ? strCooked.c_str() : nullptr));
+
+	//Load times, compare with SetUseCooked(false) to see the import cost
+	char pcStats[512];
+	double dElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	sprintf_s(pcStats, "Model %s from %s in %.2fms (%u meshes, %u instances, %.1fKB saved by 16 bit indices, %.1fKB by packed vertices): %s\n", bSuccessful ? "loaded" : "failed to load",
+		bFromCook ? "cook" : "Assimp", dElapsedMs, GetMeshCount(), GetInstanceCount(), GetIndexBytesSaved() / 1024.0, GetVertexBytesSaved() / 1024.0, _kpcFilename);
+	CLogManager::GetInstance().WriteDebug(pcStats, "Model");
+
+	return(bSuccessful);
+}
+
+bool
+CModel::LoadCooked(const char* _kpcCookedFile, const char* _kpcSourceFile)
+{
+	auto tStageStart = std::chrono::steady_clock::now();
+
+	//Loose or from a mounted pak
+	CMappedFile mappedFile;
+	if(!CAssetManager::GetInstance().OpenFile(_kpcCookedFile, mappedFile) || mappedFile.GetSize() < sizeof(TCookedModelHeader)) return(false);
+	CLoadTelemetry::AddBytesIn(mappedFile.GetSize());
+
+	const BYTE* pData = mappedFile.GetData();
+	const TCookedModelHeader* ptHeader = reinterpret_cast<const TCookedModelHeader*>(pData);
+
+	//Reject anything that wasn't cooked by this build or has been cut short
+	bool bValid = ptHeader->uiMagic == COOKED_MODEL_MAGIC
+		&& ptHeader->uiVersion == COOKED_MODEL_VERSION
+		&& ptHeader->uiVertexSize == sizeof(TVertexTexNorm)
+		&& ptHeader->uiIndexSize == sizeof(DWORD)
+		&& ptHeader->uiInstanceSize == sizeof(TModelMeshInstance)
+		&& ptHeader->ullFileSize == mappedFile.GetSize();
+
+	//Stale if the source has changed since, a missing source is fine (shipped without it)
+	unsigned long long ullSourceTime = CMappedFile::GetWriteTime(_kpcSourceFile);
+	if(bValid && ullSourceTime && ullSourceTime != ptHeader->ullSourceWriteTime) bValid = false;
+	if(!bValid) return(false);
+
+	//Tables directly after the header
+	size_t uiTableEnd = sizeof(TCookedModelHeader) + ptHeader->uiMeshCount * sizeof(TCookedMesh) + ptHeader->uiInstanceCount * sizeof(TModelMeshInstance);
+	if(uiTableEnd > mappedFile.GetSize()) return(false);
+
+	const TCookedMesh* ptMeshes = reinterpret_cast<const TCookedMesh*>(pData + sizeof(TCookedModelHeader));
+	const TModelMeshInstance* ptInstances = reinterpret_cast<const TModelMeshInstance*>(ptMeshes + ptHeader->uiMeshCount);
+
+	m_iMaterialCount = ptHeader->iMaterialCount;
+
+	//Blobs must sit inside the file, 16 bit indices only where they can reach every vertex
+	for(unsigned int i = 0; i < ptHeader->uiMeshCount; ++i)
+	{
+		const TCookedMesh& rtMesh = ptMeshes[i];
+		if((rtMesh.uiVertexFormat != (unsigned int)EVertexFormat::TEX_NORM && rtMesh.uiVertexFormat != (unsigned int)EVertexFormat::PACKED)
+			|| (rtMesh.uiIndexSize != sizeof(WORD) && rtMesh.uiIndexSize != sizeof(DWORD))
+			|| (rtMesh.uiIndexSize == sizeof(WORD) && !CanUseShortIndices(rtMesh.uiVertexCount))
+			|| rtMesh.ullVertexOffset + (unsigned long long)rtMesh.uiVertexCount * GetCookedVertexSize(rtMesh) > mappedFile.GetSize()
+			|| rtMesh.ullIndexOffset + (unsigned long long)rtMesh.uiIndexCount * rtMesh.uiIndexSize > mappedFile.GetSize()
+			|| rtMesh.uiLodCount > COOKED_MODEL_MAX_LODS) return(false);
+
+		//Levels must add up to no more than the index blob
+		unsigned long long ullLodIndices = 0;
+		for(unsigned int j = 0; j < rtMesh.uiLodCount; ++j) ullLodIndices += rtMesh.puiLodIndexCount[j];
+		if(ullLodIndices > rtMesh.uiIndexCount) return(false);
+
+		//Clusters are read in place, so the blob must sit inside the file aligned for them. CMesh checks their ranges against LOD 0
+		if(rtMesh.uiClusterCount && (rtMesh.ullClusterOffset % alignof(TMeshCluster)
+			|| rtMesh.ullClusterOffset + (unsigned long long)rtMesh.uiClusterCount * sizeof(TMeshCluster) > mappedFile.GetSize())) return(false);
+	}
+	double dMapMs = GetStageMs(tStageStart, LOAD_STAGE_READ);
+
+	//Mesh data points straight into the mapping, read only and not owned. The buffers are created from it before it is unmapped
+	std::vector<TModelMeshData> vecMeshData(ptHeader->uiMeshCount);
+	CJobSystem::GetParallelPool().ParallelFor(ptHeader->uiMeshCount, 0, [&](unsigned int _uiMesh)
+	{
+		const TCookedMesh& rtMesh = ptMeshes[_uiMesh];
+		bool bShortIndices = rtMesh.uiIndexSize == sizeof(WORD);
+		bool bPacked = rtMesh.uiVertexFormat == (unsigned int)EVertexFormat::PACKED;
+		TVertexTexNorm* pVertices = bPacked ? nullptr : (TVertexTexNorm*)(pData + rtMesh.ullVertexOffset);
+		DWORD* pIndices = (rtMesh.uiIndexCount && !bShortIndices) ? (DWORD*)(pData + rtMesh.ullIndexOffset) : nullptr;
+
+		TModelMeshData& rtModelMesh = vecMeshData[_uiMesh];
+		rtModelMesh.pShortIndices = (rtMesh.uiIndexCount && bShortIndices) ? (WORD*)(pData + rtMesh.ullIndexOffset) : nullptr;
+		rtModelMesh.pPackedVertices = bPacked ? (TVertexPacked*)(pData + rtMesh.ullVertexOffset) : nullptr;
+
+		TMeshData<TVertexTexNorm>& rtMeshInit = rtModelMesh.tMesh;
+		rtMeshInit = TMeshData<TVertexTexNorm>(pVertices, rtMesh.uiVertexCount, pIndices, rtMesh.uiIndexCount, EMeshAccess::RAW, EMeshAccess::RAW, false);
+		rtMeshInit.iMaterialId = rtMesh.iMaterialId;
+		rtMeshInit.vec3BBCenter = float3(rtMesh.fBBCenter[0], rtMesh.fBBCenter[1], rtMesh.fBBCenter[2]);
+		rtMeshInit.vec3BBExtends = float3(rtMesh.fBBExtends[0], rtMesh.fBBExtends[1], rtMesh.fBBExtends[2]);
+		rtMeshInit.vec3SphereCenter = float3(rtMesh.fSphere[0], rtMesh.fSphere[1], rtMesh.fSphere[2]);
+		rtMeshInit.fSphereRadius = rtMesh.fSphere[3];
+		rtMeshInit.vec3OBBCenter = float3(rtMesh.fOBBCenter[0], rtMesh.fOBBCenter[1], rtMesh.fOBBCenter[2]);
+		rtMeshInit.vec3OBBExtends = float3(rtMesh.fOBBExtends[0], rtMesh.fOBBExtends[1], rtMesh.fOBBExtends[2]);
+		rtMeshInit.vec4OBBOrientation = float4(rtMesh.fOBBOrientation[0], rtMesh.fOBBOrientation[1], rtMesh.fOBBOrientation[2], rtMesh.fOBBOrientation[3]);
+		rtMeshInit.fUVDensity = rtMesh.fUVDensity;
+
+		rtMeshInit.uiLodCount = rtMesh.uiLodCount;
+		for(unsigned int j = 0; j < rtMesh.uiLodCount; ++j)
+		{
+			rtMeshInit.ptLods[j].uiIndexStart = j ? rtMeshInit.ptLods[j - 1].uiIndexStart + rtMeshInit.ptLods[j - 1].uiIndexCount : 0;
+			rtMeshInit.ptLods[j].uiIndexCount = rtMesh.puiLodIndexCount[j];
+			rtMeshInit.ptLods[j].fError = rtMesh.pfLodError[j];
+		}
+
+		rtMeshInit.ptClusters = rtMesh.uiClusterCount ? (const TMeshCluster*)(pData + rtMesh.ullClusterOffset) : nullptr;
+		rtMeshInit.uiClusterCount = rtMesh.uiClusterCount;
+	});
+	double dConvertMs = GetStageMs(tStageStart, LOAD_STAGE_CONVERT);
+
+	//Instance table is already flattened, static batching needs it before the buffers are created
+	m_vecInstances.assign(ptInstances, ptInstances + ptHeader->uiInstanceCount);
+
+	//Create the buffers and queue their data
+	bool bSuccessful = CreateMeshes(vecMeshData);
+	double dUploadMs = GetStageMs(tStageStart, LOAD_STAGE_UPLOAD);
+	if(!bSuccessful) Release(); //Leave nothing behind for the Assimp fallback
+
+	char pcStats[512];
+	sprintf_s(pcStats, "Model cook stages: map %.2fms, convert %.2fms (%u meshes), upload %.2fms: %s\n",
+		dMapMs, dConvertMs, ptHeader->uiMeshCount, dUploadMs, _kpcCookedFile);
+	CLogManager::GetInstance().WriteDebug(pcStats, "Model");
+
+	return(bSuccessful);
+}
+
+bool
+CModel::CreateMeshes(const std::vector<TModelMeshData>& _rvecMeshData)
+{
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	bool bSuccessful = true;
+
+	//Batches replace the meshes they were made from, the rest are created as they are
+	std::vector<TModelMeshData> vecBatched;
+	unsigned int uiBatchCount = sm_bUseStaticBatching ? BatchStaticMeshes(_rvecMeshData, vecBatched) : 0;
+	const std::vector<TModelMeshData>& rvecMeshData = uiBatchCount ? vecBatched : _rvecMeshData;
+
+	//Buffers are created here, their data goes up between frames through the renderer's upload queue
+	for(unsigned int i = 0; i < rvecMeshData.size() && bSuccessful; ++i)
+	{
+		//Create and store new mesh, the vertex and index types follow the data. One another model already has is shared instead
+		unsigned long long ullKey = 0;
+		IMesh* pTargetMesh = (sm_bShareMeshes && m_bCanShareMeshes) ? CreateSharedMesh(pRenderer, rvecMeshData[i], ullKey, bSuccessful)
+			: CreateMesh(pRenderer, rvecMeshData[i], bSuccessful);
+
+		//The material id stays with the model, the shared mesh may have been made by a model that numbers its materials differently
+		m_vecMeshes.push_back(pTargetMesh);
+		m_vecMeshKeys.push_back(ullKey);
+		m_vecMeshMaterialIds.push_back(rvecMeshData[i].tMesh.iMaterialId);
+	}
+
+	//Batches sit at the end, their data has been copied out
+	for(size_t i = vecBatched.size() - uiBatchCount; i < vecBatched.size(); ++i) FreeMeshData(vecBatched[i]);
+
+	//Textures of materials set before the model was released are loaded again by name
+	for(const auto& rPair : m_mapMaterialTextures)
+	{
+		TMaterial& rtMaterial = m_mapMaterials[rPair.first];
+		CAssetRef<CTexture>* pTextures[] = { &rtMaterial.pDiffuseTex, &rtMaterial.pNormalTex, &rtMaterial.pSpecularTex, &rtMaterial.pAOTex };
+		for(unsigned int i = 0; i < rPair.second.size() && i < _countof(pTextures); ++i)
+		{
+			if(!rPair.second[i].empty()) *pTextures[i] = CAssetManager::GetInstance().LoadAsset<CTexture>(rPair.second[i].c_str());
+		}
+	}
+	m_mapMaterialTextures.clear();
+
+	return(bSuccessful);
+}
+
+unsigned int
+CModel::BatchStaticMeshes(const std::vector<TModelMeshData>& _rvecMeshData, std::vector<TModelMeshData>& _rvecMeshes)
+{
+	auto tStart = std::chrono::steady_clock::now();
+	_rvecMeshes.clear();
+
+	//Only meshes placed once can be moved into world space, anything instanced more than that keeps its own buffers
+	unsigned int uiMeshCount = (unsigned int)_rvecMeshData.size();
+	std::vector<unsigned int> vecInstanceCount(uiMeshCount, 0);
+	std::vector<unsigned int> vecInstanceOf(uiMeshCount, 0);
+	for(unsigned int i = 0; i < m_vecInstances.size(); ++i)
+	{
+		unsigned int uiMeshID = m_vecInstances[i].uiMeshID;
+		if(uiMeshID >= uiMeshCount) continue;
+		++vecInstanceCount[uiMeshID];
+		vecInstanceOf[uiMeshID] = i;
+	}
+
+	//Candidates grouped by material, each group in Morton order so parts next to each other in the batch are close in the world
+	//and the culler can merge the ranges of neighbours that are both visible
+	std::map<int, std::vector<unsigned int>> mapGroups;
+	float3 vec3Min(FLT_MAX, FLT_MAX, FLT_MAX);
+	float3 vec3Max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for(unsigned int i = 0; i < uiMeshCount; ++i)
+	{
+		if(vecInstanceCount[i] != 1) continue;
+
+		const TModelMeshData& rtMesh = _rvecMeshData[i];
+		const TModelMeshInstance& rtInstance = m_vecInstances[vecInstanceOf[i]];
+		unsigned int uiIndexCount = rtMesh.tMesh.uiLodCount ? rtMesh.tMesh.ptLods[0].uiIndexCount : rtMesh.tMesh.uiIndexCount;
+
+		if((!rtMesh.pShortIndices && !rtMesh.tMesh.pIndices) || (!rtMesh.pPackedVertices && !rtMesh.tMesh.pVertices)
+			|| rtMesh.tMesh.tVertexTopology != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST
+			|| uiIndexCount / 3 > STATIC_BATCH_MAX_TRIANGLES || rtMesh.tMesh.uiVertexCount > STATIC_BATCH_MAX_VERTICES
+			|| rtInstance.vec3Scale.x <= 0.0f || rtInstance.vec3Scale.y <= 0.0f || rtInstance.vec3Scale.z <= 0.0f) continue;
+
+		mapGroups[rtMesh.tMesh.iMaterialId].push_back(i);
+		vec3Min = float3(min(vec3Min.x, rtInstance.vec3Pos.x), min(vec3Min.y, rtInstance.vec3Pos.y), min(vec3Min.z, rtInstance.vec3Pos.z));
+		vec3Max = float3(max(vec3Max.x, rtInstance.vec3Pos.x), max(vec3Max.y, rtInstance.vec3Pos.y), max(vec3Max.z, rtInstance.vec3Pos.z));
+	}
+
+	float3 vec3Extent = vec3Max - vec3Min;
+	auto GetCode = [&](unsigned int _uiMesh)
+	{
+		const float3& rvec3Pos = m_vecInstances[vecInstanceOf[_uiMesh]].vec3Pos;
+		return(GetMortonCode(vec3Extent.x > 0.0f ? (unsigned int)((rvec3Pos.x - vec3Min.x) / vec3Extent.x * 1023.0f) : 0,
+			vec3Extent.y > 0.0f ? (unsigned int)((rvec3Pos.y - vec3Min.y) / vec3Extent.y * 1023.0f) : 0,
+			vec3Extent.z > 0.0f ? (unsigned int)((rvec3Pos.z - vec3Min.z) / vec3Extent.z * 1023.0f) : 0));
+	};
+
+	//Parts are taken in order until the next would go over the vertex limit, a batch of one is left alone
+	std::vector<std::vector<TStaticBatchPart>> vecBatchParts;
+	std::vector<std::vector<unsigned int>> vecBatchMeshes;
+	for(auto& rPair : mapGroups)
+	{
+		std::vector<unsigned int>& rvecGroup = rPair.second;
+		std::sort(rvecGroup.begin(), rvecGroup.end(), [&](unsigned int _uiA, unsigned int _uiB) { return(GetCode(_uiA) < GetCode(_uiB)); });
+
+		std::vector<TStaticBatchPart> vecParts;
+		std::vector<unsigned int> vecMeshes;
+		unsigned int uiVertices = 0;
+		for(unsigned int i = 0; i <= rvecGroup.size(); ++i)
+		{
+			bool bEnd = i == rvecGroup.size();
+			if(bEnd || uiVertices + _rvecMeshData[rvecGroup[i]].tMesh.uiVertexCount > STATIC_BATCH_MAX_VERTICES)
+			{
+				if(vecParts.size() > 1)
+				{
+					vecBatchParts.push_back(vecParts);
+					vecBatchMeshes.push_back(vecMeshes);
+				}
+				vecParts.clear();
+				vecMeshes.clear();
+				uiVertices = 0;
+				if(bEnd) break;
+			}
+
+			TStaticBatchPart tPart;
+			tPart.ptMesh = &_rvecMeshData[rvecGroup[i]];
+			XMStoreFloat4x4(&tPart.matWorld, GetInstanceWorld(m_vecInstances[vecInstanceOf[rvecGroup[i]]]));
+			vecParts.push_back(tPart);
+			vecMeshes.push_back(rvecGroup[i]);
+			uiVertices += tPart.ptMesh->tMesh.uiVertexCount;
+		}
+	}
+	if(vecBatchParts.empty()) return(0);
+
+	//Merged, then narrowed and packed like any converted mesh. A batch that fails leaves its parts as they were
+	std::vector<TModelMeshData> vecBatches(vecBatchParts.size());
+	std::vector<char> vecMerged(vecBatchParts.size(), 0);
+	CJobSystem::GetParallelPool().ParallelFor((unsigned int)vecBatchParts.size(), 0, [&](unsigned int _uiBatch)
+	{
+		TModelMeshData& rtBatch = vecBatches[_uiBatch];
+		if(!MergeStaticBatch(vecBatchParts[_uiBatch].data(), (unsigned int)vecBatchParts[_uiBatch].size(), rtBatch)) return;
+
+		TMeshData<TVertexTexNorm>& rtMesh = rtBatch.tMesh;
+		rtMesh.fUVDensity = ComputeUVDensity(rtMesh.pVertices, rtMesh.uiVertexCount, rtMesh.pIndices, rtMesh.uiIndexCount);
+
+		TMeshConvertStats tStats;
+		NarrowIndices(rtBatch);
+		PackMeshVertices(rtBatch, tStats);
+		vecMerged[_uiBatch] = 1;
+	});
+
+	std::vector<unsigned int> vecRemap(uiMeshCount, 0);
+	std::vector<char> vecBatched(uiMeshCount, 0);
+	unsigned int uiPartCount = 0;
+	for(unsigned int i = 0; i < vecBatchMeshes.size(); ++i)
+	{
+		if(!vecMerged[i]) continue;
+		for(unsigned int uiMesh : vecBatchMeshes[i]) vecBatched[uiMesh] = 1;
+		uiPartCount += (unsigned int)vecBatchMeshes[i].size();
+	}
+
+	for(unsigned int i = 0; i < uiMeshCount; ++i)
+	{
+		if(vecBatched[i]) continue;
+		vecRemap[i] = (unsigned int)_rvecMeshes.size();
+		_rvecMeshes.push_back(_rvecMeshData[i]);
+	}
+
+	//Batched parts lose their instances, each batch gets one at the origin
+	std::vector<TModelMeshInstance> vecInstances;
+	vecInstances.reserve(m_vecInstances.size());
+	for(const TModelMeshInstance& rtInstance : m_vecInstances)
+	{
+		if(rtInstance.uiMeshID < uiMeshCount && vecBatched[rtInstance.uiMeshID]) continue;
+		vecInstances.push_back(rtInstance);
+		if(rtInstance.uiMeshID < uiMeshCount) vecInstances.back().uiMeshID = vecRemap[rtInstance.uiMeshID];
+	}
+
+	unsigned int uiBatchCount = 0;
+	for(unsigned int i = 0; i < vecBatches.size(); ++i)
+	{
+		if(!vecMerged[i])
+		{
+			FreeMeshData(vecBatches[i]);
+			continue;
+		}
+
+		TModelMeshInstance tInstance;
+		tInstance.uiMeshID = (unsigned int)_rvecMeshes.size();
+		XMStoreFloat4x4(&tInstance.matObject, XMMatrixIdentity());
+		XMStoreFloat4x4(&tInstance.matRotation, XMMatrixIdentity());
+		tInstance.vec3Pos = float3(0.0f, 0.0f, 0.0f);
+		tInstance.vec3Scale = float3(1.0f, 1.0f, 1.0f);
+		tInstance.vec3Rot = float3(0.0f, 0.0f, 0.0f);
+		vecInstances.push_back(tInstance);
+
+		_rvecMeshes.push_back(vecBatches[i]);
+		++uiBatchCount;
+	}
+
+	if(!uiBatchCount)
+	{
+		_rvecMeshes.clear();
+		return(0);
+	}
+	m_vecInstances.swap(vecInstances);
+
+	//Every mesh with instances is one instanced draw and one set of buffer binds a pass, before any culling or level of detail split
+	unsigned int uiDrawsBefore = 0;
+	for(unsigned int i = 0; i < uiMeshCount; ++i) uiDrawsBefore += vecInstanceCount[i] ? 1 : 0;
+	unsigned int uiDrawsAfter = uiDrawsBefore - uiPartCount + uiBatchCount;
+
+	char pcStats[512];
+	sprintf_s(pcStats, "Static batching: %u meshes placed once merged into %u batches by material, %u to %u mesh draws and buffer binds a pass, %.2fms: %s\n",
+		uiPartCount, uiBatchCount, uiDrawsBefore, uiDrawsAfter, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count(), m_strAssetName.c_str());
+	CLogManager::GetInstance().WriteDebug(pcStats, "Model");
+
+	return(uiBatchCount);
+}
+
+bool
+CModel::WriteCooked(const char* _kpcCookedFile, const char* _kpcSourceFile, const std::vector<TModelMeshData>& _rvecMeshData,
+	const std::vector<TModelMeshInstance>& _rvecInstances) const
+{
+	//Header, then the mesh and instance tables, then the aligned blobs
+	TCookedModelHeader tHeader;
+	ZeroMemory(&tHeader, sizeof(TCookedModelHeader));
+	tHeader.uiMagic = COOKED_MODEL_MAGIC;
+	tHeader.uiVersion = COOKED_MODEL_VERSION;
+	tHeader.uiVertexSize = sizeof(TVertexTexNorm);
+	tHeader.uiIndexSize = sizeof(DWORD);
+	tHeader.uiInstanceSize = sizeof(TModelMeshInstance);
+	tHeader.uiMeshCount = (unsigned int)_rvecMeshData.size();
+	tHeader.uiInstanceCount = (unsigned int)_rvecInstances.size();
+	tHeader.iMaterialCount = m_iMaterialCount;
+	tHeader.ullSourceWriteTime = CMappedFile::GetWriteTime(_kpcSourceFile);
+
+	//Lay out the blobs
+	std::vector<TCookedMesh> vecMeshes(_rvecMeshData.size());
+	unsigned long long ullOffset = sizeof(TCookedModelHeader) + vecMeshes.size() * sizeof(TCookedMesh) + _rvecInstances.size() * sizeof(TModelMeshInstance);
+	for(unsigned int i = 0; i < vecMeshes.size(); ++i)
+	{
+		const TMeshData<TVertexTexNorm>& rtData = _rvecMeshData[i].tMesh;
+		TCookedMesh& rtMesh = vecMeshes[i];
+		ZeroMemory(&rtMesh, sizeof(TCookedMesh));
+
+		ullOffset = (ullOffset + COOKED_MODEL_ALIGNMENT - 1) & ~(unsigned long long)(COOKED_MODEL_ALIGNMENT - 1);
+		rtMesh.ullVertexOffset = ullOffset;
+		rtMesh.uiVertexCount = rtData.uiVertexCount;
+		rtMesh.uiVertexFormat = (unsigned int)(_rvecMeshData[i].pPackedVertices ? EVertexFormat::PACKED : EVertexFormat::TEX_NORM);
+		ullOffset += rtData.uiVertexCount * GetCookedVertexSize(rtMesh);
+
+		ullOffset = (ullOffset + COOKED_MODEL_ALIGNMENT - 1) & ~(unsigned long long)(COOKED_MODEL_ALIGNMENT - 1);
+		rtMesh.ullIndexOffset = ullOffset;
+		rtMesh.uiIndexSize = _rvecMeshData[i].pShortIndices ? sizeof(WORD) : sizeof(DWORD);
+		rtMesh.uiIndexCount = (rtData.pIndices || _rvecMeshData[i].pShortIndices) ? rtData.uiIndexCount : 0;
+		ullOffset += rtMesh.uiIndexCount * rtMesh.uiIndexSize;
+
+		ullOffset = (ullOffset + COOKED_MODEL_ALIGNMENT - 1) & ~(unsigned long long)(COOKED_MODEL_ALIGNMENT - 1);
+		rtMesh.ullClusterOffset = ullOffset;
+		rtMesh.uiClusterCount = rtMesh.uiIndexCount ? rtData.uiClusterCount : 0;
+		ullOffset += rtMesh.uiClusterCount * sizeof(TMeshCluster);
+
+		rtMesh.iMaterialId = rtData.iMaterialId;
+		rtMesh.fBBCenter[0] = rtData.vec3BBCenter.x;
+		rtMesh.fBBCenter[1] = rtData.vec3BBCenter.y;
+		rtMesh.fBBCenter[2] = rtData.vec3BBCenter.z;
+		rtMesh.fBBExtends[0] = rtData.vec3BBExtends.x;
+		rtMesh.fBBExtends[1] = rtData.vec3BBExtends.y;
+		rtMesh.fBBExtends[2] = rtData.vec3BBExtends.z;
+		rtMesh.fSphere[0] = rtData.vec3SphereCenter.x;
+		rtMesh.fSphere[1] = rtData.vec3SphereCenter.y;
+		rtMesh.fSphere[2] = rtData.vec3SphereCenter.z;
+		rtMesh.fSphere[3] = rtData.fSphereRadius;
+		rtMesh.fOBBCenter[0] = rtData.vec3OBBCenter.x;
+		rtMesh.fOBBCenter[1] = rtData.vec3OBBCenter.y;
+		rtMesh.fOBBCenter[2] = rtData.vec3OBBCenter.z;
+		rtMesh.fOBBExtends[0] = rtData.vec3OBBExtends.x;
+		rtMesh.fOBBExtends[1] = rtData.vec3OBBExtends.y;
+		rtMesh.fOBBExtends[2] = rtData.vec3OBBExtends.z;
+		rtMesh.fOBBOrientation[0] = rtData.vec4OBBOrientation.x;
+		rtMesh.fOBBOrientation[1] = rtData.vec4OBBOrientation.y;
+		rtMesh.fOBBOrientation[2] = rtData.vec4OBBOrientation.z;
+		rtMesh.fOBBOrientation[3] = rtData.vec4OBBOrientation.w;
+		rtMesh.fUVDensity = rtData.fUVDensity;
+
+		//Levels are written back to back, so only their sizes are kept
+		rtMesh.uiLodCount = rtMesh.uiIndexCount ? rtData.uiLodCount : 0;
+		for(unsigned int j = 0; j < rtMesh.uiLodCount; ++j)
+		{
+			rtMesh.puiLodIndexCount[j] = rtData.ptLods[j].uiIndexCount;
+			rtMesh.pfLodError[j] = rtData.ptLods[j].fError;
+		}
+	}
+	tHeader.ullFileSize = ullOffset;
+
+	FILE* pFile = nullptr;
+	if(fopen_s(&pFile, _kpcCookedFile, "wb") != 0 || !pFile) return(false);
+
+	bool bSuccessful = fwrite(&tHeader, sizeof(TCookedModelHeader), 1, pFile) == 1;
+	if(bSuccessful && !vecMeshes.empty()) bSuccessful = fwrite(vecMeshes.data(), sizeof(TCookedMesh), vecMeshes.size(), pFile) == vecMeshes.size();
+	if(bSuccessful && !_rvecInstances.empty()) bSuccessful = fwrite(_rvecInstances.data(), sizeof(TModelMeshInstance), _rvecInstances.size(), pFile) == _rvecInstances.size();
+
+	//Blobs, padding written as zeros
+	const BYTE pPadding[COOKED_MODEL_ALIGNMENT] = {};
+	for(unsigned int i = 0; bSuccessful && i < vecMeshes.size(); ++i)
+	{
+		const TCookedMesh& rtMesh = vecMeshes[i];
+
+		const void* pVertices = _rvecMeshData[i].pPackedVertices ? (const void*)_rvecMeshData[i].pPackedVertices : (const void*)_rvecMeshData[i].tMesh.pVertices;
+		long lPosition = ftell(pFile);
+		bSuccessful = fwrite(pPadding, 1, (size_t)(rtMesh.ullVertexOffset - lPosition), pFile) == (size_t)(rtMesh.ullVertexOffset - lPosition)
+			&& fwrite(pVertices, GetCookedVertexSize(rtMesh), rtMesh.uiVertexCount, pFile) == rtMesh.uiVertexCount;
+
+		const void* pIndices = _rvecMeshData[i].pShortIndices ? (const void*)_rvecMeshData[i].pShortIndices : (const void*)_rvecMeshData[i].tMesh.pIndices;
+		lPosition = ftell(pFile);
+		bSuccessful = bSuccessful && fwrite(pPadding, 1, (size_t)(rtMesh.ullIndexOffset - lPosition), pFile) == (size_t)(rtMesh.ullIndexOffset - lPosition)
+			&& fwrite(pIndices, rtMesh.uiIndexSize, rtMesh.uiIndexCount, pFile) == rtMesh.uiIndexCount;
+
+		lPosition = ftell(pFile);
+		bSuccessful = bSuccessful && fwrite(pPadding, 1, (size_t)(rtMesh.ullClusterOffset - lPosition), pFile) == (size_t)(rtMesh.ullClusterOffset - lPosition)
+			&& fwrite(_rvecMeshData[i].tMesh.ptClusters, sizeof(TMeshCluster), rtMesh.uiClusterCount, pFile) == rtMesh.uiClusterCount;
+	}
+
+	fclose(pFile);
+
+	//A partial file fails the size check anyway, but don't leave it lying around
+	if(!bSuccessful) remove(_kpcCookedFile);
+
+	return(bSuccessful);
+}
+
 bool
-CModel::Load(const char* _strFile)
+CModel::LoadImported(const char* _strFile, const char* _kpcCookedFile)
 {
 	bool bSuccessful = false;
+	std::vector<TModelMeshData> vecMeshData; //Converted data is kept until the cook is written
+	std::vector<TModelMeshInstance> vecSourceInstances;
+
+	//Parse, convert, upload and cook run one after another, timed separately
+	auto tStageStart = std::chrono::steady_clock::now();
+	double dParseMs = 0.0, dConvertMs = 0.0, dUploadMs = 0.0, dCookMs = 0.0;
 
 	//Set up assimp and import the mesh
 	Assimp::Importer assetImporter;
-	unsigned int uiFlags = (aiProcess_Triangulate |			//Triangulate all quad meshes
-							aiProcess_CalcTangentSpace |	//Calc tangent space for t-space normal maps
-							aiProcess_GenBoundingBoxes |	//Pre-gen of bounding boxes, saves re-writing this code below
-							aiProcess_GlobalScale |			//Fixing the sizing of models
-							aiProcess_MakeLeftHanded |		//For DirectX
-							aiProcess_FlipWindingOrder |	//Fixes normals for LH system
-							aiProcess_OptimizeGraph |		//Collapse empty nodes
-							aiProcess_OptimizeMeshes |		//Collapse empty transform nodes (fixes rotation of child objects)
-							aiProcess_PopulateArmatureData |//Generates armature info
-							aiProcess_FlipUVs);				//A fix for UV's which saves flipping in the shader
-
-	//Read in the scene
+	unsigned int uiFlags = GetImportFlags();
+
+	//Read in the scene, null if Assimp couldn't read the file
 	const aiScene* scene = assetImporter.ReadFile(_strFile, uiFlags);
+	if(!scene) return(false);
 	m_iMaterialCount = scene->mNumMaterials;
+	CLoadTelemetry::AddBytesIn((size_t)CMappedFile::GetFileBytes(_strFile));
+	dParseMs = GetStageMs(tStageStart, LOAD_STAGE_DECODE);
 
 	//Mesh Loading
 	if(scene->HasMeshes())
@@ -111,12 +1358,23 @@ CModel::Load(const char* _strFile)
 			bool test2 = false;
 		}
 
-		//For each mesh
+		//Hashed up front so repeated geometry can be found before anything is converted. Rigged meshes are left apart, their weights aren't compared
+		std::vector<unsigned long long> vecSourceHashes(scene->mNumMeshes, 0);
+		CJobSystem::GetParallelPool().ParallelFor(scene->mNumMeshes, 0, [&](unsigned int _uiMesh)
+		{
+			if(scene->mMeshes[_uiMesh]->HasPositions() && !scene->mMeshes[_uiMesh]->HasBones()) vecSourceHashes[_uiMesh] = HashSourceMesh(scene->mMeshes[_uiMesh]);
+		});
+
+		//Pick out the meshes that can be used first, conversion can then run in any order
+		//A mesh with the same geometry and material as an earlier one is converted once, its instances point at the earlier one and draw with it
+		std::vector<const aiMesh*> vecSourceMeshes;
+		std::vector<unsigned int> vecSceneMeshes(scene->mNumMeshes, s_kuiNoMesh); //Converted mesh each scene mesh became
+		std::vector<unsigned int> vecDuplicates; //Scene meshes folded into each converted mesh
+		std::unordered_map<unsigned long long, std::vector<unsigned int>> mapSourceHashes;
+		unsigned int uiDuplicateCount = 0;
 		for(unsigned int i = 0; i < scene->mNumMeshes; ++i)
 		{
-			TVertexTexNorm* pVertices = nullptr;
-			DWORD* pIndices = nullptr;
-			aiMesh* pSourceMesh = scene->mMeshes[i]; //Get scene mesh
+			const aiMesh* pSourceMesh = scene->mMeshes[i]; //Get scene mesh
 
 			//Check to see if mesh has vertex data, followed by a check to see if the mesh has indicies and is triangulated
 			if(!pSourceMesh->HasPositions())
@@ -128,132 +1386,43 @@ CModel::Load(const char* _strFile)
 				continue; //not a triangulated mesh
 			}
 
-			//pSourceMesh->mBitangents;
-			bool hasbones = pSourceMesh->HasBones();
-
-			//We should leave the tree processing to CArmature, passing in the mesh so that it can extract itself
-			//We will need to build the weights here for the mesh though
-			if(hasbones)
-			{
-				//TODO:
-				// 
-				// BoneID and weights should be stored in a separate buffer
-				// bound at IA stage to reduce duplicate code here.
-				// 
-				// If we try put the weights into its own TVertexTexRigged then we need to make edge
-				// cases everywhere for selecting which vertex for zero gain where we can
-				// use a second buffer that's independant like the instance buffer.
-				// 
-				// Each vertex of a rigged mesh will require:
-				//  - 4x BoneIDs (used to look up matrix in the bone table such that offsets can be applied)
-				//  - 4x Weights (used to calculate weighting between the affectors)
-				//
-				// that is straight forward, can be done here optimally with CMesh updated for granular control over extra buffers
-				// the shader will be the same, a modification from instancing with little effort
-				// 
-				// On top of that, we need a umap of bones where the key is the bone NAME (string)
-				// Where each value is:
-				//  - bone id, number for reference to the matrix table which allows for shader lookup
-				//  - bone offset, the base offset for the bone, this will be combined with the bone matrix in the animation to produce the final matrix for weighted verts
-				//
-				// this map will most likely be created and held by CArmature. Technically we don't actually
-				// need a bone tree just yet, as the lookup is enough, however in future we will need to produce a tree.
-				// CArmature can be linked to a CAnimator using CAnimation classes for all the required information
-				//
-				//
-				//
-
-				//bones link to an armature, explore armature in the skeleton class
-				//name
-				//numWeights = number of vertices this bone effects
-				//armature is the node tree for the bones, not sure why this exists as it's the parent of the following node pointer
-				//node pointer which links to the current armature node
-				//weights for each vertex
-				//offset matrix for the bone
-				auto bones = pSourceMesh->mBones;
-				bool test2 = false;
-
-				//root node can be found from traversing the parents of any node
-				//root node has two children
-				//first child seems to be the mesh binding for the armature, it contains the mesh ID and mesh name
-				//second child is the pelvis postrotation (is this caused by an import flag)
-				//	this node has a unique transformation matrix
-				//child of the pelvis_pr is the actual pelvis bone, which contains the identity transform
-				//  the next three children of pelvis are spine and thigh PR's
-
-				//looks like the postrot nodes contain the bone transform and
-				//	the normal node only contains the bone matching info found in mBones
-				//still not sure why they're split up unless the identity transform is for scaling/offset
-				//
-				//most likely have to flatten the armature to easy traversal
-				//check assimp docs to see
-			}
-
-			//Vertices
-			pVertices = new TVertexTexNorm[pSourceMesh->mNumVertices];
-
-			bool bHasNormal = pSourceMesh->HasNormals();
-			bool bHasTangent = pSourceMesh->HasTangentsAndBitangents();
-			bool bHasUV = pSourceMesh->HasTextureCoords(0);
-
-			//Debug break for multi-channel UVs, I believe assimp supports up to 8
-			if(pSourceMesh->GetNumUVChannels() > 1)
-			{
-				//currently unsupported
-				int uvcount = pSourceMesh->GetNumUVChannels();
-				bool breakHereToFix = true;
-			}
-
-			for(unsigned int j = 0; j < pSourceMesh->mNumVertices; ++j)
+			if(vecSourceHashes[i])
 			{
-				//TODO: Support multiple UV channels
-				pVertices[j].pos = float3(pSourceMesh->mVertices[j].x, pSourceMesh->mVertices[j].y, pSourceMesh->mVertices[j].z);
-				if(bHasNormal)	pVertices[j].normal = float3(pSourceMesh->mNormals[j].x, pSourceMesh->mNormals[j].y, pSourceMesh->mNormals[j].z);
-				if(bHasTangent) pVertices[j].tangent = float3(pSourceMesh->mTangents[j].x, pSourceMesh->mTangents[j].y, pSourceMesh->mTangents[j].z);
-				if(bHasUV)		pVertices[j].texcoord = float2(pSourceMesh->mTextureCoords[0][j].x, pSourceMesh->mTextureCoords[0][j].y);
-			}
-
-			//Indices, check if we have faces and that they are triangulated
-			if(pSourceMesh->HasFaces() && pSourceMesh->mFaces[0].mNumIndices == 3)
-			{
-				const unsigned int uiFaceCount = pSourceMesh->mNumFaces;
-				const unsigned int uiIndexCount = pSourceMesh->mFaces[0].mNumIndices;
-				pIndices = new DWORD[uiFaceCount * uiIndexCount];
-
-				//Could memcpy but UINT to ULONG may cause issues in future
-				//Loop through each face, then loop through each index of face (code supports tri/quad even though we only support tri)
-				for(unsigned int uiFace = 0; uiFace < uiFaceCount; ++uiFace)
+				std::vector<unsigned int>& rvecSame = mapSourceHashes[vecSourceHashes[i]];
+				auto itSame = std::find_if(rvecSame.begin(), rvecSame.end(), [&](unsigned int _uiMesh) { return(IsSameSourceMesh(vecSourceMeshes[_uiMesh], pSourceMesh)); });
+				if(itSame != rvecSame.end())
 				{
-					for(unsigned int uiIndex = 0; uiIndex < uiIndexCount; ++uiIndex)
-					{
-						pIndices[(uiFace * uiIndexCount) + uiIndex] = pSourceMesh->mFaces[uiFace].mIndices[uiIndex];
-					}
+					vecSceneMeshes[i] = *itSame;
+					++vecDuplicates[*itSame];
+					++uiDuplicateCount;
+					continue;
 				}
+				rvecSame.push_back((unsigned int)vecSourceMeshes.size());
 			}
 
-			//New mesh data, read only with memory handover
-			TMeshData<TVertexTexNorm> tMeshInit(pVertices, pSourceMesh->mNumVertices,
-				pIndices, pSourceMesh->mNumFaces * 3,
-				EMeshAccess::RAW,
-				EMeshAccess::RAW, true);
-
-			//Material
-			tMeshInit.iMaterialId = pSourceMesh->mMaterialIndex;
+			vecSceneMeshes[i] = (unsigned int)vecSourceMeshes.size();
+			vecSourceMeshes.push_back(pSourceMesh);
+			vecDuplicates.push_back(0);
+		}
 
-			//Load AABB from the source mesh
-			aiAABB tSourceAABB = pSourceMesh->mAABB;
-			float3 vec3minPoint = float3(tSourceAABB.mMin.x, tSourceAABB.mMin.y, tSourceAABB.mMin.z);
-			float3 vec3maxPoint = float3(tSourceAABB.mMax.x, tSourceAABB.mMax.y, tSourceAABB.mMax.z);
-			tMeshInit.vec3BBCenter = (vec3minPoint + vec3maxPoint) * 0.5f;
-			tMeshInit.vec3BBExtends = (vec3maxPoint - vec3minPoint) * 0.5f;
+		//Each mesh converts on its own, spread over the parallel pool with this thread helping
+		vecMeshData.resize(vecSourceMeshes.size());
+		std::vector<TMeshConvertStats> vecConvertStats(vecSourceMeshes.size());
+		CJobSystem::GetParallelPool().ParallelFor((unsigned int)vecSourceMeshes.size(), 0, [&](unsigned int _uiMesh)
+		{
+			ConvertMesh(vecSourceMeshes[_uiMesh], vecMeshData[_uiMesh], vecConvertStats[_uiMesh]);
+		});
+		dConvertMs = GetStageMs(tStageStart, LOAD_STAGE_CONVERT);
+		WriteConvertStats(vecSourceMeshes, vecConvertStats, _strFile);
 
-			//Create and store new mesh
-			CMesh<TVertexTexNorm>* pTargetMesh = new CMesh<TVertexTexNorm>();
-			bSuccessful = pTargetMesh->Initialize(CAssetManager::GetInstance().GetRenderer(), tMeshInit);
+		//Buffers the repeated meshes would have taken once converted
+		size_t uiDuplicateBytes = 0;
+		for(unsigned int i = 0; i < vecMeshData.size(); ++i) uiDuplicateBytes += vecDuplicates[i] * GetMeshDataBytes(vecMeshData[i]);
 
-			//Store
-			m_vecMeshes.push_back(pTargetMesh);
-		}
+		char pcStats[512];
+		sprintf_s(pcStats, "Mesh dedup: %u of %u meshes repeat another's geometry and material and are instanced from it, %u converted, %.1fKB of buffers saved: %s\n",
+			uiDuplicateCount, scene->mNumMeshes, (unsigned int)vecSourceMeshes.size(), uiDuplicateBytes / 1024.0, _strFile);
+		CLogManager::GetInstance().WriteDebug(pcStats, "Model");
 
 		//TODO: Individual models load in fine, but full scenes may be rotated 90 deg...
 		//		may have to check metadata or wherever the axis info is
@@ -283,10 +1452,44 @@ CModel::Load(const char* _strFile)
 		vec3RootTranform[2].x = (iUpAxis == 2 ? XMConvertToRadians(90.0f * iUpSign) : 0.0f);
 
 		ProcessSceneNodes(scene->mRootNode, vec3Orientation, vec3RootTranform);
+
+		//Nodes name scene meshes, point their instances at the converted ones. Instances of meshes that were skipped are dropped
+		std::vector<TModelMeshInstance> vecInstances;
+		vecInstances.reserve(m_vecInstances.size());
+		for(const TModelMeshInstance& rtInstance : m_vecInstances)
+		{
+			if(rtInstance.uiMeshID >= vecSceneMeshes.size() || vecSceneMeshes[rtInstance.uiMeshID] == s_kuiNoMesh) continue;
+			vecInstances.push_back(rtInstance);
+			vecInstances.back().uiMeshID = vecSceneMeshes[rtInstance.uiMeshID];
+		}
+		m_vecInstances.swap(vecInstances);
+
+		//The cook keeps the instances as imported, static batching rewrites them for this load only
+		vecSourceInstances = m_vecInstances;
+
+		//Create the buffers and queue their data
+		bSuccessful = !vecMeshData.empty() && CreateMeshes(vecMeshData);
+		dUploadMs = GetStageMs(tStageStart, LOAD_STAGE_UPLOAD);
 	}
 
-	//Release scene
+	//Release scene, counted as part of the import
 	assetImporter.FreeScene();
+	GetStageMs(tStageStart, LOAD_STAGE_DECODE);
+
+	//Cook for the next launch
+	if(bSuccessful && _kpcCookedFile && !WriteCooked(_kpcCookedFile, _strFile, vecMeshData, vecSourceInstances))
+	{
+		std::string debug = std::string("Failed to write cooked model: ") + _kpcCookedFile + "\n";
+		CLogManager::GetInstance().WriteDebug(debug.c_str(), "Model");
+	}
+	dCookMs = GetStageMs(tStageStart, LOAD_STAGE_COOK);
+
+	char pcStats[512];
+	sprintf_s(pcStats, "Model import stages: parse %.2fms, convert %.2fms (%u meshes), upload %.2fms, cook %.2fms: %s\n",
+		dParseMs, dConvertMs, (unsigned int)vecMeshData.size(), dUploadMs, dCookMs, _strFile);
+	CLogManager::GetInstance().WriteDebug(pcStats, "Model");
+
+	for(TModelMeshData& rtMeshData : vecMeshData) FreeMeshData(rtMeshData);
 
 	//TODO: Double check all cases here
 	return(bSuccessful);
@@ -299,12 +1502,193 @@ CModel::Release()
 	for(unsigned int i = 0; i < m_vecMeshes.size(); ++i)
 	{
 		if(!m_vecMeshes[i]) continue;
+
+		//Shared meshes are freed by the last model using them
+		if(i < m_vecMeshKeys.size() && m_vecMeshKeys[i])
+		{
+			std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+			auto itShared = sm_mapSharedMeshes.find(m_vecMeshKeys[i]);
+			if(itShared != sm_mapSharedMeshes.end())
+			{
+				if(--itShared->second.uiUsers)
+				{
+					m_vecMeshes[i] = nullptr;
+					continue;
+				}
+				sm_mapSharedMeshes.erase(itShared);
+			}
+		}
+
 		delete m_vecMeshes[i];
 		m_vecMeshes[i] = nullptr;
 	}
 
+	//Materials are kept but hold their textures by name only, a released model shouldn't keep them from being evicted
+	for(auto& rPair : m_mapMaterials)
+	{
+		if(m_mapMaterialTextures.find(rPair.first) != m_mapMaterialTextures.end()) continue;
+
+		CAssetRef<CTexture>* pTextures[] = { &rPair.second.pDiffuseTex, &rPair.second.pNormalTex, &rPair.second.pSpecularTex, &rPair.second.pAOTex };
+		std::vector<std::string>& rvecNames = m_mapMaterialTextures[rPair.first];
+		for(CAssetRef<CTexture>* pTexture : pTextures)
+		{
+			rvecNames.push_back(pTexture->Get() ? pTexture->Get()->GetName() : "");
+			pTexture->Reset();
+		}
+	}
+
 	m_vecInstances.clear(); //Only references so clear this
 	m_vecMeshes.clear();
+	m_vecMeshKeys.clear();
+	m_vecMeshMaterialIds.clear();
+}
+
+IAsset*
+CModel::CreateReloadTarget() const
+{
+	//Its meshes are swapped into this model's, one borrowed from another model would be swapped out from under it
+	CModel* pModel = new CModel();
+	pModel->m_bCanShareMeshes = false;
+
+	return(pModel);
+}
+
+bool
+CModel::SwapReloaded(IAsset* _pReloaded)
+{
+	CModel* pReloaded = static_cast<CModel*>(_pReloaded);
+
+	//Keep drawing the old meshes until the new buffers are up
+	for(IMesh* pMesh : pReloaded->m_vecMeshes)
+	{
+		if(!pMesh->IsUploaded()) return(false);
+	}
+
+	//Swapped in place, entities and instancers hold on to the mesh pointers. Extra meshes are handed over
+	for(unsigned int i = 0; i < pReloaded->m_vecMeshes.size(); ++i)
+	{
+		if(i < m_vecMeshes.size())
+		{
+			//Another model draws with it too, changing it would change that model
+			if(!UnshareMesh(i))
+			{
+				std::string debug = "Mesh " + std::to_string(i) + " is shared with another model, reload skipped for it: " + m_strAssetName + "\n";
+				CLogManager::GetInstance().WriteDebug(debug.c_str(), "Model");
+				continue;
+			}
+
+			//A mesh that crossed the 16 bit index limit or the packing tolerance can't be swapped behind the same pointer, the old one stays until a full load
+			if(!SwapMeshes(m_vecMeshes[i], pReloaded->m_vecMeshes[i]))
+			{
+				std::string debug = "Mesh " + std::to_string(i) + " changed vertex format or index size, reload skipped for it: " + m_strAssetName + "\n";
+				CLogManager::GetInstance().WriteDebug(debug.c_str(), "Model");
+				continue;
+			}
+			m_vecMeshMaterialIds[i] = pReloaded->m_vecMeshMaterialIds[i];
+		}
+		else
+		{
+			m_vecMeshes.push_back(pReloaded->m_vecMeshes[i]);
+			m_vecMeshKeys.push_back(0);
+			m_vecMeshMaterialIds.push_back(pReloaded->m_vecMeshMaterialIds[i]);
+			pReloaded->m_vecMeshes[i] = nullptr;
+		}
+	}
+
+	//Meshes the new file no longer has are emptied rather than freed, they draw nothing
+	for(unsigned int i = (unsigned int)pReloaded->m_vecMeshes.size(); i < m_vecMeshes.size(); ++i)
+	{
+		if(!UnshareMesh(i)) continue;
+		if(m_vecMeshes[i]->GetVertexFormat() == EVertexFormat::PACKED) EmptyMeshAs<TVertexPacked>(m_vecMeshes[i]);
+		else EmptyMeshAs<TVertexTexNorm>(m_vecMeshes[i]);
+	}
+
+	//Entities already placed from the old instance table stay where they are
+	m_vecInstances.swap(pReloaded->m_vecInstances);
+	m_iMaterialCount = pReloaded->m_iMaterialCount;
+
+	return(true);
+}
+
+IMesh*
+CModel::CreateSharedMesh(CRenderer* _pRenderer, const TModelMeshData& _rtMeshData, unsigned long long& _rullKey, bool& _rbSuccessful)
+{
+	//The hash finds it, the bytes it was made from decide
+	std::vector<BYTE> vecData;
+	GetModelMeshBytes(_rtMeshData, vecData);
+	_rullKey = HashMeshBytes(vecData.data(), vecData.size());
+	if(!_rullKey) _rullKey = 1;
+
+	//Found under the lock, created outside it so models loading on other threads aren't held up
+	{
+		std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+		auto itShared = sm_mapSharedMeshes.find(_rullKey);
+		if(itShared != sm_mapSharedMeshes.end())
+		{
+			if(itShared->second.vecData == vecData)
+			{
+				++itShared->second.uiUsers;
+				_rbSuccessful = true;
+				return(itShared->second.pMesh);
+			}
+			_rullKey = 0;
+		}
+	}
+
+	IMesh* pMesh = CreateMesh(_pRenderer, _rtMeshData, _rbSuccessful);
+	if(!_rbSuccessful || !_rullKey)
+	{
+		_rullKey = 0;
+		return(pMesh);
+	}
+
+	std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+	auto itShared = sm_mapSharedMeshes.find(_rullKey);
+	if(itShared == sm_mapSharedMeshes.end())
+	{
+		sm_mapSharedMeshes[_rullKey] = { pMesh, 1, std::move(vecData) };
+		return(pMesh);
+	}
+
+	//Another model made the same mesh in the meantime, its copy is used
+	if(itShared->second.vecData == vecData)
+	{
+		++itShared->second.uiUsers;
+		delete pMesh;
+		return(itShared->second.pMesh);
+	}
+
+	//A key already taken belongs to data that only hashed the same, this mesh keeps to itself
+	_rullKey = 0;
+	return(pMesh);
+}
+
+unsigned int
+CModel::GetMeshUsers(unsigned int _uiIndex) const
+{
+	if(_uiIndex >= m_vecMeshKeys.size() || !m_vecMeshKeys[_uiIndex]) return(1);
+
+	std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+	auto itShared = sm_mapSharedMeshes.find(m_vecMeshKeys[_uiIndex]);
+
+	return(itShared != sm_mapSharedMeshes.end() ? max(itShared->second.uiUsers, 1u) : 1);
+}
+
+bool
+CModel::UnshareMesh(unsigned int _uiIndex)
+{
+	if(_uiIndex >= m_vecMeshKeys.size() || !m_vecMeshKeys[_uiIndex]) return(true);
+
+	std::lock_guard<std::mutex> lockShared(sm_mutexSharedMeshes);
+	auto itShared = sm_mapSharedMeshes.find(m_vecMeshKeys[_uiIndex]);
+	if(itShared != sm_mapSharedMeshes.end())
+	{
+		if(itShared->second.uiUsers > 1) return(false);
+		sm_mapSharedMeshes.erase(itShared);
+	}
+	m_vecMeshKeys[_uiIndex] = 0;
+
+	return(true);
 }
 
 void
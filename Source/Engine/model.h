@@ -5,6 +5,9 @@
 //Library Includes
 #include <vector>
 #include <string>
+#include <map>
+#include <unordered_map>
+#include <mutex>
 #include <assimp\matrix4x4.h>
 
 //Local Includes
@@ -23,6 +26,21 @@ struct TModelMeshInstance
 	float3 vec3Rot;
 };
 
+//Mesh data as it is converted or read from a cook. Meshes with few enough vertices use 16 bit indices, pShortIndices replaces tMesh.pIndices
+//Meshes that pack within tolerance use TVertexPacked, pPackedVertices replaces tMesh.pVertices
+struct TModelMeshData
+{
+	TMeshData<TVertexTexNorm> tMesh;
+	WORD* pShortIndices;
+	TVertexPacked* pPackedVertices;
+
+	TModelMeshData()
+		: pShortIndices(nullptr)
+		, pPackedVertices(nullptr)
+	{
+	}
+};
+
 //Prototype
 struct aiNode;
 class CModel: public IAsset
@@ -40,25 +58,99 @@ public:
 	TModelMeshInstance GetInstance(unsigned int _uiIndex) const;
 	unsigned int GetInstanceCount() const;
 
-	void SetMaterial(int _iMatID, const TMaterial& _rtMaterial); //rename to material slot
+	void SetMaterial(int _iMatID, const TMaterial& _rtMaterial); //rename to material slot, kept if the model is reloaded
 	int GetMaterialCount() const;
 
+	//Material set for mesh _uiIndex's id, pass it to the mesh's draw. The mesh may be shared with models that set their own
+	const TMaterial& GetMeshMaterial(unsigned int _uiIndex) const;
+
+	virtual size_t GetCPUBytes() const;
+	virtual size_t GetGPUBytes() const;
+	virtual void GetMemoryUsage(TAssetMemory& _rtMemory) const;
+
+	//Index buffer bytes saved by meshes using 16 bit indices over 32 bit ones
+	size_t GetIndexBytesSaved() const;
+
+	//Vertex buffer bytes saved by meshes using TVertexPacked over TVertexTexNorm
+	size_t GetVertexBytesSaved() const;
+
 	void GetSkeleton(int _iMeshIndex); //Return skeleton pointer if there is one
 	bool IsRigged() const; //same as checking GetSkeleton != nullptr
 
 	static EAssetType GetAssetType();
 
+	//Load from "<file>.cmdl" when it is up to date and write one after every Assimp import, on by default
+	static void SetUseCooked(bool _bUseCooked);
+
+	//Meshes placed once that share a material are merged into world space batches as they are created, on by default.
+	//The cook keeps them apart so this can be changed without cooking again
+	static void SetUseStaticBatching(bool _bUseStaticBatching);
+
+	//A mesh with the same buffers as one another model has created shares that model's CMesh, on by default.
+	//Each model keeps its own material ids and materials for its meshes, see GetMeshMaterial
+	static void SetShareMeshes(bool _bShareMeshes);
+
+	//Mesh objects every loaded model would have created over those they share and the buffer bytes that saved
+	static void GetSharedMeshStats(unsigned int& _ruiMeshesSaved, size_t& _ruiBytesSaved);
+
+	//aiProcess flags every import runs with, a change to these invalidates cooked models
+	static unsigned int GetImportFlags();
+
+	//Offline cook of _kpcSourceFile to _kpcCookedFile, nothing is kept loaded. Safe to call from several threads
+	static bool Cook(const char* _kpcSourceFile, const char* _kpcCookedFile);
+
 protected:
 	bool Load(const char* _kpcFilename);
 	void Release();
 
+	//Hot reload, meshes are swapped in place so entities holding mesh pointers keep working
+	IAsset* CreateReloadTarget() const;
+	bool SwapReloaded(IAsset* _pReloaded);
+
+	bool LoadCooked(const char* _kpcCookedFile, const char* _kpcSourceFile);
+	bool LoadImported(const char* _strFile, const char* _kpcCookedFile);
+	bool CreateMeshes(const std::vector<TModelMeshData>& _rvecMeshData); //Data is copied into the upload queue, free to release after. Needs the instances
+	bool WriteCooked(const char* _kpcCookedFile, const char* _kpcSourceFile, const std::vector<TModelMeshData>& _rvecMeshData,
+		const std::vector<TModelMeshInstance>& _rvecInstances) const;
+
+	//Fills _rvecMeshes with the meshes left alone followed by the batches and points the instances at them. Returns the batch count,
+	//0 leaves _rvecMeshes empty and the instances as they were. The batches' arrays belong to the caller
+	unsigned int BatchStaticMeshes(const std::vector<TModelMeshData>& _rvecMeshData, std::vector<TModelMeshData>& _rvecMeshes);
+
 	void ProcessSceneNodes(aiNode* _pNode, const float3* _vec3UpRightFwd, float3 _vec3PosScaleRot[3]);
 
+	//Mesh to draw _rtMeshData with, an equal one from another model when there is one or a new one registered for others to find
+	IMesh* CreateSharedMesh(CRenderer* _pRenderer, const TModelMeshData& _rtMeshData, unsigned long long& _rullKey, bool& _rbSuccessful);
+
+	//Number of models drawing mesh _uiIndex, 1 unless it is shared
+	unsigned int GetMeshUsers(unsigned int _uiIndex) const;
+
+	//Takes mesh _uiIndex out of the shared meshes so it can be changed in place, false if another model still uses it
+	bool UnshareMesh(unsigned int _uiIndex);
+
 	//Member Variables
 protected:
-	std::vector<CMesh<TVertexTexNorm>*> m_vecMeshes;
+	struct TSharedMesh
+	{
+		IMesh* pMesh;
+		unsigned int uiUsers;
+		std::vector<BYTE> vecData; //What the mesh was made from, a matching hash only shares once this compares the same
+	};
+
+	static bool sm_bUseCooked;
+	static bool sm_bUseStaticBatching;
+	static bool sm_bShareMeshes;
+	static std::mutex sm_mutexSharedMeshes;
+	static std::unordered_map<unsigned long long, TSharedMesh> sm_mapSharedMeshes; //By a hash of the mesh data, freed by the last model to release it
+
+	std::vector<IMesh*> m_vecMeshes; //CMesh of TVertexTexNorm or TVertexPacked with WORD or DWORD indices, see GetVertexFormat and GetIndexSize
+	std::vector<unsigned long long> m_vecMeshKeys; //Key of each mesh in sm_mapSharedMeshes, 0 for meshes this model keeps to itself
+	std::vector<int> m_vecMeshMaterialIds; //Material id of each mesh as this model numbers them, looked up in m_mapMaterials to draw
+	bool m_bCanShareMeshes; //Off for reload targets, their meshes are swapped into the live model's
 	std::vector<TModelMeshInstance> m_vecInstances;
 	int m_iMaterialCount;
+	std::map<int, TMaterial> m_mapMaterials; //Materials set by id, outlives Release() so eviction doesn't lose them
+	std::map<int, std::vector<std::string>> m_mapMaterialTextures; //Texture names of m_mapMaterials while released, their refs are dropped so the textures can be evicted too
 
 	friend CAssetManager;
 };
@@ -0,0 +1,193 @@
+//Library Includes
+#include <string.h>
+#include <vector>
+#include <algorithm>
+
+//Local Includes
+#include "lzcompress.h"
+
+//This Include
+#include "pakfile.h"
+
+//Implementation
+CPakFile::CPakFile()
+	: m_ptHeader(nullptr)
+	, m_ptEntries(nullptr)
+	, m_ptChunks(nullptr)
+	, m_pcNames(nullptr)
+{
+	//Constructor
+}
+
+CPakFile::~CPakFile()
+{
+	//Destructor
+	Close();
+}
+
+bool
+CPakFile::Open(const char* _kpcFilename)
+{
+	Close();
+	if(!m_mappedFile.Open(_kpcFilename) || m_mappedFile.GetSize() < sizeof(TPakHeader)) return(false);
+
+	const BYTE* pData = m_mappedFile.GetData();
+	size_t uiSize = m_mappedFile.GetSize();
+	const TPakHeader* ptHeader = reinterpret_cast<const TPakHeader*>(pData);
+
+	//Reject anything from another version or cut short, then make sure the tables fit
+	bool bValid = ptHeader->uiMagic == PAK_MAGIC
+		&& ptHeader->uiVersion == PAK_VERSION
+		&& ptHeader->uiChunkSize == PAK_CHUNK_SIZE
+		&& ptHeader->ullFileSize == uiSize
+		&& ptHeader->ullTOCOffset >= sizeof(TPakHeader)
+		&& ptHeader->ullTOCOffset + (unsigned long long)ptHeader->uiEntryCount * sizeof(TPakEntry)
+			+ (unsigned long long)ptHeader->uiChunkCount * sizeof(TPakChunk) + ptHeader->uiNamesSize <= uiSize;
+
+	if(!bValid)
+	{
+		m_mappedFile.Close();
+		return(false);
+	}
+
+	m_strFilename = _kpcFilename;
+	m_ptHeader = ptHeader;
+	m_ptEntries = reinterpret_cast<const TPakEntry*>(pData + ptHeader->ullTOCOffset);
+	m_ptChunks = reinterpret_cast<const TPakChunk*>(m_ptEntries + ptHeader->uiEntryCount);
+	m_pcNames = reinterpret_cast<const char*>(m_ptChunks + ptHeader->uiChunkCount);
+
+	return(true);
+}
+
+void
+CPakFile::Close()
+{
+	m_mappedFile.Close();
+	m_strFilename.clear();
+	m_ptHeader = nullptr;
+	m_ptEntries = nullptr;
+	m_ptChunks = nullptr;
+	m_pcNames = nullptr;
+}
+
+bool
+CPakFile::IsOpen() const
+{
+	return(m_ptHeader != nullptr);
+}
+
+bool
+CPakFile::Contains(const char* _kpcName) const
+{
+	return(FindEntry(_kpcName) != nullptr);
+}
+
+bool
+CPakFile::OpenFile(const char* _kpcName, CMappedFile& _rFile) const
+{
+	_rFile.Close();
+
+	const TPakEntry* ptEntry = FindEntry(_kpcName);
+	if(!ptEntry || !ptEntry->ullSize) return(false);
+
+	//Chunk table and the data it points at, checked before anything is read
+	unsigned long long ullExpectedChunks = (ptEntry->ullSize + PAK_CHUNK_SIZE - 1) / PAK_CHUNK_SIZE;
+	if(ptEntry->uiChunkCount != ullExpectedChunks || (unsigned long long)ptEntry->uiFirstChunk + ptEntry->uiChunkCount > m_ptHeader->uiChunkCount) return(false);
+
+	const TPakChunk* ptChunks = m_ptChunks + ptEntry->uiFirstChunk;
+	bool bCompressed = false;
+	for(unsigned int i = 0; i < ptEntry->uiChunkCount; ++i)
+	{
+		if(ptChunks[i].ullOffset + ptChunks[i].uiStoredSize > m_ptHeader->ullTOCOffset) return(false);
+		if(ptChunks[i].uiFlags & PAK_CHUNK_COMPRESSED) bCompressed = true;
+	}
+
+	//Stored chunks are written back to back, the whole file is a view into the mapping
+	const BYTE* pData = m_mappedFile.GetData();
+	if(!bCompressed)
+	{
+		if(ptChunks[0].ullOffset + ptEntry->ullSize > m_ptHeader->ullTOCOffset) return(false);
+
+		_rFile.OpenView(pData + ptChunks[0].ullOffset, (size_t)ptEntry->ullSize);
+		return(true);
+	}
+
+	std::vector<BYTE> vecData((size_t)ptEntry->ullSize);
+	for(unsigned int i = 0; i < ptEntry->uiChunkCount; ++i)
+	{
+		const TPakChunk& rtChunk = ptChunks[i];
+		size_t uiOffset = (size_t)i * PAK_CHUNK_SIZE;
+		size_t uiChunkSize = min((size_t)PAK_CHUNK_SIZE, vecData.size() - uiOffset);
+
+		if(rtChunk.uiFlags & PAK_CHUNK_COMPRESSED)
+		{
+			if(!LZDecompress(pData + rtChunk.ullOffset, rtChunk.uiStoredSize, vecData.data() + uiOffset, uiChunkSize)) return(false);
+		}
+		else
+		{
+			if(rtChunk.uiStoredSize != uiChunkSize) return(false);
+			memcpy(vecData.data() + uiOffset, pData + rtChunk.ullOffset, uiChunkSize);
+		}
+	}
+
+	_rFile.OpenBuffer(std::move(vecData));
+	return(true);
+}
+
+unsigned int
+CPakFile::GetEntryCount() const
+{
+	return(m_ptHeader ? m_ptHeader->uiEntryCount : 0);
+}
+
+const std::string&
+CPakFile::GetFilename() const
+{
+	return(m_strFilename);
+}
+
+unsigned long long
+CPakFile::HashName(const char* _kpcName)
+{
+	//64bit FNV-1a
+	unsigned long long ullHash = 14695981039346656037ULL;
+	for(const char* pc = _kpcName; *pc; ++pc)
+	{
+		ullHash ^= (unsigned char)FoldNameChar(*pc);
+		ullHash *= 1099511628211ULL;
+	}
+
+	return(ullHash);
+}
+
+char
+CPakFile::FoldNameChar(char _c)
+{
+	if(_c >= 'A' && _c <= 'Z') return(_c - 'A' + 'a');
+	if(_c == '/') return('\\');
+	return(_c);
+}
+
+const TPakEntry*
+CPakFile::FindEntry(const char* _kpcName) const
+{
+	if(!m_ptHeader || !_kpcName) return(nullptr);
+
+	//Binary search on the hash, then the names settle any collision
+	unsigned long long ullHash = HashName(_kpcName);
+	const TPakEntry* ptEnd = m_ptEntries + m_ptHeader->uiEntryCount;
+	const TPakEntry* ptEntry = std::lower_bound(m_ptEntries, ptEnd, ullHash, [](const TPakEntry& _rtEntry, unsigned long long _ullHash) { return(_rtEntry.ullNameHash < _ullHash); });
+
+	size_t uiLength = strlen(_kpcName);
+	for(; ptEntry != ptEnd && ptEntry->ullNameHash == ullHash; ++ptEntry)
+	{
+		if(ptEntry->uiNameLength != uiLength || (unsigned long long)ptEntry->uiNameOffset + uiLength > m_ptHeader->uiNamesSize) continue;
+
+		const char* pcStored = m_pcNames + ptEntry->uiNameOffset;
+		bool bMatch = true;
+		for(size_t i = 0; i < uiLength && bMatch; ++i) bMatch = (pcStored[i] == FoldNameChar(_kpcName[i]));
+		if(bMatch) return(ptEntry);
+	}
+
+	return(nullptr);
+}
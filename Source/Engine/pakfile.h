@@ -0,0 +1,59 @@
+#pragma once
+#ifndef __PAK_FILE_H__
+#define __PAK_FILE_H__
+
+//Library Includes
+#include <string>
+
+//Local Includes
+#include "mappedfile.h"
+#include "pakformat.h"
+
+//Read side of a pak archive, see pakformat.h. The whole archive is one mapping, so opening a file inside it costs no system calls
+//Stored files are handed out as views into the mapping, compressed ones are decompressed on the calling thread (the loader's worker)
+
+//Prototypes
+class CPakFile
+{
+	//Member Functions
+public:
+	CPakFile();
+	~CPakFile();
+
+	//Maps the archive and checks the table of contents against the file
+	bool Open(const char* _kpcFilename);
+	void Close();
+	bool IsOpen() const;
+
+	//Any thread once open. Names are matched the way asset names are, case and slash direction don't matter
+	bool Contains(const char* _kpcName) const;
+
+	//Views stay valid until the pak is closed, nothing loaded from it may outlive it
+	bool OpenFile(const char* _kpcName, CMappedFile& _rFile) const;
+
+	unsigned int GetEntryCount() const;
+	const std::string& GetFilename() const;
+
+	//FNV-1a over the folded name
+	static unsigned long long HashName(const char* _kpcName);
+	static char FoldNameChar(char _c);
+
+private:
+	CPakFile(const CPakFile& _rhs) = delete;
+
+	const TPakEntry* FindEntry(const char* _kpcName) const;
+
+	//Member Variables
+private:
+	std::string m_strFilename;
+	CMappedFile m_mappedFile;
+
+	//Inside the mapping
+	const TPakHeader* m_ptHeader;
+	const TPakEntry* m_ptEntries;
+	const TPakChunk* m_ptChunks;
+	const char* m_pcNames;
+
+};
+
+#endif //__PAK_FILE_H__
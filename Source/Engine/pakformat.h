@@ -0,0 +1,53 @@
+#pragma once
+#ifndef __PAK_FORMAT_H__
+#define __PAK_FORMAT_H__
+
+//Pak archive layout, written by the cooker and read back by CPakFile through a single mapping
+//
+//	TPakHeader
+//	File data, each file split into PAK_CHUNK_SIZE chunks, one after another
+//	TPakEntry[uiEntryCount], sorted by name hash
+//	TPakChunk[uiChunkCount], each entry's chunks in order
+//	Names, folded the same way asset names are and not null terminated
+//
+//Chunks are LZ4 blocks, or stored as is when compressing didn't pay for itself
+//An entry with no compressed chunks is contiguous and read straight out of the mapping
+
+//Types
+#define PAK_MAGIC 0x314B4150 //"PAK1"
+#define PAK_VERSION 1
+#define PAK_EXTENSION ".pak"
+#define PAK_CHUNK_SIZE (64 * 1024) //Inside LZ4's 64K window, so a chunk never needs anything outside itself
+
+#define PAK_CHUNK_COMPRESSED 0x1
+
+struct TPakHeader
+{
+	unsigned int uiMagic;
+	unsigned int uiVersion;
+	unsigned int uiEntryCount;
+	unsigned int uiChunkCount;
+	unsigned int uiChunkSize;
+	unsigned int uiNamesSize;
+	unsigned long long ullTOCOffset; //Entries, chunks and names follow each other from here
+	unsigned long long ullFileSize; //Catches truncated writes
+};
+
+struct TPakEntry
+{
+	unsigned long long ullNameHash; //CPakFile::HashName
+	unsigned long long ullSize; //Uncompressed
+	unsigned int uiNameOffset; //Into the names block
+	unsigned int uiNameLength;
+	unsigned int uiFirstChunk;
+	unsigned int uiChunkCount;
+};
+
+struct TPakChunk
+{
+	unsigned long long ullOffset; //From the start of the file
+	unsigned int uiStoredSize; //Bytes in the file, the unpacked size is PAK_CHUNK_SIZE except for an entry's last chunk
+	unsigned int uiFlags;
+};
+
+#endif //__PAK_FORMAT_H__
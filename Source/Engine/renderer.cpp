@@ -33,6 +33,10 @@ CRenderer::CRenderer()
 	for(int i = 0; i < DefaultRasterStates::MAX_RS; ++i) m_pRasterStates[i] = nullptr;
 	for(int i = 0; i < DefaultBlendStates::MAX_BS; ++i) m_pBlendStates[i] = nullptr;
 
+	//Frame stats
+	m_uiBuffersCreated = 0;
+	m_uiTexturesCreated = 0;
+	m_uiBytesCreated = 0;
 }
 
 CRenderer::~CRenderer()
@@ -47,6 +51,7 @@ bool CRenderer::Initialize(HWND _hWindow, int _iWidth, int _iHeight, bool _bWind
 
 	bSuccess = bSuccess && StartDX11(_hWindow, _iWidth, _iHeight, _bWindowed);
 	bSuccess = bSuccess && Resize(_iWidth, _iHeight);
+	bSuccess = bSuccess && m_uploadQueue.Initialize(m_pDevice, m_pDeviceContext);
 
 	return(bSuccess); //TODO: Finish Initialise
 }
@@ -55,6 +60,9 @@ void CRenderer::Shutdown()
 {
 	if(m_pDeviceContext) m_pDeviceContext->ClearState();
 
+	//Drops anything not yet uploaded along with its references
+	m_uploadQueue.Shutdown();
+
 	for(int i = 0; i < DefaultSamplerStates::MAX_SS; ++i) ReleaseCOM(m_pSamplerStates[i]);
 	for(int i = 0; i < DefaultRasterStates::MAX_RS; ++i) ReleaseCOM(m_pRasterStates[i]);
 	for(int i = 0; i < DefaultBlendStates::MAX_BS; ++i) ReleaseCOM(m_pBlendStates[i]);
@@ -124,31 +132,26 @@ bool CRenderer::SceneBegin()
 {
 	bool bSuccess = false;
 
-	if(!m_bSceneActive && m_pDeviceContext && m_pSwapChain)
+	if(!m_bSceneActive && IsDeviceReady())
 	{
-		//Get the lock for the scene, this is due to resource allocation
-		m_mutexScene.lock();
-
+		//Initial data queued by loaders since the last frame, up to the frame budget
+		m_tFrameStats.uiBytesUploaded += m_uploadQueue.Process();
 
 		bSuccess = true;
 		m_bSceneActive = true;
-		m_pDeviceContext->ClearRenderTargetView(m_pRenderTarget[0], (float*)(&m_tClearColor));
-		m_pDeviceContext->ClearDepthStencilView(m_pDepthStencil, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+		ClearRenderTarget(m_pRenderTarget[0], (float*)(&m_tClearColor));
+		ClearDepthStencil(m_pDepthStencil, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
-		m_pDeviceContext->OMSetDepthStencilState(nullptr, 0);
+		SetDepthStencilState(nullptr, 0);
 
 		float pfBlendFactors[] = {0.0f, 0.0f, 0.0f, 1.0f};
-		m_pDeviceContext->OMSetBlendState(m_pBlendStates[DefaultBlendStates::BS_DEFAULT], pfBlendFactors, 0xffffffff);
+		SetBlendState(m_pBlendStates[DefaultBlendStates::BS_DEFAULT], pfBlendFactors, 0xffffffff);
 
-		m_pDeviceContext->RSSetState(m_bRenderWireframe ? m_pRasterStates[DefaultRasterStates::RS_WIREFRAME] : m_pRasterStates[DefaultRasterStates::RS_SOLID]);
+		SetRasterState(m_bRenderWireframe ? m_pRasterStates[DefaultRasterStates::RS_WIREFRAME] : m_pRasterStates[DefaultRasterStates::RS_SOLID]);
 	}
-	else if(!m_pDeviceContext)
+	else if(!IsDeviceReady())
 	{
-		//No Device Context
-	}
-	else if(!m_pSwapChain)
-	{
-		//No swap chain
+		//No Device Context or swap chain
 	}
 	else
 	{
@@ -162,7 +165,7 @@ bool CRenderer::SceneEnd()
 {
 	bool bSuccess = false;
 
-	if(m_bSceneActive && m_pSwapChain)
+	if(m_bSceneActive && IsDeviceReady())
 	{
 		//Call finish shader
 		//TODO: Is this required?
@@ -171,17 +174,22 @@ bool CRenderer::SceneEnd()
 
 		//Present the final scene
 		m_bSceneActive = false;
-		bSuccess = SUCCEEDED(m_pSwapChain->Present(0, 0));
+		bSuccess = Present();
 
 		//Due to DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL
-		m_pDeviceContext->OMSetRenderTargets(2, m_pRenderTarget, m_pDepthStencil);
-
-		//Unlock the scene, allows for resource creation
-		m_mutexScene.unlock();
+		SetRenderTargets(2, m_pRenderTarget, m_pDepthStencil);
+
+		//Close off the frame stats, creation counters include anything created since the last present
+		m_tLastFrameStats = m_tFrameStats;
+		m_tLastFrameStats.uiBuffersCreated = m_uiBuffersCreated.exchange(0);
+		m_tLastFrameStats.uiTexturesCreated = m_uiTexturesCreated.exchange(0);
+		m_tLastFrameStats.uiBytesUploaded += m_uiBytesCreated.exchange(0);
+		m_tFrameStats = TRendererStats();
+		m_clusterCuller.EndFrame();
 	}
-	else if(!m_pSwapChain)
+	else if(!IsDeviceReady())
 	{
-		//No swap chain to present
+		//Nothing to present to
 	}
 	else
 	{
@@ -193,12 +201,20 @@ bool CRenderer::SceneEnd()
 
 bool CRenderer::IsSceneActive()
 {
-	return(m_pDevice && m_bSceneActive);
+	return(IsDeviceReady() && m_bSceneActive);
+}
+
+bool CRenderer::IsDeviceReady() const
+{
+	return(m_pDevice && m_pDeviceContext && m_pSwapChain);
 }
 
 void CRenderer::SetRenderMode(bool _bWireframe)
 {
 	m_bRenderWireframe = _bWireframe;
+
+	//Back facing clusters are visible with culling off
+	m_clusterCuller.SetBackfaceCulling(!_bWireframe);
 }
 
 bool CRenderer::GetRenderMode() const
@@ -217,21 +233,23 @@ void CRenderer::UpdateGlobalCBuffer(CCamera* _pCamera)
 	cBufferData.tCamera.vec3EyeLook = _pCamera->GetLook();
 
 	D3D11_MAPPED_SUBRESOURCE MappedResource;
-	m_pDeviceContext->Map(m_pGlobalCBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &MappedResource);
-	memcpy_s(MappedResource.pData, sizeof(ShaderGlobals::TCBufferGlobal), &cBufferData, sizeof(ShaderGlobals::TCBufferGlobal));
-	m_pDeviceContext->Unmap(m_pGlobalCBuffer, 0);
+	if(Map(m_pGlobalCBuffer, D3D11_MAP_WRITE_DISCARD, &MappedResource))
+	{
+		memcpy_s(MappedResource.pData, sizeof(ShaderGlobals::TCBufferGlobal), &cBufferData, sizeof(ShaderGlobals::TCBufferGlobal));
+		Unmap(m_pGlobalCBuffer);
+	}
 
 	//Apply the per-frame cbuffer data
 	//TODO: set it across other shaders
-	m_pDeviceContext->VSSetConstantBuffers(ShaderGlobals::ERegisters::CB_GlobalCBuffer, 1, &m_pGlobalCBuffer);
-	m_pDeviceContext->PSSetConstantBuffers(ShaderGlobals::ERegisters::CB_GlobalCBuffer, 1, &m_pGlobalCBuffer);
-	m_pDeviceContext->GSSetConstantBuffers(ShaderGlobals::ERegisters::CB_GlobalCBuffer, 1, &m_pGlobalCBuffer);
+	SetVSConstantBuffers(ShaderGlobals::ERegisters::CB_GlobalCBuffer, 1, &m_pGlobalCBuffer);
+	SetPSConstantBuffers(ShaderGlobals::ERegisters::CB_GlobalCBuffer, 1, &m_pGlobalCBuffer);
+	SetGSConstantBuffers(ShaderGlobals::ERegisters::CB_GlobalCBuffer, 1, &m_pGlobalCBuffer);
 }
 
 void CRenderer::RebindSwapChainTarget(bool _bResetRasterState)
 {
-	m_pDeviceContext->OMSetRenderTargets(2, m_pRenderTarget, m_pDepthStencil);
-	if(_bResetRasterState) m_pDeviceContext->RSSetState(m_bRenderWireframe ? m_pRasterStates[DefaultRasterStates::RS_WIREFRAME] : m_pRasterStates[DefaultRasterStates::RS_SOLID]);
+	SetRenderTargets(2, m_pRenderTarget, m_pDepthStencil);
+	if(_bResetRasterState) SetRasterState(m_bRenderWireframe ? m_pRasterStates[DefaultRasterStates::RS_WIREFRAME] : m_pRasterStates[DefaultRasterStates::RS_SOLID]);
 }
 
 
@@ -255,7 +273,7 @@ float2 CRenderer::GetSize() const
 	return float2((float)m_iWidth, (float)m_iHeight);
 }
 
-ID3D11Buffer* CRenderer::CreateBuffer(UINT _uiBufferType, void* _pData, size_t _uiStructSize, D3D11_USAGE _eBufferUsage)
+ID3D11Buffer* CRenderer::CreateBuffer(UINT _uiBufferType, void* _pData, size_t _uiStructSize, D3D11_USAGE _eBufferUsage, unsigned long long* _pullUploadFence)
 {
 	ID3D11Buffer* pBuffer = nullptr;
 	D3D11_BUFFER_DESC tBufferDescription;
@@ -271,11 +289,265 @@ ID3D11Buffer* CRenderer::CreateBuffer(UINT _uiBufferType, void* _pData, size_t _
 	//Open buffer to write access if dynamic
 	if(_eBufferUsage == D3D11_USAGE_DYNAMIC) tBufferDescription.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 
-	m_pDevice->CreateBuffer(&tBufferDescription, tResourceData.pSysMem ? &tResourceData : nullptr, &pBuffer);
+	//Default buffers can be created empty and filled in later, the upload then happens on the main thread between frames
+	bool bDeferred = _pullUploadFence && _pData && _eBufferUsage == D3D11_USAGE_DEFAULT;
+	if(_pullUploadFence) *_pullUploadFence = 0;
+
+	if(m_pDevice) m_pDevice->CreateBuffer(&tBufferDescription, (tResourceData.pSysMem && !bDeferred) ? &tResourceData : nullptr, &pBuffer);
+	if(pBuffer) RecordBufferCreated((_pData && !bDeferred) ? _uiStructSize : 0);
+	if(pBuffer && bDeferred) *_pullUploadFence = m_uploadQueue.QueueBuffer(pBuffer, _pData, _uiStructSize);
 
 	return(pBuffer); //if nullptr then failed
 }
 
+bool CRenderer::CreateTexture2D(const D3D11_TEXTURE2D_DESC* _ptDesc, const D3D11_SUBRESOURCE_DATA* _ptInitialData, ID3D11Texture2D** _ppTexture, unsigned long long* _pullUploadFence)
+{
+	//Same as buffers, default textures are created empty and every subresource is queued
+	bool bDeferred = _pullUploadFence && _ptInitialData && _ptDesc->Usage == D3D11_USAGE_DEFAULT;
+	if(_pullUploadFence) *_pullUploadFence = 0;
+
+	bool bSuccess = m_pDevice && SUCCEEDED(m_pDevice->CreateTexture2D(_ptDesc, bDeferred ? nullptr : _ptInitialData, _ppTexture));
+
+	if(bSuccess)
+	{
+		//Sum the initial data, one subresource per mip per array slice
+		size_t uiBytes = 0;
+		if(_ptInitialData && !bDeferred)
+		{
+			for(UINT i = 0; i < _ptDesc->MipLevels * _ptDesc->ArraySize; ++i) uiBytes += _ptInitialData[i].SysMemSlicePitch;
+		}
+
+		RecordTextureCreated(uiBytes);
+
+		//Queued in order, so the last subresource's fence covers the whole texture
+		for(UINT i = 0; bDeferred && i < _ptDesc->MipLevels * _ptDesc->ArraySize; ++i)
+		{
+			unsigned long long ullFence = m_uploadQueue.QueueTexture(*_ppTexture, i, _ptInitialData[i]);
+			if(ullFence) *_pullUploadFence = ullFence;
+		}
+	}
+
+	return(bSuccess);
+}
+
+bool CRenderer::CreateShaderResourceView(ID3D11Resource* _pResource, const D3D11_SHADER_RESOURCE_VIEW_DESC* _ptDesc, ID3D11ShaderResourceView** _ppView)
+{
+	return(m_pDevice && SUCCEEDED(m_pDevice->CreateShaderResourceView(_pResource, _ptDesc, _ppView)));
+}
+
+bool CRenderer::CreateVertexShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11VertexShader** _ppShader)
+{
+	return(m_pDevice && SUCCEEDED(m_pDevice->CreateVertexShader(_pByteCode, _uiByteCodeSize, nullptr, _ppShader)));
+}
+
+bool CRenderer::CreatePixelShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11PixelShader** _ppShader)
+{
+	return(m_pDevice && SUCCEEDED(m_pDevice->CreatePixelShader(_pByteCode, _uiByteCodeSize, nullptr, _ppShader)));
+}
+
+bool CRenderer::CreateGeometryShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11GeometryShader** _ppShader)
+{
+	return(m_pDevice && SUCCEEDED(m_pDevice->CreateGeometryShader(_pByteCode, _uiByteCodeSize, nullptr, _ppShader)));
+}
+
+bool CRenderer::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* _ptElements, UINT _uiElementCount, const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11InputLayout** _ppLayout)
+{
+	return(m_pDevice && SUCCEEDED(m_pDevice->CreateInputLayout(_ptElements, _uiElementCount, _pByteCode, _uiByteCodeSize, _ppLayout)));
+}
+
+unsigned int CRenderer::GetMaxTextureSize() const
+{
+	unsigned int uiMaxSize = 0;
+
+	//Maximum size supported
+	switch(m_pDevice ? m_pDevice->GetFeatureLevel() : D3D_FEATURE_LEVEL_11_0)
+	{
+	case D3D_FEATURE_LEVEL_9_1:
+	case D3D_FEATURE_LEVEL_9_2:
+		uiMaxSize = 2048;
+		break;
+	case D3D_FEATURE_LEVEL_9_3:
+		uiMaxSize = 4096;
+		break;
+	case D3D_FEATURE_LEVEL_10_0:
+	case D3D_FEATURE_LEVEL_10_1:
+		uiMaxSize = 8192;
+		break;
+	default:
+		uiMaxSize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
+		break;
+	}
+
+	return(uiMaxSize);
+}
+
+bool CRenderer::IsFormatSupported(DXGI_FORMAT _eFormat, UINT _uiRequiredSupport) const
+{
+	UINT uiSupport = 0;
+	bool bSupported = m_pDevice && SUCCEEDED(m_pDevice->CheckFormatSupport(_eFormat, &uiSupport));
+	return(bSupported && (uiSupport & _uiRequiredSupport) == _uiRequiredSupport);
+}
+
+bool CRenderer::Map(ID3D11Resource* _pResource, D3D11_MAP _eMapType, D3D11_MAPPED_SUBRESOURCE* _ptMapped, UINT _uiSubresource)
+{
+	RecordMap(_pResource, _eMapType);
+	return(m_pDeviceContext && _pResource && SUCCEEDED(m_pDeviceContext->Map(_pResource, _uiSubresource, _eMapType, 0, _ptMapped)));
+}
+
+void CRenderer::Unmap(ID3D11Resource* _pResource, UINT _uiSubresource)
+{
+	if(m_pDeviceContext && _pResource) m_pDeviceContext->Unmap(_pResource, _uiSubresource);
+}
+
+void CRenderer::SetShaders(ID3D11VertexShader* _pVertexShader, ID3D11PixelShader* _pPixelShader, ID3D11GeometryShader* _pGeometryShader, ID3D11HullShader* _pHullShader, ID3D11DomainShader* _pDomainShader, ID3D11ComputeShader* _pComputeShader)
+{
+	m_tFrameStats.uiStateChanges += 6;
+
+	if(m_pDeviceContext)
+	{
+		//Shaders set to NULL will be disabled
+		m_pDeviceContext->VSSetShader(_pVertexShader, nullptr, 0);
+		m_pDeviceContext->PSSetShader(_pPixelShader, nullptr, 0);
+		m_pDeviceContext->GSSetShader(_pGeometryShader, nullptr, 0);
+		m_pDeviceContext->HSSetShader(_pHullShader, nullptr, 0);
+		m_pDeviceContext->DSSetShader(_pDomainShader, nullptr, 0);
+		m_pDeviceContext->CSSetShader(_pComputeShader, nullptr, 0);
+	}
+}
+
+void CRenderer::SetVertexShader(ID3D11VertexShader* _pVertexShader)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->VSSetShader(_pVertexShader, nullptr, 0);
+}
+
+void CRenderer::SetInputLayout(ID3D11InputLayout* _pInputLayout)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->IASetInputLayout(_pInputLayout);
+}
+
+void CRenderer::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY _eTopology)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->IASetPrimitiveTopology(_eTopology);
+}
+
+void CRenderer::SetVertexBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers, const UINT* _puiStrides, const UINT* _puiOffsets)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->IASetVertexBuffers(_uiStartSlot, _uiBufferCount, _ppBuffers, _puiStrides, _puiOffsets);
+}
+
+void CRenderer::SetIndexBuffer(ID3D11Buffer* _pBuffer, DXGI_FORMAT _eFormat, UINT _uiOffset)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->IASetIndexBuffer(_pBuffer, _eFormat, _uiOffset);
+}
+
+void CRenderer::SetVSConstantBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->VSSetConstantBuffers(_uiStartSlot, _uiBufferCount, _ppBuffers);
+}
+
+void CRenderer::SetPSConstantBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->PSSetConstantBuffers(_uiStartSlot, _uiBufferCount, _ppBuffers);
+}
+
+void CRenderer::SetGSConstantBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->GSSetConstantBuffers(_uiStartSlot, _uiBufferCount, _ppBuffers);
+}
+
+void CRenderer::SetPSShaderResources(UINT _uiStartSlot, UINT _uiViewCount, ID3D11ShaderResourceView* const* _ppViews)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->PSSetShaderResources(_uiStartSlot, _uiViewCount, _ppViews);
+}
+
+void CRenderer::SetRenderTargets(UINT _uiViewCount, ID3D11RenderTargetView* const* _ppViews, ID3D11DepthStencilView* _pDepthStencil)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->OMSetRenderTargets(_uiViewCount, _ppViews, _pDepthStencil);
+}
+
+void CRenderer::SetRasterState(ID3D11RasterizerState* _pRasterState)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->RSSetState(_pRasterState);
+}
+
+void CRenderer::SetBlendState(ID3D11BlendState* _pBlendState, const float _kfBlendFactors[4], UINT _uiSampleMask)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->OMSetBlendState(_pBlendState, _kfBlendFactors, _uiSampleMask);
+}
+
+void CRenderer::SetDepthStencilState(ID3D11DepthStencilState* _pDepthStencilState, UINT _uiStencilRef)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->OMSetDepthStencilState(_pDepthStencilState, _uiStencilRef);
+}
+
+void CRenderer::SetViewports(UINT _uiViewportCount, const D3D11_VIEWPORT* _ptViewports)
+{
+	++m_tFrameStats.uiStateChanges;
+	if(m_pDeviceContext) m_pDeviceContext->RSSetViewports(_uiViewportCount, _ptViewports);
+}
+
+void CRenderer::ClearRenderTarget(ID3D11RenderTargetView* _pRenderTarget, const float _kfColor[4])
+{
+	//Clears are not state changes, forward only
+	if(m_pDeviceContext && _pRenderTarget) m_pDeviceContext->ClearRenderTargetView(_pRenderTarget, _kfColor);
+}
+
+void CRenderer::ClearDepthStencil(ID3D11DepthStencilView* _pDepthStencil, UINT _uiClearFlags, float _fDepth, UINT8 _uiStencil)
+{
+	if(m_pDeviceContext && _pDepthStencil) m_pDeviceContext->ClearDepthStencilView(_pDepthStencil, _uiClearFlags, _fDepth, _uiStencil);
+}
+
+void CRenderer::Draw(UINT _uiVertexCount, UINT _uiStartVertex)
+{
+	++m_tFrameStats.uiDrawCalls;
+	m_tFrameStats.uiVerticesSubmitted += _uiVertexCount;
+	if(m_pDeviceContext) m_pDeviceContext->Draw(_uiVertexCount, _uiStartVertex);
+}
+
+void CRenderer::DrawIndexed(UINT _uiIndexCount, UINT _uiStartIndex, INT _iBaseVertex)
+{
+	++m_tFrameStats.uiDrawCalls;
+	m_tFrameStats.uiVerticesSubmitted += _uiIndexCount;
+	if(m_pDeviceContext) m_pDeviceContext->DrawIndexed(_uiIndexCount, _uiStartIndex, _iBaseVertex);
+}
+
+void CRenderer::DrawInstanced(UINT _uiVertexCount, UINT _uiInstanceCount, UINT _uiStartVertex, UINT _uiStartInstance)
+{
+	++m_tFrameStats.uiDrawCalls;
+	m_tFrameStats.uiVerticesSubmitted += _uiVertexCount * _uiInstanceCount;
+	if(m_pDeviceContext) m_pDeviceContext->DrawInstanced(_uiVertexCount, _uiInstanceCount, _uiStartVertex, _uiStartInstance);
+}
+
+void CRenderer::DrawIndexedInstanced(UINT _uiIndexCount, UINT _uiInstanceCount, UINT _uiStartIndex, INT _iBaseVertex, UINT _uiStartInstance)
+{
+	++m_tFrameStats.uiDrawCalls;
+	m_tFrameStats.uiVerticesSubmitted += _uiIndexCount * _uiInstanceCount;
+	if(m_pDeviceContext) m_pDeviceContext->DrawIndexedInstanced(_uiIndexCount, _uiInstanceCount, _uiStartIndex, _iBaseVertex, _uiStartInstance);
+}
+
+const TRendererStats& CRenderer::GetFrameStats() const
+{
+	return(m_tLastFrameStats);
+}
+
+const TRendererStats& CRenderer::GetCurrentFrameStats() const
+{
+	return(m_tFrameStats);
+}
+
 ID3D11Device* CRenderer::GetDevice() const
 {
 	return(m_pDevice);
@@ -286,9 +558,47 @@ ID3D11DeviceContext* CRenderer::GetDeviceContext() const
 	return(m_pDeviceContext);
 }
 
-std::mutex& CRenderer::GetGPUMutex()
+CUploadQueue& CRenderer::GetUploadQueue()
 {
-	return(m_mutexScene);
+	return(m_uploadQueue);
+}
+
+CClusterCuller& CRenderer::GetClusterCuller()
+{
+	return(m_clusterCuller);
+}
+
+bool CRenderer::Present()
+{
+	return(m_pSwapChain && SUCCEEDED(m_pSwapChain->Present(0, 0)));
+}
+
+void CRenderer::RecordBufferCreated(size_t _uiBytes)
+{
+	++m_uiBuffersCreated;
+	m_uiBytesCreated += _uiBytes;
+}
+
+void CRenderer::RecordTextureCreated(size_t _uiBytes)
+{
+	++m_uiTexturesCreated;
+	m_uiBytesCreated += _uiBytes;
+}
+
+void CRenderer::RecordMap(ID3D11Resource* _pResource, D3D11_MAP _eMapType)
+{
+	++m_tFrameStats.uiMaps;
+
+	//Only buffers are mapped for writing in the engine, count the whole buffer as a discard renames it
+	D3D11_RESOURCE_DIMENSION eDimension = D3D11_RESOURCE_DIMENSION_UNKNOWN;
+	if(_pResource) _pResource->GetType(&eDimension);
+
+	if(eDimension == D3D11_RESOURCE_DIMENSION_BUFFER && _eMapType != D3D11_MAP_READ)
+	{
+		D3D11_BUFFER_DESC tDesc;
+		static_cast<ID3D11Buffer*>(_pResource)->GetDesc(&tDesc);
+		m_tFrameStats.uiBytesUploaded += tDesc.ByteWidth;
+	}
 }
 
 void CRenderer::ProcessWindowsMsg(UINT _msg, WPARAM _wparam, LPARAM _lparam)
@@ -372,7 +682,7 @@ bool CRenderer::StartDX11(HWND _hWindow, int _iWidth, int _iHeight, bool _bWindo
 		//D3D_FEATURE_LEVEL_9_1
 	};
 
-	UINT uiCreationFlags = D3D11_CREATE_DEVICE_SINGLETHREADED; //TODO: Change to multi-threaded if that's the case
+	UINT uiCreationFlags = 0; //Free threaded, loader threads create resources while the main thread draws
 
 #ifdef _DEBUG
 //#define D3D_DEBUG_INFO
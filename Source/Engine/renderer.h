@@ -4,12 +4,34 @@
 
 //Library Includes
 #include <mutex>
+#include <atomic>
 
 //Local Includes
 #include "common.h"
 #include "samplerstates.h"
 #include "rasterstates.h"
 #include "blendstates.h"
+#include "uploadqueue.h"
+#include "clusterculler.h"
+
+//Types
+struct TRendererStats
+{
+	//Member Variables
+	unsigned int uiBuffersCreated; //Buffers created through CreateBuffer
+	unsigned int uiTexturesCreated; //Textures created through CreateTexture2D
+	size_t uiBytesUploaded; //Initial data passed at creation and bytes opened through Map
+	unsigned int uiMaps; //Map calls, including failed attempts
+	unsigned int uiStateChanges; //Shader, input assembler, cbuffer/SRV, output merger and raster binds
+	unsigned int uiDrawCalls; //Draw, DrawIndexed, DrawInstanced, DrawIndexedInstanced
+	unsigned int uiVerticesSubmitted; //Vertices/indices submitted across all instances
+
+	//Member Functions
+	TRendererStats()
+	{
+		ZeroMemory(this, sizeof(TRendererStats));
+	}
+};
 
 //Prototypes
 class CCamera;
@@ -18,9 +40,9 @@ class CRenderer
 	//Member Functions
 public:
 	CRenderer();
-	~CRenderer();
+	virtual ~CRenderer();
 
-	bool Initialize(HWND _hWindow, int _iWidth, int _iHeight, bool _bWindowed);
+	virtual bool Initialize(HWND _hWindow, int _iWidth, int _iHeight, bool _bWindowed);
 	void Shutdown();
 
 	bool Resize(int _iWidth, int _iHeight);
@@ -29,6 +51,9 @@ public:
 	bool SceneEnd();
 	bool IsSceneActive();
 
+	//True when there is something to submit work to, a device context or a recording backend
+	virtual bool IsDeviceReady() const;
+
 	void SetRenderMode(bool _bWireframe);
 	bool GetRenderMode() const;
 
@@ -42,16 +67,75 @@ public:
 
 	float2 GetSize() const;
 
-	ID3D11Buffer* CreateBuffer(UINT _uiBufferType, void* _pData, size_t _uiStructSize, D3D11_USAGE _eBufferUsage = D3D11_USAGE_DEFAULT);
+	//Resource creation, thread safe as the device is free threaded
+	//Given _pullUploadFence, default usage initial data is queued for upload between frames rather than sent at creation
+	//The fence is written either way, 0 when the data went up with the resource
+	virtual ID3D11Buffer* CreateBuffer(UINT _uiBufferType, void* _pData, size_t _uiStructSize, D3D11_USAGE _eBufferUsage = D3D11_USAGE_DEFAULT, unsigned long long* _pullUploadFence = nullptr);
+	virtual bool CreateTexture2D(const D3D11_TEXTURE2D_DESC* _ptDesc, const D3D11_SUBRESOURCE_DATA* _ptInitialData, ID3D11Texture2D** _ppTexture, unsigned long long* _pullUploadFence = nullptr);
+	virtual bool CreateShaderResourceView(ID3D11Resource* _pResource, const D3D11_SHADER_RESOURCE_VIEW_DESC* _ptDesc, ID3D11ShaderResourceView** _ppView);
+	virtual bool CreateVertexShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11VertexShader** _ppShader);
+	virtual bool CreatePixelShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11PixelShader** _ppShader);
+	virtual bool CreateGeometryShader(const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11GeometryShader** _ppShader);
+	virtual bool CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* _ptElements, UINT _uiElementCount, const void* _pByteCode, SIZE_T _uiByteCodeSize, ID3D11InputLayout** _ppLayout);
+
+	//Device capabilities
+	virtual unsigned int GetMaxTextureSize() const;
+	virtual bool IsFormatSupported(DXGI_FORMAT _eFormat, UINT _uiRequiredSupport) const;
+
+	//Resource access, main thread only
+	virtual bool Map(ID3D11Resource* _pResource, D3D11_MAP _eMapType, D3D11_MAPPED_SUBRESOURCE* _ptMapped, UINT _uiSubresource = 0);
+	virtual void Unmap(ID3D11Resource* _pResource, UINT _uiSubresource = 0);
+
+	//Pipeline bindings, main thread only. Recorded in the frame stats before being passed to the context
+	void SetShaders(ID3D11VertexShader* _pVertexShader, ID3D11PixelShader* _pPixelShader, ID3D11GeometryShader* _pGeometryShader = nullptr, ID3D11HullShader* _pHullShader = nullptr, ID3D11DomainShader* _pDomainShader = nullptr, ID3D11ComputeShader* _pComputeShader = nullptr);
+	void SetVertexShader(ID3D11VertexShader* _pVertexShader);
+	void SetInputLayout(ID3D11InputLayout* _pInputLayout);
+	void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY _eTopology);
+	void SetVertexBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers, const UINT* _puiStrides, const UINT* _puiOffsets);
+	void SetIndexBuffer(ID3D11Buffer* _pBuffer, DXGI_FORMAT _eFormat, UINT _uiOffset = 0);
+	void SetVSConstantBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers);
+	void SetPSConstantBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers);
+	void SetGSConstantBuffers(UINT _uiStartSlot, UINT _uiBufferCount, ID3D11Buffer* const* _ppBuffers);
+	void SetPSShaderResources(UINT _uiStartSlot, UINT _uiViewCount, ID3D11ShaderResourceView* const* _ppViews);
+	void SetRenderTargets(UINT _uiViewCount, ID3D11RenderTargetView* const* _ppViews, ID3D11DepthStencilView* _pDepthStencil);
+	void SetRasterState(ID3D11RasterizerState* _pRasterState);
+	void SetBlendState(ID3D11BlendState* _pBlendState, const float _kfBlendFactors[4], UINT _uiSampleMask = 0xffffffff);
+	void SetDepthStencilState(ID3D11DepthStencilState* _pDepthStencilState, UINT _uiStencilRef = 0);
+	void SetViewports(UINT _uiViewportCount, const D3D11_VIEWPORT* _ptViewports);
+	void ClearRenderTarget(ID3D11RenderTargetView* _pRenderTarget, const float _kfColor[4]);
+	void ClearDepthStencil(ID3D11DepthStencilView* _pDepthStencil, UINT _uiClearFlags, float _fDepth = 1.0f, UINT8 _uiStencil = 0);
+
+	//Draw calls, main thread only
+	void Draw(UINT _uiVertexCount, UINT _uiStartVertex);
+	void DrawIndexed(UINT _uiIndexCount, UINT _uiStartIndex, INT _iBaseVertex);
+	void DrawInstanced(UINT _uiVertexCount, UINT _uiInstanceCount, UINT _uiStartVertex, UINT _uiStartInstance);
+	void DrawIndexedInstanced(UINT _uiIndexCount, UINT _uiInstanceCount, UINT _uiStartIndex, INT _iBaseVertex, UINT _uiStartInstance);
+
+	//Counters for the last presented frame. Resources created between frames are counted toward the next frame
+	const TRendererStats& GetFrameStats() const;
+	const TRendererStats& GetCurrentFrameStats() const; //So far this frame, the difference across a pass is that pass's share
 
 	ID3D11Device* GetDevice() const;
 	ID3D11DeviceContext* GetDeviceContext() const;
 
-	std::mutex& GetGPUMutex();
+	//Drained at the start of every scene
+	CUploadQueue& GetUploadQueue();
+
+	//Stats are per view and latched at the end of every scene
+	CClusterCuller& GetClusterCuller();
 
 	//Process the windows message queue
 	void ProcessWindowsMsg(UINT _msg, WPARAM _wparam, LPARAM _lparam);
 
+protected:
+	//Presents the back buffer, the recording backend has nothing to present
+	virtual bool Present();
+
+	//Stat recording, used by both the D3D11 path and the recording backend
+	void RecordBufferCreated(size_t _uiBytes);
+	void RecordTextureCreated(size_t _uiBytes);
+	void RecordMap(ID3D11Resource* _pResource, D3D11_MAP _eMapType);
+
 private:
 	bool StartDX11(HWND _hWindow, int _iWidth, int _iHeight, bool _bWindowed);
 
@@ -80,10 +164,20 @@ protected:
 	//Global cbuffer
 	ID3D11Buffer* m_pGlobalCBuffer;
 
-	//Used in conjunction with the multi-threaded asset manager to prevent device lockups
-	std::mutex m_mutexScene;
+	//Initial data from loader threads, uploaded between frames
+	CUploadQueue m_uploadQueue;
+
+	//Mesh clusters culled against the active camera while drawing
+	CClusterCuller m_clusterCuller;
 
 	float4 m_tClearColor;
+
+	//Frame stats, the creation counters are atomic as loader threads create resources while the main thread draws
+	TRendererStats m_tFrameStats;
+	TRendererStats m_tLastFrameStats;
+	std::atomic<unsigned int> m_uiBuffersCreated;
+	std::atomic<unsigned int> m_uiTexturesCreated;
+	std::atomic<size_t> m_uiBytesCreated;
 };
 
 #endif //__RENDERER_H__
@@ -0,0 +1,131 @@
+//Local Includes
+#include "vertexpack.h"
+#include "meshcluster.h"
+#include "meshbounds.h"
+
+//This Include
+#include "staticbatch.h"
+
+//Helpers
+//Index range of LOD 0, the whole buffer for meshes without levels
+static TMeshLod GetLodZero(const TMeshData<TVertexTexNorm>& _rtMesh)
+{
+	TMeshLod tLod;
+	tLod.uiIndexStart = 0;
+	tLod.uiIndexCount = _rtMesh.uiIndexCount;
+	if(_rtMesh.uiLodCount) tLod = _rtMesh.ptLods[0];
+
+	return(tLod);
+}
+
+//Implementation
+void
+GetMeshVertices(const TModelMeshData& _rtMesh, std::vector<TVertexTexNorm>& _rvecVertices)
+{
+	const TMeshData<TVertexTexNorm>& rtMesh = _rtMesh.tMesh;
+	if(!_rtMesh.pPackedVertices)
+	{
+		_rvecVertices.assign(rtMesh.pVertices, rtMesh.pVertices + (rtMesh.pVertices ? rtMesh.uiVertexCount : 0));
+		return;
+	}
+
+	float3 vec3Scale, vec3Offset;
+	GetPackedPositionDecode(rtMesh.vec3BBCenter, rtMesh.vec3BBExtends, vec3Scale, vec3Offset);
+
+	_rvecVertices.resize(rtMesh.uiVertexCount);
+	for(unsigned int i = 0; i < rtMesh.uiVertexCount; ++i) UnpackVertex(_rtMesh.pPackedVertices[i], vec3Scale, vec3Offset, _rvecVertices[i]);
+}
+
+void
+GetMeshIndices(const TModelMeshData& _rtMesh, std::vector<DWORD>& _rvecIndices)
+{
+	TMeshLod tLod = GetLodZero(_rtMesh.tMesh);
+	_rvecIndices.clear();
+
+	if(_rtMesh.pShortIndices) _rvecIndices.assign(_rtMesh.pShortIndices + tLod.uiIndexStart, _rtMesh.pShortIndices + tLod.uiIndexStart + tLod.uiIndexCount);
+	else if(_rtMesh.tMesh.pIndices) _rvecIndices.assign(_rtMesh.tMesh.pIndices + tLod.uiIndexStart, _rtMesh.tMesh.pIndices + tLod.uiIndexStart + tLod.uiIndexCount);
+}
+
+bool
+MergeStaticBatch(const TStaticBatchPart* _ptParts, unsigned int _uiPartCount, TModelMeshData& _rtBatch)
+{
+	std::vector<TVertexTexNorm> vecVertices;
+	std::vector<DWORD> vecIndices;
+	std::vector<TMeshCluster> vecClusters;
+	std::vector<TVertexTexNorm> vecPartVertices;
+	std::vector<DWORD> vecPartIndices;
+	int iMaterialId = _uiPartCount ? _ptParts[0].ptMesh->tMesh.iMaterialId : -1;
+
+	for(unsigned int i = 0; i < _uiPartCount; ++i)
+	{
+		const TModelMeshData& rtMesh = *_ptParts[i].ptMesh;
+		if(rtMesh.tMesh.iMaterialId != iMaterialId) return(false);
+
+		GetMeshVertices(rtMesh, vecPartVertices);
+		GetMeshIndices(rtMesh, vecPartIndices);
+		if(vecVertices.size() + vecPartVertices.size() > STATIC_BATCH_MAX_VERTICES) return(false);
+
+		//Normals go through the inverse transpose so a non uniform scale still leaves them at right angles to the surface
+		XMMATRIX xmmatWorld = XMLoadFloat4x4(&_ptParts[i].matWorld);
+		XMMATRIX xmmatNormal = XMMatrixTranspose(XMMatrixInverse(nullptr, xmmatWorld));
+
+		DWORD dwBaseVertex = (DWORD)vecVertices.size();
+		for(TVertexTexNorm tVertex : vecPartVertices)
+		{
+			XMStoreFloat3(&tVertex.pos, XMVector3TransformCoord(XMLoadFloat3(&tVertex.pos), xmmatWorld));
+			XMStoreFloat3(&tVertex.normal, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&tVertex.normal), xmmatNormal)));
+			XMStoreFloat3(&tVertex.tangent, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&tVertex.tangent), xmmatWorld)));
+			vecVertices.push_back(tVertex);
+		}
+
+		unsigned int uiPartStart = (unsigned int)vecIndices.size();
+		for(DWORD dwIndex : vecPartIndices) vecIndices.push_back(dwBaseVertex + dwIndex);
+
+		//Clusters of the part moved along with it, their bounds are redone once every vertex is in place
+		const TMeshData<TVertexTexNorm>& rtPart = rtMesh.tMesh;
+		unsigned int uiLodStart = GetLodZero(rtPart).uiIndexStart;
+		if(rtPart.ptClusters && rtPart.uiClusterCount)
+		{
+			for(unsigned int j = 0; j < rtPart.uiClusterCount; ++j)
+			{
+				TMeshCluster tCluster;
+				tCluster.uiIndexStart = uiPartStart + rtPart.ptClusters[j].uiIndexStart - uiLodStart;
+				tCluster.uiIndexCount = rtPart.ptClusters[j].uiIndexCount;
+				vecClusters.push_back(tCluster);
+			}
+		}
+		else
+		{
+			TMeshCluster tCluster;
+			tCluster.uiIndexStart = uiPartStart;
+			tCluster.uiIndexCount = (unsigned int)vecPartIndices.size();
+			vecClusters.push_back(tCluster);
+		}
+	}
+
+	if(vecVertices.empty() || vecIndices.empty()) return(false);
+
+	for(TMeshCluster& rtCluster : vecClusters) rtCluster = ComputeClusterBounds(vecIndices.data(), rtCluster.uiIndexStart, rtCluster.uiIndexCount, vecVertices.data());
+
+	TMeshBounds tBounds;
+	ComputeMeshBounds(vecVertices.data(), (unsigned int)vecVertices.size(), sizeof(TVertexTexNorm), tBounds);
+
+	//Owned copies, freed by whoever created the batch
+	TVertexTexNorm* pVertices = new TVertexTexNorm[vecVertices.size()];
+	memcpy(pVertices, vecVertices.data(), vecVertices.size() * sizeof(TVertexTexNorm));
+	DWORD* pIndices = new DWORD[vecIndices.size()];
+	memcpy(pIndices, vecIndices.data(), vecIndices.size() * sizeof(DWORD));
+	TMeshCluster* pClusters = new TMeshCluster[vecClusters.size()];
+	memcpy(pClusters, vecClusters.data(), vecClusters.size() * sizeof(TMeshCluster));
+
+	TMeshData<TVertexTexNorm>& rtBatch = _rtBatch.tMesh;
+	rtBatch = TMeshData<TVertexTexNorm>(pVertices, (UINT)vecVertices.size(), pIndices, (UINT)vecIndices.size(), EMeshAccess::RAW, EMeshAccess::RAW, false);
+	rtBatch.iMaterialId = iMaterialId;
+	SetMeshBounds(tBounds, rtBatch);
+	rtBatch.ptClusters = pClusters;
+	rtBatch.uiClusterCount = (UINT)vecClusters.size();
+	_rtBatch.pShortIndices = nullptr;
+	_rtBatch.pPackedVertices = nullptr;
+
+	return(true);
+}
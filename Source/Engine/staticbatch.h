@@ -0,0 +1,37 @@
+#pragma once
+#ifndef __STATIC_BATCH_H__
+#define __STATIC_BATCH_H__
+
+//Library Includes
+#include <vector>
+
+//Local Includes
+#include "model.h"
+
+//Load time merging of placed meshes into one vertex and index buffer
+//	Each part's LOD 0 is moved into world space and appended, so the batch draws with one bind and an identity transform
+//	The parts keep their clusters, offset into the batch, and a part without any becomes one, so a batch can still be
+//	culled part by part and drawn as ranges. Bounds are worked out again on the placed vertices
+//Index buffers are triangle lists
+
+//Types
+#define STATIC_BATCH_MAX_VERTICES 0x10000 //Batches stop here so their indices stay 16 bit
+#define STATIC_BATCH_MAX_TRIANGLES 4096 //Larger meshes keep their own buffers and LOD chain, a batch only draws LOD 0
+
+struct TStaticBatchPart
+{
+	const TModelMeshData* ptMesh;
+	float4x4 matWorld;
+};
+
+//Prototypes
+//Vertices of _rtMesh, unpacked if they were packed
+void GetMeshVertices(const TModelMeshData& _rtMesh, std::vector<TVertexTexNorm>& _rvecVertices);
+
+//LOD 0 indices of _rtMesh widened to 32 bit
+void GetMeshIndices(const TModelMeshData& _rtMesh, std::vector<DWORD>& _rvecIndices);
+
+//Full vertices and 32 bit indices in _rtBatch, which owns them and its clusters. The caller narrows and packs them as for any other mesh
+bool MergeStaticBatch(const TStaticBatchPart* _ptParts, unsigned int _uiPartCount, TModelMeshData& _rtBatch);
+
+#endif //__STATIC_BATCH_H__
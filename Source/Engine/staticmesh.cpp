@@ -1,18 +1,50 @@
 //Local Includes
 #include "camera.h"
+#include "renderer.h"
 #include "model.h"
 #include "staticmeshinstancer.h"
+#include "assetmanager.hpp"
+#include "meshbounds.h"
 
 //This Include
 #include "staticmesh.h"
 
+//Static Variables
+static std::vector<TRange<unsigned int>> s_vecClusterRanges; //Draws are main thread only, kept to save reallocating every draw
+
+//Helpers
+//Level for _pMesh drawn with _rmatWorld, the mesh's bounds give the distance and how far the matrix scales its error
+static unsigned int SelectLodAt(const IMesh* _pMesh, const float4x4& _rmatWorld, unsigned int _uiCurrentLod)
+{
+	if(_pMesh->GetLodCount() <= 1) return(0);
+
+	const DirectX::BoundingSphere& rtMeshSphere = _pMesh->GetBoundingSphere();
+	DirectX::BoundingSphere tWorldSphere;
+	rtMeshSphere.Transform(tWorldSphere, XMLoadFloat4x4(&_rmatWorld));
+
+	float fScale = rtMeshSphere.Radius > 0.0f ? tWorldSphere.Radius / rtMeshSphere.Radius : 1.0f;
+	return(CStaticMesh::SelectLod(_pMesh, tWorldSphere, fScale, _uiCurrentLod));
+}
+
+//LOD 0 is drawn as the clusters left after culling against the active camera, other levels and meshes without clusters whole
+static bool DrawCulled(IMesh* _pMesh, float4x4* _pmatWorld, unsigned int _uiLod, const TMaterial& _rtMaterial)
+{
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	if(_uiLod == 0 && pRenderer && pRenderer->GetClusterCuller().Cull(_pMesh, *_pmatWorld, s_vecClusterRanges))
+	{
+		return(_pMesh->DrawRanges(_pmatWorld, s_vecClusterRanges.data(), (unsigned int)s_vecClusterRanges.size(), nullptr, &_rtMaterial));
+	}
+
+	return(_pMesh->Draw(_pmatWorld, nullptr, _uiLod, &_rtMaterial));
+}
+
 //Implementation
 CStaticMesh::CStaticMesh()
-	: m_pModel(nullptr)
-	, m_pMesh(nullptr)
+	: m_pMesh(nullptr)
 	, m_pInstancer(nullptr)
 	, m_iMeshID(-1)
 	, m_bVisible(true)
+	, m_uiLod(0)
 {
 	//Constructor
 }
@@ -20,7 +52,7 @@ CStaticMesh::CStaticMesh()
 CStaticMesh::~CStaticMesh()
 {
 	//Destructor
-	m_pModel = nullptr;
+	m_pModel.Reset();
 	m_pMesh = nullptr;
 	m_pInstancer = nullptr;
 	m_bVisible = false;
@@ -33,17 +65,18 @@ CStaticMesh::Initialize(CModel* _pModel, int _iInstanceID, CStaticMeshInstancer*
 	//TODO: This class needs an overhaul for dealing with instanced versions
 	 
 	
-	//Check asset state of model before building combined AABB
-	//Blocking but not much we can do...
-	while(_pModel->GetAssetState() == EAssetState::Queued || _pModel->GetAssetState() == EAssetState::Loading);
-
-	//Bind model
+	//Bind model, referencing an evicted model queues it again
 	m_pModel = _pModel;
 	m_pInstancer = _pInstancer;
 
-	//Bounding box generation
-	float3 vec3Min(FLT_MAX, FLT_MAX, FLT_MAX);
-	float3 vec3Max(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	//Check asset state of model before building combined AABB
+	//Blocking but not much we can do...
+	CAssetManager::GetInstance().WaitForAsset(_pModel);
+
+	//Bounding box generation, a single instance keeps its mesh's own volumes for the entity's transform to place.
+	//Otherwise each instance's oriented box is placed as it is drawn and the model space box around them all is kept
+	DirectX::BoundingBox tModelBox;
+	bool bHasModelBox = false;
 	for(unsigned int i = 0; i < _pModel->GetInstanceCount(); ++i)
 	{
 		//Force use of a single instance
@@ -53,32 +86,14 @@ CStaticMesh::Initialize(CModel* _pModel, int _iInstanceID, CStaticMeshInstancer*
 		TModelMeshInstance tInstance = _pModel->GetInstance(i);
 		IMesh* pMesh = _pModel->GetMeshObject(tInstance.uiMeshID);
 
-		//Adjust mesh bounding box to instance pos/size
-		float3 vec3MeshCenter = (float3)pMesh->GetBoundingBox().Center;
-		float3 vec3MeshExtends = (float3)pMesh->GetBoundingBox().Extents;
-		float3 vec3MeshMin = vec3MeshCenter - vec3MeshExtends;
-		float3 vec3MeshMax = vec3MeshCenter + vec3MeshExtends;
-
-		//Bounding box min/max point calculation
-		vec3Min.x = min(vec3Min.x, vec3MeshMin.x);
-		vec3Min.y = min(vec3Min.y, vec3MeshMin.y);
-		vec3Min.z = min(vec3Min.z, vec3MeshMin.z);
-
-		vec3Max.x = max(vec3Max.x, vec3MeshMax.x);
-		vec3Max.y = max(vec3Max.y, vec3MeshMax.y);
-		vec3Max.z = max(vec3Max.z, vec3MeshMax.z);
-
-		//Make new bounding box
-		m_tOBB.Center = (vec3Min + vec3Max) * 0.5f;
-		m_tOBB.Extents = (vec3Max - vec3Min) * 0.5f;
-		m_tOriginalOBB = m_tOBB; //TODO: This is redundant code, consider Oriented BB and BB
-
 		//Single instance breakout
 		if(_iInstanceID != -1 || !_pInstancer && _pModel->GetInstanceCount() <= 1)
 		{
 			//Store quick access to instance mesh
 			m_pMesh = pMesh;
 			m_iMeshID = tInstance.uiMeshID;
+			m_tOriginalOBB = pMesh->GetOrientedBox();
+			m_tOriginalSphere = pMesh->GetBoundingSphere();
 
 			//We're a single instance, set our transform to that of the instance
 			SetRotation(m_pModel->GetInstance(i).vec3Rot);
@@ -87,10 +102,40 @@ CStaticMesh::Initialize(CModel* _pModel, int _iInstanceID, CStaticMeshInstancer*
 
 			break;
 		}
+
+		//Scale, rotate, move like CEntity3D
+		XMMATRIX matInstance = XMMatrixScaling(tInstance.vec3Scale.x, tInstance.vec3Scale.y, tInstance.vec3Scale.z);
+		matInstance = XMMatrixMultiply(matInstance, XMMatrixRotationRollPitchYaw(XMConvertToRadians(tInstance.vec3Rot.x), XMConvertToRadians(tInstance.vec3Rot.y), XMConvertToRadians(tInstance.vec3Rot.z)));
+		matInstance = XMMatrixMultiply(matInstance, XMMatrixTranslation(tInstance.vec3Pos.x, tInstance.vec3Pos.y, tInstance.vec3Pos.z));
+
+		DirectX::BoundingOrientedBox tInstanceOBB;
+		TransformOrientedBox(pMesh->GetOrientedBox(), matInstance, tInstanceOBB);
+		XMFLOAT3 pCorners[8];
+		tInstanceOBB.GetCorners(pCorners);
+		DirectX::BoundingBox tInstanceBox;
+		DirectX::BoundingBox::CreateFromPoints(tInstanceBox, 8, pCorners, sizeof(XMFLOAT3));
+
+		if(bHasModelBox) DirectX::BoundingBox::CreateMerged(tModelBox, tModelBox, tInstanceBox);
+		else tModelBox = tInstanceBox;
+		bHasModelBox = true;
+	}
+
+	//Whole model, the sphere is left to come from the box
+	if(!m_pMesh)
+	{
+		if(!bHasModelBox) tModelBox = DirectX::BoundingBox(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+		DirectX::BoundingOrientedBox::CreateFromBoundingBox(m_tOriginalOBB, tModelBox);
+		m_tOriginalSphere.Radius = 0.0f;
 	}
+	m_tOBB = m_tOriginalOBB;
 
 	//Bounding Sphere gen
 	DirectX::BoundingSphere::CreateFromBoundingBox(m_tBoundingSphere, m_tOBB);
+	if(m_tOriginalSphere.Radius > 0.0f && m_tOriginalSphere.Radius < m_tBoundingSphere.Radius) m_tBoundingSphere = m_tOriginalSphere;
+
+	//Levels start at full detail
+	m_uiLod = 0;
+	m_vecInstanceLods.assign(m_pMesh ? 0 : _pModel->GetInstanceCount(), 0);
 
 	//Render options
 	SetRenderOptions(true, true, true);
@@ -98,8 +143,8 @@ CStaticMesh::Initialize(CModel* _pModel, int _iInstanceID, CStaticMeshInstancer*
 	if(_iInstanceID != -1)
 	{
 		auto id = m_pModel->GetInstance(_iInstanceID).uiMeshID;
-		auto mat = m_pModel->GetMeshObject(id)->GetMaterial();
-		SetRenderOptions(true, mat.bCastShadow, mat.bReceiveShadow);
+		const TMaterial& rtMaterial = m_pModel->GetMeshMaterial(id);
+		SetRenderOptions(true, rtMaterial.bCastShadow, rtMaterial.bReceiveShadow);
 	}
 
 	//TODO: Fix this
@@ -116,14 +161,19 @@ CStaticMesh::Draw()
 		{
 			//We cannot use this here as it bogs the engine draw logic down with map/unmap which technically shouldn't even work
 			//if(m_pInstancer) m_pInstancer->AddToBatch(this);
-			if(!m_pInstancer) m_pMesh->Draw(&m_matWorld);
+			if(!m_pInstancer)
+			{
+				m_uiLod = SelectLodAt(m_pMesh, m_matWorld, m_uiLod);
+				DrawCulled(m_pMesh, &m_matWorld, m_uiLod, m_pModel->GetMeshMaterial(m_iMeshID));
+			}
 		}
 		else
 		{
 			//Render instances rather than individual meshes
 			for(unsigned int i = 0; i < m_pModel->GetInstanceCount(); ++i)
 			{
-				IMesh* pMesh = m_pModel->GetMeshObject(m_pModel->GetInstance(i).uiMeshID);
+				unsigned int uiMeshID = m_pModel->GetInstance(i).uiMeshID;
+				IMesh* pMesh = m_pModel->GetMeshObject(uiMeshID);
 
 				float4x4 matObject = m_pModel->GetInstance(i).matObject;
 				XMMATRIX xmmatObject = XMLoadFloat4x4(&matObject);
@@ -138,23 +188,22 @@ CStaticMesh::Draw()
 				//		and by doing this, the code here will be stupid to account for multiple instancers, one per mesh
 				//		unless we adjust the instancer such that we can draw 0,n for one mesh, then n through y for another mesh
 				//		Doing that would require sorting and a lookup
-				pMesh->Draw(&matWorld);
+				if(i < m_vecInstanceLods.size()) m_vecInstanceLods[i] = SelectLodAt(pMesh, matWorld, m_vecInstanceLods[i]);
+				DrawCulled(pMesh, &matWorld, i < m_vecInstanceLods.size() ? m_vecInstanceLods[i] : 0, m_pModel->GetMeshMaterial(uiMeshID));
 			}
 		}
 	}
 }
 
 int
-CStaticMesh::GetTriangleCount() const
+CStaticMesh::GetTriangleCount(bool _bFullDetail) const
 {
 	int iTriangles = 0;
 
 	//If we're a specific mesh of the model
 	if(m_pMesh)
 	{
-		int iVertices = m_pMesh->GetVertexCount();
-		int iIndices = m_pMesh->GetIndexCount();
-		iTriangles = (iIndices > 0 ? iIndices : iVertices) / 3;
+		iTriangles = m_pMesh->GetLod(_bFullDetail ? 0 : m_uiLod).uiIndexCount / 3;
 	}
 	else
 	{
@@ -163,9 +212,8 @@ CStaticMesh::GetTriangleCount() const
 		for(unsigned int i = 0; i < m_pModel->GetInstanceCount(); ++i)
 		{
 			int iMeshID = m_pModel->GetInstance(i).uiMeshID;
-			int iVertices = m_pModel->GetMeshObject(iMeshID)->GetVertexCount();
-			int iIndices = m_pModel->GetMeshObject(iMeshID)->GetIndexCount();
-			iTriangles += (iIndices > 0 ? iIndices : iVertices) / 3;
+			unsigned int uiLod = (_bFullDetail || i >= m_vecInstanceLods.size()) ? 0 : m_vecInstanceLods[i];
+			iTriangles += m_pModel->GetMeshObject(iMeshID)->GetLod(uiLod).uiIndexCount / 3;
 		}
 	}
 
@@ -176,3 +224,28 @@ int CStaticMesh::GetMeshID() const
 {
 	return(m_iMeshID);
 }
+
+unsigned int
+CStaticMesh::SelectLod(const IMesh* _pMesh, const DirectX::BoundingSphere& _rtWorldSphere, float _fWorldScale, unsigned int _uiCurrentLod)
+{
+	unsigned int uiLodCount = _pMesh ? _pMesh->GetLodCount() : 1;
+	_uiCurrentLod = min(_uiCurrentLod, uiLodCount - 1);
+
+	//Shadow and other orthogonal views reuse whatever the scene camera picked
+	CCamera* pCamera = CCamera::GetActiveCamera();
+	if(uiLodCount <= 1 || !pCamera || pCamera->IsOrthogonal() || _fWorldScale <= 0.0f) return(_uiCurrentLod);
+
+	//Screen pixels per world unit at the nearest point of the bounds
+	float fPixelsPerUnit = pCamera->GetPixelsPerUnit(_rtWorldSphere);
+
+	//Errors grow with each level, so the first one over its limit ends the search
+	unsigned int uiLod = 0;
+	for(unsigned int i = 1; i < uiLodCount; ++i)
+	{
+		float fLimit = STATIC_MESH_LOD_PIXEL_ERROR * (i <= _uiCurrentLod ? 1.0f + STATIC_MESH_LOD_HYSTERESIS : 1.0f - STATIC_MESH_LOD_HYSTERESIS);
+		if(_pMesh->GetLod(i).fError * _fWorldScale * fPixelsPerUnit > fLimit) break;
+		uiLod = i;
+	}
+
+	return(uiLod);
+}
@@ -2,8 +2,16 @@
 #ifndef __STATIC_MESH_H__
 #define __STATIC_MESH_H__
 
+//Library Includes
+#include <vector>
+
 //Local Includes
 #include "entity3d.h"
+#include "assetref.hpp"
+
+//Types
+#define STATIC_MESH_LOD_PIXEL_ERROR 1.0f //A level is used while its error covers no more than this many pixels on screen
+#define STATIC_MESH_LOD_HYSTERESIS 0.25f //Coarser levels need this much less error to switch to, the current one keeps up to this much more
 
 //Prototype
 class IMesh;
@@ -21,17 +29,23 @@ public:
 	//If m_pInstancer, draw will silently fail as the Instancer will handle the drawing of this mesh
 	virtual void Draw();
 
-	//Just for debug purposes
-	virtual int GetTriangleCount() const;
+	//Just for debug purposes, triangles at the levels of detail drawn last unless _bFullDetail
+	virtual int GetTriangleCount(bool _bFullDetail = false) const;
 	virtual int GetMeshID() const;
 
+	//Coarsest level of _pMesh whose error stays under STATIC_MESH_LOD_PIXEL_ERROR at the active camera, _uiCurrentLod is kept
+	//without a perspective camera. _fWorldScale takes the mesh's object space error to world units
+	static unsigned int SelectLod(const IMesh* _pMesh, const DirectX::BoundingSphere& _rtWorldSphere, float _fWorldScale, unsigned int _uiCurrentLod);
+
 	//Member Variables
 protected:
 	CStaticMeshInstancer* m_pInstancer; //Instancer, if valid then Draw() only adds to the instancer batch
-	CModel* m_pModel; //Main model for this static mesh, this should be a shared_pointer
+	CAssetRef<CModel> m_pModel; //Main model for this static mesh, keeps it from being evicted
 	IMesh* m_pMesh; //Obtained from pModel if Init(model, !0)
 	int m_iMeshID;
 	bool m_bVisible;
+	unsigned int m_uiLod; //Level m_pMesh was last drawn at
+	std::vector<unsigned int> m_vecInstanceLods; //Level each model instance was last drawn at, when we are the whole model
 
 	friend CStaticMeshInstancer;
 
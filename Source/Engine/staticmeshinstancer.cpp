@@ -1,15 +1,31 @@
 //Local Includes
 #include "instancepool.hpp"
 #include "staticmesh.h"
+#include "model.h"
 #include "mesh.hpp"
+#include "camera.h"
+#include "assetmanager.hpp"
 
 //This Include
 #include "staticmeshinstancer.h"
 
+//Helpers
+//Reference mesh's bounds placed as _rtInstance, _fScale being its largest scale axis
+static BoundingSphere GetInstanceSphere(const BoundingSphere& _rtMeshSphere, const TStaticMeshInstance& _rtInstance, float _fScale)
+{
+	BoundingSphere tSphere;
+	XMVECTOR vecCenter = XMVector3Rotate(XMVectorScale(XMLoadFloat3(&_rtMeshSphere.Center), _fScale), XMLoadFloat4(&_rtInstance.rot)) + XMLoadFloat3(&_rtInstance.pos);
+	XMStoreFloat3(&tSphere.Center, vecCenter);
+	tSphere.Radius = _rtMeshSphere.Radius * _fScale;
+
+	return(tSphere);
+}
+
 //Implementation
 CStaticMeshInstancer::CStaticMeshInstancer()
 	: m_pInstancePool(nullptr)
 	, m_pReferenceMesh(nullptr)
+	, m_bRebuildBatch(false)
 {
 	//Constructor
 }
@@ -35,6 +51,12 @@ CStaticMeshInstancer::Initialize(CRenderer* _pRenderer, unsigned int _uiMaxInsta
 bool
 CStaticMeshInstancer::ReadyBatch(bool _bAppendToLastFrame)
 {
+	if(!_bAppendToLastFrame)
+	{
+		m_vecInstances.clear();
+		m_vecInstanceLods.clear();
+		for(TRange<unsigned int>& rtRange : m_ptLodRanges) rtRange = {0, 0};
+	}
 	return(m_pInstancePool != nullptr && m_pInstancePool->Unlock(!_bAppendToLastFrame));
 }
 
@@ -58,6 +80,13 @@ CStaticMeshInstancer::AddToBatch(CStaticMesh* _pMesh)
 		tInstanceData.rot = vec4Quat;
 
 		bSuccess = m_pInstancePool->AppendInstances(&tInstanceData, 1);
+		if(bSuccess)
+		{
+			//Appended after every level, so the next draw regroups the pool
+			m_vecInstances.push_back(tInstanceData);
+			m_vecInstanceLods.push_back(0);
+			m_bRebuildBatch = true;
+		}
 	}
 
 	return(bSuccess);
@@ -76,8 +105,163 @@ CStaticMeshInstancer::DrawBatch()
 
 	if(m_pInstancePool && m_pReferenceMesh && m_pReferenceMesh->m_pMesh)
 	{
-		m_pReferenceMesh->m_pMesh->DrawInstanced(m_pInstancePool, {0, m_pInstancePool->GetValid()});
+		//A failed rebuild is tried again next draw
+		if(SelectLods() || m_bRebuildBatch) m_bRebuildBatch = !RebuildBatch();
+
+		IMesh* pMesh = m_pReferenceMesh->m_pMesh;
+		if(m_bRebuildBatch)
+		{
+			//Not grouped yet, everything at full detail
+			pMesh->DrawInstanced(m_pInstancePool, {0, m_pInstancePool->GetValid()}, nullptr, 0, &GetMaterial());
+		}
+		else
+		{
+			for(unsigned int i = 0; i < MESH_MAX_LODS; ++i)
+			{
+				//A few close instances gain more from culling than they lose drawing one at a time
+				if(i == 0 && m_ptLodRanges[i].b <= STATIC_MESH_INSTANCER_CULL_LIMIT && DrawCulledInstances()) continue;
+				if(m_ptLodRanges[i].b) pMesh->DrawInstanced(m_pInstancePool, m_ptLodRanges[i], nullptr, i, &GetMaterial());
+			}
+		}
+
+		RequestTextureMips();
 	}
 
 	return(false);
 }
+
+unsigned int
+CStaticMeshInstancer::GetTriangleCount(bool _bFullDetail) const
+{
+	if(!m_pReferenceMesh || !m_pReferenceMesh->m_pMesh) return(0);
+
+	IMesh* pMesh = m_pReferenceMesh->m_pMesh;
+	if(_bFullDetail) return((unsigned int)m_vecInstances.size() * (pMesh->GetLod(0).uiIndexCount / 3));
+
+	unsigned int uiTriangles = 0;
+	for(unsigned int i = 0; i < MESH_MAX_LODS; ++i) uiTriangles += m_ptLodRanges[i].b * (pMesh->GetLod(i).uiIndexCount / 3);
+
+	return(uiTriangles);
+}
+
+bool
+CStaticMeshInstancer::SelectLods()
+{
+	IMesh* pMesh = m_pReferenceMesh->m_pMesh;
+	if(pMesh->GetLodCount() <= 1) return(false);
+
+	const BoundingSphere& rtMeshSphere = pMesh->GetBoundingSphere();
+	bool bChanged = false;
+
+	for(unsigned int i = 0; i < m_vecInstances.size(); ++i)
+	{
+		const TStaticMeshInstance& rtInstance = m_vecInstances[i];
+		float fScale = max(max(rtInstance.scale.x, rtInstance.scale.y), rtInstance.scale.z);
+
+		unsigned int uiLod = CStaticMesh::SelectLod(pMesh, GetInstanceSphere(rtMeshSphere, rtInstance, fScale), fScale, m_vecInstanceLods[i]);
+		bChanged |= uiLod != m_vecInstanceLods[i];
+		m_vecInstanceLods[i] = uiLod;
+	}
+
+	return(bChanged);
+}
+
+bool
+CStaticMeshInstancer::RebuildBatch()
+{
+	//Instances in level order, each level one contiguous range
+	std::vector<TStaticMeshInstance> vecGrouped;
+	vecGrouped.reserve(m_vecInstances.size());
+
+	TRange<unsigned int> ptRanges[MESH_MAX_LODS];
+	for(unsigned int uiLod = 0; uiLod < MESH_MAX_LODS; ++uiLod)
+	{
+		ptRanges[uiLod].a = (unsigned int)vecGrouped.size();
+		for(unsigned int i = 0; i < m_vecInstances.size(); ++i)
+		{
+			if(m_vecInstanceLods[i] == uiLod) vecGrouped.push_back(m_vecInstances[i]);
+		}
+		ptRanges[uiLod].b = (unsigned int)vecGrouped.size() - ptRanges[uiLod].a;
+	}
+
+	if(!m_pInstancePool->Unlock(true)) return(false);
+
+	bool bSuccess = vecGrouped.empty() || m_pInstancePool->AppendInstances(vecGrouped.data(), (unsigned int)vecGrouped.size());
+	bSuccess = m_pInstancePool->Lock() && bSuccess;
+	if(bSuccess) memcpy(m_ptLodRanges, ptRanges, sizeof(ptRanges));
+
+	return(bSuccess);
+}
+
+bool
+CStaticMeshInstancer::DrawCulledInstances()
+{
+	IMesh* pMesh = m_pReferenceMesh->m_pMesh;
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	if(!pRenderer || !pRenderer->GetClusterCuller().CanCull(pMesh)) return(false);
+
+	//The pool holds LOD 0's instances first, in the order they sit in m_vecInstances
+	unsigned int uiSlot = m_ptLodRanges[0].a;
+	for(unsigned int i = 0; i < m_vecInstances.size(); ++i)
+	{
+		if(m_vecInstanceLods[i] != 0) continue;
+
+		//Same placement as the instanced vertex shader, scale then rotate then translate
+		const TStaticMeshInstance& rtInstance = m_vecInstances[i];
+		float4x4 matWorld;
+		XMStoreFloat4x4(&matWorld, XMMatrixScaling(rtInstance.scale.x, rtInstance.scale.y, rtInstance.scale.z)
+			* XMMatrixRotationQuaternion(XMLoadFloat4(&rtInstance.rot)) * XMMatrixTranslation(rtInstance.pos.x, rtInstance.pos.y, rtInstance.pos.z));
+
+		if(pRenderer->GetClusterCuller().Cull(pMesh, matWorld, m_vecClusterRanges))
+		{
+			pMesh->DrawInstancedRanges(m_pInstancePool, {uiSlot, 1}, m_vecClusterRanges.data(), (unsigned int)m_vecClusterRanges.size(), nullptr, &GetMaterial());
+		}
+		else
+		{
+			pMesh->DrawInstanced(m_pInstancePool, {uiSlot, 1}, nullptr, 0, &GetMaterial());
+		}
+		++uiSlot;
+	}
+
+	return(true);
+}
+
+void
+CStaticMeshInstancer::RequestTextureMips()
+{
+	CCamera* pCamera = CCamera::GetActiveCamera();
+	if(!pCamera || m_vecInstances.empty()) return;
+
+	//Every instance shares the material, so only the one needing the most detail matters
+	//Mip falls with distance over scale, so that is what's compared
+	const BoundingSphere& rtMeshSphere = m_pReferenceMesh->m_pMesh->GetBoundingSphere();
+	float3 vec3Eye = pCamera->GetEyePos();
+	XMVECTOR vecEye = XMLoadFloat3(&vec3Eye);
+	BoundingSphere tNearestSphere;
+	float fNearestScale = 0.0f;
+	float fNearestRatio = FLT_MAX;
+
+	for(const TStaticMeshInstance& rtInstance : m_vecInstances)
+	{
+		float fScale = max(max(rtInstance.scale.x, rtInstance.scale.y), rtInstance.scale.z);
+		if(fScale <= 0.0f) continue;
+
+		BoundingSphere tSphere = GetInstanceSphere(rtMeshSphere, rtInstance, fScale);
+		float fRatio = (XMVectorGetX(XMVector3Length(XMLoadFloat3(&tSphere.Center) - vecEye)) - tSphere.Radius) / fScale;
+
+		if(fRatio < fNearestRatio)
+		{
+			tNearestSphere = tSphere;
+			fNearestScale = fScale;
+			fNearestRatio = fRatio;
+		}
+	}
+
+	if(fNearestScale > 0.0f) CAssetManager::GetInstance().GetTextureStreamer().RequestMesh(m_pReferenceMesh->m_pMesh, GetMaterial(), tNearestSphere, fNearestScale);
+}
+
+const TMaterial&
+CStaticMeshInstancer::GetMaterial() const
+{
+	return(m_pReferenceMesh->m_pModel->GetMeshMaterial(m_pReferenceMesh->m_iMeshID));
+}
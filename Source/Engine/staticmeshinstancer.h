@@ -2,10 +2,16 @@
 #ifndef __STATIC_MESH_INSTANCER_H__
 #define __STATIC_MESH_INSTANCER_H__
 
+//Library Includes
+#include <vector>
+
 //Local Include
 #include "instancepool.hpp"
+#include "imesh.h"
 
 //Types
+#define STATIC_MESH_INSTANCER_CULL_LIMIT 4 //Full detail instances up to this many are drawn one by one with their clusters culled
+
 struct TStaticMeshInstance
 {
 	float3 pos;
@@ -32,14 +38,28 @@ public:
 	bool ReadyBatch(bool _bAppendToLastFrame = false); //Unlocks instance buffer, if _keeplast then copy last frame (instancepool supports this natively)
 	bool AddToBatch(CStaticMesh* _pMesh); //Adds a mesh to the instance pool in append mode, may start at 0 if readybatch(false)
 	void FinishBatch(); //Close batch
-	bool DrawBatch(); //Closes? batch and draws
+	bool DrawBatch(); //Closes? batch and draws, one draw per level of detail in use
+
+	//Triangles submitted by the last DrawBatch(), or with every instance at LOD 0 if _bFullDetail
+	unsigned int GetTriangleCount(bool _bFullDetail = false) const;
 
+private:
+	void RequestTextureMips(); //Texture streaming request for the instance needing the most detail
+	bool SelectLods(); //Picks every instance's level at the active camera, true if any changed
+	bool RebuildBatch(); //Rewrites the pool grouped by level, the ranges follow
+	bool DrawCulledInstances(); //LOD 0 instances one at a time with their clusters culled, false if the mesh can't be culled
+	const TMaterial& GetMaterial() const; //Reference mesh's material as its model sets it, the mesh may be shared between models
 
 
 	//Member Variables
 protected:
 	CInstancePool<TStaticMeshInstance>* m_pInstancePool;
 	CStaticMesh* m_pReferenceMesh;
+	std::vector<TStaticMeshInstance> m_vecInstances; //CPU copy of the batch, the nearest instance requests texture mips
+	std::vector<unsigned int> m_vecInstanceLods; //Level of each instance in m_vecInstances
+	TRange<unsigned int> m_ptLodRanges[MESH_MAX_LODS]; //Start and count of each level's instances in the pool
+	std::vector<TRange<unsigned int>> m_vecClusterRanges; //Scratch for DrawCulledInstances(), kept to save reallocating every draw
+	bool m_bRebuildBatch; //Pool order no longer matches the ranges, set when instances are added
 
 };
 
@@ -1,15 +1,102 @@
+//Library Includes
+#include <vector>
+#include <string>
+#include <chrono>
+#include <utility>
+
 //Local Includes
 #include "wichelper.h"
 #include "assetmanager.hpp"
+#include "mappedfile.h"
+#include "cookedtexture.h"
+#include "blockcompress.h"
+#include "loadtelemetry.h"
+#include "logmanager.h"
 
 //This Include
 #include "texture.h"
 
+//Static Variables
+bool CTexture::sm_bUseCooked = true;
+bool CTexture::sm_bHighQualityCook = false;
+
+EMipFilter CTexture::sm_eMipFilter = MIP_FILTER_KAISER;
+bool CTexture::sm_bStreamed = true;
+
+static const unsigned int s_kuiStreamTailSize = 64; //Largest side of the mip a streamed texture starts from
+
+//Helpers
+//Normal maps are found by name, they are filtered as linear data and cooked to two channels
+static bool IsNormalMapName(const char* _kpcFilename)
+{
+	std::string strName = _kpcFilename ? _kpcFilename : "";
+	for (char& c : strName) c = (char)tolower(c);
+
+	return(strName.find("normal") != std::string::npos);
+}
+
+//Mostly fully opaque or fully clear texels, i.e. alpha tested foliage and fences rather than blended glass
+static bool IsAlphaCutout(const TImageData& _rtImage)
+{
+	size_t uiPartial = 0;
+	size_t uiClear = 0;
+	for (unsigned int i = 3; i < _rtImage.uiSlicePitch; i += 4)
+	{
+		uint8_t ucAlpha = _rtImage.pPixelData[i];
+		if (ucAlpha < 16) ++uiClear;
+		else if (ucAlpha < 240) ++uiPartial;
+	}
+
+	size_t uiTexels = _rtImage.uiSlicePitch / 4;
+	return(uiClear > 0 && uiPartial * 10 < uiTexels);
+}
+
+//Drops pixels still queued for a texture about to be released
+static void CancelUpload(ID3D11Texture2D* _pTexture)
+{
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	if (_pTexture && pRenderer) pRenderer->GetUploadQueue().Cancel(_pTexture);
+}
+
+//First mip at or under the tail size. Block compressed textures stop early as their top level has to be whole blocks
+static unsigned int GetTailMip(const TCookedTextureHeader& _rtHeader)
+{
+	bool bCompressed = IsBlockCompressed((DXGI_FORMAT)_rtHeader.uiFormat);
+	unsigned int uiTail = 0;
+
+	while (uiTail + 1 < _rtHeader.uiMipLevels && max(_rtHeader.uiWidth >> uiTail, _rtHeader.uiHeight >> uiTail) > s_kuiStreamTailSize)
+	{
+		unsigned int uiWidth = max(1u, _rtHeader.uiWidth >> (uiTail + 1));
+		unsigned int uiHeight = max(1u, _rtHeader.uiHeight >> (uiTail + 1));
+		if (bCompressed && (uiWidth % 4 || uiHeight % 4)) break;
+
+		++uiTail;
+	}
+
+	return(uiTail);
+}
+
 //Implementation
 CTexture::CTexture()
 	: m_pTexture(nullptr)
 	, m_pSRView(nullptr)
 	, m_bIsTextureArray(false)
+	, m_uiGPUBytes(0)
+	, m_ullUploadFence(0)
+	, m_pStreamFile(nullptr)
+	, m_uiWidth(0)
+	, m_uiHeight(0)
+	, m_uiMipLevels(0)
+	, m_uiTailMip(0)
+	, tm_uiResidentMip(0)
+	, tm_uiRequestedMip(0)
+	, tm_bStreaming(false)
+	, m_bPendingReady(false)
+	, m_pPendingTexture(nullptr)
+	, m_pPendingSRV(nullptr)
+	, m_uiPendingMip(0)
+	, m_uiPendingBytes(0)
+	, m_ullPendingFence(0)
 {
 	//Constructor
 }
@@ -22,23 +109,105 @@ CTexture::~CTexture()
 ID3D11ShaderResourceView*
 CTexture::GetSRV() const
 {
+	//Not ready until the pixels are on the GPU
+	if (!CAssetManager::GetInstance().GetRenderer()->GetUploadQueue().IsComplete(m_ullUploadFence)) return(nullptr);
+
 	return(m_pSRView);
 }
 
+size_t
+CTexture::GetCPUBytes() const
+{
+	//Only a stream source decompressed out of a pak, a mapped one is backed by the file
+	return(m_pStreamFile ? m_pStreamFile->GetHeapBytes() : 0);
+}
+
+size_t
+CTexture::GetGPUBytes() const
+{
+	return(m_uiGPUBytes);
+}
+
+void
+CTexture::GetMemoryUsage(TAssetMemory& _rtMemory) const
+{
+	IAsset::GetMemoryUsage(_rtMemory);
+
+	//Every subresource is copied into the upload queue, the chain is staged in full until its fence completes
+	if (!CAssetManager::GetInstance().GetRenderer()->GetUploadQueue().IsComplete(m_ullUploadFence))
+	{
+		_rtMemory.puiBytes[MEMORY_HEAP_CPU_STAGING] = m_uiGPUBytes;
+	}
+}
+
 EAssetType
 CTexture::GetAssetType()
 {
 	return(ASSET_TEXTURE);
 }
 
+void
+CTexture::SetUseCooked(bool _bUseCooked)
+{
+	sm_bUseCooked = _bUseCooked;
+}
+
+void
+CTexture::SetHighQualityCook(bool _bHighQuality)
+{
+	sm_bHighQualityCook = _bHighQuality;
+}
+
+void
+CTexture::SetMipFilter(EMipFilter _eFilter)
+{
+	sm_eMipFilter = _eFilter;
+}
+
+void
+CTexture::SetStreamed(bool _bStreamed)
+{
+	sm_bStreamed = _bStreamed;
+}
+
+bool
+CTexture::Cook(const char* _kpcSourceFile, const char* _kpcCookedFile)
+{
+	//An old cook left behind would look like success
+	remove(_kpcCookedFile);
+
+	CTexture texture;
+	bool bCooked = texture.CookImage(_kpcSourceFile, _kpcCookedFile);
+	texture.Release();
+
+	return(bCooked && CMappedFile::GetWriteTime(_kpcCookedFile) != 0);
+}
+
 bool
 CTexture::Load(const char* _kpcFilename)
 {
 	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	auto tStart = std::chrono::steady_clock::now();
+
+	//Cooked files can be loaded directly, anything else looks for a cook next to the source
+	std::string strCooked = _kpcFilename;
+	size_t uiExtLength = strlen(COOKED_TEXTURE_EXTENSION);
+	bool bIsCooked = strCooked.size() > uiExtLength && _stricmp(strCooked.c_str() + strCooked.size() - uiExtLength, COOKED_TEXTURE_EXTENSION) == 0;
+	if (!bIsCooked) strCooked += COOKED_TEXTURE_EXTENSION;
 
-	if (pRenderer)
+	bool bFromCook = pRenderer && (sm_bUseCooked || bIsCooked) && LoadCooked(strCooked.c_str(), bIsCooked ? nullptr : _kpcFilename);
+
+	//Missing, stale or unsupported cook, decode the source and cook it for next time
+	if (pRenderer && !bFromCook && !bIsCooked && sm_bUseCooked)
 	{
-		TImageData pTempImage = LoadImageFromFile(_kpcFilename);
+		CookImage(_kpcFilename, strCooked.c_str());
+	}
+	else if (pRenderer && !bFromCook && !bIsCooked)
+	{
+		auto tDecodeStart = std::chrono::steady_clock::now();
+		TImageData pTempImage = LoadImageFromFile(_kpcFilename, true);
+		CLoadTelemetry::AddBytesIn((size_t)CMappedFile::GetFileBytes(_kpcFilename));
+		CLoadTelemetry::AddStage(LOAD_STAGE_DECODE, tDecodeStart);
 
 		if (pTempImage.pPixelData != nullptr)
 		{
@@ -55,6 +224,13 @@ CTexture::Load(const char* _kpcFilename)
 		}
 	}
 
+	//Load times, compare with SetUseCooked(false) to see the decode cost
+	char pcStats[512];
+	double dElapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tStart).count();
+	sprintf_s(pcStats, "Texture %s from %s in %.2fms (%zu bytes): %s\n", m_pTexture ? "loaded" : "failed to load",
+		bFromCook ? "cook" : (sm_bUseCooked ? "WIC + cook" : "WIC"), dElapsedMs, m_uiGPUBytes, _kpcFilename);
+	CLogManager::GetInstance().WriteDebug(pcStats, "Texture");
+
 	//Return true if texture was valid
 	return(m_pTexture != nullptr);
 }
@@ -62,27 +238,83 @@ CTexture::Load(const char* _kpcFilename)
 void
 CTexture::Release()
 {
+	//Nothing can be streaming, the job holds a reference that keeps us from being released
+	if (m_pStreamFile) CAssetManager::GetInstance().GetTextureStreamer().RemoveTexture(this);
+	SafeDelete(m_pStreamFile);
+
+	m_mutexPending.lock();
+	CancelUpload(m_pPendingTexture);
+	ReleaseCOM(m_pPendingTexture);
+	ReleaseCOM(m_pPendingSRV);
+	m_bPendingReady = false;
+	m_mutexPending.unlock();
+	tm_bStreaming = false;
+
+	CancelUpload(m_pTexture);
 	if (m_pTexture) m_pTexture->Release();
 	if (m_pSRView) m_pSRView->Release();
 	m_pTexture = nullptr;
 	m_pSRView = nullptr;
+	m_uiGPUBytes = 0;
+	m_ullUploadFence = 0;
+}
+
+IAsset*
+CTexture::CreateReloadTarget() const
+{
+	return(new CTexture());
+}
+
+bool
+CTexture::SwapReloaded(IAsset* _pReloaded)
+{
+	CTexture* pReloaded = static_cast<CTexture*>(_pReloaded);
+	CTextureStreamer& rStreamer = CAssetManager::GetInstance().GetTextureStreamer();
+
+	//Keep drawing the old pixels until the new ones are up, and let a streaming job finish with the old file first
+	if (tm_bStreaming || pReloaded->tm_bStreaming || !CAssetManager::GetInstance().GetRenderer()->GetUploadQueue().IsComplete(pReloaded->m_ullUploadFence)) return(false);
+
+	//The streamer tracks textures by pointer, both come off and this goes back on if the new one streams
+	if (m_pStreamFile) rStreamer.RemoveTexture(this);
+	if (pReloaded->m_pStreamFile) rStreamer.RemoveTexture(pReloaded);
+
+	std::swap(m_pTexture, pReloaded->m_pTexture);
+	std::swap(m_pSRView, pReloaded->m_pSRView);
+	std::swap(m_bIsTextureArray, pReloaded->m_bIsTextureArray);
+	std::swap(m_uiGPUBytes, pReloaded->m_uiGPUBytes);
+	std::swap(m_ullUploadFence, pReloaded->m_ullUploadFence);
+	std::swap(m_pStreamFile, pReloaded->m_pStreamFile);
+	std::swap(m_uiWidth, pReloaded->m_uiWidth);
+	std::swap(m_uiHeight, pReloaded->m_uiHeight);
+	std::swap(m_uiMipLevels, pReloaded->m_uiMipLevels);
+	std::swap(m_uiTailMip, pReloaded->m_uiTailMip);
+	tm_uiResidentMip = pReloaded->tm_uiResidentMip.exchange(tm_uiResidentMip);
+	tm_uiRequestedMip = m_uiTailMip;
+
+	if (m_pStreamFile) rStreamer.AddTexture(this);
+
+	//The old resources are freed with pReloaded, without it trying to unregister from the streamer
+	SafeDelete(pReloaded->m_pStreamFile);
+
+	return(true);
 }
 
 void
 CTexture::CreateTextureArray(TImageData* _lptImages, int _iImageCount)
 {
-	HRESULT hr = S_OK;
-	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
 	m_bIsTextureArray = true;
 
-	//Acquire a lock so we can allocate assets
-	pRenderer->GetGPUMutex().lock();
+	//Full chains when every slice is RGBA8 of the same size, otherwise just the top level
+	auto tStageStart = std::chrono::steady_clock::now();
+	std::vector<std::vector<uint8_t>> vecLevels;
+	bool bHasMips = GenerateMips(GetName(), _lptImages, _iImageCount, vecLevels);
+	CLoadTelemetry::AddStage(LOAD_STAGE_CONVERT, tStageStart);
 
 	//Texture description
 	D3D11_TEXTURE2D_DESC desc;
 	desc.Width = _lptImages[0].uiWidth;
 	desc.Height = _lptImages[0].uiHeight;
-	desc.MipLevels = 1;
+	desc.MipLevels = bHasMips ? GetMipLevelCount(desc.Width, desc.Height) : 1;
 	desc.ArraySize = _iImageCount;
 	desc.Format = _lptImages[0].eFormat;
 	desc.SampleDesc.Count = 1;
@@ -93,46 +325,81 @@ CTexture::CreateTextureArray(TImageData* _lptImages, int _iImageCount)
 	desc.MiscFlags = 0;
 
 	//Allocate intial data buffer
-	D3D11_SUBRESOURCE_DATA* initData = new D3D11_SUBRESOURCE_DATA[desc.ArraySize];
+	D3D11_SUBRESOURCE_DATA* initData = new D3D11_SUBRESOURCE_DATA[desc.ArraySize * desc.MipLevels];
 
 	//For each image provided, prep subresource data.
-	for (unsigned int i = 0; i < desc.ArraySize; ++i)
+	for (unsigned int i = 0; i < desc.ArraySize * desc.MipLevels; ++i)
+	{
+		if (bHasMips)
+		{
+			unsigned int uiWidth = max(1u, desc.Width >> (i % desc.MipLevels));
+			initData[i].pSysMem = vecLevels[i].data();
+			initData[i].SysMemPitch = uiWidth * 4;
+			initData[i].SysMemSlicePitch = (UINT)vecLevels[i].size();
+		}
+		else
+		{
+			initData[i].pSysMem = _lptImages[i].pPixelData;
+			initData[i].SysMemPitch = _lptImages[i].uiRowPitch;
+			initData[i].SysMemSlicePitch = _lptImages[i].uiSlicePitch;
+		}
+	}
+
+	tStageStart = std::chrono::steady_clock::now();
+	CreateTexture(desc, initData, &m_pTexture, &m_pSRView, &m_uiGPUBytes, &m_ullUploadFence);
+	CLoadTelemetry::AddStage(LOAD_STAGE_UPLOAD, tStageStart);
+
+	//Delete temp data
+	if (initData)
 	{
-		initData[i].pSysMem = _lptImages[i].pPixelData;
-		initData[i].SysMemPitch = _lptImages[i].uiRowPitch;
-		initData[i].SysMemSlicePitch = _lptImages[i].uiSlicePitch;
+		delete[] initData;
+		initData = nullptr;
 	}
+}
+
+bool
+CTexture::CreateTexture(const D3D11_TEXTURE2D_DESC& _rtDesc, const D3D11_SUBRESOURCE_DATA* _ptInitialData, ID3D11Texture2D** _ppTexture, ID3D11ShaderResourceView** _ppSRV, size_t* _puiBytes, unsigned long long* _pullUploadFence) const
+{
+	HRESULT hr = S_OK;
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
 
-	//Attempt to create the texture
-	hr = pRenderer->GetDevice()->CreateTexture2D(&desc, initData, &m_pTexture);
+	//Attempt to create the texture, the pixels are queued and go up between frames
+	hr = pRenderer->CreateTexture2D(&_rtDesc, _ptInitialData, _ppTexture, _pullUploadFence) ? S_OK : E_FAIL;
 
 	if (SUCCEEDED(hr))
 	{
 		D3D11_SHADER_RESOURCE_VIEW_DESC SRVDesc;
 		ZeroMemory(&SRVDesc, sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC));
-		SRVDesc.Format = desc.Format;
+		SRVDesc.Format = _rtDesc.Format;
 
 		//Only difference for loading into a texture array
-		if (desc.ArraySize > 1)
+		if (_rtDesc.ArraySize > 1)
 		{
 			SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
-			SRVDesc.Texture2DArray.ArraySize = desc.ArraySize;
-			SRVDesc.Texture2DArray.MipLevels = 1;
+			SRVDesc.Texture2DArray.ArraySize = _rtDesc.ArraySize;
+			SRVDesc.Texture2DArray.MipLevels = _rtDesc.MipLevels;
 		}
 		else
 		{
 			SRVDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-			SRVDesc.Texture2D.MipLevels = 1;
+			SRVDesc.Texture2D.MipLevels = _rtDesc.MipLevels;
 		}
 
 		//Create the shader resource for the texture
-		hr = pRenderer->GetDevice()->CreateShaderResourceView(m_pTexture, &SRVDesc, &m_pSRView);
+		hr = pRenderer->CreateShaderResourceView(*_ppTexture, &SRVDesc, _ppSRV) ? S_OK : E_FAIL;
 
 		if (FAILED(hr))
 		{
 			//Failed to create the shader resource
-			m_pTexture->Release();
-			m_pTexture = nullptr;
+			CancelUpload(*_ppTexture);
+			(*_ppTexture)->Release();
+			*_ppTexture = nullptr;
+		}
+		else
+		{
+			//Size for the asset manager budget
+			*_puiBytes = 0;
+			for (unsigned int i = 0; i < _rtDesc.ArraySize * _rtDesc.MipLevels; ++i) *_puiBytes += _ptInitialData[i].SysMemSlicePitch;
 		}
 	}
 	else
@@ -140,19 +407,359 @@ CTexture::CreateTextureArray(TImageData* _lptImages, int _iImageCount)
 		//No texture created
 	}
 
-	//Delete temp data
-	if (initData)
+	return(*_ppTexture != nullptr);
+}
+
+bool
+CTexture::LoadCooked(const char* _kpcCookedFile, const char* _kpcSourceFile)
+{
+	auto tStageStart = std::chrono::steady_clock::now();
+
+	//Loose or from a mounted pak, a stored pak entry streams straight out of the pak's mapping
+	CMappedFile* pMappedFile = new CMappedFile();
+	if (!CAssetManager::GetInstance().OpenFile(_kpcCookedFile, *pMappedFile) || pMappedFile->GetSize() < sizeof(TCookedTextureHeader))
 	{
-		delete[] initData;
-		initData = nullptr;
+		delete pMappedFile;
+		return(false);
+	}
+	CLoadTelemetry::AddBytesIn(pMappedFile->GetSize());
+
+	//Stale if the source has changed since, a missing source is fine (shipped without it)
+	const TCookedTextureHeader* ptHeader = reinterpret_cast<const TCookedTextureHeader*>(pMappedFile->GetData());
+	unsigned long long ullSourceTime = CMappedFile::GetWriteTime(_kpcSourceFile);
+	if (ullSourceTime && ullSourceTime != ptHeader->ullSourceWriteTime)
+	{
+		delete pMappedFile;
+		return(false);
+	}
+
+	CLoadTelemetry::AddStage(LOAD_STAGE_READ, tStageStart);
+	tStageStart = std::chrono::steady_clock::now();
+
+	//Streamed textures start from the tail and keep the mapping to read the rest from
+	unsigned int uiFirstMip = (sm_bStreamed && ptHeader->uiArraySize == 1) ? GetTailMip(*ptHeader) : 0;
+	bool bCreated = CreateFromCooked(pMappedFile->GetData(), pMappedFile->GetSize(), uiFirstMip);
+	CLoadTelemetry::AddStage(LOAD_STAGE_UPLOAD, tStageStart);
+
+	if (bCreated && uiFirstMip > 0)
+	{
+		m_pStreamFile = pMappedFile;
+		m_uiWidth = ptHeader->uiWidth;
+		m_uiHeight = ptHeader->uiHeight;
+		m_uiMipLevels = ptHeader->uiMipLevels;
+		m_uiTailMip = uiFirstMip;
+		tm_uiResidentMip = uiFirstMip;
+		tm_uiRequestedMip = uiFirstMip;
+		CAssetManager::GetInstance().GetTextureStreamer().AddTexture(this);
+	}
+	else
+	{
+		//Everything is resident, the mapping only had to live until the texture was created
+		delete pMappedFile;
+	}
+
+	return(bCreated);
+}
+
+bool
+CTexture::CreateFromCooked(const BYTE* _pData, size_t _uiSize, unsigned int _uiFirstMip)
+{
+	D3D11_TEXTURE2D_DESC desc;
+	std::vector<D3D11_SUBRESOURCE_DATA> vecInitData;
+	if (!BuildCookedDesc(_pData, _uiSize, _uiFirstMip, desc, vecInitData)) return(false);
+
+	m_bIsTextureArray = (desc.ArraySize > 1);
+	return(CreateTexture(desc, vecInitData.data(), &m_pTexture, &m_pSRView, &m_uiGPUBytes, &m_ullUploadFence));
+}
+
+bool
+CTexture::BuildCookedDesc(const BYTE* _pData, size_t _uiSize, unsigned int _uiFirstMip, D3D11_TEXTURE2D_DESC& _rtDesc, std::vector<D3D11_SUBRESOURCE_DATA>& _rvecInitData) const
+{
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	const TCookedTextureHeader* ptHeader = reinterpret_cast<const TCookedTextureHeader*>(_pData);
+
+	//Reject anything that wasn't cooked by this build, has been cut short or the device can't sample
+	bool bValid = ptHeader->uiMagic == COOKED_TEXTURE_MAGIC
+		&& ptHeader->uiVersion == COOKED_TEXTURE_VERSION
+		&& ptHeader->ullFileSize == _uiSize
+		&& ptHeader->uiWidth && ptHeader->uiHeight && ptHeader->uiMipLevels && ptHeader->uiArraySize
+		&& _uiFirstMip < ptHeader->uiMipLevels
+		&& pRenderer->IsFormatSupported((DXGI_FORMAT)ptHeader->uiFormat, D3D11_FORMAT_SUPPORT_TEXTURE2D);
+
+	unsigned int uiSubresources = ptHeader->uiMipLevels * ptHeader->uiArraySize;
+	if (!bValid || sizeof(TCookedTextureHeader) + uiSubresources * sizeof(TCookedSubresource) > _uiSize) return(false);
+
+	//Skipping mips moves the top of the texture down the chain
+	_rtDesc.Width = max(1u, ptHeader->uiWidth >> _uiFirstMip);
+	_rtDesc.Height = max(1u, ptHeader->uiHeight >> _uiFirstMip);
+	_rtDesc.MipLevels = ptHeader->uiMipLevels - _uiFirstMip;
+	_rtDesc.ArraySize = ptHeader->uiArraySize;
+	_rtDesc.Format = (DXGI_FORMAT)ptHeader->uiFormat;
+	_rtDesc.SampleDesc.Count = 1;
+	_rtDesc.SampleDesc.Quality = 0;
+	_rtDesc.Usage = D3D11_USAGE_DEFAULT; //Not immutable, so the pixels go up through the upload queue's frame budget
+	_rtDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	_rtDesc.CPUAccessFlags = 0;
+	_rtDesc.MiscFlags = 0;
+
+	//Point the subresources straight at the blobs
+	const TCookedSubresource* ptSubresources = reinterpret_cast<const TCookedSubresource*>(_pData + sizeof(TCookedTextureHeader));
+	_rvecInitData.resize(_rtDesc.ArraySize * _rtDesc.MipLevels);
+	for (unsigned int i = 0; i < _rvecInitData.size(); ++i)
+	{
+		const TCookedSubresource& rtSource = ptSubresources[(i / _rtDesc.MipLevels) * ptHeader->uiMipLevels + _uiFirstMip + (i % _rtDesc.MipLevels)];
+		if (rtSource.ullOffset + rtSource.uiSlicePitch > _uiSize) return(false);
+
+		_rvecInitData[i].pSysMem = _pData + rtSource.ullOffset;
+		_rvecInitData[i].SysMemPitch = rtSource.uiRowPitch;
+		_rvecInitData[i].SysMemSlicePitch = rtSource.uiSlicePitch;
+	}
+
+	return(true);
+}
+
+DXGI_FORMAT
+CTexture::ChooseCookFormat(const char* _kpcFilename, const TImageData& _rtImage) const
+{
+	CRenderer* pRenderer = CAssetManager::GetInstance().GetRenderer();
+	DXGI_FORMAT eFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	//The top level of a block compressed texture has to be whole blocks
+	if (_rtImage.uiWidth % 4 == 0 && _rtImage.uiHeight % 4 == 0)
+	{
+		//Normal maps only need XY, the shader rebuilds Z
+		bool bHasAlpha = false;
+		for (unsigned int i = 3; i < _rtImage.uiSlicePitch && !bHasAlpha; i += 4) bHasAlpha = (_rtImage.pPixelData[i] != 255);
+
+		if (IsNormalMapName(_kpcFilename)) eFormat = DXGI_FORMAT_BC5_UNORM;
+		else if (sm_bHighQualityCook) eFormat = DXGI_FORMAT_BC7_UNORM;
+		else eFormat = bHasAlpha ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+	}
+
+	//Fall back to uncompressed on devices without the format
+	if (!pRenderer->IsFormatSupported(eFormat, D3D11_FORMAT_SUPPORT_TEXTURE2D)) eFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	return(eFormat);
+}
+
+bool
+CTexture::CookImage(const char* _kpcFilename, const char* _kpcCookedFile)
+{
+	auto tStageStart = std::chrono::steady_clock::now();
+	TImageData tImage = LoadImageFromFile(_kpcFilename, true);
+	CLoadTelemetry::AddBytesIn((size_t)CMappedFile::GetFileBytes(_kpcFilename));
+	CLoadTelemetry::AddStage(LOAD_STAGE_DECODE, tStageStart);
+	if (!tImage.pPixelData) return(false);
+
+	//Mips and block compression
+	tStageStart = std::chrono::steady_clock::now();
+
+	//Full chain down to 1x1
+	std::vector<std::vector<uint8_t>> vecMips;
+	if (!GenerateMips(_kpcFilename, &tImage, 1, vecMips))
+	{
+		tImage.Release();
+		return(false);
+	}
+
+	unsigned int uiMipLevels = (unsigned int)vecMips.size();
+
+	DXGI_FORMAT eFormat = ChooseCookFormat(_kpcFilename, tImage);
+	bool bCompressed = IsBlockCompressed(eFormat);
+
+	//Lay out the whole file in memory, it is both written out and uploaded from
+	size_t uiOffset = sizeof(TCookedTextureHeader) + uiMipLevels * sizeof(TCookedSubresource);
+	std::vector<TCookedSubresource> vecSubresources(uiMipLevels);
+	for (unsigned int i = 0; i < uiMipLevels; ++i)
+	{
+		unsigned int uiWidth = max(1u, tImage.uiWidth >> i);
+		unsigned int uiHeight = max(1u, tImage.uiHeight >> i);
+
+		uiOffset = (uiOffset + COOKED_TEXTURE_ALIGNMENT - 1) & ~(size_t)(COOKED_TEXTURE_ALIGNMENT - 1);
+		vecSubresources[i].ullOffset = uiOffset;
+		vecSubresources[i].uiRowPitch = bCompressed ? GetBlockRowPitch(eFormat, uiWidth) : uiWidth * 4;
+		vecSubresources[i].uiSlicePitch = bCompressed ? GetBlockImageSize(eFormat, uiWidth, uiHeight) : uiWidth * uiHeight * 4;
+		uiOffset += vecSubresources[i].uiSlicePitch;
+	}
+
+	std::vector<uint8_t> vecFile(uiOffset, 0);
+
+	TCookedTextureHeader* ptHeader = reinterpret_cast<TCookedTextureHeader*>(vecFile.data());
+	ptHeader->uiMagic = COOKED_TEXTURE_MAGIC;
+	ptHeader->uiVersion = COOKED_TEXTURE_VERSION;
+	ptHeader->uiFormat = eFormat;
+	ptHeader->uiWidth = tImage.uiWidth;
+	ptHeader->uiHeight = tImage.uiHeight;
+	ptHeader->uiMipLevels = uiMipLevels;
+	ptHeader->uiArraySize = 1;
+	ptHeader->ullSourceWriteTime = CMappedFile::GetWriteTime(_kpcFilename);
+	ptHeader->ullFileSize = vecFile.size();
+	memcpy(vecFile.data() + sizeof(TCookedTextureHeader), vecSubresources.data(), uiMipLevels * sizeof(TCookedSubresource));
+
+	for (unsigned int i = 0; i < uiMipLevels; ++i)
+	{
+		unsigned int uiWidth = max(1u, tImage.uiWidth >> i);
+		unsigned int uiHeight = max(1u, tImage.uiHeight >> i);
+		uint8_t* pDest = vecFile.data() + vecSubresources[i].ullOffset;
+
+		if (bCompressed) BlockCompress(eFormat, vecMips[i].data(), uiWidth, uiHeight, uiWidth * 4, pDest);
+		else memcpy(pDest, vecMips[i].data(), vecMips[i].size());
+	}
+
+	tImage.Release();
+	CLoadTelemetry::AddStage(LOAD_STAGE_CONVERT, tStageStart);
+
+	//Write it out, a failure here only costs the next launch another decode
+	tStageStart = std::chrono::steady_clock::now();
+	FILE* pFile = nullptr;
+	bool bWritten = fopen_s(&pFile, _kpcCookedFile, "wb") == 0 && pFile;
+	if (bWritten)
+	{
+		bWritten = fwrite(vecFile.data(), 1, vecFile.size(), pFile) == vecFile.size();
+		fclose(pFile);
+		if (!bWritten) remove(_kpcCookedFile);
+	}
+
+	if (!bWritten)
+	{
+		std::string debug = std::string("Failed to write cooked texture: ") + _kpcCookedFile + "\n";
+		CLogManager::GetInstance().WriteDebug(debug.c_str(), "Texture");
 	}
+	CLoadTelemetry::AddStage(LOAD_STAGE_COOK, tStageStart);
+
+	//Load back through the mapping so it can stream, otherwise upload everything from memory
+	if (bWritten && LoadCooked(_kpcCookedFile, nullptr)) return(true);
+
+	tStageStart = std::chrono::steady_clock::now();
+	bool bCreated = CreateFromCooked(vecFile.data(), vecFile.size());
+	CLoadTelemetry::AddStage(LOAD_STAGE_UPLOAD, tStageStart);
+
+	return(bCreated);
+}
+
+bool
+CTexture::GenerateMips(const char* _kpcFilename, const TImageData* _ptImages, unsigned int _uiImageCount, std::vector<std::vector<uint8_t>>& _rvecLevels) const
+{
+	std::vector<const uint8_t*> vecSlices(_uiImageCount);
+	bool bCutout = false;
+
+	for (unsigned int i = 0; i < _uiImageCount; ++i)
+	{
+		//Slices have to match the first and be tightly packed RGBA8
+		if (_ptImages[i].eFormat != DXGI_FORMAT_R8G8B8A8_UNORM || _ptImages[i].uiWidth != _ptImages[0].uiWidth || _ptImages[i].uiHeight != _ptImages[0].uiHeight
+			|| _ptImages[i].uiRowPitch != _ptImages[i].uiWidth * 4 || !_ptImages[i].pPixelData)
+		{
+			return(false);
+		}
+
+		vecSlices[i] = _ptImages[i].pPixelData;
+		bCutout = bCutout || IsAlphaCutout(_ptImages[i]);
+	}
+
+	//Colour is filtered in linear space, normals as plain data. Cutouts keep their coverage so foliage doesn't thin out
+	TMipDesc tDesc;
+	tDesc.eFilter = sm_eMipFilter;
+	tDesc.bSRGB = !IsNormalMapName(_kpcFilename);
+	tDesc.fAlphaReference = bCutout ? 0.5f : 0.0f;
+
+	TMipStats tStats;
+	if (!GenerateMipChain(tDesc, vecSlices.data(), _uiImageCount, _ptImages[0].uiWidth, _ptImages[0].uiHeight, _rvecLevels, &tStats)) return(false);
+
+	char pcStats[512];
+	double dMBs = tStats.dMs > 0.0 ? tStats.uiBytes / (1024.0 * 1024.0) / (tStats.dMs / 1000.0) : 0.0;
+	sprintf_s(pcStats, "Mips for %s: %zu levels in %.2fms, %.1f MB/s over %u threads (%.1f MB/s per core)\n",
+		_kpcFilename, _rvecLevels.size() / _uiImageCount, tStats.dMs, dMBs, tStats.uiThreads, dMBs / tStats.uiThreads);
+	CLogManager::GetInstance().WriteDebug(pcStats, "Texture");
+
+	return(true);
+}
+
+void
+CTexture::RequestMip(unsigned int _uiMip)
+{
+	//Keep the most detailed request made this frame
+	unsigned int uiCurrent = tm_uiRequestedMip;
+	while (_uiMip < uiCurrent && !tm_uiRequestedMip.compare_exchange_weak(uiCurrent, _uiMip));
+}
+
+unsigned int
+CTexture::LatchRequestedMip()
+{
+	return(tm_uiRequestedMip.exchange(m_uiTailMip));
+}
+
+size_t
+CTexture::GetMipBytes(unsigned int _uiFirstMip) const
+{
+	if (!m_pStreamFile) return(m_uiGPUBytes);
+
+	const TCookedSubresource* ptSubresources = reinterpret_cast<const TCookedSubresource*>(m_pStreamFile->GetData() + sizeof(TCookedTextureHeader));
+	size_t uiBytes = 0;
+	for (unsigned int i = _uiFirstMip; i < m_uiMipLevels; ++i) uiBytes += ptSubresources[i].uiSlicePitch;
+
+	return(uiBytes);
+}
 
-	//Release the lock as we are done allocating
-	pRenderer->GetGPUMutex().unlock();
+bool
+CTexture::BuildMips(unsigned int _uiFirstMip)
+{
+	D3D11_TEXTURE2D_DESC desc;
+	std::vector<D3D11_SUBRESOURCE_DATA> vecInitData;
+	ID3D11Texture2D* pTexture = nullptr;
+	ID3D11ShaderResourceView* pSRV = nullptr;
+	size_t uiBytes = 0;
+	unsigned long long ullFence = 0;
+
+	//The mapping is read only and stays put while we're referenced, so no lock is needed to read it
+	bool bBuilt = m_pStreamFile
+		&& BuildCookedDesc(m_pStreamFile->GetData(), m_pStreamFile->GetSize(), _uiFirstMip, desc, vecInitData)
+		&& CreateTexture(desc, vecInitData.data(), &pTexture, &pSRV, &uiBytes, &ullFence);
+
+	//Handed over even on failure so the main thread knows the job is done
+	m_mutexPending.lock();
+	CancelUpload(m_pPendingTexture);
+	ReleaseCOM(m_pPendingTexture);
+	ReleaseCOM(m_pPendingSRV);
+	m_pPendingTexture = pTexture;
+	m_pPendingSRV = pSRV;
+	m_uiPendingMip = _uiFirstMip;
+	m_uiPendingBytes = uiBytes;
+	m_ullPendingFence = ullFence;
+	m_bPendingReady = true;
+	m_mutexPending.unlock();
+
+	return(bBuilt);
+}
+
+bool
+CTexture::CommitMips()
+{
+	std::lock_guard<std::mutex> lockPending(m_mutexPending);
+
+	//Held back until the upload queue has the new chain on the GPU, the old one stays bound meanwhile
+	if (!m_bPendingReady || !CAssetManager::GetInstance().GetRenderer()->GetUploadQueue().IsComplete(m_ullPendingFence)) return(false);
+
+	m_bPendingReady = false;
+	tm_bStreaming = false;
+	if (!m_pPendingTexture) return(false);
+
+	//Between frames, so nothing is mid draw with the old view. Anything still bound keeps its own reference
+	ReleaseCOM(m_pTexture);
+	ReleaseCOM(m_pSRView);
+	m_pTexture = m_pPendingTexture;
+	m_pSRView = m_pPendingSRV;
+	m_uiGPUBytes = m_uiPendingBytes;
+	m_ullUploadFence = m_ullPendingFence;
+	tm_uiResidentMip = m_uiPendingMip;
+
+	m_pPendingTexture = nullptr;
+	m_pPendingSRV = nullptr;
+
+	return(true);
 }
 
 TImageData
-CTexture::LoadImageFromFile(const char* _strFilename)
+CTexture::LoadImageFromFile(const char* _strFilename, bool _bForceRGBA)
 {
 	HRESULT hr = S_OK;
 	unsigned int uiBitsPerPixel = 0;
@@ -168,39 +775,28 @@ CTexture::LoadImageFromFile(const char* _strFilename)
 
 	//Covert filename to a wchar_t for WIC
 	size_t uiLength = 0;
-	wchar_t wstrFilename[128];
-	mbstowcs_s(&uiLength, wstrFilename, _strFilename, 128);
+	wchar_t wstrFilename[MAX_PATH];
+	mbstowcs_s(&uiLength, wstrFilename, _strFilename, MAX_PATH);
 
 	//WIC Decoder
 	hr = pWIC->CreateDecoderFromFilename(wstrFilename, 0, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &pDecoder);
-	assert(SUCCEEDED(hr));
 
 	//Get Bitmap frame
-	hr = pDecoder->GetFrame(0, &pBitmapFrame);
-	assert(SUCCEEDED(hr));
+	if (SUCCEEDED(hr)) hr = pDecoder->GetFrame(0, &pBitmapFrame);
+
+	//Missing or not an image WIC can read, comes back empty
+	if (FAILED(hr))
+	{
+		ReleaseCOM(pDecoder);
+		return(TImageData());
+	}
 
 	//Attempt to get the size of the image
 	hr = pBitmapFrame->GetSize(&uiImportWidth, &uiImportHeight);
 	assert(SUCCEEDED(hr));
 
 	//Maximum size supported
-	switch (pRenderer->GetDevice()->GetFeatureLevel())
-	{
-	case D3D_FEATURE_LEVEL_9_1:
-	case D3D_FEATURE_LEVEL_9_2:
-		uiMaxSize = 2048;
-		break;
-	case D3D_FEATURE_LEVEL_9_3:
-		uiMaxSize = 4096;
-		break;
-	case D3D_FEATURE_LEVEL_10_0:
-	case D3D_FEATURE_LEVEL_10_1:
-		uiMaxSize = 8192;
-		break;
-	default:
-		uiMaxSize = D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION;
-		break;
-	}
+	uiMaxSize = pRenderer->GetMaxTextureSize();
 
 	//Scale down the image to match uiMaxSize
 	if (uiImportWidth > uiMaxSize || uiImportHeight > uiMaxSize)
@@ -264,9 +860,8 @@ CTexture::LoadImageFromFile(const char* _strFilename)
 
 	// Verify our target format is supported by the current device
 	// (handles WDDM 1.0 or WDDM 1.1 device driver cases as well as DirectX 11.0 Runtime without 16bpp format support)
-	unsigned int support = 0;
-	hr = pRenderer->GetDevice()->CheckFormatSupport(eFormat, &support);
-	if (FAILED(hr) || !(support & D3D11_FORMAT_SUPPORT_TEXTURE2D))
+	// The cooker always works in RGBA 32-bit
+	if (_bForceRGBA || !pRenderer->IsFormatSupported(eFormat, D3D11_FORMAT_SUPPORT_TEXTURE2D))
 	{
 		// Fallback to RGBA 32-bit format which is supported by all devices
 		memcpy(&convertGUID, &GUID_WICPixelFormat32bppRGBA, sizeof(WICPixelFormatGUID));
@@ -344,6 +939,10 @@ CTexture::LoadImageFromFile(const char* _strFilename)
 		ReleaseCOM(FC);
 	}
 
+	//Done with the file, the decoder holds it open
+	ReleaseCOM(pBitmapFrame);
+	ReleaseCOM(pDecoder);
+
 	//Return the image data
 	return(tUsableImage);
 }
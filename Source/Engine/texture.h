@@ -2,9 +2,15 @@
 #ifndef __TEXTURE_H__
 #define __TEXTURE_H__
 
+//Library Includes
+#include <vector>
+#include <atomic>
+#include <mutex>
+
 //Local Includes
 #include "renderer.h"
 #include "asset.h"
+#include "mipgen.h"
 
 //Data Types
 struct TImageData
@@ -31,6 +37,8 @@ struct TImageData
 };
 
 //Prototype
+class CMappedFile;
+class CTextureStreamer;
 class CTexture: public IAsset
 {
 	//Member Functions
@@ -40,9 +48,29 @@ public:
 
 	static EAssetType GetAssetType();
 
+	virtual size_t GetCPUBytes() const;
+	virtual size_t GetGPUBytes() const;
+	virtual void GetMemoryUsage(TAssetMemory& _rtMemory) const;
+
+	//Load from "<file>.ctex" when it is up to date, otherwise decode and cook one with mips and block compression. On by default
+	static void SetUseCooked(bool _bUseCooked);
+
+	//Cook colour textures to BC7 rather than BC1/BC3, slower to encode
+	static void SetHighQualityCook(bool _bHighQuality);
+
+	//Filter used to build mip chains for cooked and uncooked loads, Kaiser by default
+	static void SetMipFilter(EMipFilter _eFilter);
+
+	//Cooked textures load from a small tail mip and stream the rest in as they are drawn closer up, on by default
+	static void SetStreamed(bool _bStreamed);
+
+	//Offline cook of _kpcSourceFile to _kpcCookedFile using the current cook settings, nothing is kept loaded
+	//Safe to call from several threads as long as each has COM initialised
+	static bool Cook(const char* _kpcSourceFile, const char* _kpcCookedFile);
+
 protected:
 	CTexture();
-	CTexture(const CTexture& _rhs) = default;
+	CTexture(const CTexture& _rhs) = delete;
 	virtual ~CTexture();
 
 	//TODO: Support texturearray
@@ -50,17 +78,66 @@ protected:
 	//virtual bool Load(void* _pData, size_t _size);
 	virtual void Release();
 
+	//Hot reload, the GPU resources and streaming state are traded once the new pixels are up
+	virtual IAsset* CreateReloadTarget() const;
+	virtual bool SwapReloaded(IAsset* _pReloaded);
+
 private:
 	void CreateTextureArray(TImageData* _lptImages, int _iImageCount);
-	virtual TImageData LoadImageFromFile(const char* _strFilename);
+	bool CreateTexture(const D3D11_TEXTURE2D_DESC& _rtDesc, const D3D11_SUBRESOURCE_DATA* _ptInitialData, ID3D11Texture2D** _ppTexture, ID3D11ShaderResourceView** _ppSRV, size_t* _puiBytes, unsigned long long* _pullUploadFence) const;
+	virtual TImageData LoadImageFromFile(const char* _strFilename, bool _bForceRGBA = false);
+
+	bool LoadCooked(const char* _kpcCookedFile, const char* _kpcSourceFile);
+	bool CookImage(const char* _kpcFilename, const char* _kpcCookedFile);
+	bool CreateFromCooked(const BYTE* _pData, size_t _uiSize, unsigned int _uiFirstMip = 0);
+	bool BuildCookedDesc(const BYTE* _pData, size_t _uiSize, unsigned int _uiFirstMip, D3D11_TEXTURE2D_DESC& _rtDesc, std::vector<D3D11_SUBRESOURCE_DATA>& _rvecInitData) const;
+	DXGI_FORMAT ChooseCookFormat(const char* _kpcFilename, const TImageData& _rtImage) const;
+
+	//RGBA8 images only, levels come back in subresource order
+	bool GenerateMips(const char* _kpcFilename, const TImageData* _ptImages, unsigned int _uiImageCount, std::vector<std::vector<uint8_t>>& _rvecLevels) const;
+
+	//Streaming, driven by CTextureStreamer
+	void RequestMip(unsigned int _uiMip); //Any thread, keeps the most detailed request until latched
+	unsigned int LatchRequestedMip(); //Returns this frame's request and resets it to the tail
+	size_t GetMipBytes(unsigned int _uiFirstMip) const; //Size of the chain from _uiFirstMip down
+	bool BuildMips(unsigned int _uiFirstMip); //Worker, creates the replacement texture off to the side
+	bool CommitMips(); //Main thread, swaps in a finished replacement. Returns true if the size changed
 
 	//Member Variables
 protected:
+	static bool sm_bUseCooked;
+	static bool sm_bHighQualityCook;
+	static EMipFilter sm_eMipFilter;
+
+	static bool sm_bStreamed;
+
 	ID3D11Texture2D* m_pTexture;
 	ID3D11ShaderResourceView* m_pSRView;
 	bool m_bIsTextureArray;
+	size_t m_uiGPUBytes; //Sum of the uploaded slices
+	unsigned long long m_ullUploadFence; //GetSRV returns null until this completes
+
+	//Streaming, only set up for cooked 2D textures with mips below the tail size
+	CMappedFile* m_pStreamFile; //Kept mapped while loaded, higher mips are read from it on demand
+	unsigned int m_uiWidth; //Size of mip 0, not of what is resident
+	unsigned int m_uiHeight;
+	unsigned int m_uiMipLevels;
+	unsigned int m_uiTailMip; //Least detailed first mip, always resident
+	std::atomic<unsigned int> tm_uiResidentMip;
+	std::atomic<unsigned int> tm_uiRequestedMip;
+	std::atomic_bool tm_bStreaming; //Set from job submission until the result is committed
+
+	//Replacement built by a streaming job, waiting for the main thread
+	std::mutex m_mutexPending;
+	bool m_bPendingReady;
+	ID3D11Texture2D* m_pPendingTexture;
+	ID3D11ShaderResourceView* m_pPendingSRV;
+	unsigned int m_uiPendingMip;
+	size_t m_uiPendingBytes;
+	unsigned long long m_ullPendingFence;
 
 	friend CAssetManager;
+	friend CTextureStreamer;
 };
 
 #endif //__TEXTURE_H__
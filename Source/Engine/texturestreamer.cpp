@@ -0,0 +1,212 @@
+//Library Includes
+#include <algorithm>
+#include <cmath>
+
+//Local Includes
+#include "assetmanager.hpp"
+#include "camera.h"
+#include "imesh.h"
+#include "material.h"
+#include "logmanager.h"
+
+//This Include
+#include "texturestreamer.h"
+
+//Implementation
+CTextureStreamer::CTextureStreamer()
+	: m_bAsync(false)
+	, m_uiUploadBudget(4 * 1024 * 1024)
+	, m_uiDropDelay(120)
+	, m_uiStarted(0)
+	, m_uiCommitted(0)
+{
+	//Constructor
+}
+
+CTextureStreamer::~CTextureStreamer()
+{
+	//Destructor
+	Shutdown();
+}
+
+bool
+CTextureStreamer::Initialize()
+{
+	//Without a worker mips are still streamed, just built on the main thread
+	m_bAsync = m_jobSystem.Initialize(1);
+	return(m_bAsync);
+}
+
+void
+CTextureStreamer::Shutdown()
+{
+	m_jobSystem.Shutdown();
+	m_bAsync = false;
+}
+
+void
+CTextureStreamer::SetUploadBudget(size_t _uiBytesPerFrame)
+{
+	m_uiUploadBudget = _uiBytesPerFrame;
+}
+
+void
+CTextureStreamer::SetDropDelay(unsigned int _uiFrames)
+{
+	m_uiDropDelay = _uiFrames;
+}
+
+void
+CTextureStreamer::RequestMesh(const IMesh* _pMesh, const TMaterial& _rtMaterial, const DirectX::BoundingSphere& _rtWorldSphere, float _fWorldScale)
+{
+	if(!_pMesh) return;
+
+	CTexture* pTextures[] = { _rtMaterial.pDiffuseTex, _rtMaterial.pNormalTex, _rtMaterial.pSpecularTex, _rtMaterial.pAOTex };
+
+	for(CTexture* pTexture : pTextures)
+	{
+		//Loaded first, the streaming fields are written by the loader
+		if(!AssetLoaded(pTexture) || !pTexture->m_pStreamFile) continue;
+		pTexture->RequestMip(GetWantedMip(pTexture, _rtWorldSphere, _fWorldScale, _pMesh->GetUVDensity()));
+	}
+}
+
+void
+CTextureStreamer::Process()
+{
+	std::lock_guard<std::mutex> lockTextures(m_mutexTextures);
+	CAssetManager& rAssetManager = CAssetManager::GetInstance();
+	std::vector<TStreamedTexture*> vecCandidates;
+	unsigned int uiInFlight = 0;
+
+	for(TStreamedTexture& rtEntry : m_vecTextures)
+	{
+		CTexture* pTexture = rtEntry.pTexture;
+
+		//Swap in anything finished since last frame, the size changes so the budget has to hear about it
+		if(pTexture->CommitMips())
+		{
+			rAssetManager.ChargeAsset(pTexture);
+			++m_uiCommitted;
+		}
+
+		//More detail is acted on straight away, less has to be asked for over the drop delay
+		unsigned int uiRequested = pTexture->LatchRequestedMip();
+		if(uiRequested <= rtEntry.uiWantedMip || ++rtEntry.uiFramesUnwanted >= m_uiDropDelay)
+		{
+			rtEntry.uiWantedMip = uiRequested;
+			rtEntry.uiFramesUnwanted = 0;
+		}
+
+		if(pTexture->tm_bStreaming) ++uiInFlight;
+		else if(rtEntry.uiWantedMip != pTexture->tm_uiResidentMip && pTexture->GetAssetState() == EAssetState::Loaded) vecCandidates.push_back(&rtEntry);
+	}
+
+	//Furthest from what is wanted first. Drops come out negative so they go after every upgrade
+	std::sort(vecCandidates.begin(), vecCandidates.end(), [](const TStreamedTexture* _ptLeft, const TStreamedTexture* _ptRight)
+	{
+		int iLeft = (int)_ptLeft->pTexture->tm_uiResidentMip - (int)_ptLeft->uiWantedMip;
+		int iRight = (int)_ptRight->pTexture->tm_uiResidentMip - (int)_ptRight->uiWantedMip;
+		return(iLeft > iRight);
+	});
+
+	size_t uiStartedBytes = 0;
+	for(TStreamedTexture* ptEntry : vecCandidates)
+	{
+		if(uiInFlight >= sm_kuiMaxInFlight) break;
+
+		//The whole chain is recreated, so that is what gets uploaded
+		CTexture* pTexture = ptEntry->pTexture;
+		unsigned int uiMip = ptEntry->uiWantedMip;
+		size_t uiBytes = pTexture->GetMipBytes(uiMip);
+		if(m_uiUploadBudget && uiStartedBytes && uiStartedBytes + uiBytes > m_uiUploadBudget) continue;
+
+		pTexture->tm_bStreaming = true;
+		uiStartedBytes += uiBytes;
+		++uiInFlight;
+		++m_uiStarted;
+
+		//The reference keeps the texture from being evicted or unloaded while the job has it
+		CAssetRef<CTexture> pTextureRef(pTexture);
+		if(!m_bAsync || !m_jobSystem.Submit([pTextureRef, uiMip]() { pTextureRef->BuildMips(uiMip); }))
+		{
+			pTexture->BuildMips(uiMip);
+		}
+	}
+}
+
+void
+CTextureStreamer::WriteResidencyReport()
+{
+	std::lock_guard<std::mutex> lockTextures(m_mutexTextures);
+	char pcLine[512];
+	size_t uiResidentBytes = 0;
+	size_t uiWantedBytes = 0;
+	size_t uiFullBytes = 0;
+
+	sprintf_s(pcLine, "Residency of %zu streamed textures, %u mip changes started, %u committed\n", m_vecTextures.size(), m_uiStarted, m_uiCommitted);
+	CLogManager::GetInstance().WriteDebug(pcLine, "Texture Streamer");
+
+	for(TStreamedTexture& rtEntry : m_vecTextures)
+	{
+		CTexture* pTexture = rtEntry.pTexture;
+		unsigned int uiResident = pTexture->tm_uiResidentMip;
+
+		uiResidentBytes += pTexture->GetMipBytes(uiResident);
+		uiWantedBytes += pTexture->GetMipBytes(rtEntry.uiWantedMip);
+		uiFullBytes += pTexture->GetMipBytes(0);
+
+		sprintf_s(pcLine, "  %s: mip %u resident (%ux%u), mip %u wanted%s, %zuKB of %zuKB\n", pTexture->GetName(),
+			uiResident, max(1u, pTexture->m_uiWidth >> uiResident), max(1u, pTexture->m_uiHeight >> uiResident),
+			rtEntry.uiWantedMip, pTexture->tm_bStreaming ? " (streaming)" : "", pTexture->GetMipBytes(uiResident) / 1024, pTexture->GetMipBytes(0) / 1024);
+		CLogManager::GetInstance().WriteDebug(pcLine, "Texture Streamer");
+	}
+
+	sprintf_s(pcLine, "Resident %.2fMB, wanted %.2fMB, full detail %.2fMB\n",
+		uiResidentBytes / (1024.0 * 1024.0), uiWantedBytes / (1024.0 * 1024.0), uiFullBytes / (1024.0 * 1024.0));
+	CLogManager::GetInstance().WriteDebug(pcLine, "Texture Streamer");
+}
+
+void
+CTextureStreamer::AddTexture(CTexture* _pTexture)
+{
+	TStreamedTexture tEntry;
+	tEntry.pTexture = _pTexture;
+	tEntry.uiWantedMip = _pTexture->m_uiTailMip;
+	tEntry.uiFramesUnwanted = 0;
+
+	m_mutexTextures.lock();
+	m_vecTextures.push_back(tEntry);
+	m_mutexTextures.unlock();
+}
+
+void
+CTextureStreamer::RemoveTexture(CTexture* _pTexture)
+{
+	m_mutexTextures.lock();
+	auto it = std::find_if(m_vecTextures.begin(), m_vecTextures.end(), [_pTexture](const TStreamedTexture& _rtEntry) { return(_rtEntry.pTexture == _pTexture); });
+	if(it != m_vecTextures.end())
+	{
+		*it = m_vecTextures.back();
+		m_vecTextures.pop_back();
+	}
+	m_mutexTextures.unlock();
+}
+
+unsigned int
+CTextureStreamer::GetWantedMip(const CTexture* _pTexture, const DirectX::BoundingSphere& _rtWorldSphere, float _fWorldScale, float _fUVDensity) const
+{
+	//Without a perspective camera or a known density there's nothing to go on, ask for everything
+	CCamera* pCamera = CCamera::GetActiveCamera();
+	if(!pCamera || pCamera->IsOrthogonal() || _fUVDensity <= 0.0f || _fWorldScale <= 0.0f) return(0);
+
+	//Screen pixels per world unit at the nearest point of the bounds
+	float fPixelsPerUnit = pCamera->GetPixelsPerUnit(_rtWorldSphere);
+
+	//Texels per world unit at mip 0, halved by every mip after it
+	float fTexelsPerUnit = sqrtf((float)_pTexture->m_uiWidth * (float)_pTexture->m_uiHeight) / (_fUVDensity * _fWorldScale);
+	float fMip = log2f(fTexelsPerUnit / fPixelsPerUnit);
+
+	//Rounded towards detail
+	return(fMip <= 0.0f ? 0 : min((unsigned int)fMip, _pTexture->m_uiTailMip));
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef __TEXTURE_STREAMER_H__
+#define __TEXTURE_STREAMER_H__
+
+//Library Includes
+#include <vector>
+#include <mutex>
+#include <DirectXCollision.h>
+
+//Local Includes
+#include "jobsystem.h"
+
+//Streams mips of cooked textures in and out by how large they appear on screen
+//Textures load with only their tail resident. Draws request the mip their texel density needs from the camera,
+//the most wanted upgrades are rebuilt from the cooked file on a worker and swapped in between frames
+//D3D11 has no partially resident textures, so a change of mip recreates the texture with the new top level
+
+//Prototypes
+class CTexture;
+class IMesh;
+struct TMaterial;
+class CAssetManager;
+class CTextureStreamer
+{
+	//Types
+private:
+	struct TStreamedTexture
+	{
+		CTexture* pTexture;
+		unsigned int uiWantedMip; //Latched request, with drops held back by the delay
+		unsigned int uiFramesUnwanted; //Frames the request has been below what is resident
+	};
+
+	//Member Functions
+public:
+	CTextureStreamer();
+	~CTextureStreamer();
+
+	bool Initialize();
+	void Shutdown(); //Waits on the job in progress, anything not started is dropped
+
+	//Bytes of new mips started per frame, at least one texture always starts. 0 is unlimited
+	void SetUploadBudget(size_t _uiBytesPerFrame);
+
+	//Frames a texture has to go unwanted before its higher mips are dropped, stops thrashing at a mip boundary
+	void SetDropDelay(unsigned int _uiFrames);
+
+	//Requests the mips _rtMaterial needs on this mesh at its distance from the active camera, called as it is drawn
+	//_rtWorldSphere is the mesh bounds in world space, _fWorldScale the largest scale applied to the mesh
+	void RequestMesh(const IMesh* _pMesh, const TMaterial& _rtMaterial, const DirectX::BoundingSphere& _rtWorldSphere, float _fWorldScale);
+
+	//Main thread, once per frame. Swaps in finished mips then starts the next most wanted
+	void Process();
+
+	//Resident against wanted mips for every streamed texture, written to the debug log
+	void WriteResidencyReport();
+
+private:
+	CTextureStreamer(const CTextureStreamer& _rhs) = delete;
+
+	//Called by the texture on load and release
+	void AddTexture(CTexture* _pTexture);
+	void RemoveTexture(CTexture* _pTexture);
+
+	unsigned int GetWantedMip(const CTexture* _pTexture, const DirectX::BoundingSphere& _rtWorldSphere, float _fWorldScale, float _fUVDensity) const;
+
+	friend CTexture;
+
+	//Member Variables
+private:
+	static const unsigned int sm_kuiMaxInFlight = 2;
+
+	CJobSystem m_jobSystem; //One worker, uploads are paced by the renderer's upload queue anyway
+	bool m_bAsync;
+
+	//Additions come from loader threads, removal and everything else from the main thread
+	std::mutex m_mutexTextures;
+	std::vector<TStreamedTexture> m_vecTextures;
+
+	size_t m_uiUploadBudget;
+	unsigned int m_uiDropDelay;
+
+	//Totals for the residency report, from the last Process()
+	unsigned int m_uiStarted;
+	unsigned int m_uiCommitted;
+
+};
+
+#endif //__TEXTURE_STREAMER_H__
@@ -0,0 +1,304 @@
+//Local Includes
+#include "common.h"
+
+//This Include
+#include "uploadqueue.h"
+
+//Static Variables
+static const size_t s_kuiDefaultFrameBudget = 4 * 1024 * 1024;
+
+//Implementation
+CUploadQueue::CUploadQueue()
+	: m_pDevice(nullptr)
+	, m_pDeviceContext(nullptr)
+	, m_uiStagingIndex(0)
+	, m_uiStagingSize(0)
+	, m_uiFrameBudget(s_kuiDefaultFrameBudget)
+	, m_ullNextFence(0)
+	, m_ullCompletedFence(0)
+	, m_uiPendingBytes(0)
+{
+	//Constructor
+	for(unsigned int i = 0; i < sm_kuiStagingCount; ++i) m_pStaging[i] = nullptr;
+}
+
+CUploadQueue::~CUploadQueue()
+{
+	//Destructor
+	Shutdown();
+}
+
+bool
+CUploadQueue::Initialize(ID3D11Device* _pDevice, ID3D11DeviceContext* _pDeviceContext)
+{
+	m_pDevice = _pDevice;
+	m_pDeviceContext = _pDeviceContext;
+
+	return(m_pDevice && m_pDeviceContext && CreateStagingRing());
+}
+
+void
+CUploadQueue::Shutdown()
+{
+	m_mutexQueue.lock();
+	for(TUpload* ptUpload : m_dequeUploads)
+	{
+		ReleaseCOM(ptUpload->pDestination);
+		delete ptUpload;
+	}
+	m_dequeUploads.clear();
+	m_uiPendingBytes = 0;
+
+	//Nothing left to wait for, dropped uploads count as done so no one waits on them forever
+	m_ullCompletedFence = m_ullNextFence;
+	m_mutexQueue.unlock();
+
+	ReleaseStagingRing();
+	m_pDevice = nullptr;
+	m_pDeviceContext = nullptr;
+}
+
+unsigned long long
+CUploadQueue::QueueBuffer(ID3D11Buffer* _pBuffer, const void* _pData, size_t _uiBytes)
+{
+	if(!_pBuffer || !_pData || !_uiBytes) return(0);
+
+	TUpload* ptUpload = new TUpload();
+	ptUpload->pDestination = _pBuffer;
+	ptUpload->uiSubresource = 0;
+	ptUpload->uiRowPitch = 0;
+	ptUpload->uiSlicePitch = 0;
+	ptUpload->bBuffer = true;
+	ptUpload->vecData.assign(static_cast<const BYTE*>(_pData), static_cast<const BYTE*>(_pData) + _uiBytes);
+	ptUpload->uiUploaded = 0;
+	ptUpload->bCancelled = false;
+
+	return(Queue(ptUpload));
+}
+
+unsigned long long
+CUploadQueue::QueueTexture(ID3D11Texture2D* _pTexture, UINT _uiSubresource, const D3D11_SUBRESOURCE_DATA& _rtData)
+{
+	if(!_pTexture || !_rtData.pSysMem || !_rtData.SysMemSlicePitch) return(0);
+
+	TUpload* ptUpload = new TUpload();
+	ptUpload->pDestination = _pTexture;
+	ptUpload->uiSubresource = _uiSubresource;
+	ptUpload->uiRowPitch = _rtData.SysMemPitch;
+	ptUpload->uiSlicePitch = _rtData.SysMemSlicePitch;
+	ptUpload->bBuffer = false;
+	ptUpload->vecData.assign(static_cast<const BYTE*>(_rtData.pSysMem), static_cast<const BYTE*>(_rtData.pSysMem) + _rtData.SysMemSlicePitch);
+	ptUpload->uiUploaded = 0;
+	ptUpload->bCancelled = false;
+
+	return(Queue(ptUpload));
+}
+
+bool
+CUploadQueue::IsComplete(unsigned long long _ullFence) const
+{
+	return(_ullFence <= m_ullCompletedFence);
+}
+
+void
+CUploadQueue::Cancel(ID3D11Resource* _pResource)
+{
+	if(!_pResource) return;
+
+	std::lock_guard<std::mutex> lockQueue(m_mutexQueue);
+	for(TUpload* ptUpload : m_dequeUploads)
+	{
+		if(ptUpload->pDestination == _pResource) ptUpload->bCancelled = true;
+	}
+}
+
+size_t
+CUploadQueue::Process()
+{
+	if(!m_pDeviceContext) return(0);
+
+	//Budget changes are picked up here, the ring is only ever touched on this thread
+	if(m_uiStagingSize != m_uiFrameBudget && !CreateStagingRing()) return(0);
+	size_t uiBudget = m_uiStagingSize;
+
+	ID3D11Buffer* pStaging = m_pStaging[m_uiStagingIndex];
+	m_uiStagingIndex = (m_uiStagingIndex + 1) % sm_kuiStagingCount;
+
+	D3D11_MAPPED_SUBRESOURCE tMapped;
+	ZeroMemory(&tMapped, sizeof(D3D11_MAPPED_SUBRESOURCE));
+	bool bMapTried = false;
+	std::vector<TStagedCopy> vecCopies;
+	size_t uiStaged = 0;
+	size_t uiSent = 0;
+	size_t uiIndex = 0; //Uploads before this one are waiting on a frame with a staging buffer
+
+	while(true)
+	{
+		m_mutexQueue.lock();
+		TUpload* ptUpload = uiIndex < m_dequeUploads.size() ? m_dequeUploads[uiIndex] : nullptr;
+		bool bCancelled = ptUpload && ptUpload->bCancelled;
+		m_mutexQueue.unlock();
+		if(!ptUpload) break;
+
+		//Its owner released it while it was waiting, there is no one to upload for
+		if(bCancelled)
+		{
+			Complete(ptUpload);
+			continue;
+		}
+
+		size_t uiRemaining = ptUpload->vecData.size() - ptUpload->uiUploaded;
+		size_t uiBudgetLeft = uiBudget > uiSent ? uiBudget - uiSent : 0;
+
+		if(ptUpload->bBuffer)
+		{
+			//Mapped on the first buffer of the frame. Never waits, if the GPU still has it the buffers wait a frame
+			if(!bMapTried)
+			{
+				bMapTried = true;
+				if(FAILED(m_pDeviceContext->Map(pStaging, 0, D3D11_MAP_WRITE, D3D11_MAP_FLAG_DO_NOT_WAIT, &tMapped))) tMapped.pData = nullptr;
+			}
+
+			size_t uiChunk = min(uiRemaining, uiBudgetLeft);
+			if(!uiChunk) break;
+
+			//GPU still has the staging buffer, this buffer waits a frame while textures behind it can still go
+			if(!tMapped.pData)
+			{
+				++uiIndex;
+				continue;
+			}
+
+			memcpy_s(static_cast<BYTE*>(tMapped.pData) + uiStaged, m_uiStagingSize - uiStaged, ptUpload->vecData.data() + ptUpload->uiUploaded, uiChunk);
+
+			//Copied out once the staging buffer is unmapped, with its own reference in case this was the last chunk
+			TStagedCopy tCopy;
+			tCopy.pDestination = ptUpload->pDestination;
+			tCopy.pDestination->AddRef();
+			tCopy.uiDestinationOffset = (UINT)ptUpload->uiUploaded;
+			tCopy.uiStagingOffset = (UINT)uiStaged;
+			tCopy.uiBytes = (UINT)uiChunk;
+			vecCopies.push_back(tCopy);
+
+			ptUpload->uiUploaded += uiChunk;
+			uiStaged += uiChunk;
+			uiSent += uiChunk;
+
+			//Rest of it goes next frame
+			if(ptUpload->uiUploaded < ptUpload->vecData.size()) break;
+		}
+		else
+		{
+			//Whole subresources only, one bigger than the budget goes up on its own frame
+			if(uiSent && uiRemaining > uiBudgetLeft) break;
+
+			m_pDeviceContext->UpdateSubresource(ptUpload->pDestination, ptUpload->uiSubresource, nullptr, ptUpload->vecData.data(), ptUpload->uiRowPitch, ptUpload->uiSlicePitch);
+			uiSent += uiRemaining;
+		}
+
+		Complete(ptUpload);
+	}
+
+	if(tMapped.pData) m_pDeviceContext->Unmap(pStaging, 0);
+
+	//Queued ahead of any draw this frame, so completed fences are safe to draw with
+	for(TStagedCopy& rtCopy : vecCopies)
+	{
+		D3D11_BOX tSourceBox = { rtCopy.uiStagingOffset, 0, 0, rtCopy.uiStagingOffset + rtCopy.uiBytes, 1, 1 };
+		m_pDeviceContext->CopySubresourceRegion(rtCopy.pDestination, 0, rtCopy.uiDestinationOffset, 0, 0, pStaging, 0, &tSourceBox);
+		ReleaseCOM(rtCopy.pDestination);
+	}
+
+	return(uiSent);
+}
+
+void
+CUploadQueue::SetFrameBudget(size_t _uiBytes)
+{
+	m_uiFrameBudget = _uiBytes ? _uiBytes : s_kuiDefaultFrameBudget;
+}
+
+size_t
+CUploadQueue::GetFrameBudget() const
+{
+	return(m_uiFrameBudget);
+}
+
+size_t
+CUploadQueue::GetPendingBytes() const
+{
+	return(m_uiPendingBytes);
+}
+
+size_t
+CUploadQueue::GetStagingBytes() const
+{
+	return(m_uiStagingSize * sm_kuiStagingCount);
+}
+
+unsigned long long
+CUploadQueue::Queue(TUpload* _ptUpload)
+{
+	_ptUpload->pDestination->AddRef();
+	m_uiPendingBytes += _ptUpload->vecData.size();
+
+	//Fences are handed out under the lock so queue order and fence order always agree
+	std::lock_guard<std::mutex> lockQueue(m_mutexQueue);
+	_ptUpload->ullFence = ++m_ullNextFence;
+	m_dequeUploads.push_back(_ptUpload);
+
+	return(_ptUpload->ullFence);
+}
+
+void
+CUploadQueue::Complete(TUpload* _ptUpload)
+{
+	//Fences complete up to the oldest upload still waiting, which may be one skipped this frame
+	m_mutexQueue.lock();
+	for(auto itUpload = m_dequeUploads.begin(); itUpload != m_dequeUploads.end(); ++itUpload)
+	{
+		if(*itUpload != _ptUpload) continue;
+
+		m_dequeUploads.erase(itUpload);
+		break;
+	}
+	m_ullCompletedFence = m_dequeUploads.empty() ? m_ullNextFence : m_dequeUploads.front()->ullFence - 1;
+	m_mutexQueue.unlock();
+
+	m_uiPendingBytes -= _ptUpload->vecData.size();
+
+	ReleaseCOM(_ptUpload->pDestination);
+	delete _ptUpload;
+}
+
+bool
+CUploadQueue::CreateStagingRing()
+{
+	ReleaseStagingRing();
+	if(!m_pDevice) return(false);
+
+	D3D11_BUFFER_DESC tDesc;
+	ZeroMemory(&tDesc, sizeof(D3D11_BUFFER_DESC));
+	tDesc.ByteWidth = (UINT)m_uiFrameBudget;
+	tDesc.Usage = D3D11_USAGE_STAGING;
+	tDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	bool bSuccessful = true;
+	for(unsigned int i = 0; i < sm_kuiStagingCount && bSuccessful; ++i)
+	{
+		bSuccessful = SUCCEEDED(m_pDevice->CreateBuffer(&tDesc, nullptr, &m_pStaging[i]));
+	}
+
+	if(bSuccessful) m_uiStagingSize = tDesc.ByteWidth;
+	else ReleaseStagingRing();
+
+	return(bSuccessful);
+}
+
+void
+CUploadQueue::ReleaseStagingRing()
+{
+	for(unsigned int i = 0; i < sm_kuiStagingCount; ++i) ReleaseCOM(m_pStaging[i]);
+	m_uiStagingIndex = 0;
+	m_uiStagingSize = 0;
+}
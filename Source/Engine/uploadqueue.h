@@ -0,0 +1,106 @@
+#pragma once
+#ifndef __UPLOAD_QUEUE_H__
+#define __UPLOAD_QUEUE_H__
+
+//Library Includes
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+//Local Includes
+#include "dxcommon.h"
+
+//Initial data for resources created off the main thread. Loaders create the resource empty and queue its data,
+//the renderer drains the queue between frames up to a byte budget so a big load is spread over several frames
+//
+//Each upload is given a fence, an upload is on the GPU once IsComplete(fence) is true. A fence only completes once every
+//upload queued before it has too, so a later fence completing covers every earlier one. Fence 0 is always complete
+//
+//The queue holds a reference to every destination, owners cancel their uploads when they release the resource
+//
+//Buffers are copied through a ring of staging buffers, one per frame in flight, and may be split across frames
+//D3D11 can't copy a buffer into a texture so texture subresources go up whole through UpdateSubresource
+
+//Prototypes
+class CUploadQueue
+{
+	//Types
+private:
+	struct TUpload
+	{
+		ID3D11Resource* pDestination; //Referenced while queued
+		UINT uiSubresource;
+		UINT uiRowPitch; //Textures only
+		UINT uiSlicePitch;
+		bool bBuffer;
+		std::vector<BYTE> vecData;
+		size_t uiUploaded; //Buffers can go up over several frames
+		unsigned long long ullFence;
+		bool bCancelled; //Dropped at its next turn, set under the queue lock
+	};
+
+	struct TStagedCopy
+	{
+		ID3D11Resource* pDestination;
+		UINT uiDestinationOffset;
+		UINT uiStagingOffset;
+		UINT uiBytes;
+	};
+
+	//Member Functions
+public:
+	CUploadQueue();
+	~CUploadQueue();
+
+	bool Initialize(ID3D11Device* _pDevice, ID3D11DeviceContext* _pDeviceContext);
+	void Shutdown(); //Anything still queued is dropped
+
+	//Any thread. The data is copied, the caller can free it straight away
+	unsigned long long QueueBuffer(ID3D11Buffer* _pBuffer, const void* _pData, size_t _uiBytes);
+	unsigned long long QueueTexture(ID3D11Texture2D* _pTexture, UINT _uiSubresource, const D3D11_SUBRESOURCE_DATA& _rtData);
+
+	bool IsComplete(unsigned long long _ullFence) const;
+
+	//Any thread. Drops the uploads still queued for _pResource, call before releasing it. Fences stay valid and complete as usual
+	void Cancel(ID3D11Resource* _pResource);
+
+	//Main thread, between frames. Returns the bytes sent this frame
+	size_t Process();
+
+	//Bytes sent per Process, a single texture subresource larger than this still goes up on its own. 4MB by default
+	void SetFrameBudget(size_t _uiBytes);
+	size_t GetFrameBudget() const;
+	size_t GetPendingBytes() const;
+	size_t GetStagingBytes() const; //The staging ring, held whether or not anything is queued
+
+private:
+	CUploadQueue(const CUploadQueue& _rhs) = delete;
+
+	unsigned long long Queue(TUpload* _ptUpload);
+	void Complete(TUpload* _ptUpload);
+	bool CreateStagingRing();
+	void ReleaseStagingRing();
+
+	//Member Variables
+private:
+	static const unsigned int sm_kuiStagingCount = 3; //Frames a staging buffer is left before it is written again
+
+	ID3D11Device* m_pDevice;
+	ID3D11DeviceContext* m_pDeviceContext;
+
+	ID3D11Buffer* m_pStaging[sm_kuiStagingCount];
+	unsigned int m_uiStagingIndex;
+	size_t m_uiStagingSize;
+	std::atomic<size_t> m_uiFrameBudget;
+
+	//Only Process removes, so an item can be worked on outside the lock. Kept in fence order
+	mutable std::mutex m_mutexQueue;
+	std::deque<TUpload*> m_dequeUploads;
+	unsigned long long m_ullNextFence;
+	std::atomic<unsigned long long> m_ullCompletedFence;
+	std::atomic<size_t> m_uiPendingBytes;
+
+};
+
+#endif //__UPLOAD_QUEUE_H__
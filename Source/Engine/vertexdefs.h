@@ -29,4 +29,28 @@ struct TVertexTexNorm
 	}
 };
 
+//Compact static mesh vertex, 20 bytes against TVertexTexNorm's 44. Packed and checked by vertexpack.h, decoded in default_vs.hlsli
+//	pos				- UNORM16 across the mesh's bounding box, w unused. Both sides decode with GetPackedPositionDecode
+//	normalTangent	- octahedral SNORM16 normal in xy, tangent in zw
+//	texcoord		- half floats
+struct TVertexPacked
+{
+	//Variables
+	unsigned short pos[4];
+	short normalTangent[4];
+	unsigned short texcoord[2];
+};
+
+//Vertex formats the default shader has input layouts for, see IMesh::GetVertexFormat
+enum class EVertexFormat
+{
+	UNKNOWN,
+	TEX_NORM,	//TVertexTexNorm
+	PACKED,		//TVertexPacked
+};
+
+template<typename TVertexType> struct TVertexFormatOf { static const EVertexFormat keFormat = EVertexFormat::UNKNOWN; };
+template<> struct TVertexFormatOf<TVertexTexNorm> { static const EVertexFormat keFormat = EVertexFormat::TEX_NORM; };
+template<> struct TVertexFormatOf<TVertexPacked> { static const EVertexFormat keFormat = EVertexFormat::PACKED; };
+
 #endif //__VERTEX_DEFINES_H__
\ No newline at end of file
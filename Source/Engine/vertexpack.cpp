@@ -0,0 +1,334 @@
+//Library Includes
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+//Local Includes
+#include "logmanager.h"
+
+//This Include
+#include "vertexpack.h"
+
+//Helpers
+static inline float Clamp(float _fValue, float _fMin, float _fMax)
+{
+	return(_fValue < _fMin ? _fMin : (_fValue > _fMax ? _fMax : _fValue));
+}
+
+static inline float SignNotZero(float _fValue)
+{
+	return(_fValue >= 0.0f ? 1.0f : -1.0f);
+}
+
+//Unit vector onto the octahedron, the lower half folded over the upper
+static void EncodeOctahedral(const float3& _rvec3Normal, short* _psOut)
+{
+	float fLength = fabsf(_rvec3Normal.x) + fabsf(_rvec3Normal.y) + fabsf(_rvec3Normal.z);
+	if(fLength <= 0.0f)
+	{
+		_psOut[0] = _psOut[1] = 0;
+		return;
+	}
+
+	float fX = _rvec3Normal.x / fLength;
+	float fY = _rvec3Normal.y / fLength;
+	if(_rvec3Normal.z < 0.0f)
+	{
+		float fFoldedX = (1.0f - fabsf(fY)) * SignNotZero(fX);
+		float fFoldedY = (1.0f - fabsf(fX)) * SignNotZero(fY);
+		fX = fFoldedX;
+		fY = fFoldedY;
+	}
+
+	_psOut[0] = (short)lrintf(Clamp(fX, -1.0f, 1.0f) * 32767.0f);
+	_psOut[1] = (short)lrintf(Clamp(fY, -1.0f, 1.0f) * 32767.0f);
+}
+
+//Matches DecodeOctahedral in default_vs.hlsli, SNORM16 conversion included
+static float3 DecodeOctahedral(const short* _psIn)
+{
+	float fX = Clamp(_psIn[0] / 32767.0f, -1.0f, 1.0f);
+	float fY = Clamp(_psIn[1] / 32767.0f, -1.0f, 1.0f);
+	float fZ = 1.0f - fabsf(fX) - fabsf(fY);
+	float fFold = Clamp(-fZ, 0.0f, 1.0f);
+	fX += (fX >= 0.0f) ? -fFold : fFold;
+	fY += (fY >= 0.0f) ? -fFold : fFold;
+
+	float fLength = sqrtf(fX * fX + fY * fY + fZ * fZ);
+	return(float3(fX / fLength, fY / fLength, fZ / fLength));
+}
+
+//Degrees between the source direction and what came back, 0 for a source with no direction
+static float AngleBetween(const float3& _rvec3Source, const float3& _rvec3Decoded)
+{
+	float fLength = sqrtf(_rvec3Source.x * _rvec3Source.x + _rvec3Source.y * _rvec3Source.y + _rvec3Source.z * _rvec3Source.z);
+	if(fLength <= 1e-6f) return(0.0f);
+
+	float fDot = (_rvec3Source.x * _rvec3Decoded.x + _rvec3Source.y * _rvec3Decoded.y + _rvec3Source.z * _rvec3Decoded.z) / fLength;
+	return(acosf(Clamp(fDot, -1.0f, 1.0f)) * (180.0f / 3.14159265f));
+}
+
+static inline unsigned short QuantizeUnit(float _fValue, float _fScale, float _fOffset)
+{
+	if(_fScale <= 0.0f) return(0);
+	return((unsigned short)lrintf(Clamp((_fValue - _fOffset) / _fScale, 0.0f, 1.0f) * 65535.0f));
+}
+
+//Unit vector from an unnormalized direction
+static float3 Normalized(float _fX, float _fY, float _fZ)
+{
+	float fLength = sqrtf(_fX * _fX + _fY * _fY + _fZ * _fZ);
+	return(float3(_fX / fLength, _fY / fLength, _fZ / fLength));
+}
+
+//Between _fMin and _fMax, the same sequence every run
+static float NextRandom(unsigned int& _ruiSeed, float _fMin, float _fMax)
+{
+	_ruiSeed = _ruiSeed * 1664525u + 1013904223u;
+	return(_fMin + (_fMax - _fMin) * (float)(_ruiSeed >> 8) / 16777215.0f);
+}
+
+//Packs the case, unpacks it on its own and checks both the measured and reported worst errors against the tolerance
+static bool TestPackCase(const char* _kpcName, const std::vector<TVertexTexNorm>& _rvecVertices, bool _bShouldPack)
+{
+	//Bounds as the importer computes them
+	float3 vec3Min = _rvecVertices[0].pos;
+	float3 vec3Max = _rvecVertices[0].pos;
+	for(const TVertexTexNorm& rtVertex : _rvecVertices)
+	{
+		vec3Min = float3(fminf(vec3Min.x, rtVertex.pos.x), fminf(vec3Min.y, rtVertex.pos.y), fminf(vec3Min.z, rtVertex.pos.z));
+		vec3Max = float3(fmaxf(vec3Max.x, rtVertex.pos.x), fmaxf(vec3Max.y, rtVertex.pos.y), fmaxf(vec3Max.z, rtVertex.pos.z));
+	}
+	float3 vec3Center((vec3Min.x + vec3Max.x) * 0.5f, (vec3Min.y + vec3Max.y) * 0.5f, (vec3Min.z + vec3Max.z) * 0.5f);
+	float3 vec3Extends((vec3Max.x - vec3Min.x) * 0.5f, (vec3Max.y - vec3Min.y) * 0.5f, (vec3Max.z - vec3Min.z) * 0.5f);
+
+	std::vector<TVertexPacked> vecPacked(_rvecVertices.size());
+	TVertexPackError tReported = PackVertices(_rvecVertices.data(), (unsigned int)_rvecVertices.size(), vec3Center, vec3Extends, vecPacked.data());
+
+	float3 vec3Scale, vec3Offset;
+	GetPackedPositionDecode(vec3Center, vec3Extends, vec3Scale, vec3Offset);
+
+	TVertexPackError tMeasured;
+	for(size_t i = 0; i < _rvecVertices.size(); ++i)
+	{
+		const TVertexTexNorm& rtSource = _rvecVertices[i];
+		TVertexTexNorm tDecoded;
+		UnpackVertex(vecPacked[i], vec3Scale, vec3Offset, tDecoded);
+
+		tMeasured.fPosition = fmaxf(tMeasured.fPosition, fmaxf(fmaxf(fabsf(tDecoded.pos.x - rtSource.pos.x), fabsf(tDecoded.pos.y - rtSource.pos.y)), fabsf(tDecoded.pos.z - rtSource.pos.z)));
+		tMeasured.fNormalDegrees = fmaxf(tMeasured.fNormalDegrees, fmaxf(AngleBetween(rtSource.normal, tDecoded.normal), AngleBetween(rtSource.tangent, tDecoded.tangent)));
+		tMeasured.fTexcoord = fmaxf(tMeasured.fTexcoord, fmaxf(fabsf(tDecoded.texcoord.x - rtSource.texcoord.x), fabsf(tDecoded.texcoord.y - rtSource.texcoord.y)));
+	}
+
+	//The importer decides on the reported error, it has to match what unpacking actually gives
+	TVertexPackTolerance tTolerance;
+	bool bReportMatches = fabsf(tReported.fPosition - tMeasured.fPosition) <= 1e-6f && fabsf(tReported.fNormalDegrees - tMeasured.fNormalDegrees) <= 1e-4f
+		&& fabsf(tReported.fTexcoord - tMeasured.fTexcoord) <= 1e-6f;
+	bool bPassed = bReportMatches && tMeasured.IsWithin(tTolerance) == _bShouldPack && tReported.IsWithin(tTolerance) == _bShouldPack;
+
+	char pcStats[256];
+	sprintf_s(pcStats, "%s: %s, %u vertices, position %.6f (%.6f), normal %.4f deg (%.4f), UV %.6f (%.6f)%s\n", bPassed ? "Passed" : "FAILED", _kpcName,
+		(unsigned int)_rvecVertices.size(), tMeasured.fPosition, tTolerance.fPosition, tMeasured.fNormalDegrees, tTolerance.fNormalDegrees, tMeasured.fTexcoord, tTolerance.fTexcoord,
+		bReportMatches ? "" : ", reported error differs");
+	CLogManager::GetInstance().WriteDebug(pcStats, "Vertex Pack");
+
+	return(bPassed);
+}
+
+//Implementation
+void
+GetPackedPositionDecode(const float3& _rvec3BBCenter, const float3& _rvec3BBExtends, float3& _rvec3Scale, float3& _rvec3Offset)
+{
+	_rvec3Scale = float3(_rvec3BBExtends.x * 2.0f, _rvec3BBExtends.y * 2.0f, _rvec3BBExtends.z * 2.0f);
+	_rvec3Offset = float3(_rvec3BBCenter.x - _rvec3BBExtends.x, _rvec3BBCenter.y - _rvec3BBExtends.y, _rvec3BBCenter.z - _rvec3BBExtends.z);
+}
+
+void
+PackVertex(const TVertexTexNorm& _rtVertex, const float3& _rvec3Scale, const float3& _rvec3Offset, TVertexPacked& _rtPacked)
+{
+	_rtPacked.pos[0] = QuantizeUnit(_rtVertex.pos.x, _rvec3Scale.x, _rvec3Offset.x);
+	_rtPacked.pos[1] = QuantizeUnit(_rtVertex.pos.y, _rvec3Scale.y, _rvec3Offset.y);
+	_rtPacked.pos[2] = QuantizeUnit(_rtVertex.pos.z, _rvec3Scale.z, _rvec3Offset.z);
+	_rtPacked.pos[3] = 0;
+
+	EncodeOctahedral(_rtVertex.normal, &_rtPacked.normalTangent[0]);
+	EncodeOctahedral(_rtVertex.tangent, &_rtPacked.normalTangent[2]);
+
+	_rtPacked.texcoord[0] = FloatToHalf(_rtVertex.texcoord.x);
+	_rtPacked.texcoord[1] = FloatToHalf(_rtVertex.texcoord.y);
+}
+
+void
+UnpackVertex(const TVertexPacked& _rtPacked, const float3& _rvec3Scale, const float3& _rvec3Offset, TVertexTexNorm& _rtVertex)
+{
+	_rtVertex.pos = float3(_rtPacked.pos[0] / 65535.0f * _rvec3Scale.x + _rvec3Offset.x,
+		_rtPacked.pos[1] / 65535.0f * _rvec3Scale.y + _rvec3Offset.y,
+		_rtPacked.pos[2] / 65535.0f * _rvec3Scale.z + _rvec3Offset.z);
+
+	_rtVertex.normal = DecodeOctahedral(&_rtPacked.normalTangent[0]);
+	_rtVertex.tangent = DecodeOctahedral(&_rtPacked.normalTangent[2]);
+	_rtVertex.texcoord = float2(HalfToFloat(_rtPacked.texcoord[0]), HalfToFloat(_rtPacked.texcoord[1]));
+}
+
+TVertexPackError
+PackVertices(const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount, const float3& _rvec3BBCenter, const float3& _rvec3BBExtends, TVertexPacked* _pPacked)
+{
+	TVertexPackError tError;
+	float3 vec3Scale, vec3Offset;
+	GetPackedPositionDecode(_rvec3BBCenter, _rvec3BBExtends, vec3Scale, vec3Offset);
+
+	for(unsigned int i = 0; i < _uiVertexCount; ++i)
+	{
+		const TVertexTexNorm& rtSource = _pVertices[i];
+		PackVertex(rtSource, vec3Scale, vec3Offset, _pPacked[i]);
+
+		TVertexTexNorm tDecoded;
+		UnpackVertex(_pPacked[i], vec3Scale, vec3Offset, tDecoded);
+
+		//NaN fails every comparison below, so count it as out of tolerance instead
+		float fPosition = fmaxf(fmaxf(fabsf(tDecoded.pos.x - rtSource.pos.x), fabsf(tDecoded.pos.y - rtSource.pos.y)), fabsf(tDecoded.pos.z - rtSource.pos.z));
+		float fNormal = fmaxf(AngleBetween(rtSource.normal, tDecoded.normal), AngleBetween(rtSource.tangent, tDecoded.tangent));
+		float fTexcoord = fmaxf(fabsf(tDecoded.texcoord.x - rtSource.texcoord.x), fabsf(tDecoded.texcoord.y - rtSource.texcoord.y));
+
+		tError.fPosition = (fPosition == fPosition) ? fmaxf(tError.fPosition, fPosition) : INFINITY;
+		tError.fNormalDegrees = (fNormal == fNormal) ? fmaxf(tError.fNormalDegrees, fNormal) : INFINITY;
+		tError.fTexcoord = (fTexcoord == fTexcoord) ? fmaxf(tError.fTexcoord, fTexcoord) : INFINITY;
+	}
+
+	return(tError);
+}
+
+unsigned short
+FloatToHalf(float _fValue)
+{
+	unsigned int uiBits;
+	memcpy(&uiBits, &_fValue, sizeof(float));
+
+	unsigned short usSign = (unsigned short)((uiBits >> 16) & 0x8000);
+	unsigned int uiAbs = uiBits & 0x7FFFFFFF;
+
+	//NaN stays NaN, infinity and anything past the largest half become infinity
+	if(uiAbs > 0x7F800000) return(usSign | 0x7E00);
+	if(uiAbs >= 0x47800000) return(usSign | 0x7C00);
+
+	//Below the smallest normal half, shifted down into a subnormal
+	if(uiAbs < 0x38800000)
+	{
+		if(uiAbs < 0x33000000) return(usSign);
+
+		unsigned int uiShift = 126 - (uiAbs >> 23);
+		unsigned int uiMantissa = (uiAbs & 0x7FFFFF) | 0x800000;
+		unsigned int uiResult = uiMantissa >> uiShift;
+		unsigned int uiRemainder = uiMantissa & ((1u << uiShift) - 1);
+		unsigned int uiHalfway = 1u << (uiShift - 1);
+		if(uiRemainder > uiHalfway || (uiRemainder == uiHalfway && (uiResult & 1))) ++uiResult;
+
+		return(usSign | (unsigned short)uiResult);
+	}
+
+	//Rebias the exponent and round off the low 13 bits, a carry moves into the exponent as it should
+	unsigned int uiResult = (uiAbs - 0x38000000) >> 13;
+	unsigned int uiRemainder = uiAbs & 0x1FFF;
+	if(uiRemainder > 0x1000 || (uiRemainder == 0x1000 && (uiResult & 1))) ++uiResult;
+
+	return(usSign | (unsigned short)uiResult);
+}
+
+float
+HalfToFloat(unsigned short _usValue)
+{
+	unsigned int uiSign = (unsigned int)(_usValue & 0x8000) << 16;
+	unsigned int uiExponent = (_usValue >> 10) & 0x1F;
+	unsigned int uiMantissa = _usValue & 0x3FF;
+
+	if(uiExponent == 0)
+	{
+		float fValue = ldexpf((float)uiMantissa, -24);
+		return(uiSign ? -fValue : fValue);
+	}
+
+	unsigned int uiBits = uiSign | (uiExponent == 31 ? 0x7F800000 : ((uiExponent + 112) << 23)) | (uiMantissa << 13);
+	float fValue;
+	memcpy(&fValue, &uiBits, sizeof(float));
+
+	return(fValue);
+}
+
+bool
+TestVertexPacking()
+{
+	unsigned int uiSeed = 12345;
+	std::vector<TVertexTexNorm> vecVertices;
+	bool bPassed = true;
+
+	//Scattered through a box about the size of a demo prop, any direction and UVs over a tile
+	vecVertices.resize(4096);
+	for(TVertexTexNorm& rtVertex : vecVertices)
+	{
+		rtVertex.pos = float3(NextRandom(uiSeed, -20.0f, 20.0f), NextRandom(uiSeed, -5.0f, 30.0f), NextRandom(uiSeed, -20.0f, 20.0f));
+		rtVertex.normal = Normalized(NextRandom(uiSeed, -1.0f, 1.0f), NextRandom(uiSeed, -1.0f, 1.0f), NextRandom(uiSeed, -1.0f, 1.0f));
+		rtVertex.tangent = Normalized(NextRandom(uiSeed, -1.0f, 1.0f), NextRandom(uiSeed, -1.0f, 1.0f), NextRandom(uiSeed, -1.0f, 1.0f));
+		rtVertex.texcoord = float2(NextRandom(uiSeed, 0.0f, 1.0f), NextRandom(uiSeed, 0.0f, 1.0f));
+	}
+	bPassed = TestPackCase("random", vecVertices, true) && bPassed;
+
+	//Flat on Y, that axis has no extent to quantize across
+	for(TVertexTexNorm& rtVertex : vecVertices) rtVertex.pos.y = 2.5f;
+	bPassed = TestPackCase("flat bounds", vecVertices, true) && bPassed;
+
+	//Every vertex on one point, the whole box is degenerate
+	for(TVertexTexNorm& rtVertex : vecVertices) rtVertex.pos = float3(-3.0f, 7.0f, 0.25f);
+	bPassed = TestPackCase("point bounds", vecVertices, true) && bPassed;
+
+	//Both signs of every axis as normal and tangent, the corners and centre of the octahedral square. Zero length ones are skipped
+	const float3 pvec3Axes[] = { float3(1.0f, 0.0f, 0.0f), float3(-1.0f, 0.0f, 0.0f), float3(0.0f, 1.0f, 0.0f), float3(0.0f, -1.0f, 0.0f),
+		float3(0.0f, 0.0f, 1.0f), float3(0.0f, 0.0f, -1.0f), float3(0.0f, 0.0f, 0.0f) };
+	vecVertices.clear();
+	for(const float3& rvec3Normal : pvec3Axes)
+	{
+		for(const float3& rvec3Tangent : pvec3Axes)
+		{
+			TVertexTexNorm tVertex;
+			tVertex.pos = float3((float)vecVertices.size(), 0.0f, 1.0f);
+			tVertex.normal = rvec3Normal;
+			tVertex.tangent = rvec3Tangent;
+			tVertex.texcoord = float2(0.0f, 1.0f);
+			vecVertices.push_back(tVertex);
+		}
+	}
+	bPassed = TestPackCase("axis aligned normals", vecVertices, true) && bPassed;
+
+	//Lower hemisphere folds over the upper, the seams are just under the equator, around -Z and where X or Y changes sign
+	vecVertices.clear();
+	const float pfSeams[] = { -1e-6f, -1e-3f, -0.05f, -0.5f, -0.999f, -1.0f };
+	for(float fZ : pfSeams)
+	{
+		for(unsigned int i = 0; i < 64; ++i)
+		{
+			float fAngle = i * (3.14159265f * 2.0f / 64.0f) + (i % 2 ? 1e-4f : 0.0f);
+			float fRadius = sqrtf(1.0f - fZ * fZ);
+
+			TVertexTexNorm tVertex;
+			tVertex.pos = float3(NextRandom(uiSeed, -1.0f, 1.0f), NextRandom(uiSeed, -1.0f, 1.0f), NextRandom(uiSeed, -1.0f, 1.0f));
+			tVertex.normal = Normalized(fRadius * cosf(fAngle), fRadius * sinf(fAngle), fZ);
+			tVertex.tangent = Normalized(fRadius * cosf(fAngle), -fRadius * sinf(fAngle), fZ);
+			tVertex.texcoord = float2(NextRandom(uiSeed, 0.0f, 1.0f), NextRandom(uiSeed, 0.0f, 1.0f));
+			vecVertices.push_back(tVertex);
+		}
+	}
+	bPassed = TestPackCase("octahedral fold", vecVertices, true) && bPassed;
+
+	//Half floats lose UV precision past 2, tiled UVs that far out have to be caught so the mesh keeps full vertices
+	for(TVertexTexNorm& rtVertex : vecVertices) rtVertex.texcoord = float2(rtVertex.texcoord.x * 8.0f + 8.0f, rtVertex.texcoord.y);
+	bPassed = TestPackCase("tiled UVs past half precision", vecVertices, false) && bPassed;
+
+	//Bounds too large for 16 bits to hold a millimetre
+	vecVertices[0].pos = float3(-500.0f, 0.0f, 0.0f);
+	vecVertices[1].pos = float3(500.0f, 0.0f, 0.0f);
+	for(TVertexTexNorm& rtVertex : vecVertices) rtVertex.texcoord = float2(0.5f, 0.5f);
+	bPassed = TestPackCase("bounds past position precision", vecVertices, false) && bPassed;
+
+	CLogManager::GetInstance().WriteDebug(bPassed ? "Vertex packing round trip passed\n" : "Vertex packing round trip FAILED\n", "Vertex Pack");
+	return(bPassed);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef __VERTEX_PACK_H__
+#define __VERTEX_PACK_H__
+
+//Local Includes
+#include "dxcommon.h"
+#include "vertexdefs.h"
+
+//CPU side of TVertexPacked. Packing is checked by unpacking every vertex again and measuring the round trip against the source,
+//the importer only keeps packed vertices when each attribute's worst error is inside the tolerance
+
+//Types
+struct TVertexPackTolerance
+{
+	float fPosition;		//Object space units, a millimetre at the demo scene's scale
+	float fNormalDegrees;	//Angle between the source and decoded normal or tangent
+	float fTexcoord;		//UV units, half a texel of a 1024 texture
+
+	TVertexPackTolerance()
+		: fPosition(0.001f)
+		, fNormalDegrees(0.5f)
+		, fTexcoord(1.0f / 2048.0f)
+	{
+	}
+};
+
+struct TVertexPackError
+{
+	float fPosition;
+	float fNormalDegrees; //Zero length normals and tangents are skipped, there is no direction to keep
+	float fTexcoord;
+
+	TVertexPackError()
+		: fPosition(0.0f)
+		, fNormalDegrees(0.0f)
+		, fTexcoord(0.0f)
+	{
+	}
+
+	bool IsWithin(const TVertexPackTolerance& _rtTolerance) const
+	{
+		return(fPosition <= _rtTolerance.fPosition && fNormalDegrees <= _rtTolerance.fNormalDegrees && fTexcoord <= _rtTolerance.fTexcoord);
+	}
+};
+
+//Prototypes
+//Positions are stored across the bounding box, position = stored * scale + offset. The shader is given the same values
+void GetPackedPositionDecode(const float3& _rvec3BBCenter, const float3& _rvec3BBExtends, float3& _rvec3Scale, float3& _rvec3Offset);
+
+void PackVertex(const TVertexTexNorm& _rtVertex, const float3& _rvec3Scale, const float3& _rvec3Offset, TVertexPacked& _rtPacked);
+void UnpackVertex(const TVertexPacked& _rtPacked, const float3& _rvec3Scale, const float3& _rvec3Offset, TVertexTexNorm& _rtVertex); //Decodes as the GPU does
+
+//Packs _uiVertexCount vertices against the bounding box and returns the worst round trip error of each attribute
+TVertexPackError PackVertices(const TVertexTexNorm* _pVertices, unsigned int _uiVertexCount, const float3& _rvec3BBCenter, const float3& _rvec3BBExtends, TVertexPacked* _pPacked);
+
+//CPU round trip over random vertices, flat and zero sized bounds, axis aligned normals and the octahedral fold. Each case is
+//logged with its worst errors, returns false if one that should pack is out of tolerance or one that shouldn't isn't caught
+bool TestVertexPacking();
+
+//IEEE half floats, rounded to nearest even
+unsigned short FloatToHalf(float _fValue);
+float HalfToFloat(unsigned short _usValue);
+
+#endif //__VERTEX_PACK_H__